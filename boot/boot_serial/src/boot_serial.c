@@ -73,6 +73,14 @@
 #include "boot_serial/boot_serial_encryption.h"
 #endif
 
+#ifdef MCUBOOT_SERIAL_UPLOAD_HASH
+#include "bootutil/crypto/sha.h"
+#endif
+
+#ifdef MCUBOOT_SERIAL_UPLOAD_COMPRESSION
+#include "boot_serial_heatshrink.h"
+#endif
+
 #include "bootutil/boot_hooks.h"
 
 BOOT_LOG_MODULE_DECLARE(mcuboot);
@@ -128,7 +136,40 @@ BOOT_LOG_MODULE_DECLARE(mcuboot);
 
 #define BOOT_SERIAL_OUT_MAX     (BOOT_SERIAL_MAX_MESSAGE_SIZE * BOOT_IMAGE_NUMBER)
 
-#define BOOT_SERIAL_FRAME_MTU   124 /* 127 - pkt start (2 bytes) and stop (1 byte) */
+#ifndef MCUBOOT_SERIAL_MAX_LINE_INPUT_LEN
+#define MCUBOOT_SERIAL_MAX_LINE_INPUT_LEN 128
+#endif
+
+#ifdef MCUBOOT_SERIAL_UPLOAD_WINDOW
+#define BOOT_SERIAL_UPLOAD_BUF_COUNT (MCUBOOT_SERIAL_UPLOAD_WINDOW + 1)
+#else
+#define BOOT_SERIAL_UPLOAD_BUF_COUNT 1
+#endif
+
+#if defined(MCUBOOT_SERIAL_UPLOAD_WINDOW) || defined(MCUBOOT_SERIAL_BINARY_FRAMING) || \
+    defined(MCUBOOT_SERIAL_UPLOAD_COMPRESSION)
+#define BOOT_SERIAL_MGMT_PARAMS
+#endif
+
+#ifdef MCUBOOT_SERIAL_UPLOAD_COMPRESSION
+/*
+ * Decompressed data is written out from the window of the decoder half of
+ * it at a time, so that the other half keeps the data back-references need.
+ */
+#define BOOT_SERIAL_HS_FLUSH_SIZE   (1 << (BOOT_SERIAL_HS_WINDOW_BITS_MAX - 1))
+
+#if BOOT_SERIAL_HS_FLUSH_SIZE < BOOT_MAX_ALIGN
+#error "MCUBOOT_SERIAL_UPLOAD_COMPRESSION_WINDOW_BITS too small for the flash alignment"
+#endif
+#endif
+
+#ifdef MCUBOOT_SERIAL_BINARY_FRAMING
+/*
+ * COBS encoded data has no zero bytes; it is sent xor-ed with this so that
+ * the line terminator does not appear within a fragment instead.
+ */
+#define BOOT_SERIAL_COBS_XOR    '\n'
+#endif
 
 /* Number of estimated CBOR elements for responses */
 #define CBOR_ENTRIES_SLOT_INFO_IMAGE_MAP 4
@@ -160,6 +201,14 @@ BOOT_LOG_MODULE_DECLARE(mcuboot);
 #define IMAGES_ITER(x)
 #endif
 
+#if defined(MCUBOOT_SERIAL_UPLOAD_HASH) && defined(MCUBOOT_SIGN_PURE)
+#error "MCUBOOT_SERIAL_UPLOAD_HASH requires a hashed signature"
+#endif
+
+#if defined(MCUBOOT_SERIAL_ERASE_AHEAD) && !defined(MCUBOOT_ERASE_PROGRESSIVELY)
+#error "MCUBOOT_SERIAL_ERASE_AHEAD requires MCUBOOT_ERASE_PROGRESSIVELY"
+#endif
+
 #define SWAP_USING_OFFSET_SECTOR_UPDATE_BEGIN 1
 #define BOOT_DIRECT_UPLOAD_SECONDARY_SLOT_ID_REMAINDER 0
 
@@ -171,6 +220,11 @@ static bool bs_entry;
 
 static char bs_obuf[BOOT_SERIAL_OUT_MAX];
 
+#ifdef MCUBOOT_SERIAL_BINARY_FRAMING
+/* Framing of the request being processed, responses use the same one. */
+static bool bs_binary;
+#endif
+
 static void boot_serial_output(void);
 
 #ifdef MCUBOOT_SERIAL_IMG_GRP_HASH
@@ -891,6 +945,291 @@ static off_t erase_range(const struct flash_area *fap, off_t start, off_t end)
 }
 #endif
 
+#ifdef MCUBOOT_SERIAL_UPLOAD_WINDOW
+/*
+ * Reorder buffer of windowed uploads: chunks received ahead of the expected
+ * offset are held here until the data preceding them has been written.
+ */
+struct bs_upload_chunk {
+    size_t off;                         /* Offset of chunk within image */
+    size_t len;                         /* Length of chunk, 0 if entry is free */
+    uint8_t data[MCUBOOT_SERIAL_MAX_RECEIVE_SIZE];
+};
+
+static struct bs_upload_chunk bs_upload_window[MCUBOOT_SERIAL_UPLOAD_WINDOW];
+
+static void
+bs_upload_window_reset(void)
+{
+    int i;
+
+    for (i = 0; i < MCUBOOT_SERIAL_UPLOAD_WINDOW; i++) {
+        bs_upload_window[i].len = 0;
+    }
+}
+
+/*
+ * Holds a chunk received ahead of curr_off. When the buffer is full the
+ * chunk replaces the one furthest away, if it is further away itself it is
+ * dropped and will be requested again.
+ */
+static void
+bs_upload_window_store(size_t off, const uint8_t *chunk, size_t len)
+{
+    struct bs_upload_chunk *entry = NULL;
+    int i;
+
+    if (len == 0 || len > sizeof(bs_upload_window[0].data)) {
+        return;
+    }
+
+    for (i = 0; i < MCUBOOT_SERIAL_UPLOAD_WINDOW; i++) {
+        if (bs_upload_window[i].len == 0) {
+            if (entry == NULL || entry->len != 0) {
+                entry = &bs_upload_window[i];
+            }
+        } else if (bs_upload_window[i].off == off) {
+            /* Retransmission of a chunk that is already held. */
+            return;
+        } else if (entry == NULL ||
+                   (entry->len != 0 && bs_upload_window[i].off > entry->off)) {
+            entry = &bs_upload_window[i];
+        }
+    }
+
+    if (entry->len != 0 && entry->off < off) {
+        return;
+    }
+
+    entry->off = off;
+    entry->len = len;
+    memcpy(entry->data, chunk, len);
+}
+
+/*
+ * Takes the held chunk, if any, that continues the image at curr_off;
+ * chunks that are entirely behind curr_off are released on the way.
+ */
+static bool
+bs_upload_window_take(size_t curr_off, const uint8_t **chunk, size_t *len)
+{
+    struct bs_upload_chunk *entry;
+    bool found = false;
+    int i;
+
+    for (i = 0; i < MCUBOOT_SERIAL_UPLOAD_WINDOW; i++) {
+        entry = &bs_upload_window[i];
+
+        if (entry->len == 0 || entry->off > curr_off) {
+            continue;
+        }
+
+        if (entry->off + entry->len > curr_off) {
+            if (found) {
+                continue;
+            }
+
+            /* The data stays in place until the next chunk is stored. */
+            *chunk = entry->data + (curr_off - entry->off);
+            *len = entry->off + entry->len - curr_off;
+            found = true;
+        }
+
+        entry->len = 0;
+    }
+
+    return found;
+}
+#endif
+
+#ifdef MCUBOOT_SERIAL_UPLOAD_COMPRESSION
+/*
+ * State of a compressed upload; offsets of chunks are then offsets within
+ * the compressed stream, which is decoded into the slot as it is received.
+ */
+struct bs_upload_comp {
+    struct boot_serial_hs hs;
+    uint32_t size;                      /* Decompressed size, 0 if not compressed */
+    uint32_t written;                   /* Decompressed bytes written to the slot */
+};
+
+static struct bs_upload_comp bs_upload_comp;
+#endif
+
+#ifdef MCUBOOT_SERIAL_UPLOAD_HASH
+/*
+ * Hash of an image being uploaded to a primary slot, computed over each chunk
+ * read back once written, so that its signature can be checked when the
+ * upload completes without reading the whole image again.
+ */
+struct bs_upload_hash {
+    bootutil_sha_context sha;
+    struct image_header hdr;            /* Header of the image */
+    uint32_t len;                       /* Length of hashed data, 0 if not hashing */
+    uint32_t off;                       /* Length of data hashed so far */
+};
+
+static struct bs_upload_hash bs_upload_hash;
+
+/*
+ * Starts hashing the image uploaded to fap, given its first chunk; only
+ * plain images uploaded to a primary slot are hashed.
+ */
+static void
+bs_upload_hash_start(const struct flash_area *fap, const uint8_t *chunk, size_t len,
+                     size_t img_size)
+{
+    struct image_header *hdr = &bs_upload_hash.hdr;
+    int image_index;
+
+    if (bs_upload_hash.len != 0) {
+        bootutil_sha_drop(&bs_upload_hash.sha);
+        bs_upload_hash.len = 0;
+    }
+
+    if (len < sizeof(*hdr)) {
+        return;
+    }
+
+    memcpy(hdr, chunk, sizeof(*hdr));
+    if (hdr->ih_magic != IMAGE_MAGIC || (hdr->ih_flags & ENCRYPTIONFLAGS) != 0 ||
+        (uint32_t)hdr->ih_hdr_size + hdr->ih_img_size + hdr->ih_protect_tlv_size > img_size) {
+        return;
+    }
+
+    for (image_index = 0; image_index < BOOT_IMAGE_NUMBER; image_index++) {
+        if (flash_area_get_id(fap) == flash_area_id_from_multi_image_slot(image_index, 0)) {
+            break;
+        }
+    }
+
+    if (image_index == BOOT_IMAGE_NUMBER) {
+        return;
+    }
+
+    bootutil_sha_init(&bs_upload_hash.sha);
+    bs_upload_hash.len = hdr->ih_hdr_size + hdr->ih_img_size + hdr->ih_protect_tlv_size;
+    bs_upload_hash.off = 0;
+}
+
+/*
+ * Feeds the len bytes written at offset off of the image into its hash. They
+ * are read back from fap, so that what is hashed is what the slot holds;
+ * hashed images are written from the start of the slot.
+ */
+static void
+bs_upload_hash_update(const struct flash_area *fap, uint32_t off, uint32_t len)
+{
+    uint8_t buf[64];
+    uint32_t chunk_sz;
+
+    if (bs_upload_hash.len == 0 || off != bs_upload_hash.off ||
+        bs_upload_hash.off >= bs_upload_hash.len) {
+        return;
+    }
+
+    if (len > bs_upload_hash.len - bs_upload_hash.off) {
+        len = bs_upload_hash.len - bs_upload_hash.off;
+    }
+
+    while (len > 0) {
+        chunk_sz = len < sizeof(buf) ? len : sizeof(buf);
+        if (flash_area_read(fap, off, buf, chunk_sz) != 0) {
+            /* Leaves the hash incomplete */
+            return;
+        }
+        bootutil_sha_update(&bs_upload_hash.sha, buf, chunk_sz);
+        off += chunk_sz;
+        len -= chunk_sz;
+        bs_upload_hash.off = off;
+    }
+}
+
+/*
+ * Checks the signature of the uploaded image against its hash, and records
+ * the image as validated for the next boot.
+ *
+ * @return 1 if the image was verified, 0 if it failed verification and -1 if
+ *         it was not hashed.
+ */
+static int
+bs_upload_hash_check(const struct flash_area *fap)
+{
+    uint8_t digest[IMAGE_HASH_SIZE];
+    struct image_header hdr;
+    struct boot_loader_state *state;
+    FIH_DECLARE(fih_rc, FIH_FAILURE);
+    int image_index;
+    int rc;
+
+    if (bs_upload_hash.len == 0) {
+        return -1;
+    }
+
+    rc = bs_upload_hash.off == bs_upload_hash.len ? 0 : -1;
+    if (rc == 0) {
+        bootutil_sha_finish(&bs_upload_hash.sha, digest);
+    }
+    bootutil_sha_drop(&bs_upload_hash.sha);
+    bs_upload_hash.len = 0;
+
+    if (rc != 0) {
+        return -1;
+    }
+
+    /* The header was taken from the first chunk received, before it was
+     * written; it must also be the one in the slot.
+     */
+    if (flash_area_read(fap, 0, &hdr, sizeof(hdr)) != 0 ||
+        memcmp(&hdr, &bs_upload_hash.hdr, sizeof(hdr)) != 0) {
+        return -1;
+    }
+
+    for (image_index = 0; image_index < BOOT_IMAGE_NUMBER; image_index++) {
+        if (flash_area_get_id(fap) == flash_area_id_from_multi_image_slot(image_index, 0)) {
+            break;
+        }
+    }
+
+    state = boot_get_loader_state();
+    boot_state_init(state);
+
+    rc = boot_open_all_flash_areas(state);
+    if (rc == 0) {
+#if !defined(MCUBOOT_DIRECT_XIP) && !defined(MCUBOOT_RAM_LOAD)
+        IMAGES_ITER(BOOT_CURR_IMG(state)) {
+            if (rc == 0) {
+                rc = boot_read_sectors(state, NULL);
+            }
+        }
+#endif
+        if (rc == 0) {
+#if (BOOT_IMAGE_NUMBER > 1)
+            BOOT_CURR_IMG(state) = image_index;
+#endif
+            FIH_CALL(bootutil_img_validate_digest, fih_rc, state, &bs_upload_hash.hdr, fap,
+                     digest);
+        }
+        boot_close_all_flash_areas(state);
+    }
+
+    boot_state_clear(state);
+
+    if (FIH_NOT_EQ(fih_rc, FIH_SUCCESS)) {
+        BOOT_LOG_ERR("Uploaded image %d failed verification", image_index);
+        return 0;
+    }
+
+#ifdef MCUBOOT_VALIDATION_CACHE
+    if (boot_validation_cache_record(image_index, &bs_upload_hash.hdr, digest) != 0) {
+        BOOT_LOG_WRN("Image %d: failed to store validation record", image_index);
+    }
+#endif
+
+    return 1;
+}
+#endif
+
 /*
  * Image upload request.
  */
@@ -912,6 +1251,15 @@ bs_upload(char *buf, int len)
     struct zcbor_string img_chunk_data = { 0 };
     size_t decoded = 0;
     bool ok;
+#ifdef MCUBOOT_SERIAL_UPLOAD_HASH
+    uint32_t hash_off;                  /* Offset of chunk being written */
+    int verified = -1;                  /* Result of bs_upload_hash_check() */
+#endif
+#ifdef MCUBOOT_SERIAL_UPLOAD_COMPRESSION
+    uint32_t hs_w = UINT_MAX;           /* Window size of compressed upload */
+    uint32_t hs_l = UINT_MAX;           /* Lookahead size of compressed upload */
+    size_t dlen = SIZE_MAX;             /* Decompressed size of compressed upload */
+#endif
 #ifdef MCUBOOT_ERASE_PROGRESSIVELY
     static off_t not_yet_erased = 0;    /* Offset of next byte to erase; writes to flash
                                          * are done in consecutive manner and erases are done
@@ -936,6 +1284,11 @@ bs_upload(char *buf, int len)
         ZCBOR_MAP_DECODE_KEY_DECODER("data", zcbor_bstr_decode, &img_chunk_data),
         ZCBOR_MAP_DECODE_KEY_DECODER("len", zcbor_size_decode, &img_size_tmp),
         ZCBOR_MAP_DECODE_KEY_DECODER("off", zcbor_size_decode, &img_chunk_off),
+#ifdef MCUBOOT_SERIAL_UPLOAD_COMPRESSION
+        ZCBOR_MAP_DECODE_KEY_DECODER("hs_w", zcbor_uint32_decode, &hs_w),
+        ZCBOR_MAP_DECODE_KEY_DECODER("hs_l", zcbor_uint32_decode, &hs_l),
+        ZCBOR_MAP_DECODE_KEY_DECODER("dlen", zcbor_size_decode, &dlen),
+#endif
     };
 
     ok = zcbor_map_decode_bulk(zsd, image_upload_decode, ARRAY_SIZE(image_upload_decode),
@@ -955,7 +1308,13 @@ bs_upload(char *buf, int len)
      *   "data":<image data>
      *   "len":<image len>
      *   "off":<current offset of image data>
+     *   "hs_w":<heatshrink window size of compressed data (OPTIONAL)>
+     *   "hs_l":<heatshrink lookahead size of compressed data (OPTIONAL)>
+     *   "dlen":<decompressed image len (OPTIONAL)>
      * }
+     *
+     * Compression parameters are only taken from the packet with offset 0;
+     * "len" and "off" then refer to the compressed data.
      */
 
     if (img_chunk_off == SIZE_MAX || img_chunk == NULL) {
@@ -989,6 +1348,7 @@ bs_upload(char *buf, int len)
          * means that upload has started from beginning.
          */
         const size_t area_size = flash_area_get_size(fap);
+        size_t slot_len = img_size_tmp; /* Size of data written to the slot */
 
 #if defined(MCUBOOT_SWAP_USING_OFFSET) && defined(MCUBOOT_SERIAL_DIRECT_IMAGE_UPLOAD)
         uint32_t num_sectors = SWAP_USING_OFFSET_SECTOR_UPDATE_BEGIN;
@@ -996,6 +1356,21 @@ bs_upload(char *buf, int len)
 #endif
 
         curr_off = 0;
+
+#ifdef MCUBOOT_SERIAL_UPLOAD_COMPRESSION
+        bs_upload_comp.size = 0;
+        if (hs_w != UINT_MAX) {
+            if (dlen == 0 || dlen > UINT32_MAX ||
+                boot_serial_hs_init(&bs_upload_comp.hs, hs_w, hs_l) != 0) {
+                goto out_invalid_data;
+            }
+
+            bs_upload_comp.size = dlen;
+            bs_upload_comp.written = 0;
+            slot_len = dlen;
+        }
+#endif
+
 #if defined(MCUBOOT_ERASE_PROGRESSIVELY) && defined(BOOT_IMAGE_HAS_STATUS_FIELDS)
         /* Get trailer sector information; this is done early because inability to get
          * that sector information means that upload will not work anyway.
@@ -1013,14 +1388,36 @@ bs_upload(char *buf, int len)
         /* We are using swap state at end of flash area to store validation
          * result. Make sure the user cannot write it from an image to skip validation.
          */
-        if (img_size_tmp > (area_size - BOOT_MAGIC_SZ)) {
+        if (slot_len > (area_size - BOOT_MAGIC_SZ)) {
             goto out_invalid_data;
         }
 #else
-        if (img_size_tmp > area_size) {
+        if (slot_len > area_size) {
+            goto out_invalid_data;
+        }
+
+#endif
+
+#ifdef MCUBOOT_VALIDATION_CACHE
+        /* The image must not reach the validation records either. */
+        if (slot_len > boot_validation_cache_off(fap)) {
             goto out_invalid_data;
         }
 
+        /* Forget the validation record of an image whose primary slot is
+         * about to be overwritten.
+         */
+        for (int i = 0; i < BOOT_IMAGE_NUMBER; i++) {
+            if (flash_area_get_id(fap) == flash_area_id_from_multi_image_slot(i, 0) &&
+                boot_validation_cache_invalidate(i) != 0) {
+                rc = MGMT_ERR_EUNKNOWN;
+                goto out;
+            }
+        }
+#endif
+
+#ifdef MCUBOOT_SERIAL_UPLOAD_WINDOW
+        bs_upload_window_reset();
 #endif
 
 #ifndef MCUBOOT_ERASE_PROGRESSIVELY
@@ -1037,6 +1434,10 @@ bs_upload(char *buf, int len)
 
         img_size = img_size_tmp;
 
+#ifdef MCUBOOT_SERIAL_UPLOAD_HASH
+        bs_upload_hash_start(fap, img_chunk, img_chunk_len, img_size);
+#endif
+
 #if defined(MCUBOOT_SWAP_USING_OFFSET) && defined(MCUBOOT_SERIAL_DIRECT_IMAGE_UPLOAD)
         if (img_num > 0 &&
             (img_num % BOOT_NUM_SLOTS) == BOOT_DIRECT_UPLOAD_SECONDARY_SLOT_ID_REMAINDER) {
@@ -1058,6 +1459,14 @@ bs_upload(char *buf, int len)
          * success and jump to out; out will respond to client with success
          * and request the expected offset, held by curr_off.
          */
+#ifdef MCUBOOT_SERIAL_UPLOAD_WINDOW
+        /* With windowed upload, a chunk ahead of the expected one is kept to
+         * be written once the gap before it is filled.
+         */
+        if (img_chunk_off > curr_off && img_chunk_off + img_chunk_len <= img_size) {
+            bs_upload_window_store(img_chunk_off, img_chunk, img_chunk_len);
+        }
+#endif
         rc = 0;
         goto out;
     } else if (curr_off + img_chunk_len > img_size) {
@@ -1065,6 +1474,92 @@ bs_upload(char *buf, int len)
         goto out;
     }
 
+#ifdef MCUBOOT_SERIAL_UPLOAD_WINDOW
+write_chunk:
+#endif
+#ifdef MCUBOOT_SERIAL_UPLOAD_COMPRESSION
+    if (bs_upload_comp.size != 0) {
+        /* A compressed chunk is consumed whole; it is decoded into the window,
+         * from which every completed half of it is written to the slot. The
+         * last one is padded to the flash alignment.
+         */
+        curr_off += img_chunk_len;
+        rc = 0;
+
+        while (bs_upload_comp.written < bs_upload_comp.size) {
+            uint32_t out_end = MIN(bs_upload_comp.written + BOOT_SERIAL_HS_FLUSH_SIZE,
+                                   bs_upload_comp.size);
+            uint8_t *out;
+            size_t out_len;
+            size_t used;
+
+            used = boot_serial_hs_decode(&bs_upload_comp.hs, img_chunk, img_chunk_len,
+                                         out_end);
+            img_chunk += used;
+            img_chunk_len -= used;
+
+            if (bs_upload_comp.hs.out_off < out_end) {
+                break;
+            }
+
+            out = &bs_upload_comp.hs.window[bs_upload_comp.written %
+                                            sizeof(bs_upload_comp.hs.window)];
+            out_len = out_end - bs_upload_comp.written;
+            rem_bytes = (flash_area_align(fap) - out_len % flash_area_align(fap)) %
+                        flash_area_align(fap);
+            memset(out + out_len, flash_area_erased_val(fap), rem_bytes);
+
+#ifdef MCUBOOT_ERASE_PROGRESSIVELY
+#ifdef MCUBOOT_SWAP_USING_OFFSET
+            not_yet_erased = erase_range(fap, not_yet_erased, bs_upload_comp.written +
+                                         out_len + rem_bytes - 1 + start_off);
+#else
+            not_yet_erased = erase_range(fap, not_yet_erased, bs_upload_comp.written +
+                                         out_len + rem_bytes - 1);
+#endif
+
+            if (not_yet_erased < 0) {
+                rc = MGMT_ERR_EINVAL;
+                goto out;
+            }
+#endif
+
+#ifdef MCUBOOT_SWAP_USING_OFFSET
+            rc = flash_area_write(fap, bs_upload_comp.written + start_off, out,
+                                  out_len + rem_bytes);
+#else
+            rc = flash_area_write(fap, bs_upload_comp.written, out, out_len + rem_bytes);
+#endif
+            if (rc != 0) {
+                goto out;
+            }
+
+#ifdef MCUBOOT_SERIAL_UPLOAD_HASH
+            if (bs_upload_comp.written == 0) {
+                bs_upload_hash_start(fap, out, out_len, bs_upload_comp.size);
+            }
+            bs_upload_hash_update(fap, bs_upload_comp.written, out_len);
+#endif
+            bs_upload_comp.written += out_len;
+        }
+
+        if (curr_off == img_size && bs_upload_comp.written != bs_upload_comp.size) {
+            BOOT_LOG_ERR("Compressed image ended after %u of %u bytes",
+                         (unsigned int)bs_upload_comp.written,
+                         (unsigned int)bs_upload_comp.size);
+            goto out_invalid_data;
+        }
+
+        /* Nothing is left for the common path below to account for. */
+        img_chunk_len = 0;
+        rem_bytes = 0;
+#ifdef MCUBOOT_SERIAL_UPLOAD_HASH
+        hash_off = curr_off;
+#endif
+        goto chunk_written;
+    }
+#endif
+
 #ifdef MCUBOOT_ERASE_PROGRESSIVELY
     /* Progressive erase will erase enough flash, aligned to sector size,
      * as needed for the current chunk to be written.
@@ -1088,6 +1583,10 @@ bs_upload(char *buf, int len)
      * new buffer by responding with request for offset after the last aligned
      * write.
      */
+#ifdef MCUBOOT_SERIAL_UPLOAD_HASH
+    hash_off = curr_off;
+#endif
+
     rem_bytes = img_chunk_len % flash_area_align(fap);
     img_chunk_len -= rem_bytes;
 
@@ -1160,8 +1659,21 @@ bs_upload(char *buf, int len)
 #endif
     }
 
+#ifdef MCUBOOT_SERIAL_UPLOAD_COMPRESSION
+chunk_written:
+#endif
     if (rc == 0) {
         curr_off += img_chunk_len + rem_bytes;
+#ifdef MCUBOOT_SERIAL_UPLOAD_HASH
+        bs_upload_hash_update(fap, hash_off, curr_off - hash_off);
+#endif
+#ifdef MCUBOOT_SERIAL_UPLOAD_WINDOW
+        /* Continue with chunks that were received ahead of this one. */
+        if (curr_off < img_size &&
+            bs_upload_window_take(curr_off, &img_chunk, &img_chunk_len)) {
+            goto write_chunk;
+        }
+#endif
         if (curr_off == img_size) {
 #if defined(MCUBOOT_ERASE_PROGRESSIVELY) && defined(BOOT_IMAGE_HAS_STATUS_FIELDS)
             /* Assure that sector for image trailer was erased. */
@@ -1173,12 +1685,21 @@ bs_upload(char *buf, int len)
                 goto out;
             }
 #endif
+#ifdef MCUBOOT_SERIAL_UPLOAD_COMPRESSION
+            rc = BOOT_HOOK_CALL(boot_serial_uploaded_hook, 0, img_num, fap,
+                                bs_upload_comp.size != 0 ? bs_upload_comp.size : img_size);
+#else
             rc = BOOT_HOOK_CALL(boot_serial_uploaded_hook, 0, img_num, fap,
                                 img_size);
+#endif
             if (rc) {
                 BOOT_LOG_ERR("Error %d post upload hook", rc);
                 goto out;
             }
+
+#ifdef MCUBOOT_SERIAL_UPLOAD_HASH
+            verified = bs_upload_hash_check(fap);
+#endif
         }
     } else {
 out_invalid_data:
@@ -1193,11 +1714,49 @@ out:
     if (rc == 0) {
         zcbor_tstr_put_lit_cast(cbor_state, "off");
         zcbor_uint32_put(cbor_state, curr_off);
+#ifdef MCUBOOT_SERIAL_UPLOAD_HASH
+        if (verified >= 0) {
+            zcbor_tstr_put_lit_cast(cbor_state, "verified");
+            zcbor_bool_put(cbor_state, verified == 1);
+        }
+#endif
     }
     zcbor_map_end_encode(cbor_state, 10);
 
     boot_serial_output();
 
+#ifdef MCUBOOT_SERIAL_ERASE_AHEAD
+    /* With the response sent, erase the flash the chunks the client may
+     * have in flight are going to be written to while it is sending them,
+     * instead of after they have been received.
+     */
+    if (rc == 0 && curr_off < img_size) {
+        size_t write_off = curr_off;
+        size_t write_end = img_size;
+        off_t erased;
+
+#ifdef MCUBOOT_SERIAL_UPLOAD_COMPRESSION
+        if (bs_upload_comp.size != 0) {
+            write_off = bs_upload_comp.written;
+            write_end = bs_upload_comp.size;
+        }
+#endif
+
+        write_end = MIN(write_off + BOOT_SERIAL_UPLOAD_BUF_COUNT *
+                        MCUBOOT_SERIAL_MAX_RECEIVE_SIZE, write_end);
+#ifdef MCUBOOT_SWAP_USING_OFFSET
+        erased = erase_range(fap, not_yet_erased, write_end - 1 + start_off);
+#else
+        erased = erase_range(fap, not_yet_erased, write_end - 1);
+#endif
+
+        /* On failure, the erase is retried before the next write. */
+        if (erased >= 0) {
+            not_yet_erased = erased;
+        }
+    }
+#endif
+
 #ifdef MCUBOOT_ENC_IMAGES
     /* Check if this upload was for the primary slot */
 #if !defined(MCUBOOT_SERIAL_DIRECT_IMAGE_UPLOAD)
@@ -1264,6 +1823,43 @@ out:
 }
 #endif
 
+#ifdef BOOT_SERIAL_MGMT_PARAMS
+/*
+ * Report SMP buffer parameters; a client may keep up to buf_count upload
+ * requests of at most buf_size bytes in flight. With binary framing, its
+ * fragments may be up to bin_frame_mtu bytes long, markers and line
+ * terminator included.
+ */
+static void
+bs_params(char *buf, int len)
+{
+    bool ok;
+
+    ok = zcbor_map_start_encode(cbor_state, 10) &&
+         zcbor_tstr_put_lit(cbor_state, "buf_size") &&
+         zcbor_uint32_put(cbor_state, MCUBOOT_SERIAL_MAX_RECEIVE_SIZE) &&
+         zcbor_tstr_put_lit(cbor_state, "buf_count") &&
+         zcbor_uint32_put(cbor_state, BOOT_SERIAL_UPLOAD_BUF_COUNT) &&
+#ifdef MCUBOOT_SERIAL_BINARY_FRAMING
+         zcbor_tstr_put_lit(cbor_state, "bin_frame_mtu") &&
+         zcbor_uint32_put(cbor_state, MCUBOOT_SERIAL_MAX_LINE_INPUT_LEN) &&
+#endif
+#ifdef MCUBOOT_SERIAL_UPLOAD_COMPRESSION
+         zcbor_tstr_put_lit(cbor_state, "hs_w") &&
+         zcbor_uint32_put(cbor_state, BOOT_SERIAL_HS_WINDOW_BITS_MAX) &&
+#endif
+         zcbor_map_end_encode(cbor_state, 10);
+
+    if (!ok) {
+        reset_cbor_state();
+        bs_rc_rsp(MGMT_ERR_ENOMEM);
+        return;
+    }
+
+    boot_serial_output();
+}
+#endif
+
 /*
  * Reset, and (presumably) boot to newly uploaded image. Flush console
  * before restarting.
@@ -1357,6 +1953,11 @@ boot_serial_input(char *buf, int len)
         case NMGR_ID_RESET:
             bs_reset(buf, len);
             break;
+#ifdef BOOT_SERIAL_MGMT_PARAMS
+        case NMGR_ID_PARAMS:
+            bs_params(buf, len);
+            break;
+#endif
         default:
             bs_rc_rsp(MGMT_ERR_ENOTSUP);
             break;
@@ -1373,6 +1974,102 @@ boot_serial_input(char *buf, int len)
 #endif
 }
 
+#ifdef MCUBOOT_SERIAL_BINARY_FRAMING
+/*
+ * COBS encodes len bytes from in to out, which must be able to hold
+ * len + len / 254 + 1 bytes. Returns length of encoded data.
+ */
+int
+boot_serial_cobs_encode(const uint8_t *in, int len, uint8_t *out)
+{
+    int code_off = 0;
+    int off = 1;
+    uint8_t code = 1;
+    int i;
+
+    for (i = 0; i < len; i++) {
+        if (in[i] == 0) {
+            out[code_off] = code ^ BOOT_SERIAL_COBS_XOR;
+            code_off = off++;
+            code = 1;
+            continue;
+        }
+
+        out[off++] = in[i] ^ BOOT_SERIAL_COBS_XOR;
+        if (++code == 0xff) {
+            out[code_off] = code ^ BOOT_SERIAL_COBS_XOR;
+            code_off = off++;
+            code = 1;
+        }
+    }
+    out[code_off] = code ^ BOOT_SERIAL_COBS_XOR;
+
+    return off;
+}
+
+/*
+ * Decodes COBS encoded data; returns length of decoded data or -1 if the
+ * data is malformed or does not fit in maxout bytes.
+ */
+int
+boot_serial_cobs_decode(const uint8_t *in, int inlen, uint8_t *out, int maxout)
+{
+    int off = 0;
+    int i = 0;
+    int code;
+    int n;
+
+    while (i < inlen) {
+        code = in[i++] ^ BOOT_SERIAL_COBS_XOR;
+        if (code == 0 || code - 1 > inlen - i || code - 1 > maxout - off) {
+            return -1;
+        }
+
+        for (n = 1; n < code; n++) {
+            out[off++] = in[i++] ^ BOOT_SERIAL_COBS_XOR;
+        }
+
+        /* Each group but a full or the last one is followed by a zero. */
+        if (code != 0xff && i < inlen) {
+            if (off == maxout) {
+                return -1;
+            }
+            out[off++] = 0;
+        }
+    }
+
+    return off;
+}
+
+/*
+ * Sends a frame in fragments of COBS encoded data.
+ */
+static void
+boot_serial_output_bin(const char *buf, int len)
+{
+    char pkt_cont[2] = { BOOT_SERIAL_BIN_DATA_START1, BOOT_SERIAL_BIN_DATA_START2 };
+    char pkt_start[2] = { BOOT_SERIAL_BIN_PKT_START1, BOOT_SERIAL_BIN_PKT_START2 };
+    uint8_t encoded_buf[BOOT_SERIAL_FRAME_MTU];
+    int out;
+    int chunk;
+
+    for (out = 0; out < len; out += chunk) {
+        if (out == 0) {
+            boot_uf->write(pkt_start, sizeof(pkt_start));
+        } else {
+            boot_uf->write(pkt_cont, sizeof(pkt_cont));
+        }
+
+        /* Fragments are shorter than 254 bytes, encoding adds one byte. */
+        chunk = MIN(BOOT_SERIAL_FRAME_MTU - 1, len - out);
+        boot_uf->write((char *)encoded_buf,
+                       boot_serial_cobs_encode((const uint8_t *)&buf[out], chunk,
+                                               encoded_buf));
+        boot_uf->write("\n", 1);
+    }
+}
+#endif
+
 static void
 boot_serial_output(void)
 {
@@ -1417,6 +2114,13 @@ boot_serial_output(void)
     totlen += len;
     memcpy(&buf[totlen], &crc, sizeof(crc));
     totlen += sizeof(crc);
+#ifdef MCUBOOT_SERIAL_BINARY_FRAMING
+    if (bs_binary) {
+        boot_serial_output_bin(buf, totlen);
+        BOOT_LOG_DBG("TX");
+        return;
+    }
+#endif
 #ifdef __ZEPHYR__
     size_t enc_len;
     base64_encode(encoded_buf, sizeof(encoded_buf), &enc_len, buf, totlen);
@@ -1448,6 +2152,42 @@ boot_serial_output(void)
     BOOT_LOG_DBG("TX");
 }
 
+/*
+ * Checks decoded data for a complete packet with valid CRC; returns 1 if
+ * full packet has been received.
+ */
+static int
+boot_serial_in_packet(char *out, int *out_off)
+{
+    uint16_t crc;
+    uint16_t len;
+
+    if (*out_off <= sizeof(uint16_t)) {
+        return 0;
+    }
+
+    len = ntohs(*(uint16_t *)out);
+    if (len != *out_off - sizeof(uint16_t)) {
+        return 0;
+    }
+
+    out += sizeof(uint16_t);
+#ifdef __ZEPHYR__
+    crc = crc16_itu_t(CRC16_INITIAL_CRC, out, len);
+#elif __ESPRESSIF__
+    crc = ~esp_crc16_be(~CRC16_INITIAL_CRC, (uint8_t *)out, len);
+#else
+    crc = crc16_ccitt(CRC16_INITIAL_CRC, out, len);
+#endif
+    if (crc || len <= sizeof(crc)) {
+        return 0;
+    }
+    *out_off -= sizeof(crc);
+    out[*out_off] = '\0';
+
+    return 1;
+}
+
 /*
  * Returns 1 if full packet has been received.
  */
@@ -1455,8 +2195,6 @@ static int
 boot_serial_in_dec(char *in, int inlen, char *out, int *out_off, int maxout)
 {
     size_t rc;
-    uint16_t crc;
-    uint16_t len;
 
 #ifdef __ZEPHYR__
     int err;
@@ -1481,31 +2219,38 @@ boot_serial_in_dec(char *in, int inlen, char *out, int *out_off, int maxout)
 #endif
 
     *out_off += rc;
-    if (*out_off <= sizeof(uint16_t)) {
-        return 0;
-    }
 
-    len = ntohs(*(uint16_t *)out);
-    if (len != *out_off - sizeof(uint16_t)) {
-        return 0;
+    return boot_serial_in_packet(out, out_off);
+}
+
+#ifdef MCUBOOT_SERIAL_BINARY_FRAMING
+/*
+ * Binary framing counterpart of boot_serial_in_dec(); a fragment ends at
+ * the line terminator, which COBS encoded data does not contain.
+ */
+static int
+boot_serial_in_dec_bin(char *in, int inlen, char *out, int *out_off, int maxout)
+{
+    char *end;
+    int rc;
+
+    end = memchr(in, '\n', inlen);
+    if (end != NULL) {
+        inlen = end - in;
     }
 
-    out += sizeof(uint16_t);
-#ifdef __ZEPHYR__
-    crc = crc16_itu_t(CRC16_INITIAL_CRC, out, len);
-#elif __ESPRESSIF__
-    crc = ~esp_crc16_be(~CRC16_INITIAL_CRC, (uint8_t *)out, len);
-#else
-    crc = crc16_ccitt(CRC16_INITIAL_CRC, out, len);
-#endif
-    if (crc || len <= sizeof(crc)) {
-        return 0;
+    /* Keep room for the terminator added to a complete packet. */
+    rc = boot_serial_cobs_decode((uint8_t *)in, inlen, (uint8_t *)&out[*out_off],
+                                 maxout - *out_off - 1);
+    if (rc < 0) {
+        return -1;
     }
-    *out_off -= sizeof(crc);
-    out[*out_off] = '\0';
 
-    return 1;
+    *out_off += rc;
+
+    return boot_serial_in_packet(out, out_off);
 }
+#endif
 
 /*
  * Task which waits reading console, expecting to get image over
@@ -1565,10 +2310,23 @@ boot_serial_read_console(const struct boot_uart_funcs *f,int timeout_in_ms)
         if (in_buf[0] == SHELL_NLIP_PKT_START1 &&
           in_buf[1] == SHELL_NLIP_PKT_START2) {
             dec_off = 0;
+#ifdef MCUBOOT_SERIAL_BINARY_FRAMING
+            bs_binary = false;
+#endif
             rc = boot_serial_in_dec(&in_buf[2], off - 2, dec_buf, &dec_off, max_input);
         } else if (in_buf[0] == SHELL_NLIP_DATA_START1 &&
           in_buf[1] == SHELL_NLIP_DATA_START2) {
             rc = boot_serial_in_dec(&in_buf[2], off - 2, dec_buf, &dec_off, max_input);
+#ifdef MCUBOOT_SERIAL_BINARY_FRAMING
+        } else if (in_buf[0] == BOOT_SERIAL_BIN_PKT_START1 &&
+          in_buf[1] == BOOT_SERIAL_BIN_PKT_START2) {
+            dec_off = 0;
+            bs_binary = true;
+            rc = boot_serial_in_dec_bin(&in_buf[2], off - 2, dec_buf, &dec_off, max_input);
+        } else if (in_buf[0] == BOOT_SERIAL_BIN_DATA_START1 &&
+          in_buf[1] == BOOT_SERIAL_BIN_DATA_START2) {
+            rc = boot_serial_in_dec_bin(&in_buf[2], off - 2, dec_buf, &dec_off, max_input);
+#endif
         }
 
         /* serve errors: out of decode memory, or bad encoding */
@@ -0,0 +1,125 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "mcuboot_config/mcuboot_config.h"
+
+#ifdef MCUBOOT_SERIAL_UPLOAD_COMPRESSION
+
+#include "boot_serial_heatshrink.h"
+
+#if BOOT_SERIAL_HS_WINDOW_BITS_MAX < BOOT_SERIAL_HS_WINDOW_BITS_MIN || \
+    BOOT_SERIAL_HS_WINDOW_BITS_MAX > 15
+#error "MCUBOOT_SERIAL_UPLOAD_COMPRESSION_WINDOW_BITS must be between 4 and 15"
+#endif
+
+#define BS_HS_TAG           0   /* Expecting a literal or back-reference tag */
+#define BS_HS_LITERAL       1   /* Expecting the byte of a literal */
+#define BS_HS_INDEX         2   /* Expecting the distance of a back-reference */
+#define BS_HS_COUNT         3   /* Expecting the length of a back-reference */
+#define BS_HS_COPY          4   /* Copying a back-reference */
+
+#define BS_HS_WINDOW_MASK   ((1U << BOOT_SERIAL_HS_WINDOW_BITS_MAX) - 1)
+
+int
+boot_serial_hs_init(struct boot_serial_hs *hs, uint32_t window_bits,
+                    uint32_t lookahead_bits)
+{
+    if (window_bits < BOOT_SERIAL_HS_WINDOW_BITS_MIN ||
+        window_bits > BOOT_SERIAL_HS_WINDOW_BITS_MAX ||
+        lookahead_bits < BOOT_SERIAL_HS_LOOKAHEAD_BITS_MIN ||
+        lookahead_bits >= window_bits) {
+        return -1;
+    }
+
+    memset(hs, 0, sizeof(*hs));
+    hs->window_bits = window_bits;
+    hs->lookahead_bits = lookahead_bits;
+    hs->state = BS_HS_TAG;
+
+    return 0;
+}
+
+size_t
+boot_serial_hs_decode(struct boot_serial_hs *hs, const uint8_t *in, size_t len,
+                      uint32_t out_end)
+{
+    size_t used = 0;
+    uint8_t need;
+    uint32_t val;
+
+    while (hs->out_off < out_end) {
+        if (hs->state == BS_HS_COPY) {
+            hs->window[hs->out_off & BS_HS_WINDOW_MASK] =
+                hs->window[(hs->out_off - hs->index) & BS_HS_WINDOW_MASK];
+            hs->out_off++;
+            if (--hs->count == 0) {
+                hs->state = BS_HS_TAG;
+            }
+            continue;
+        }
+
+        switch (hs->state) {
+        case BS_HS_TAG:
+            need = 1;
+            break;
+        case BS_HS_LITERAL:
+            need = 8;
+            break;
+        case BS_HS_INDEX:
+            need = hs->window_bits;
+            break;
+        default:
+            need = hs->lookahead_bits;
+            break;
+        }
+
+        while (hs->bit_count < need) {
+            if (used == len) {
+                return used;
+            }
+            hs->bits = (hs->bits << 8) | in[used++];
+            hs->bit_count += 8;
+        }
+
+        hs->bit_count -= need;
+        val = (hs->bits >> hs->bit_count) & ((1U << need) - 1);
+
+        switch (hs->state) {
+        case BS_HS_TAG:
+            hs->state = val ? BS_HS_LITERAL : BS_HS_INDEX;
+            break;
+        case BS_HS_LITERAL:
+            hs->window[hs->out_off & BS_HS_WINDOW_MASK] = val;
+            hs->out_off++;
+            hs->state = BS_HS_TAG;
+            break;
+        case BS_HS_INDEX:
+            hs->index = val + 1;
+            hs->state = BS_HS_COUNT;
+            break;
+        default:
+            hs->count = val + 1;
+            hs->state = BS_HS_COPY;
+            break;
+        }
+    }
+
+    return used;
+}
+
+#endif /* MCUBOOT_SERIAL_UPLOAD_COMPRESSION */
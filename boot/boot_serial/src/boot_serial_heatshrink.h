@@ -0,0 +1,97 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef H_BOOT_SERIAL_HEATSHRINK_
+#define H_BOOT_SERIAL_HEATSHRINK_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mcuboot_config/mcuboot_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Size of the decoder window, as a power of two; streams compressed with a
+ * window up to this size can be decoded.
+ */
+#ifndef MCUBOOT_SERIAL_UPLOAD_COMPRESSION_WINDOW_BITS
+#define MCUBOOT_SERIAL_UPLOAD_COMPRESSION_WINDOW_BITS   10
+#endif
+
+#define BOOT_SERIAL_HS_WINDOW_BITS_MIN      4
+#define BOOT_SERIAL_HS_WINDOW_BITS_MAX      MCUBOOT_SERIAL_UPLOAD_COMPRESSION_WINDOW_BITS
+#define BOOT_SERIAL_HS_LOOKAHEAD_BITS_MIN   3
+
+/*
+ * Streaming decoder of heatshrink compressed data.
+ *
+ * heatshrink is an LZSS variant: the stream is a sequence of bits, most
+ * significant first, in which a 1 is followed by an 8 bit literal and a 0
+ * by a back-reference of window_bits bits of distance minus one and
+ * lookahead_bits bits of length minus one. Back-references reaching before
+ * the start of the data read zeros.
+ *
+ * Decoded data is produced into the window, so that it can be written out
+ * from there before it is overwritten.
+ */
+struct boot_serial_hs {
+    uint32_t out_off;           /* Number of bytes decoded so far */
+    uint32_t bits;              /* Input bits not consumed yet, right aligned */
+    uint16_t index;             /* Distance of the back-reference being decoded */
+    uint16_t count;             /* Bytes of the back-reference left to copy */
+    uint8_t bit_count;          /* Number of valid bits in bits */
+    uint8_t window_bits;
+    uint8_t lookahead_bits;
+    uint8_t state;
+    uint8_t window[1 << BOOT_SERIAL_HS_WINDOW_BITS_MAX];
+};
+
+/**
+ * Starts decoding a new stream.
+ *
+ * @param hs                The decoder.
+ * @param window_bits       Window size the stream was compressed with.
+ * @param lookahead_bits    Lookahead size the stream was compressed with.
+ *
+ * @return 0 on success; -1 if the sizes are not supported.
+ */
+int boot_serial_hs_init(struct boot_serial_hs *hs, uint32_t window_bits,
+                        uint32_t lookahead_bits);
+
+/**
+ * Decodes compressed data until either all of it has been consumed or
+ * hs->out_off has reached out_end. Decoded byte n of the stream is found at
+ * hs->window[n % sizeof(hs->window)], until out_end is moved past n +
+ * sizeof(hs->window).
+ *
+ * @param hs        The decoder.
+ * @param in        Compressed data.
+ * @param len       Length of @p in.
+ * @param out_end   Offset in the decoded data at which to stop.
+ *
+ * @return Number of bytes of @p in consumed.
+ */
+size_t boot_serial_hs_decode(struct boot_serial_hs *hs, const uint8_t *in, size_t len,
+                             uint32_t out_end);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* H_BOOT_SERIAL_HEATSHRINK_ */
@@ -33,6 +33,18 @@ extern "C" {
 #define SHELL_NLIP_DATA_START1  4
 #define SHELL_NLIP_DATA_START2  20
 
+/*
+ * Binary framing; same as above, but fragments carry COBS encoded data
+ * instead of base64.
+ */
+#define BOOT_SERIAL_BIN_PKT_START1   6
+#define BOOT_SERIAL_BIN_PKT_START2   11
+
+#define BOOT_SERIAL_BIN_DATA_START1  4
+#define BOOT_SERIAL_BIN_DATA_START2  22
+
+#define BOOT_SERIAL_FRAME_MTU   124 /* 127 - pkt start (2 bytes) and stop (1 byte) */
+
 /*
  * From newtmgr.h
  */
@@ -54,6 +66,7 @@ extern "C" {
 #define NMGR_ID_ECHO            0
 #define NMGR_ID_CONS_ECHO_CTRL  1
 #define NMGR_ID_RESET           5
+#define NMGR_ID_PARAMS          6
 
 #ifndef __packed
 #define __packed __attribute__((__packed__))
@@ -86,6 +99,11 @@ struct nmgr_hdr {
 void boot_serial_input(char *buf, int len);
 extern const struct boot_uart_funcs *boot_uf;
 
+#ifdef MCUBOOT_SERIAL_BINARY_FRAMING
+int boot_serial_cobs_encode(const uint8_t *in, int len, uint8_t *out);
+int boot_serial_cobs_decode(const uint8_t *in, int inlen, uint8_t *out, int maxout);
+#endif
+
 /**
  * @brief Selects direct image to upload according to the "image"
  * parameter of the mcumgr update frame.
@@ -39,10 +39,29 @@ TEST_CASE_DECL(boot_serial_empty_msg)
 TEST_CASE_DECL(boot_serial_empty_img_msg)
 TEST_CASE_DECL(boot_serial_img_msg)
 TEST_CASE_DECL(boot_serial_upload_bigger_image)
+#if MYNEWT_VAL(BOOT_SERIAL_UPLOAD_WINDOW)
+TEST_CASE_DECL(boot_serial_upload_window)
+#endif
+#if MYNEWT_VAL(BOOT_SERIAL_UPLOAD_COMPRESSION)
+TEST_CASE_DECL(boot_serial_upload_compressed)
+#endif
+#if MYNEWT_VAL(BOOT_SERIAL_BINARY_FRAMING)
+TEST_CASE_DECL(boot_serial_cobs)
+#endif
+#if MYNEWT_VAL(BOOT_SERIAL_UPLOAD_HASH)
+TEST_CASE_DECL(boot_serial_upload_hash)
+#endif
+
+static char test_uart_buf[256];
+static int test_uart_len;
 
 static void
 test_uart_write(const char *str, int len)
 {
+    if (test_uart_len + len <= sizeof(test_uart_buf)) {
+        memcpy(&test_uart_buf[test_uart_len], str, len);
+        test_uart_len += len;
+    }
 }
 
 static const struct boot_uart_funcs test_uart = {
@@ -52,9 +71,36 @@ static const struct boot_uart_funcs test_uart = {
 void
 tx_msg(void *src, int len)
 {
+    test_uart_len = 0;
     boot_serial_input(src, len);
 }
 
+/*
+ * Decodes the response to the last message sent into dst, returning its
+ * length, or -1 if it is not a single base64 encoded fragment that fits.
+ */
+int
+rx_msg(void *dst, int len)
+{
+    char str[sizeof(test_uart_buf)];
+    int str_len;
+
+    /* Start marker, base64 data and newline */
+    str_len = test_uart_len - 3;
+    if (str_len <= 0 || test_uart_buf[test_uart_len - 1] != '\n' ||
+        memchr(test_uart_buf, '\n', test_uart_len - 1) != NULL) {
+        return -1;
+    }
+
+    memcpy(str, &test_uart_buf[2], str_len);
+    str[str_len] = '\0';
+    if (base64_decode_len(str) > len) {
+        return -1;
+    }
+
+    return base64_decode(str, dst);
+}
+
 TEST_SUITE(boot_serial_suite)
 {
     boot_serial_setup();
@@ -62,6 +108,18 @@ TEST_SUITE(boot_serial_suite)
     boot_serial_empty_img_msg();
     boot_serial_img_msg();
     boot_serial_upload_bigger_image();
+#if MYNEWT_VAL(BOOT_SERIAL_UPLOAD_WINDOW)
+    boot_serial_upload_window();
+#endif
+#if MYNEWT_VAL(BOOT_SERIAL_UPLOAD_COMPRESSION)
+    boot_serial_upload_compressed();
+#endif
+#if MYNEWT_VAL(BOOT_SERIAL_BINARY_FRAMING)
+    boot_serial_cobs();
+#endif
+#if MYNEWT_VAL(BOOT_SERIAL_UPLOAD_HASH)
+    boot_serial_upload_hash();
+#endif
 }
 
 int
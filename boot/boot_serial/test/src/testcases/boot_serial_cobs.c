@@ -0,0 +1,111 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "boot_test.h"
+
+#if MYNEWT_VAL(BOOT_SERIAL_BINARY_FRAMING)
+/*
+ * Encodes len bytes of data, checks that the result holds neither a zero
+ * nor a line terminator and decodes it back into exactly len bytes.
+ */
+static void
+boot_serial_cobs_round_trip(const uint8_t *data, int len)
+{
+    uint8_t enc[600 + 600 / 254 + 1];
+    uint8_t dec[600];
+    int enc_len;
+    int rc;
+    int i;
+
+    assert(len <= sizeof(dec));
+
+    enc_len = boot_serial_cobs_encode(data, len, enc);
+    assert(enc_len > len && enc_len <= len + len / 254 + 1);
+    for (i = 0; i < enc_len; i++) {
+        assert(enc[i] != '\n');
+    }
+
+    rc = boot_serial_cobs_decode(enc, enc_len, dec, len);
+    assert(rc == len);
+    assert(!memcmp(dec, data, len));
+
+    /* Not a byte more than the room given may be written. */
+    if (len > 0) {
+        rc = boot_serial_cobs_decode(enc, enc_len, dec, len - 1);
+        assert(rc == -1);
+    }
+}
+
+TEST_CASE(boot_serial_cobs)
+{
+    uint8_t data[600];
+    int i;
+
+    /* Runs of non-zero bytes around and over the 254 bytes of a group. */
+    for (i = 0; i < sizeof(data); i++) {
+        data[i] = 1 + i % 255;
+    }
+    boot_serial_cobs_round_trip(data, 253);
+    boot_serial_cobs_round_trip(data, 254);
+    boot_serial_cobs_round_trip(data, 255);
+    boot_serial_cobs_round_trip(data, sizeof(data));
+
+    /* A zero right after a full group, and at the end. */
+    data[254] = 0;
+    boot_serial_cobs_round_trip(data, 255);
+    data[sizeof(data) - 1] = 0;
+    boot_serial_cobs_round_trip(data, sizeof(data));
+
+    /* Line terminators and zeros, alone and in runs. */
+    memset(data, '\n', sizeof(data));
+    boot_serial_cobs_round_trip(data, 1);
+    boot_serial_cobs_round_trip(data, sizeof(data));
+    memset(data, 0, sizeof(data));
+    boot_serial_cobs_round_trip(data, 1);
+    boot_serial_cobs_round_trip(data, sizeof(data));
+    for (i = 0; i < sizeof(data); i++) {
+        data[i] = (i % 3) ? '\n' : 0;
+    }
+    boot_serial_cobs_round_trip(data, sizeof(data));
+
+    /* Every byte value, in the largest fragment the framing sends. */
+    for (i = 0; i < BOOT_SERIAL_FRAME_MTU - 1; i++) {
+        data[i] = i * 7;
+    }
+    boot_serial_cobs_round_trip(data, BOOT_SERIAL_FRAME_MTU - 1);
+    for (i = 0; i < sizeof(data); i++) {
+        data[i] = i;
+    }
+    boot_serial_cobs_round_trip(data, 256);
+
+    /* A fragment of the MTU, without zeros, encodes to the MTU exactly. */
+    for (i = 0; i < BOOT_SERIAL_FRAME_MTU - 1; i++) {
+        data[i] = 0xff - i;
+    }
+    assert(boot_serial_cobs_encode(data, BOOT_SERIAL_FRAME_MTU - 1,
+                                   data + BOOT_SERIAL_FRAME_MTU) ==
+           BOOT_SERIAL_FRAME_MTU);
+
+    /* A group running past the end, or a zero code, is malformed. */
+    data[0] = 5 ^ '\n';
+    assert(boot_serial_cobs_decode(data, 3, data + 8, 8) == -1);
+    data[0] = '\n';
+    assert(boot_serial_cobs_decode(data, 1, data + 8, 8) == -1);
+}
+#endif
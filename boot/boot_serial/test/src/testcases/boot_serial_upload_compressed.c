@@ -0,0 +1,99 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <flash_map_backend/flash_map_backend.h>
+
+#include "boot_test.h"
+
+#if MYNEWT_VAL(BOOT_SERIAL_UPLOAD_COMPRESSION)
+/*
+ * A 256 byte image, compressed with heatshrink using a window of 8 bits and
+ * a lookahead of 4 bits, is uploaded in a single chunk and has to be written
+ * decompressed.
+ */
+TEST_CASE(boot_serial_upload_compressed)
+{
+    char img[256];
+    char enc_img[64];
+    char buf[sizeof(struct nmgr_hdr) + 128];
+    int len;
+    int off;
+    int rc;
+    struct nmgr_hdr *hdr;
+    const struct flash_area *fap;
+    int i;
+
+    /* 00000000  a6 64 64 61 74 61 58 2b  |.ddataX+|
+     * 00000008  80 40 60 50 38 24 16 0d  |.@`P8$..|
+     * 00000010  07 84 42 61 50 b8 64 36  |..BaP.d6|
+     * 00000018  1d 0f 07 f8 3f c1 fe 0f  |....?...|
+     * 00000020  f0 7f 83 fc 1f e0 ff 07  |........|
+     * 00000028  f8 3f c1 fe 0f f0 7f 83  |.?......|
+     * 00000030  fc 1f e0 63 6c 65 6e 18  |...clen.|
+     * 00000038  2b 63 6f 66 66 00 64 68  |+coff.dh|
+     * 00000040  73 5f 77 08 64 68 73 5f  |s_w.dhs_|
+     * 00000048  6c 04 64 64 6c 65 6e 19  |l.ddlen.|
+     * 00000050  01 00                    |..|
+     */
+    static const uint8_t payload[] = {
+        0xa6, 0x64, 0x64, 0x61, 0x74, 0x61, 0x58, 0x2b,
+        /* 43 bytes of compressed image data starts here. */
+        0x80, 0x40, 0x60, 0x50, 0x38, 0x24, 0x16, 0x0d,
+        0x07, 0x84, 0x42, 0x61, 0x50, 0xb8, 0x64, 0x36,
+        0x1d, 0x0f, 0x07, 0xf8, 0x3f, 0xc1, 0xfe, 0x0f,
+        0xf0, 0x7f, 0x83, 0xfc, 0x1f, 0xe0, 0xff, 0x07,
+        0xf8, 0x3f, 0xc1, 0xfe, 0x0f, 0xf0, 0x7f, 0x83,
+        0xfc, 0x1f, 0xe0, 0x63, 0x6c, 0x65, 0x6e, 0x18,
+        0x2b, 0x63, 0x6f, 0x66, 0x66, 0x00, 0x64, 0x68,
+        0x73, 0x5f, 0x77, 0x08, 0x64, 0x68, 0x73, 0x5f,
+        0x6c, 0x04, 0x64, 0x64, 0x6c, 0x65, 0x6e, 0x19,
+        0x01, 0x00,
+    };
+
+    for (i = 0; i < sizeof(img); i++) {
+        img[i] = i % 16;
+    }
+
+    hdr = (struct nmgr_hdr *)buf;
+    memset(hdr, 0, sizeof(*hdr));
+    hdr->nh_op = NMGR_OP_WRITE;
+    hdr->nh_group = htons(MGMT_GROUP_ID_IMAGE);
+    hdr->nh_id = IMGMGR_NMGR_ID_UPLOAD;
+
+    memcpy(buf + sizeof(*hdr), payload, sizeof payload);
+    len = sizeof payload;
+    hdr->nh_len = htons(len);
+
+    len = sizeof(*hdr) + len;
+
+    tx_msg(buf, len);
+
+    /*
+     * Validate contents inside the primary slot
+     */
+    rc = flash_area_open(FLASH_AREA_IMAGE_PRIMARY(0), &fap);
+    assert(rc == 0);
+
+    for (off = 0; off < sizeof(img); off += sizeof(enc_img)) {
+        rc = flash_area_read(fap, off, enc_img, sizeof(enc_img));
+        assert(rc == 0);
+        assert(!memcmp(enc_img, &img[off], sizeof(enc_img)));
+    }
+}
+#endif
@@ -0,0 +1,133 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <flash_map_backend/flash_map_backend.h>
+
+#include "boot_test.h"
+#include "bootutil/image.h"
+#include "bootutil/crypto/sha.h"
+#include "zcbor_encode.h"
+
+#if MYNEWT_VAL(BOOT_SERIAL_UPLOAD_HASH)
+#define UPLOAD_HASH_IMG_SIZE    200
+#define UPLOAD_HASH_TLV_SIZE    (sizeof(struct image_tlv_info) + \
+                                 sizeof(struct image_tlv) + 32)
+#define UPLOAD_HASH_SIZE        (IMAGE_HEADER_SIZE + UPLOAD_HASH_IMG_SIZE + \
+                                 UPLOAD_HASH_TLV_SIZE)
+
+/*
+ * Uploads img to the primary slot in chunks of 64 bytes and returns the
+ * "verified" value of the last response: 1 or 0, or -1 if it has none.
+ */
+static int
+boot_serial_upload_hashed(const uint8_t *img, int img_len)
+{
+    char buf[sizeof(struct nmgr_hdr) + 128];
+    uint8_t rsp[64];
+    struct nmgr_hdr *hdr;
+    zcbor_state_t zs[2];
+    bool ok;
+    int chunk;
+    int off;
+    int len;
+    int i;
+
+    for (off = 0; off < img_len; off += chunk) {
+        chunk = img_len - off < 64 ? img_len - off : 64;
+
+        hdr = (struct nmgr_hdr *)buf;
+        memset(hdr, 0, sizeof(*hdr));
+        hdr->nh_op = NMGR_OP_WRITE;
+        hdr->nh_group = htons(MGMT_GROUP_ID_IMAGE);
+        hdr->nh_id = IMGMGR_NMGR_ID_UPLOAD;
+
+        zcbor_new_encode_state(zs, sizeof(zs) / sizeof(zs[0]), (uint8_t *)(hdr + 1),
+                               sizeof(buf) - sizeof(*hdr), 0);
+        ok = zcbor_map_start_encode(zs, 3) &&
+             zcbor_tstr_put_lit(zs, "data") &&
+             zcbor_bstr_encode_ptr(zs, (const char *)&img[off], chunk);
+        if (off == 0) {
+            ok = ok && zcbor_tstr_put_lit(zs, "len") && zcbor_uint32_put(zs, img_len);
+        }
+        ok = ok && zcbor_tstr_put_lit(zs, "off") && zcbor_uint32_put(zs, off) &&
+             zcbor_map_end_encode(zs, 3);
+        assert(ok);
+
+        len = zs->payload_mut - (uint8_t *)(hdr + 1);
+        hdr->nh_len = htons(len);
+
+        tx_msg(buf, sizeof(*hdr) + len);
+    }
+
+    len = rx_msg(rsp, sizeof(rsp));
+    assert(len > 0);
+
+    for (i = 0; i + 9 < len; i++) {
+        if (!memcmp(&rsp[i], "\x68verified", 9)) {
+            return rsp[i + 9] == 0xf5;
+        }
+    }
+
+    return -1;
+}
+
+/*
+ * An image is hashed as it is uploaded and checked against its SHA-256 TLV
+ * once complete; the result is reported as "verified".
+ */
+TEST_CASE(boot_serial_upload_hash)
+{
+    uint32_t img_words[(UPLOAD_HASH_SIZE + 3) / 4];
+    uint8_t *img = (uint8_t *)img_words;
+    struct image_header *ih;
+    struct image_tlv_info *info;
+    struct image_tlv *tlv;
+    bootutil_sha_context sha;
+    int i;
+
+    memset(img_words, 0, sizeof(img_words));
+
+    ih = (struct image_header *)img;
+    ih->ih_magic = IMAGE_MAGIC;
+    ih->ih_hdr_size = IMAGE_HEADER_SIZE;
+    ih->ih_img_size = UPLOAD_HASH_IMG_SIZE;
+
+    for (i = 0; i < UPLOAD_HASH_IMG_SIZE; i++) {
+        img[IMAGE_HEADER_SIZE + i] = i * 3;
+    }
+
+    info = (struct image_tlv_info *)&img[IMAGE_HEADER_SIZE + UPLOAD_HASH_IMG_SIZE];
+    info->it_magic = IMAGE_TLV_INFO_MAGIC;
+    info->it_tlv_tot = UPLOAD_HASH_TLV_SIZE;
+    tlv = (struct image_tlv *)(info + 1);
+    tlv->it_type = IMAGE_TLV_SHA256;
+    tlv->it_len = 32;
+
+    bootutil_sha_init(&sha);
+    bootutil_sha_update(&sha, img, IMAGE_HEADER_SIZE + UPLOAD_HASH_IMG_SIZE);
+    bootutil_sha_finish(&sha, (uint8_t *)(tlv + 1));
+    bootutil_sha_drop(&sha);
+
+    assert(boot_serial_upload_hashed(img, UPLOAD_HASH_SIZE) == 1);
+
+    /* The image no longer matches its hash once a byte of it is changed. */
+    img[IMAGE_HEADER_SIZE + 10] ^= 0x01;
+    assert(boot_serial_upload_hashed(img, UPLOAD_HASH_SIZE) == 0);
+}
+#endif
@@ -38,6 +38,11 @@
     #error "One crypto backend must be defined: either CC310/TINYCRYPT/MBED_TLS/PSA_CRYPTO"
 #endif
 
+#if defined(MCUBOOT_ECDSA_COMB_TABLES) && \
+    !(defined(MCUBOOT_USE_TINYCRYPT) && defined(MCUBOOT_SIGN_EC256))
+    #error "MCUBOOT_ECDSA_COMB_TABLES requires ECDSA P-256 with TinyCrypt"
+#endif
+
 #if defined(MCUBOOT_USE_TINYCRYPT)
     #include <tinycrypt/ecc_dsa.h>
     #include <tinycrypt/constants.h>
@@ -182,10 +187,15 @@ static int bootutil_decode_sig(uint8_t signature[NUM_ECC_BYTES * 2], uint8_t *cp
 }
 #endif /* not MCUBOOT_ECDSA_NEED_ASN1_SIG */
 
+/* With MCUBOOT_ECDSA_COMB_TABLES, the context holds the comb table of the key. */
 typedef uintptr_t bootutil_ecdsa_context;
 static inline void bootutil_ecdsa_init(bootutil_ecdsa_context *ctx)
 {
+#if defined(MCUBOOT_ECDSA_COMB_TABLES)
+    *ctx = 0;
+#else
     (void)ctx;
+#endif
 }
 
 static inline void bootutil_ecdsa_drop(bootutil_ecdsa_context *ctx)
@@ -193,6 +203,14 @@ static inline void bootutil_ecdsa_drop(bootutil_ecdsa_context *ctx)
     (void)ctx;
 }
 
+#if defined(MCUBOOT_ECDSA_COMB_TABLES)
+static inline void bootutil_ecdsa_set_table(bootutil_ecdsa_context *ctx,
+                                            const unsigned int *table)
+{
+    *ctx = (uintptr_t)table;
+}
+#endif
+
 static inline int bootutil_ecdsa_verify(bootutil_ecdsa_context *ctx,
                                         uint8_t *pk, size_t pk_len,
                                         uint8_t *hash, size_t hash_len,
@@ -216,7 +234,17 @@ static inline int bootutil_ecdsa_verify(bootutil_ecdsa_context *ctx,
     }
     pk++;
 
+#if defined(MCUBOOT_ECDSA_COMB_TABLES)
+    if (*ctx != 0) {
+        rc = uECC_verify_comb(pk, (const uECC_word_t *)*ctx, hash,
+                              BOOTUTIL_CRYPTO_ECDSA_P256_HASH_SIZE, signature,
+                              uECC_secp256r1());
+    } else {
+        rc = uECC_verify(pk, hash, BOOTUTIL_CRYPTO_ECDSA_P256_HASH_SIZE, signature, uECC_secp256r1());
+    }
+#else
     rc = uECC_verify(pk, hash, BOOTUTIL_CRYPTO_ECDSA_P256_HASH_SIZE, signature, uECC_secp256r1());
+#endif
     if (rc != TC_CRYPTO_SUCCESS) {
         return -1;
     }
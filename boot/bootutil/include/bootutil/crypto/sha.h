@@ -74,6 +74,19 @@
     #include <tinycrypt/constants.h>
 #endif /* MCUBOOT_USE_TINYCRYPT */
 
+/*
+ * MCUBOOT_SHA256_NI hashes with the x86 SHA extensions, for simulator and
+ * host builds running on CPUs that have them.
+ */
+#if defined(MCUBOOT_SHA256_NI)
+#if !defined(MCUBOOT_USE_TINYCRYPT) || defined(MCUBOOT_SHA512)
+    #error "MCUBOOT_SHA256_NI requires TinyCrypt SHA-256"
+#endif
+#if !defined(TC_SHA256_NI_AVAILABLE)
+    #error "MCUBOOT_SHA256_NI requires an x86 target and GCC or Clang"
+#endif
+#endif /* MCUBOOT_SHA256_NI */
+
 #if defined(MCUBOOT_USE_CC310)
     #include <cc310_glue.h>
 #endif /* MCUBOOT_USE_CC310 */
@@ -221,6 +234,8 @@ static inline int bootutil_sha_update(bootutil_sha_context *ctx,
 {
 #if defined(MCUBOOT_SHA512)
     return tc_sha512_update(ctx, data, data_len);
+#elif defined(MCUBOOT_SHA256_NI)
+    return tc_sha256_update_ni(ctx, data, data_len);
 #else
     return tc_sha256_update(ctx, data, data_len);
 #endif
@@ -231,6 +246,8 @@ static inline int bootutil_sha_finish(bootutil_sha_context *ctx,
 {
 #if defined(MCUBOOT_SHA512)
     return tc_sha512_final(output, ctx);
+#elif defined(MCUBOOT_SHA256_NI)
+    return tc_sha256_final_ni(output, ctx);
 #else
     return tc_sha256_final(output, ctx);
 #endif
@@ -74,6 +74,10 @@ void boot_enc_decrypt(struct enc_key_data *enc_state,
         uint32_t off, uint32_t sz, uint32_t blk_off, uint8_t *buf);
 /* Note that boot_enc_zeorize takes BOOT_CURR_ENC, not BOOT_CURR_ENC_SLOT */
 void boot_enc_zeroize(struct enc_key_data *enc_state);
+#ifdef MCUBOOT_ENC_KEY_CACHE
+/* Wipes the keys cached in RAM by boot_enc_load() */
+void boot_enc_key_cache_clear(struct boot_loader_state *state);
+#endif
 
 #ifdef __cplusplus
 }
@@ -82,6 +82,12 @@ extern "C" {
 #define IMAGE_F_COMPRESSED_LZMA2         0x00000400
 #define IMAGE_F_COMPRESSED_ARM_THUMB_FLT 0x00000800
 
+/*
+ * Indicates that the image data is a patch to apply to the image in the
+ * primary slot, see IMAGE_TLV_DELTA_BASE.
+ */
+#define IMAGE_F_DELTA                    0x00001000
+
 /*
  * ECSDA224 is with NIST P-224
  * ECSDA256 is with NIST P-256
@@ -134,6 +140,16 @@ extern "C" {
 #define IMAGE_TLV_COMP_DEC_SIZE     0x73    /* Compressed decrypted image size */
 #define IMAGE_TLV_UUID_VID          0x74    /* Vendor unique identifier */
 #define IMAGE_TLV_UUID_CID          0x75    /* Device class unique identifier */
+#define IMAGE_TLV_SECTOR_HASHES     0x76    /*
+                                             * Block size (uint32_t) followed by
+                                             * the shaX hash of each block of
+                                             * the image header and body
+                                             */
+#define IMAGE_TLV_DELTA_BASE        0x77    /*
+                                             * Size (uint32_t), shift (uint32_t)
+                                             * and shaX hash of the image a
+                                             * delta image applies to
+                                             */
                                             /*
                                              * vendor reserved TLVs at xxA0-xxFF,
                                              * where xx denotes the upper byte
@@ -196,8 +212,10 @@ STRUCT_PACKED image_tlv {
 #define COMPRESSIONFLAGS (IMAGE_F_COMPRESSED_LZMA1 | IMAGE_F_COMPRESSED_LZMA2 \
                           | IMAGE_F_COMPRESSED_ARM_THUMB_FLT)
 #define IS_COMPRESSED(hdr) ((hdr)->ih_flags & COMPRESSIONFLAGS)
+#define IS_DELTA(hdr) ((hdr)->ih_flags & IMAGE_F_DELTA)
 #define MUST_DECOMPRESS(fap, idx, hdr) \
-    (flash_area_get_id(fap) == FLASH_AREA_IMAGE_SECONDARY(idx) && IS_COMPRESSED(hdr))
+    (flash_area_get_id(fap) == FLASH_AREA_IMAGE_SECONDARY(idx) && \
+     (IS_COMPRESSED(hdr) || IS_DELTA(hdr)))
 
 _Static_assert(sizeof(struct image_header) == IMAGE_HEADER_SIZE,
                "struct image_header not required size");
@@ -212,6 +230,18 @@ fih_ret bootutil_img_validate(struct boot_loader_state *state,
                               uint8_t *seed, int seed_len, uint8_t *out_hash
 );
 
+#if defined(MCUBOOT_VALIDATION_CACHE) || defined(MCUBOOT_HASH_IMAGE_COPY) || \
+    defined(MCUBOOT_SERIAL_UPLOAD_HASH)
+fih_ret bootutil_img_validate_digest(struct boot_loader_state *state,
+                                     struct image_header *hdr,
+                                     const struct flash_area *fap,
+                                     const uint8_t *digest);
+#endif
+
+#if defined(MCUBOOT_TLV_DIR_CACHE)
+struct boot_tlv_dir;
+#endif
+
 struct image_tlv_iter {
     const struct image_header *hdr;
     const struct flash_area *fap;
@@ -223,6 +253,11 @@ struct image_tlv_iter {
 #if defined(MCUBOOT_SWAP_USING_OFFSET)
     uint32_t start_off;
 #endif
+#if defined(MCUBOOT_TLV_DIR_CACHE)
+    /* Directory the TLVs are listed from, NULL to walk them in flash */
+    const struct boot_tlv_dir *dir;
+    uint8_t dir_idx;
+#endif
 };
 
 int bootutil_tlv_iter_begin(struct image_tlv_iter *it,
@@ -36,6 +36,36 @@ extern "C" {
 struct bootutil_key {
     const uint8_t *key;
     const unsigned int *len;
+#ifdef MCUBOOT_KEY_HASH_TABLE
+    /*
+     * Digest of the key, as put in the key hash TLV of images, generated at
+     * build time by `imgtool getpub --with-hash`. When NULL, or of another
+     * size than the image hash, it is computed at boot instead.
+     */
+    const uint8_t *hash;
+    const unsigned int *hash_len;
+#endif
+#ifdef MCUBOOT_ECDSA_COMB_TABLES
+    /*
+     * Comb table of an ECDSA P-256 key, generated at build time by
+     * `imgtool getpub --with-table`, or NULL.
+     */
+    const unsigned int *ecdsa_table;
+#endif
+#ifdef MCUBOOT_ED25519_PRECOMP_TABLES
+    /*
+     * Table of multiples of an Ed25519 key, generated at build time by
+     * `imgtool getpub --with-table`, or NULL.
+     */
+    const unsigned int *ed25519_table;
+#endif
+#ifdef MCUBOOT_RSA_PRECOMP_TABLES
+    /*
+     * Modulus and Montgomery constants of an RSA key, generated at build
+     * time by `imgtool getpub --with-table`, or NULL.
+     */
+    const unsigned int *rsa_table;
+#endif
 };
 
 extern const struct bootutil_key bootutil_keys[];
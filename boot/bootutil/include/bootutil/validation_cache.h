@@ -0,0 +1,81 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __VALIDATION_CACHE_H__
+#define __VALIDATION_CACHE_H__
+
+/**
+ * @file validation_cache.h
+ *
+ * Validation records of MCUBOOT_VALIDATION_CACHE.
+ *
+ * Once the image in the primary slot has been fully validated, MCUboot
+ * records its header and hash together with the slot's write generation.
+ * On later boots, while the header and generation still match, the image is
+ * accepted by checking its hash TLV and signature against the recorded hash
+ * instead of hashing the whole slot again.
+ *
+ * The records are appended to the trailer of the primary slot, so erasing
+ * the slot takes them away, and the write generation is derived from the
+ * swap state fields of that trailer.
+ *
+ * @note The record is not authenticated by itself: the scheme relies on the
+ *       primary slot being written to only by MCUboot, or by code that
+ *       erases the slot trailer before writing the image.
+ */
+
+#include <stdint.h>
+#include "bootutil/image.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BOOT_VALIDATION_RECORD_MAGIC    0x56414c44  /* "VALD" */
+
+/** Large enough for the biggest supported image hash (SHA-512). */
+#define BOOT_VALIDATION_RECORD_HASH_MAX 64
+
+struct boot_validation_record {
+    uint32_t magic;          /* BOOT_VALIDATION_RECORD_MAGIC when valid */
+    uint32_t generation;     /* Write generation of the slot when recorded */
+    struct image_header hdr; /* Header of the validated image */
+    uint8_t hash[BOOT_VALIDATION_RECORD_HASH_MAX]; /* Hash of the image */
+};
+
+/**
+ * Reads the validation record of a given image's primary slot.
+ * @param image_index       Index of the image (from 0).
+ * @param rec               Pointer to store the record.
+ * @return                  0 on success; nonzero if no record could be read.
+ */
+int boot_validation_record_read(uint32_t image_index,
+                                struct boot_validation_record *rec);
+
+/**
+ * Stores the validation record of a given image's primary slot, replacing
+ * any previous one. A record with a magic other than
+ * BOOT_VALIDATION_RECORD_MAGIC invalidates the stored record. Fails when
+ * the trailer has no room left for another valid record until the slot is
+ * erased.
+ * @param image_index       Index of the image (from 0).
+ * @param rec               Record to store.
+ * @return                  0 on success; nonzero on failure.
+ */
+int boot_validation_record_write(uint32_t image_index,
+                                 const struct boot_validation_record *rec);
+
+/**
+ * Reads the current write generation of a given image's primary slot.
+ * @param image_index       Index of the image (from 0).
+ * @param generation        Pointer to store the generation.
+ * @return                  0 on success; nonzero on failure.
+ */
+int boot_validation_generation_get(uint32_t image_index, uint32_t *generation);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __VALIDATION_CACHE_H__ */
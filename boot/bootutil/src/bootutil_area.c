@@ -46,6 +46,10 @@ static inline uint32_t
 boot_trailer_info_sz(void)
 {
     return (
+#ifdef MCUBOOT_VALIDATION_CACHE
+           /* validation records */
+           BOOT_VALIDATION_CACHE_SIZE             +
+#endif
 #ifdef MCUBOOT_ENC_IMAGES
            /* encryption keys */
 #  if MCUBOOT_SWAP_SAVE_ENCTLV
@@ -192,6 +196,57 @@ boot_trailer_scramble_offset(const struct flash_area *fa, size_t alignment, size
     return ret;
 }
 
+#ifdef MCUBOOT_ERASE_SKIP_BLANK
+/* Size of the buffer used to check that a region is blank before erasing it. */
+#define BOOT_BLANK_CHECK_SZ     128
+
+/**
+ * Checks whether a region of flash reads as erased, a word at a time.
+ *
+ * @param fa     The flash_area containing the region.
+ * @param off    The offset of the region within the flash area.
+ * @param size   The size of the region, a multiple of 4 bytes.
+ * @param blank  Set to true if the region reads as erased.
+ *
+ * @return 0 on success; nonzero on failure.
+ */
+static int
+boot_region_is_blank(const struct flash_area *fa, uint32_t off, uint32_t size, bool *blank)
+{
+    uint32_t buf[BOOT_BLANK_CHECK_SZ / sizeof(uint32_t)];
+    uint32_t erased;
+    uint32_t chunk;
+    size_t i;
+    int rc;
+
+    memset(&erased, flash_area_erased_val(fa), sizeof(erased));
+    *blank = false;
+
+    while (size > 0) {
+        chunk = size < sizeof(buf) ? size : sizeof(buf);
+
+        rc = flash_area_read(fa, off, buf, chunk);
+
+        if (rc != 0) {
+            return rc;
+        }
+
+        for (i = 0; i < chunk / sizeof(uint32_t); i++) {
+            if (buf[i] != erased) {
+                return 0;
+            }
+        }
+
+        off += chunk;
+        size -= chunk;
+    }
+
+    *blank = true;
+
+    return 0;
+}
+#endif
+
 int
 boot_erase_region(const struct flash_area *fa, uint32_t off, uint32_t size, bool backwards)
 {
@@ -201,6 +256,8 @@ boot_erase_region(const struct flash_area *fa, uint32_t off, uint32_t size, bool
                  ", size %" PRIu32 ", backwards == %" PRIu8,
                  fa, off, size, (int)backwards);
 
+    BOOT_SWAP_STATE_INVALIDATE();
+
     if (off >= flash_area_get_size(fa) || (flash_area_get_size(fa) - off) < size) {
         rc = -1;
         goto end;
@@ -238,6 +295,8 @@ boot_erase_region(const struct flash_area *fa, uint32_t off, uint32_t size, bool
         while (true) {
             /* Size to read in this iteration */
             size_t csize;
+            /* Set when the region to erase is already erased */
+            bool blank = false;
 
             /* Get current sector and, also, correct offset */
             rc = flash_area_get_sector(fa, off, &sector);
@@ -250,12 +309,51 @@ boot_erase_region(const struct flash_area *fa, uint32_t off, uint32_t size, bool
             off = flash_sector_get_off(&sector);
             csize = flash_sector_get_size(&sector);
 
-            rc = flash_area_erase(fa, off, csize);
+#ifdef MCUBOOT_FLASH_MULTI_SECTOR_ERASE
+            if (!backwards) {
+                /* Extend the erase over the following sectors of the range, as
+                 * far as the backend allows a single erase to go.
+                 */
+                uint32_t max_size = flash_area_erase_size(fa, off);
 
-            if (rc < 0) {
+                while (off + csize <= end_offset) {
+                    struct flash_sector next;
+
+                    rc = flash_area_get_sector(fa, off + csize, &next);
+
+                    if (rc < 0) {
+                        goto end;
+                    }
+
+                    if (csize + flash_sector_get_size(&next) > max_size) {
+                        break;
+                    }
+
+                    csize += flash_sector_get_size(&next);
+                }
+            }
+#endif
+
+#ifdef MCUBOOT_ERASE_SKIP_BLANK
+            rc = boot_region_is_blank(fa, off, csize, &blank);
+
+            if (rc != 0) {
                 goto end;
             }
 
+            if (blank) {
+                BOOT_LOG_DBG("boot_erase_region: skipping blank region at %" PRIu32, off);
+            }
+#endif
+
+            if (!blank) {
+                rc = flash_area_erase(fa, off, csize);
+
+                if (rc < 0) {
+                    goto end;
+                }
+            }
+
             MCUBOOT_WATCHDOG_FEED();
 
             if (backwards) {
@@ -314,6 +412,7 @@ boot_scramble_region(const struct flash_area *fa, uint32_t off, uint32_t size, b
         uint32_t end_offset;
 
         BOOT_LOG_DBG("boot_scramble_region: device without erase, overwriting");
+        BOOT_SWAP_STATE_INVALIDATE();
         memset(buf, flash_area_erased_val(fa), sizeof(buf));
 
         if (backwards) {
@@ -107,7 +107,8 @@ int boot_trailer_scramble_offset(const struct flash_area *fa, size_t alignment,
 
 /**
  * Erases a region of device that requires erase prior to write; does
- * nothing on devices without erase.
+ * nothing on devices without erase. With MCUBOOT_ERASE_SKIP_BLANK, sectors
+ * that already read as erased are not erased again.
  *
  * @param fa         The flash_area containing the region to erase.
  * @param off        The offset within the flash area to start the erase.
@@ -119,6 +120,24 @@ int boot_trailer_scramble_offset(const struct flash_area *fa, size_t alignment,
  */
 int boot_erase_region(const struct flash_area *fap, uint32_t off, uint32_t sz, bool backwards);
 
+#ifdef MCUBOOT_FLASH_MULTI_SECTOR_ERASE
+/**
+ * Provided by the flash map backend when MCUBOOT_FLASH_MULTI_SECTOR_ERASE is
+ * set: returns the largest number of bytes a single flash_area_erase() call
+ * starting at `off`, which is the start of a sector, can erase. This is
+ * typically the size of the largest erase block of the device `off` is
+ * aligned to. boot_erase_region() erases as many contiguous sectors as fit in
+ * that size at once; any value smaller than the sector at `off` makes it
+ * erase that sector alone.
+ *
+ * @param fa   The flash_area being erased.
+ * @param off  The offset of the erase within the flash area.
+ *
+ * @return The largest erase size at `off`, in bytes.
+ */
+uint32_t flash_area_erase_size(const struct flash_area *fa, uint32_t off);
+#endif
+
 /**
  * Removes data from specified region either by writing erase value in place of data or by doing
  * erase, if device has such hardware requirement.
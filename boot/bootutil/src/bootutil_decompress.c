@@ -0,0 +1,614 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Decompression of LZMA2 (optionally ARM-Thumb filtered) images from the
+ * secondary slot into the primary slot.
+ *
+ * imgtool builds a compressed image from the image it would have produced
+ * without compression: the payload is compressed, the IMAGE_TLV_DECOMP_SIZE,
+ * IMAGE_TLV_DECOMP_SHA and IMAGE_TLV_DECOMP_SIGNATURE TLVs are added to the
+ * protected area and the result is hashed and signed again. Decompression
+ * undoes this, streaming the payload through the decoder while writing
+ * the original header, payload and TLVs to the primary slot, so the primary
+ * slot ends up holding a regular image.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <flash_map_backend/flash_map_backend.h>
+
+#include "bootutil/image.h"
+#include "bootutil/crypto/sha.h"
+#include "bootutil/fault_injection_hardening.h"
+#include "bootutil_priv.h"
+#include "bootutil_decompress.h"
+#include "bootutil_lzma.h"
+#include "mcuboot_config/mcuboot_config.h"
+#include "bootutil/bootutil_log.h"
+
+#ifdef MCUBOOT_DECOMPRESS_IMAGES
+
+BOOT_LOG_MODULE_DECLARE(mcuboot);
+
+#if defined(MCUBOOT_SIGN_PURE)
+#error "Image decompression does not support pure signatures"
+#endif
+
+struct boot_decomp_reader {
+    const struct flash_area *fap;
+    uint32_t off;
+    uint32_t end;
+};
+
+struct boot_decomp_writer boot_decomp_writer;
+static bootutil_sha_context boot_decomp_sha;
+
+static bool
+boot_decomp_is_decomp_tlv(uint16_t type)
+{
+    return type == IMAGE_TLV_DECOMP_SIZE || type == IMAGE_TLV_DECOMP_SHA ||
+           type == IMAGE_TLV_DECOMP_SIGNATURE || type == IMAGE_TLV_COMP_DEC_SIZE ||
+           type == IMAGE_TLV_DELTA_BASE;
+}
+
+static bool
+boot_decomp_is_hash_tlv(uint16_t type)
+{
+    return type == IMAGE_TLV_SHA256 || type == IMAGE_TLV_SHA384 ||
+           type == IMAGE_TLV_SHA512;
+}
+
+static bool
+boot_decomp_is_sig_tlv(uint16_t type)
+{
+    return type == IMAGE_TLV_RSA2048_PSS || type == IMAGE_TLV_ECDSA224 ||
+           type == IMAGE_TLV_ECDSA_SIG || type == IMAGE_TLV_RSA3072_PSS ||
+           type == IMAGE_TLV_ED25519;
+}
+
+/*
+ * Walks the TLVs of the compressed image to work out the size of the TLV
+ * areas of the decompressed image and where its hash and signature are.
+ */
+int
+boot_decomp_read_layout(const struct image_header *hdr, const struct flash_area *fap,
+                        struct boot_decomp_layout *layout)
+{
+    struct image_tlv_iter it;
+    uint32_t off;
+    uint16_t len;
+    uint16_t type;
+    bool have_size = false;
+    int rc;
+
+    memset(layout, 0, sizeof(*layout));
+    layout->unprot_size = sizeof(struct image_tlv_info);
+
+    rc = bootutil_tlv_iter_begin(&it, hdr, fap, IMAGE_TLV_ANY, false);
+    if (rc != 0) {
+        return -1;
+    }
+
+    while (true) {
+        rc = bootutil_tlv_iter_next(&it, &off, &len, &type);
+        if (rc < 0) {
+            return -1;
+        } else if (rc > 0) {
+            break;
+        }
+
+        if (bootutil_tlv_iter_is_prot(&it, off)) {
+            switch (type) {
+            case IMAGE_TLV_DECOMP_SIZE:
+                if (len != sizeof(layout->img_size) ||
+                    flash_area_read(fap, off, &layout->img_size, len) != 0) {
+                    return -1;
+                }
+                have_size = true;
+                break;
+            case IMAGE_TLV_DECOMP_SHA:
+                layout->sha_off = off;
+                layout->sha_len = len;
+                break;
+            case IMAGE_TLV_DECOMP_SIGNATURE:
+                layout->sig_off = off;
+                layout->sig_len = len;
+                break;
+            case IMAGE_TLV_DELTA_BASE:
+                layout->delta_off = off;
+                layout->delta_len = len;
+                break;
+            default:
+                if (!boot_decomp_is_decomp_tlv(type)) {
+                    layout->prot_size += sizeof(struct image_tlv) + len;
+                }
+                break;
+            }
+            continue;
+        }
+
+        /* The protected area always comes first, so the lengths are known. */
+        if (boot_decomp_is_hash_tlv(type)) {
+            if (layout->sha_len == 0) {
+                return -1;
+            }
+            len = layout->sha_len;
+        } else if (boot_decomp_is_sig_tlv(type)) {
+            if (layout->sig_len == 0) {
+                return -1;
+            }
+            len = layout->sig_len;
+        }
+        layout->unprot_size += sizeof(struct image_tlv) + len;
+    }
+
+    if (!have_size || layout->sha_len != IMAGE_HASH_SIZE) {
+        return -1;
+    }
+
+    if (layout->prot_size > 0) {
+        layout->prot_size += sizeof(struct image_tlv_info);
+    }
+
+    if (layout->prot_size > UINT16_MAX || layout->unprot_size > UINT16_MAX) {
+        return -1;
+    }
+
+    return 0;
+}
+
+int
+boot_decomp_total_size(const struct image_header *hdr,
+                       const struct boot_decomp_layout *layout, uint32_t *size)
+{
+    if (!boot_u32_safe_add(size, hdr->ih_hdr_size, layout->img_size) ||
+        !boot_u32_safe_add(size, *size, layout->prot_size) ||
+        !boot_u32_safe_add(size, *size, layout->unprot_size)) {
+        return -1;
+    }
+
+    return 0;
+}
+
+int
+boot_decompress_image_size(struct boot_loader_state *state, int slot,
+                           uint32_t *size)
+{
+    struct image_header *hdr = boot_img_hdr(state, slot);
+    struct boot_decomp_layout layout;
+
+    if (boot_decomp_read_layout(hdr, BOOT_IMG_AREA(state, slot), &layout) != 0) {
+        return BOOT_EBADIMAGE;
+    }
+
+    if (boot_decomp_total_size(hdr, &layout, size) != 0) {
+        return BOOT_EBADIMAGE;
+    }
+
+    return 0;
+}
+
+int
+boot_decompress_check_image(struct boot_loader_state *state, int slot)
+{
+    const struct flash_area *fap = BOOT_IMG_AREA(state, slot);
+    struct image_header *hdr = boot_img_hdr(state, slot);
+    struct boot_decomp_layout layout;
+    uint8_t lzma_hdr[BOOTUTIL_LZMA2_HDR_SZ];
+    uint32_t size;
+
+#ifdef MCUBOOT_DELTA_IMAGES
+    if (IS_DELTA(hdr)) {
+        return boot_delta_check_image(state, slot);
+    }
+#endif
+
+    if (!(hdr->ih_flags & IMAGE_F_COMPRESSED_LZMA2) ||
+        (hdr->ih_flags & IMAGE_F_COMPRESSED_LZMA1)) {
+        BOOT_LOG_ERR("Image %d: unsupported compression type", BOOT_CURR_IMG(state));
+        return BOOT_EBADIMAGE;
+    }
+
+    if (IS_ENCRYPTED(hdr)) {
+        BOOT_LOG_ERR("Image %d: compressed images cannot be encrypted",
+                     BOOT_CURR_IMG(state));
+        return BOOT_EBADIMAGE;
+    }
+
+    if (hdr->ih_hdr_size < sizeof(struct image_header) ||
+        hdr->ih_img_size <= BOOTUTIL_LZMA2_HDR_SZ) {
+        return BOOT_EBADIMAGE;
+    }
+
+    if (boot_decomp_read_layout(hdr, fap, &layout) != 0 ||
+        boot_decomp_total_size(hdr, &layout, &size) != 0) {
+        BOOT_LOG_ERR("Image %d: invalid decompression TLVs", BOOT_CURR_IMG(state));
+        return BOOT_EBADIMAGE;
+    }
+
+    if (size > bootutil_max_image_size(state, BOOT_IMG_AREA(state, BOOT_SLOT_PRIMARY))) {
+        BOOT_LOG_ERR("Image %d: decompressed image too large: %u",
+                     BOOT_CURR_IMG(state), (unsigned)size);
+        return BOOT_EBADIMAGE;
+    }
+
+    if (flash_area_read(fap, hdr->ih_hdr_size, lzma_hdr, sizeof(lzma_hdr)) != 0) {
+        return BOOT_EFLASH;
+    }
+
+    if (bootutil_lzma2_check_header(lzma_hdr, layout.img_size) != BOOTUTIL_LZMA_OK) {
+        BOOT_LOG_ERR("Image %d: unsupported LZMA2 stream (dictionary limit %u bytes)",
+                     BOOT_CURR_IMG(state), (unsigned)MCUBOOT_DECOMPRESS_DICT_SIZE);
+        return BOOT_EBADIMAGE;
+    }
+
+    return 0;
+}
+
+/*
+ * Writer for the primary slot. Data is hashed as it goes through, until the
+ * hash is finalized and w->sha cleared, and written out in
+ * MCUBOOT_DECOMPRESS_BUFFER_SIZE chunks, by w->flush if set.
+ */
+
+void
+boot_decomp_writer_init(struct boot_decomp_writer *w, const struct flash_area *fap,
+                        bool hash)
+{
+    w->fap = fap;
+    w->off = 0;
+    w->len = 0;
+    w->flush = NULL;
+    w->sha = NULL;
+    if (hash) {
+        w->sha = &boot_decomp_sha;
+        bootutil_sha_init(w->sha);
+    }
+}
+
+void
+boot_decomp_writer_drop(struct boot_decomp_writer *w)
+{
+    if (w->sha != NULL) {
+        bootutil_sha_drop(w->sha);
+        w->sha = NULL;
+    }
+}
+
+static int
+boot_decomp_writer_flush(struct boot_decomp_writer *w)
+{
+    int rc;
+
+    if (w->flush != NULL) {
+        rc = w->flush(w);
+        if (rc != 0) {
+            return rc;
+        }
+    } else if (flash_area_write(w->fap, w->off, w->buf, w->len) != 0) {
+        return BOOT_EFLASH;
+    }
+
+    w->off += w->len;
+    w->len = 0;
+
+    MCUBOOT_WATCHDOG_FEED();
+
+    return 0;
+}
+
+int
+boot_decomp_writer_write(void *ctx, const uint8_t *data, uint32_t len)
+{
+    struct boot_decomp_writer *w = ctx;
+    uint32_t chunk;
+    int rc;
+
+    if (w->sha != NULL) {
+        bootutil_sha_update(w->sha, data, len);
+    }
+
+    while (len > 0) {
+        chunk = sizeof(w->buf) - w->len;
+        if (chunk > len) {
+            chunk = len;
+        }
+
+        memcpy(&w->buf[w->len], data, chunk);
+        w->len += chunk;
+        data += chunk;
+        len -= chunk;
+
+        if (w->len == sizeof(w->buf)) {
+            rc = boot_decomp_writer_flush(w);
+            if (rc != 0) {
+                return rc;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* Copies a region of the compressed image through the writer. */
+int
+boot_decomp_writer_copy(struct boot_decomp_writer *w, const struct flash_area *fap,
+                        uint32_t off, uint32_t len)
+{
+    uint32_t chunk;
+    int rc;
+
+    while (len > 0) {
+        chunk = sizeof(w->buf) - w->len;
+        if (chunk > len) {
+            chunk = len;
+        }
+
+        if (flash_area_read(fap, off, &w->buf[w->len], chunk) != 0) {
+            return BOOT_EFLASH;
+        }
+
+        if (w->sha != NULL) {
+            bootutil_sha_update(w->sha, &w->buf[w->len], chunk);
+        }
+
+        w->len += chunk;
+        off += chunk;
+        len -= chunk;
+
+        if (w->len == sizeof(w->buf)) {
+            rc = boot_decomp_writer_flush(w);
+            if (rc != 0) {
+                return rc;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* Pads the staged data to the write alignment and writes it out. */
+int
+boot_decomp_writer_finish(struct boot_decomp_writer *w)
+{
+    uint32_t align = flash_area_align(w->fap);
+    uint32_t pad = (align - (w->len % align)) % align;
+
+    memset(&w->buf[w->len], flash_area_erased_val(w->fap), pad);
+    w->len += pad;
+
+    return boot_decomp_writer_flush(w);
+}
+
+static int
+boot_decomp_writer_tlv(struct boot_decomp_writer *w, uint16_t type, uint16_t len)
+{
+    struct image_tlv tlv = {
+        .it_type = type,
+        .it_len = len,
+    };
+
+    return boot_decomp_writer_write(w, (const uint8_t *)&tlv, sizeof(tlv));
+}
+
+static int
+boot_decomp_read(void *ctx, uint8_t *buf, uint32_t len)
+{
+    struct boot_decomp_reader *r = ctx;
+
+    if (len > r->end - r->off) {
+        len = r->end - r->off;
+    }
+
+    if (len > 0 && flash_area_read(r->fap, r->off, buf, len) != 0) {
+        return -1;
+    }
+
+    r->off += len;
+
+    return (int)len;
+}
+
+/*
+ * Writes the TLV areas of the decompressed image: the protected TLVs of the
+ * compressed image minus the decompression ones, then its unprotected TLVs
+ * with the hash and signature replaced by those of the decompressed image.
+ * The hash, if any, is finalized into @p hash once the protected area is
+ * written.
+ */
+int
+boot_decomp_write_tlvs(struct boot_decomp_writer *w, const struct image_header *hdr,
+                       const struct flash_area *fap,
+                       const struct boot_decomp_layout *layout, uint8_t *hash)
+{
+    struct image_tlv_info info;
+    struct image_tlv_iter it;
+    bool prot_done = false;
+    uint32_t off;
+    uint16_t len;
+    uint16_t type;
+    int rc;
+
+    if (layout->prot_size > 0) {
+        info.it_magic = IMAGE_TLV_PROT_INFO_MAGIC;
+        info.it_tlv_tot = (uint16_t)layout->prot_size;
+        rc = boot_decomp_writer_write(w, (const uint8_t *)&info, sizeof(info));
+        if (rc != 0) {
+            return rc;
+        }
+    }
+
+    rc = bootutil_tlv_iter_begin(&it, hdr, fap, IMAGE_TLV_ANY, false);
+    if (rc != 0) {
+        return BOOT_EBADIMAGE;
+    }
+
+    while (true) {
+        rc = bootutil_tlv_iter_next(&it, &off, &len, &type);
+        if (rc < 0) {
+            return BOOT_EBADIMAGE;
+        }
+
+        if (!prot_done && (rc > 0 || !bootutil_tlv_iter_is_prot(&it, off))) {
+            /* End of the hashed part of the image. */
+            if (w->sha != NULL) {
+                bootutil_sha_finish(w->sha, hash);
+                boot_decomp_writer_drop(w);
+            }
+            prot_done = true;
+
+            info.it_magic = IMAGE_TLV_INFO_MAGIC;
+            info.it_tlv_tot = (uint16_t)layout->unprot_size;
+            if (boot_decomp_writer_write(w, (const uint8_t *)&info, sizeof(info)) != 0) {
+                return BOOT_EFLASH;
+            }
+        }
+
+        if (rc > 0) {
+            break;
+        }
+
+        if (bootutil_tlv_iter_is_prot(&it, off)) {
+            if (boot_decomp_is_decomp_tlv(type)) {
+                continue;
+            }
+        } else if (boot_decomp_is_hash_tlv(type)) {
+            off = layout->sha_off;
+            len = layout->sha_len;
+        } else if (boot_decomp_is_sig_tlv(type)) {
+            off = layout->sig_off;
+            len = layout->sig_len;
+        }
+
+        rc = boot_decomp_writer_tlv(w, type, len);
+        if (rc == 0) {
+            rc = boot_decomp_writer_copy(w, fap, off, len);
+        }
+        if (rc != 0) {
+            return rc;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Writes the header of the decoded image: that of the compressed or delta
+ * image, for the decoded payload and TLVs, followed by whatever padding
+ * follows the header structure.
+ */
+int
+boot_decomp_write_header(struct boot_decomp_writer *w, const struct image_header *hdr,
+                         const struct flash_area *fap,
+                         const struct boot_decomp_layout *layout)
+{
+    struct image_header out_hdr;
+    int rc;
+
+    memcpy(&out_hdr, hdr, sizeof(out_hdr));
+    out_hdr.ih_img_size = layout->img_size;
+    out_hdr.ih_protect_tlv_size = (uint16_t)layout->prot_size;
+    out_hdr.ih_flags &= ~(COMPRESSIONFLAGS | IMAGE_F_DELTA);
+
+    rc = boot_decomp_writer_write(w, (const uint8_t *)&out_hdr, sizeof(out_hdr));
+    if (rc == 0) {
+        rc = boot_decomp_writer_copy(w, fap, sizeof(out_hdr),
+                                     hdr->ih_hdr_size - sizeof(out_hdr));
+    }
+
+    return rc;
+}
+
+int
+boot_decompress_image(struct boot_loader_state *state,
+                      const struct flash_area *fap_src,
+                      const struct flash_area *fap_dst)
+{
+    struct boot_decomp_writer *w = &boot_decomp_writer;
+    struct image_header *hdr = boot_img_hdr(state, BOOT_SLOT_SECONDARY);
+    struct boot_decomp_layout layout;
+    struct boot_decomp_reader reader;
+    struct bootutil_lzma_io io;
+    uint8_t lzma_hdr[BOOTUTIL_LZMA2_HDR_SZ];
+    uint8_t hash[IMAGE_HASH_SIZE];
+    FIH_DECLARE(fih_rc, FIH_FAILURE);
+    int rc;
+
+    if (sizeof(w->buf) % flash_area_align(fap_dst) != 0) {
+        BOOT_LOG_ERR("Decompression buffer not a multiple of the write size");
+        return BOOT_EBADARGS;
+    }
+
+    if (boot_decomp_read_layout(hdr, fap_src, &layout) != 0) {
+        return BOOT_EBADIMAGE;
+    }
+
+    if (flash_area_read(fap_src, hdr->ih_hdr_size, lzma_hdr, sizeof(lzma_hdr)) != 0) {
+        return BOOT_EFLASH;
+    }
+
+    BOOT_LOG_INF("Image %d decompressing the secondary slot to the primary slot: "
+                 "0x%x bytes", BOOT_CURR_IMG(state), (unsigned)layout.img_size);
+
+    boot_decomp_writer_init(w, fap_dst, true);
+
+    rc = boot_decomp_write_header(w, hdr, fap_src, &layout);
+    if (rc != 0) {
+        goto out;
+    }
+
+    reader.fap = fap_src;
+    reader.off = hdr->ih_hdr_size + BOOTUTIL_LZMA2_HDR_SZ;
+    reader.end = hdr->ih_hdr_size + hdr->ih_img_size;
+
+    io.read = boot_decomp_read;
+    io.write = boot_decomp_writer_write;
+    io.in_ctx = &reader;
+    io.out_ctx = w;
+
+    rc = bootutil_lzma2_decode(&io, lzma_hdr,
+                               (hdr->ih_flags & IMAGE_F_COMPRESSED_ARM_THUMB_FLT) != 0,
+                               layout.img_size);
+    if (rc != BOOTUTIL_LZMA_OK) {
+        BOOT_LOG_ERR("Image %d decompression failed: %d", BOOT_CURR_IMG(state), rc);
+        rc = BOOT_EBADIMAGE;
+        goto out;
+    }
+
+    rc = boot_decomp_write_tlvs(w, hdr, fap_src, &layout, hash);
+    if (rc == 0) {
+        rc = boot_decomp_writer_finish(w);
+    }
+    if (rc != 0) {
+        goto out;
+    }
+
+    FIH_CALL(bootutil_img_validate_decomp, fih_rc, state, hdr, fap_src, hash);
+    if (FIH_NOT_EQ(fih_rc, FIH_SUCCESS)) {
+        BOOT_LOG_ERR("Image %d decompressed image does not match its hash or signature",
+                     BOOT_CURR_IMG(state));
+        rc = BOOT_EBADIMAGE;
+    }
+
+out:
+    boot_decomp_writer_drop(w);
+
+    return rc;
+}
+
+#endif /* MCUBOOT_DECOMPRESS_IMAGES */
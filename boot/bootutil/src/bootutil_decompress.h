@@ -0,0 +1,192 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef H_BOOTUTIL_DECOMPRESS_
+#define H_BOOTUTIL_DECOMPRESS_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <flash_map_backend/flash_map_backend.h>
+
+#include "bootutil/crypto/sha.h"
+#include "bootutil/fault_injection_hardening.h"
+#include "bootutil_priv.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef MCUBOOT_DECOMPRESS_BUFFER_SIZE
+#define MCUBOOT_DECOMPRESS_BUFFER_SIZE  4096
+#endif
+
+#if defined(MCUBOOT_DELTA_IMAGES) && !defined(MCUBOOT_DECOMPRESS_IMAGES)
+#error "MCUBOOT_DELTA_IMAGES requires MCUBOOT_DECOMPRESS_IMAGES"
+#endif
+
+/* Location of the parts of the compressed image needed to rebuild the TLVs. */
+struct boot_decomp_layout {
+    uint32_t img_size;      /* Decompressed payload size */
+    uint32_t prot_size;     /* Decompressed protected TLV area, with info */
+    uint32_t unprot_size;   /* Decompressed unprotected TLV area, with info */
+    uint32_t sha_off;
+    uint16_t sha_len;
+    uint32_t sig_off;
+    uint16_t sig_len;
+    uint32_t delta_off;     /* IMAGE_TLV_DELTA_BASE, delta images only */
+    uint16_t delta_len;
+};
+
+/* Staging buffer for writes to the primary slot. */
+struct boot_decomp_writer {
+    const struct flash_area *fap;
+    bootutil_sha_context *sha;
+    uint32_t off;
+    uint32_t len;
+    /* Writes out the staged data instead of writing it to w->off of w->fap. */
+    int (*flush)(struct boot_decomp_writer *w);
+    uint8_t buf[MCUBOOT_DECOMPRESS_BUFFER_SIZE];
+};
+
+/*
+ * The single writer, also used by delta images. The functions below are
+ * shared with bootutil_delta.c and are not meant to be used elsewhere.
+ */
+extern struct boot_decomp_writer boot_decomp_writer;
+
+int boot_decomp_read_layout(const struct image_header *hdr, const struct flash_area *fap,
+                            struct boot_decomp_layout *layout);
+int boot_decomp_total_size(const struct image_header *hdr,
+                           const struct boot_decomp_layout *layout, uint32_t *size);
+void boot_decomp_writer_init(struct boot_decomp_writer *w, const struct flash_area *fap,
+                             bool hash);
+void boot_decomp_writer_drop(struct boot_decomp_writer *w);
+int boot_decomp_writer_write(void *ctx, const uint8_t *data, uint32_t len);
+int boot_decomp_writer_copy(struct boot_decomp_writer *w, const struct flash_area *fap,
+                            uint32_t off, uint32_t len);
+int boot_decomp_writer_finish(struct boot_decomp_writer *w);
+int boot_decomp_write_header(struct boot_decomp_writer *w, const struct image_header *hdr,
+                             const struct flash_area *fap,
+                             const struct boot_decomp_layout *layout);
+int boot_decomp_write_tlvs(struct boot_decomp_writer *w, const struct image_header *hdr,
+                           const struct flash_area *fap,
+                           const struct boot_decomp_layout *layout, uint8_t *hash);
+
+/**
+ * Checks that the compressed image in the given slot can be decompressed into
+ * the primary slot: supported compression and encryption flags, well formed
+ * decompression TLVs, a dictionary that fits the decoder and a decompressed
+ * image that fits the primary slot.
+ *
+ * This does not authenticate the image; that is done by
+ * bootutil_img_validate() on the compressed image beforehand.
+ *
+ * @param state Boot loader state.
+ * @param slot  Slot holding the compressed image.
+ *
+ * @return 0 if the image can be decompressed; nonzero otherwise.
+ */
+int boot_decompress_check_image(struct boot_loader_state *state, int slot);
+
+/**
+ * Computes the size the compressed image in the given slot will occupy in the
+ * primary slot once decompressed, including header and TLVs.
+ *
+ * @param state Boot loader state.
+ * @param slot  Slot holding the compressed image.
+ * @param size  On success, the decompressed image size.
+ *
+ * @return 0 on success; nonzero on failure.
+ */
+int boot_decompress_image_size(struct boot_loader_state *state, int slot,
+                               uint32_t *size);
+
+/**
+ * Decompresses the image in the secondary slot into the already erased
+ * primary slot, rebuilding the header and TLVs the image had before it was
+ * compressed. The decompressed image is hashed while it is written and the
+ * result is checked against the IMAGE_TLV_DECOMP_SHA and
+ * IMAGE_TLV_DECOMP_SIGNATURE TLVs of the compressed image.
+ *
+ * @param state   Boot loader state.
+ * @param fap_src Flash area of the secondary slot.
+ * @param fap_dst Flash area of the primary slot.
+ *
+ * @return 0 on success; nonzero on failure.
+ */
+int boot_decompress_image(struct boot_loader_state *state,
+                          const struct flash_area *fap_src,
+                          const struct flash_area *fap_dst);
+
+#ifdef MCUBOOT_DELTA_IMAGES
+/**
+ * Checks that the delta image in the given slot can be applied to the primary
+ * slot: no compression or encryption, well formed decoding and
+ * IMAGE_TLV_DELTA_BASE TLVs, and a primary slot with room for the shifted
+ * base image and the patched image, as well as room in the given slot for a
+ * staging sector.
+ *
+ * @param state Boot loader state.
+ * @param slot  Slot holding the delta image.
+ *
+ * @return 0 if the image can be applied; nonzero otherwise.
+ */
+int boot_delta_check_image(struct boot_loader_state *state, int slot);
+
+/**
+ * Applies the delta image in the secondary slot to the image in the primary
+ * slot, in place. Before anything is written, the primary slot image must
+ * match the hash of IMAGE_TLV_DELTA_BASE, unless boot_delta_check_image()
+ * already found it does for the same image. Progress is recorded in the swap
+ * status area of the secondary slot, so an interrupted patch resumes where it
+ * stopped. The patched image is then checked against the
+ * IMAGE_TLV_DECOMP_SHA and IMAGE_TLV_DECOMP_SIGNATURE TLVs of the delta image.
+ *
+ * @param state   Boot loader state.
+ * @param fap_src Flash area of the secondary slot.
+ * @param fap_dst Flash area of the primary slot.
+ *
+ * @return 0 on success; BOOT_EBADIMAGE if the primary slot does not hold
+ *         the base image and nothing was written; other nonzero values on
+ *         failure.
+ */
+int boot_delta_image(struct boot_loader_state *state,
+                     const struct flash_area *fap_src,
+                     const struct flash_area *fap_dst);
+#endif
+
+/**
+ * Verifies a hash computed over a decompressed image against the
+ * IMAGE_TLV_DECOMP_SHA and, when signatures are enabled,
+ * IMAGE_TLV_DECOMP_SIGNATURE TLVs of the compressed image it came from.
+ *
+ * @param state Boot loader state.
+ * @param hdr   Header of the compressed image.
+ * @param fap   Flash area holding the compressed image.
+ * @param hash  Hash of the decompressed image.
+ *
+ * @return FIH_SUCCESS if the hash is authentic; FIH_FAILURE otherwise.
+ */
+fih_ret bootutil_img_validate_decomp(struct boot_loader_state *state,
+                                     struct image_header *hdr,
+                                     const struct flash_area *fap,
+                                     uint8_t *hash);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* H_BOOTUTIL_DECOMPRESS_ */
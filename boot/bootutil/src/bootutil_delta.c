@@ -0,0 +1,772 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Delta images: the payload of a delta image is a patch against the image in
+ * the primary slot, the base image, identified by the hash carried in the
+ * IMAGE_TLV_DELTA_BASE TLV. Like compressed images, a delta image carries the
+ * IMAGE_TLV_DECOMP_SIZE, IMAGE_TLV_DECOMP_SHA and IMAGE_TLV_DECOMP_SIGNATURE
+ * TLVs of the image it produces, whose header and TLVs are rebuilt the same
+ * way.
+ *
+ * The patch is a sequence of commands, each a command byte followed by
+ * LEB128 encoded arguments:
+ *
+ * - BOOT_DELTA_COPY n: copies n bytes of the base image, from the current
+ *   base position, which is advanced by n.
+ * - BOOT_DELTA_LITERAL n: copies the n bytes following the command.
+ * - BOOT_DELTA_SEEK d: moves the base position by d, zigzag encoded.
+ *
+ * Base positions are offsets in the base image, output starts after the
+ * header of the patched image. The patch is applied in place, one primary
+ * slot sector at a time: each sector is first built in a staging sector of
+ * the secondary slot, after the delta image, then copied over the primary
+ * slot. This requires that no data is ever copied from the base image to an
+ * earlier offset, which imgtool makes possible by first moving the base
+ * image up by the shift given in IMAGE_TLV_DELTA_BASE.
+ *
+ * Progress is recorded in the swap status area of the secondary slot, which
+ * is otherwise unused when upgrading by overwriting, using the three entries
+ * of a sector for: base sector moved up, sector staged and sector done.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <flash_map_backend/flash_map_backend.h>
+
+#include "bootutil/image.h"
+#include "bootutil/fault_injection_hardening.h"
+#include "bootutil_priv.h"
+#include "bootutil_area.h"
+#include "bootutil_decompress.h"
+#include "mcuboot_config/mcuboot_config.h"
+#include "bootutil/bootutil_log.h"
+
+#ifdef MCUBOOT_DELTA_IMAGES
+
+BOOT_LOG_MODULE_DECLARE(mcuboot);
+
+#if !defined(MCUBOOT_OVERWRITE_ONLY)
+#error "Delta images are only supported with MCUBOOT_OVERWRITE_ONLY"
+#endif
+
+#if BOOT_STATUS_STATE_COUNT < 3
+#error "Delta images need three status entries per sector"
+#endif
+
+#define BOOT_DELTA_COPY         0x00
+#define BOOT_DELTA_LITERAL      0x01
+#define BOOT_DELTA_SEEK         0x02
+
+/* Progress flags, one swap status entry each. */
+#define BOOT_DELTA_MOVED        0
+#define BOOT_DELTA_STAGED       1
+#define BOOT_DELTA_DONE         2
+
+/* IMAGE_TLV_DELTA_BASE payload: base image size, shift, base image hash. */
+#define BOOT_DELTA_BASE_TLV_SZ  (2 * sizeof(uint32_t) + IMAGE_HASH_SIZE)
+
+struct boot_delta {
+    struct boot_loader_state *state;
+    const struct flash_area *fap_pri;
+    const struct flash_area *fap_sec;
+    uint32_t sector_sz;     /* Size of the (uniform) primary slot sectors */
+    uint32_t stage_off;     /* Staging sector, in the secondary slot */
+    uint32_t base_size;     /* Size of the base image, TLVs included */
+    uint32_t shift;         /* Offset of the base image once moved up */
+    uint32_t total;         /* Size of the patched image, TLVs included */
+    uint32_t resume_off;    /* Output below this offset is already in place */
+    uint32_t base_pos;      /* Current position in the base image */
+};
+
+struct boot_delta_reader {
+    const struct flash_area *fap;
+    uint32_t off;           /* Offset of buf[0] */
+    uint32_t end;
+    uint32_t pos;
+    uint32_t len;
+    uint8_t buf[32];
+};
+
+static struct boot_delta boot_delta;
+
+/*
+ * Images whose base image boot_delta_check_image() found in the primary slot,
+ * so that boot_delta_image() does not hash it a second time.
+ */
+static bool boot_delta_base_checked[BOOT_IMAGE_NUMBER];
+
+/* Offset of the first sector holding the trailer of the given slot. */
+static uint32_t
+boot_delta_trailer_off(struct boot_loader_state *state, int slot)
+{
+    uint32_t trailer_sz = boot_trailer_sz(BOOT_WRITE_SZ(state));
+    size_t sector = boot_img_num_sectors(state, slot);
+    uint32_t sz = 0;
+
+    do {
+        sector--;
+        sz += boot_img_sector_size(state, slot, sector);
+    } while (sz < trailer_sz && sector > 0);
+
+    return boot_img_sector_off(state, slot, sector);
+}
+
+/*
+ * Reads the IMAGE_TLV_DELTA_BASE TLV and works out where the patch can be
+ * applied, checking that everything fits.
+ */
+static int
+boot_delta_init(struct boot_delta *d, struct boot_loader_state *state, int slot,
+                const struct boot_decomp_layout *layout, uint8_t *base_hash)
+{
+    const struct flash_area *fap = BOOT_IMG_AREA(state, slot);
+    struct image_header *hdr = boot_img_hdr(state, slot);
+    struct image_tlv_iter it;
+    uint32_t base[2];
+    uint32_t limit;
+    uint32_t off;
+    uint32_t sz;
+    size_t sector;
+
+    memset(d, 0, sizeof(*d));
+    d->state = state;
+    d->fap_pri = BOOT_IMG_AREA(state, BOOT_SLOT_PRIMARY);
+    d->fap_sec = fap;
+
+    if (layout->delta_len != BOOT_DELTA_BASE_TLV_SZ ||
+        flash_area_read(fap, layout->delta_off, base, sizeof(base)) != 0) {
+        return -1;
+    }
+
+    if (base_hash != NULL &&
+        flash_area_read(fap, layout->delta_off + sizeof(base), base_hash,
+                        IMAGE_HASH_SIZE) != 0) {
+        return -1;
+    }
+
+    d->base_size = base[0];
+    d->shift = base[1];
+
+    if (boot_decomp_total_size(hdr, layout, &d->total) != 0) {
+        return -1;
+    }
+
+    /* The primary slot is patched a sector at a time. */
+    d->sector_sz = boot_img_sector_size(state, BOOT_SLOT_PRIMARY, 0);
+    for (sector = 1; sector < boot_img_num_sectors(state, BOOT_SLOT_PRIMARY); sector++) {
+        if (boot_img_sector_size(state, BOOT_SLOT_PRIMARY, sector) != d->sector_sz) {
+            return -1;
+        }
+    }
+
+    if (d->sector_sz % MCUBOOT_DECOMPRESS_BUFFER_SIZE != 0 ||
+        MCUBOOT_DECOMPRESS_BUFFER_SIZE % BOOT_WRITE_SZ(state) != 0) {
+        return -1;
+    }
+
+    limit = boot_delta_trailer_off(state, BOOT_SLOT_PRIMARY);
+    if (d->base_size == 0 || d->base_size > limit || d->shift > limit - d->base_size ||
+        d->shift % d->sector_sz != 0 || d->total > limit) {
+        return -1;
+    }
+
+    /* The staging sector comes after the delta image, sector aligned. */
+    if (boot_tlv_iter_begin(state, &it, hdr, fap, IMAGE_TLV_ANY, false) != 0) {
+        return -1;
+    }
+
+    for (sector = 0; sector < boot_img_num_sectors(state, slot); sector++) {
+        if (boot_img_sector_off(state, slot, sector) >= it.tlv_end) {
+            break;
+        }
+    }
+
+    if (sector == boot_img_num_sectors(state, slot)) {
+        return -1;
+    }
+
+    d->stage_off = boot_img_sector_off(state, slot, sector);
+    for (sz = 0; sz < d->sector_sz && sector < boot_img_num_sectors(state, slot); sector++) {
+        sz += boot_img_sector_size(state, slot, sector);
+    }
+
+    off = d->stage_off + sz;
+    if (sz != d->sector_sz || off > boot_delta_trailer_off(state, slot)) {
+        return -1;
+    }
+
+    return 0;
+}
+
+static uint32_t
+boot_delta_flag_off(const struct boot_delta *d, uint32_t sector, int flag)
+{
+    return boot_status_off(d->fap_sec) +
+           (sector * BOOT_STATUS_STATE_COUNT + flag) * BOOT_WRITE_SZ(d->state);
+}
+
+static int
+boot_delta_read_flag(const struct boot_delta *d, uint32_t sector, int flag, bool *set)
+{
+    uint8_t buf[BOOT_MAX_ALIGN];
+    uint32_t align = flash_area_align(d->fap_sec);
+
+    if (flash_area_read(d->fap_sec, boot_delta_flag_off(d, sector, flag), buf, align) != 0) {
+        return BOOT_EFLASH;
+    }
+
+    *set = !bootutil_buffer_is_erased(d->fap_sec, buf, align);
+
+    return 0;
+}
+
+static int
+boot_delta_write_flag(const struct boot_delta *d, uint32_t sector, int flag)
+{
+    uint8_t buf[BOOT_MAX_ALIGN];
+    uint32_t align = flash_area_align(d->fap_sec);
+
+    memset(buf, flash_area_erased_val(d->fap_sec), sizeof(buf));
+    buf[0] = 1;
+
+    if (flash_area_write(d->fap_sec, boot_delta_flag_off(d, sector, flag), buf, align) != 0) {
+        return BOOT_EFLASH;
+    }
+
+    return 0;
+}
+
+/* Tells whether anything of the primary slot was already overwritten. */
+static int
+boot_delta_started(const struct boot_delta *d, bool *started)
+{
+    int rc;
+
+    rc = boot_delta_read_flag(d, 0, BOOT_DELTA_STAGED, started);
+    if (rc == 0 && !*started && d->shift > 0) {
+        /* The base image is moved up last sector first. */
+        rc = boot_delta_read_flag(d, (d->base_size - 1) / d->sector_sz, BOOT_DELTA_MOVED,
+                                  started);
+    }
+
+    return rc;
+}
+
+/* Copies a region between the slots, through the writer buffer. */
+static int
+boot_delta_copy(const struct flash_area *fap_src, uint32_t off_src,
+                const struct flash_area *fap_dst, uint32_t off_dst, uint32_t len)
+{
+    uint8_t *buf = boot_decomp_writer.buf;
+    uint32_t chunk;
+
+    while (len > 0) {
+        chunk = sizeof(boot_decomp_writer.buf);
+        if (chunk > len) {
+            chunk = len;
+        }
+
+        if (flash_area_read(fap_src, off_src, buf, chunk) != 0 ||
+            flash_area_write(fap_dst, off_dst, buf, chunk) != 0) {
+            return BOOT_EFLASH;
+        }
+
+        off_src += chunk;
+        off_dst += chunk;
+        len -= chunk;
+
+        MCUBOOT_WATCHDOG_FEED();
+    }
+
+    return 0;
+}
+
+/* Moves the base image up by the shift, last sector first. */
+static int
+boot_delta_move_base(struct boot_delta *d)
+{
+    uint32_t sector = (d->base_size + d->sector_sz - 1) / d->sector_sz;
+    bool moved;
+    int rc;
+
+    while (sector-- > 0) {
+        rc = boot_delta_read_flag(d, sector, BOOT_DELTA_MOVED, &moved);
+        if (rc != 0) {
+            return rc;
+        }
+        if (moved) {
+            continue;
+        }
+
+        rc = boot_erase_region(d->fap_pri, sector * d->sector_sz + d->shift, d->sector_sz,
+                               false);
+        if (rc == 0) {
+            rc = boot_delta_copy(d->fap_pri, sector * d->sector_sz, d->fap_pri,
+                                 sector * d->sector_sz + d->shift, d->sector_sz);
+        }
+        if (rc == 0) {
+            rc = boot_delta_write_flag(d, sector, BOOT_DELTA_MOVED);
+        }
+        if (rc != 0) {
+            return rc;
+        }
+    }
+
+    return 0;
+}
+
+/* Copies the staged sector over the primary slot. */
+static int
+boot_delta_commit(struct boot_delta *d, uint32_t sector)
+{
+    uint32_t off = sector * d->sector_sz;
+    uint32_t len = d->sector_sz;
+    int rc;
+
+    if (len > d->total - off) {
+        len = ALIGN_UP(d->total - off, BOOT_WRITE_SZ(d->state));
+    }
+
+    rc = boot_erase_region(d->fap_pri, off, d->sector_sz, false);
+    if (rc == 0) {
+        rc = boot_delta_copy(d->fap_sec, d->stage_off, d->fap_pri, off, len);
+    }
+    if (rc == 0) {
+        rc = boot_delta_write_flag(d, sector, BOOT_DELTA_DONE);
+    }
+
+    return rc;
+}
+
+/*
+ * Flush hook of the writer: stages the data and commits each sector once
+ * complete. Data below the resume offset is already in place and dropped.
+ */
+static int
+boot_delta_flush(struct boot_decomp_writer *w)
+{
+    struct boot_delta *d = &boot_delta;
+    uint32_t in_sector = w->off % d->sector_sz;
+    uint32_t sector = w->off / d->sector_sz;
+    uint32_t pad;
+    int rc;
+
+    if (w->len == 0 || w->off + w->len <= d->resume_off) {
+        return 0;
+    }
+
+    /* The last chunk is only padded to the primary slot write size. */
+    pad = ALIGN_UP(w->len, BOOT_WRITE_SZ(d->state)) - w->len;
+    memset(&w->buf[w->len], flash_area_erased_val(d->fap_sec), pad);
+    w->len += pad;
+
+    if (in_sector == 0) {
+        rc = boot_erase_region(d->fap_sec, d->stage_off, d->sector_sz, false);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+
+    if (flash_area_write(d->fap_sec, d->stage_off + in_sector, w->buf, w->len) != 0) {
+        return BOOT_EFLASH;
+    }
+
+    if (in_sector + w->len < d->sector_sz && w->off + w->len < d->total) {
+        return 0;
+    }
+
+    rc = boot_delta_write_flag(d, sector, BOOT_DELTA_STAGED);
+    if (rc == 0) {
+        rc = boot_delta_commit(d, sector);
+    }
+
+    return rc;
+}
+
+static int
+boot_delta_getc(struct boot_delta_reader *r, uint8_t *c)
+{
+    if (r->pos == r->len) {
+        r->off += r->len;
+        r->pos = 0;
+        r->len = r->end - r->off;
+        if (r->len > sizeof(r->buf)) {
+            r->len = sizeof(r->buf);
+        }
+        if (r->len == 0) {
+            return -1;
+        }
+        if (flash_area_read(r->fap, r->off, r->buf, r->len) != 0) {
+            return -1;
+        }
+    }
+
+    *c = r->buf[r->pos++];
+
+    return 0;
+}
+
+static int
+boot_delta_varint(struct boot_delta_reader *r, uint32_t *val)
+{
+    uint32_t shift;
+    uint8_t c;
+
+    *val = 0;
+    for (shift = 0; shift < 32; shift += 7) {
+        if (boot_delta_getc(r, &c) != 0) {
+            return -1;
+        }
+        if (shift == 28 && c > 0x0f) {
+            return -1;
+        }
+        *val |= (uint32_t)(c & 0x7f) << shift;
+        if (!(c & 0x80)) {
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+/* Copies literal bytes of the patch through the writer. */
+static int
+boot_delta_literal(struct boot_delta_reader *r, struct boot_decomp_writer *w, uint32_t len)
+{
+    uint32_t chunk = r->len - r->pos;
+    int rc;
+
+    if (chunk > len) {
+        chunk = len;
+    }
+
+    rc = boot_decomp_writer_write(w, &r->buf[r->pos], chunk);
+    r->pos += chunk;
+    len -= chunk;
+
+    if (rc != 0 || len == 0) {
+        return rc;
+    }
+
+    /* The rest does not go through the reader buffer. */
+    r->off += r->len;
+    if (len > r->end - r->off) {
+        return -1;
+    }
+
+    rc = boot_decomp_writer_copy(w, r->fap, r->off, len);
+    r->off += len;
+    r->pos = 0;
+    r->len = 0;
+
+    return rc;
+}
+
+/* Runs the patch, writing the patched image payload. */
+static int
+boot_delta_patch(struct boot_delta *d, struct boot_decomp_writer *w,
+                 const struct image_header *hdr, uint32_t img_size)
+{
+    struct boot_delta_reader r = {
+        .fap = d->fap_sec,
+        .off = hdr->ih_hdr_size,
+        .end = hdr->ih_hdr_size + hdr->ih_img_size,
+    };
+    uint32_t done;
+    uint32_t out;
+    uint32_t len;
+    uint8_t cmd;
+    int rc;
+
+    d->base_pos = 0;
+
+    while (true) {
+        out = w->off + w->len;
+        done = out - hdr->ih_hdr_size;
+        if (done == img_size) {
+            break;
+        }
+
+        if (boot_delta_getc(&r, &cmd) != 0 || boot_delta_varint(&r, &len) != 0) {
+            return -1;
+        }
+
+        if (cmd == BOOT_DELTA_SEEK) {
+            /* Zigzag encoded signed offset. */
+            if (len & 1) {
+                len = (len >> 1) + 1;
+                if (len > d->base_pos) {
+                    return -1;
+                }
+                d->base_pos -= len;
+            } else {
+                len >>= 1;
+                if (len > d->base_size - d->base_pos) {
+                    return -1;
+                }
+                d->base_pos += len;
+            }
+            continue;
+        }
+
+        if (len > img_size - done) {
+            return -1;
+        }
+
+        if (cmd == BOOT_DELTA_LITERAL) {
+            rc = boot_delta_literal(&r, w, len);
+        } else if (cmd == BOOT_DELTA_COPY) {
+            /* The base must not be read from where output already went. */
+            if (len > d->base_size - d->base_pos || d->base_pos + d->shift < out) {
+                return -1;
+            }
+            rc = boot_decomp_writer_copy(w, d->fap_pri, d->base_pos + d->shift, len);
+            d->base_pos += len;
+        } else {
+            return -1;
+        }
+
+        if (rc != 0) {
+            return rc;
+        }
+    }
+
+    /* The whole patch must have been used. */
+    if (r.pos != r.len || r.off + r.len != r.end) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Checks that the primary slot holds the image the patch applies to. */
+static fih_ret
+boot_delta_check_base(struct boot_delta *d, const uint8_t *base_hash)
+{
+    struct boot_loader_state *state = d->state;
+    uint8_t hash[IMAGE_HASH_SIZE];
+    FIH_DECLARE(fih_rc, FIH_FAILURE);
+
+    FIH_CALL(bootutil_img_validate, fih_rc, state, boot_img_hdr(state, BOOT_SLOT_PRIMARY),
+             d->fap_pri, boot_decomp_writer.buf, sizeof(boot_decomp_writer.buf), NULL, 0,
+             hash);
+    if (FIH_NOT_EQ(fih_rc, FIH_SUCCESS)) {
+        FIH_RET(FIH_FAILURE);
+    }
+
+    FIH_CALL(boot_fih_memequal, fih_rc, hash, base_hash, IMAGE_HASH_SIZE);
+    FIH_RET(fih_rc);
+}
+
+int
+boot_delta_check_image(struct boot_loader_state *state, int slot)
+{
+    struct image_header *hdr = boot_img_hdr(state, slot);
+    struct boot_delta *d = &boot_delta;
+    struct boot_decomp_layout layout;
+    uint8_t base_hash[IMAGE_HASH_SIZE];
+    FIH_DECLARE(fih_rc, FIH_FAILURE);
+    bool started;
+    int rc;
+
+    boot_delta_base_checked[BOOT_CURR_IMG(state)] = false;
+
+    if (IS_COMPRESSED(hdr) || IS_ENCRYPTED(hdr)) {
+        BOOT_LOG_ERR("Image %d: delta images cannot be compressed or encrypted",
+                     BOOT_CURR_IMG(state));
+        return BOOT_EBADIMAGE;
+    }
+
+    if (hdr->ih_hdr_size < sizeof(struct image_header)) {
+        return BOOT_EBADIMAGE;
+    }
+
+    if (boot_decomp_read_layout(hdr, BOOT_IMG_AREA(state, slot), &layout) != 0 ||
+        layout.delta_len == 0) {
+        BOOT_LOG_ERR("Image %d: invalid delta TLVs", BOOT_CURR_IMG(state));
+        return BOOT_EBADIMAGE;
+    }
+
+    if (boot_delta_init(d, state, slot, &layout, base_hash) != 0) {
+        BOOT_LOG_ERR("Image %d: delta image does not fit the slots", BOOT_CURR_IMG(state));
+        return BOOT_EBADIMAGE;
+    }
+
+    /* Once patching started, the base image is gone. */
+    rc = boot_delta_started(d, &started);
+    if (rc != 0) {
+        return rc;
+    }
+
+    if (!started) {
+        FIH_CALL(boot_delta_check_base, fih_rc, d, base_hash);
+        if (FIH_NOT_EQ(fih_rc, FIH_SUCCESS)) {
+            BOOT_LOG_ERR("Image %d: the primary slot does not hold the delta base image",
+                         BOOT_CURR_IMG(state));
+            return BOOT_EBADIMAGE;
+        }
+
+        boot_delta_base_checked[BOOT_CURR_IMG(state)] = slot == BOOT_SLOT_SECONDARY;
+    }
+
+    return 0;
+}
+
+
+int
+boot_delta_image(struct boot_loader_state *state,
+                 const struct flash_area *fap_src,
+                 const struct flash_area *fap_dst)
+{
+    struct boot_decomp_writer *w = &boot_decomp_writer;
+    struct boot_delta *d = &boot_delta;
+    struct image_header *hdr = boot_img_hdr(state, BOOT_SLOT_SECONDARY);
+    struct image_header out_hdr;
+    struct boot_decomp_layout layout;
+    uint8_t base_hash[IMAGE_HASH_SIZE];
+    uint8_t hash[IMAGE_HASH_SIZE];
+    FIH_DECLARE(fih_rc, FIH_FAILURE);
+    uint32_t sector;
+    bool base_checked;
+    bool started;
+    bool set;
+    int rc;
+
+    (void)fap_src;
+    (void)fap_dst;
+
+    base_checked = boot_delta_base_checked[BOOT_CURR_IMG(state)];
+    boot_delta_base_checked[BOOT_CURR_IMG(state)] = false;
+
+    if (boot_decomp_read_layout(hdr, BOOT_IMG_AREA(state, BOOT_SLOT_SECONDARY),
+                                &layout) != 0 ||
+        boot_delta_init(d, state, BOOT_SLOT_SECONDARY, &layout, base_hash) != 0) {
+        return BOOT_EBADIMAGE;
+    }
+
+    /* Find out how far an interrupted patch went. */
+    rc = boot_delta_started(d, &started);
+    if (rc != 0) {
+        return rc;
+    }
+
+    /* The base was normally checked when the delta image was validated. */
+    if (!started && !base_checked) {
+        FIH_CALL(boot_delta_check_base, fih_rc, d, base_hash);
+        if (FIH_NOT_EQ(fih_rc, FIH_SUCCESS)) {
+            BOOT_LOG_ERR("Image %d: the primary slot does not hold the delta base image",
+                         BOOT_CURR_IMG(state));
+            return BOOT_EBADIMAGE;
+        }
+    }
+
+    BOOT_LOG_INF("Image %d patching the primary slot: 0x%x bytes",
+                 BOOT_CURR_IMG(state), (unsigned)d->total);
+
+    if (d->shift > 0) {
+        rc = boot_delta_move_base(d);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+
+    for (sector = 0; sector * d->sector_sz < d->total; sector++) {
+        rc = boot_delta_read_flag(d, sector, BOOT_DELTA_DONE, &set);
+        if (rc != 0) {
+            return rc;
+        }
+        if (!set) {
+            break;
+        }
+    }
+
+    if (sector * d->sector_sz < d->total) {
+        rc = boot_delta_read_flag(d, sector, BOOT_DELTA_STAGED, &set);
+        if (rc == 0 && set) {
+            rc = boot_delta_commit(d, sector);
+            sector++;
+        }
+        if (rc != 0) {
+            return rc;
+        }
+    }
+
+    d->resume_off = sector * d->sector_sz;
+    if (d->resume_off > 0) {
+        BOOT_LOG_INF("Image %d resuming patch at 0x%x", BOOT_CURR_IMG(state),
+                     (unsigned)d->resume_off);
+    }
+
+    if (d->resume_off < d->total) {
+        /* Data can only be hashed on the way if all of it is produced. */
+        boot_decomp_writer_init(w, fap_dst, d->resume_off == 0);
+        w->flush = boot_delta_flush;
+
+        rc = boot_decomp_write_header(w, hdr, fap_src, &layout);
+        if (rc == 0) {
+            rc = boot_delta_patch(d, w, hdr, layout.img_size);
+            if (rc != 0) {
+                BOOT_LOG_ERR("Image %d: invalid delta patch", BOOT_CURR_IMG(state));
+                rc = BOOT_EBADIMAGE;
+            }
+        }
+        if (rc == 0) {
+            rc = boot_decomp_write_tlvs(w, hdr, fap_src, &layout, hash);
+        }
+        if (rc == 0) {
+            rc = boot_decomp_writer_finish(w);
+        }
+        if (rc != 0) {
+            goto out;
+        }
+    }
+
+    if (d->resume_off > 0) {
+        /* Hash the patched image from flash instead. */
+        if (flash_area_read(fap_dst, 0, &out_hdr, sizeof(out_hdr)) != 0) {
+            rc = BOOT_EFLASH;
+            goto out;
+        }
+
+        FIH_CALL(bootutil_img_validate, fih_rc, state, &out_hdr, fap_dst, w->buf,
+                 sizeof(w->buf), NULL, 0, hash);
+        if (FIH_NOT_EQ(fih_rc, FIH_SUCCESS)) {
+            rc = BOOT_EBADIMAGE;
+            goto out;
+        }
+    }
+
+    FIH_CALL(bootutil_img_validate_decomp, fih_rc, state, hdr, fap_src, hash);
+    if (FIH_NOT_EQ(fih_rc, FIH_SUCCESS)) {
+        BOOT_LOG_ERR("Image %d patched image does not match its hash or signature",
+                     BOOT_CURR_IMG(state));
+        rc = BOOT_EBADIMAGE;
+        goto out;
+    }
+
+    /* Leftovers of the base image trailer must not be taken for a new one. */
+    sector = boot_delta_trailer_off(state, BOOT_SLOT_PRIMARY);
+    rc = boot_scramble_region(fap_dst, sector, flash_area_get_size(fap_dst) - sector, false);
+
+out:
+    boot_decomp_writer_drop(w);
+
+    return rc;
+}
+
+#endif /* MCUBOOT_DELTA_IMAGES */
@@ -53,6 +53,46 @@ BOOT_LOG_MODULE_DECLARE(mcuboot);
 /* Find functions are only needed when key is checked first */
 #if !defined(MCUBOOT_BUILTIN_KEY)
 #if !defined(MCUBOOT_HW_KEY)
+#if defined(MCUBOOT_KEY_HASH_TABLE)
+int bootutil_find_key(uint8_t *keyhash, uint8_t keyhash_len)
+{
+    bootutil_sha_context sha_ctx;
+    int i;
+    int found = -1;
+    const struct bootutil_key *key;
+    const uint8_t *digest;
+    uint8_t hash[IMAGE_HASH_SIZE];
+    FIH_DECLARE(fih_rc, FIH_FAILURE);
+
+    BOOT_LOG_DBG("bootutil_find_key");
+
+    if (keyhash_len > IMAGE_HASH_SIZE) {
+        return -1;
+    }
+
+    /* Every key is compared, so that the time taken does not depend on
+     * which one matches.
+     */
+    for (i = 0; i < bootutil_key_cnt; i++) {
+        key = &bootutil_keys[i];
+        if (key->hash != NULL && *key->hash_len == IMAGE_HASH_SIZE) {
+            digest = key->hash;
+        } else {
+            bootutil_sha_init(&sha_ctx);
+            bootutil_sha_update(&sha_ctx, key->key, *key->len);
+            bootutil_sha_finish(&sha_ctx, hash);
+            bootutil_sha_drop(&sha_ctx);
+            digest = hash;
+        }
+
+        FIH_CALL(boot_fih_memequal, fih_rc, digest, keyhash, keyhash_len);
+        if (FIH_EQ(fih_rc, FIH_SUCCESS) && found < 0) {
+            found = i;
+        }
+    }
+    return found;
+}
+#else /* MCUBOOT_KEY_HASH_TABLE */
 int bootutil_find_key(uint8_t *keyhash, uint8_t keyhash_len)
 {
     bootutil_sha_context sha_ctx;
@@ -78,6 +118,7 @@ int bootutil_find_key(uint8_t *keyhash, uint8_t keyhash_len)
     }
     return -1;
 }
+#endif /* MCUBOOT_KEY_HASH_TABLE */
 #else /* !MCUBOOT_HW_KEY */
 extern unsigned int pub_key_len;
 int bootutil_find_key(uint8_t image_index, uint8_t *key, uint16_t key_len)
@@ -28,6 +28,7 @@
 
 #include <stdint.h>
 #include <inttypes.h>
+#include <string.h>
 #include <flash_map_backend/flash_map_backend.h>
 
 #include "bootutil/crypto/sha.h"
@@ -38,7 +39,184 @@
 
 BOOT_LOG_MODULE_DECLARE(mcuboot);
 
+#if defined(MCUBOOT_SECTOR_HASHES) && \
+    (defined(MCUBOOT_SIGN_PURE) || defined(MCUBOOT_HASH_STORAGE_DIRECTLY) || \
+     defined(MCUBOOT_RAM_LOAD))
+#error "MCUBOOT_SECTOR_HASHES requires a hashed signature and images hashed from flash"
+#endif
+
 #ifndef MCUBOOT_SIGN_PURE
+#if !defined(MCUBOOT_HASH_STORAGE_DIRECTLY) && !defined(MCUBOOT_RAM_LOAD)
+/*
+ * Size of the next chunk to read and hash at offset `off`, bounded by the
+ * chunk size and, for encrypted images, by the start and end of the payload
+ * since only the payload gets decrypted.
+ */
+static uint32_t
+bootutil_img_hash_blk_sz(uint32_t off, uint32_t size, uint32_t chunk_sz,
+                         uint32_t hdr_size, uint32_t tlv_off)
+{
+    uint32_t blk_sz;
+
+    blk_sz = size - off;
+    if (blk_sz > chunk_sz) {
+        blk_sz = chunk_sz;
+    }
+#ifdef MCUBOOT_ENC_IMAGES
+    if ((off < hdr_size) && ((off + blk_sz) > hdr_size)) {
+        /* read only the header */
+        blk_sz = hdr_size - off;
+    }
+    if ((off < tlv_off) && ((off + blk_sz) > tlv_off)) {
+        /* read only up to the end of the image payload */
+        blk_sz = tlv_off - off;
+    }
+#else
+    (void)hdr_size;
+    (void)tlv_off;
+#endif
+
+    return blk_sz;
+}
+#endif /* !MCUBOOT_HASH_STORAGE_DIRECTLY && !MCUBOOT_RAM_LOAD */
+
+#ifdef MCUBOOT_SECTOR_HASHES
+
+/*
+ * Per-block hash table of an image (IMAGE_TLV_SECTOR_HASHES), checked while
+ * the image header and body are fed to it in order.
+ */
+struct bootutil_sector_hash {
+    const struct flash_area *fap;
+    uint32_t tbl_off;           /* Flash offset of the first hash */
+    uint32_t blk_sz;            /* Image bytes covered by each hash */
+    uint32_t img_sz;            /* Size of the image header and body */
+    uint32_t off;               /* Image offset fed so far */
+    bootutil_sha_context sha;
+};
+
+/*
+ * Locate the per-block hash table of an image.
+ * Return 0 if found, 1 if the image has none, negative on error.
+ */
+static int
+bootutil_sector_hash_init(struct bootutil_sector_hash *sh,
+                          struct boot_loader_state *state,
+                          struct image_header *hdr, const struct flash_area *fap)
+{
+    struct image_tlv_iter it;
+    uint32_t off;
+    uint32_t count;
+    uint16_t len;
+    int rc;
+
+#if defined(MCUBOOT_SWAP_USING_OFFSET)
+    it.start_off = boot_get_state_secondary_offset(state, fap);
+#else
+    (void)state;
+#endif
+
+    rc = bootutil_tlv_iter_begin(&it, hdr, fap, IMAGE_TLV_SECTOR_HASHES, true);
+    if (rc) {
+        return -1;
+    }
+
+    rc = bootutil_tlv_iter_next(&it, &off, &len, NULL);
+    if (rc != 0) {
+        return rc;
+    }
+
+    if (len < sizeof(sh->blk_sz) ||
+        flash_area_read(fap, off, &sh->blk_sz, sizeof(sh->blk_sz)) != 0 ||
+        sh->blk_sz == 0) {
+        return -1;
+    }
+
+    sh->img_sz = hdr->ih_hdr_size + hdr->ih_img_size;
+    count = (sh->img_sz + sh->blk_sz - 1) / sh->blk_sz;
+    if (count > (len - sizeof(sh->blk_sz)) / IMAGE_HASH_SIZE ||
+        len != sizeof(sh->blk_sz) + count * IMAGE_HASH_SIZE) {
+        BOOT_LOG_DBG("bootutil_sector_hash: bad table size %u", len);
+        return -1;
+    }
+
+    sh->fap = fap;
+    sh->tbl_off = off + sizeof(sh->blk_sz);
+    sh->off = 0;
+    bootutil_sha_init(&sh->sha);
+
+    return 0;
+}
+
+/*
+ * Compare the hash of the block just fed with entry `idx` of the table and
+ * start hashing the next block.
+ */
+static fih_ret
+bootutil_sector_hash_check(struct bootutil_sector_hash *sh, uint32_t idx)
+{
+    uint8_t digest[IMAGE_HASH_SIZE];
+    uint8_t expected[IMAGE_HASH_SIZE];
+    FIH_DECLARE(fih_rc, FIH_FAILURE);
+    int rc;
+
+    bootutil_sha_finish(&sh->sha, digest);
+    bootutil_sha_drop(&sh->sha);
+    bootutil_sha_init(&sh->sha);
+
+    rc = flash_area_read(sh->fap, sh->tbl_off + idx * IMAGE_HASH_SIZE, expected,
+                         IMAGE_HASH_SIZE);
+    if (rc == 0) {
+        FIH_CALL(boot_fih_memequal, fih_rc, digest, expected, IMAGE_HASH_SIZE);
+    }
+
+    FIH_RET(fih_rc);
+}
+
+/*
+ * Feed the next `len` bytes of the image header and body, checking every
+ * block completed on the way. Data past the image body is ignored.
+ */
+static fih_ret
+bootutil_sector_hash_update(struct bootutil_sector_hash *sh, const uint8_t *buf,
+                            uint32_t len)
+{
+    uint32_t blk_end;
+    uint32_t sz;
+    FIH_DECLARE(fih_rc, FIH_SUCCESS);
+
+    while (len > 0 && sh->off < sh->img_sz) {
+        blk_end = sh->off - (sh->off % sh->blk_sz);
+        if (sh->img_sz - blk_end > sh->blk_sz) {
+            blk_end += sh->blk_sz;
+        } else {
+            blk_end = sh->img_sz;
+        }
+
+        sz = blk_end - sh->off;
+        if (sz > len) {
+            sz = len;
+        }
+        bootutil_sha_update(&sh->sha, buf, sz);
+        sh->off += sz;
+        buf += sz;
+        len -= sz;
+
+        if (sh->off == blk_end) {
+            FIH_CALL(bootutil_sector_hash_check, fih_rc, sh, (blk_end - 1) / sh->blk_sz);
+            if (FIH_NOT_EQ(fih_rc, FIH_SUCCESS)) {
+                BOOT_LOG_DBG("bootutil_sector_hash: block %" PRIu32 " mismatch",
+                             (blk_end - 1) / sh->blk_sz);
+                break;
+            }
+        }
+    }
+
+    FIH_RET(fih_rc);
+}
+
+#endif /* MCUBOOT_SECTOR_HASHES */
+
 /*
  * Compute SHA hash over the image.
  * (SHA384 if ECDSA-P384 is being used,
@@ -60,6 +238,12 @@ bootutil_img_hash(struct boot_loader_state *state,
     int rc;
     uint32_t off;
     uint32_t blk_sz;
+    uint32_t next_sz;
+    uint32_t chunk_sz;
+    uint8_t *buf;
+#endif
+#if !defined(MCUBOOT_HASH_STORAGE_DIRECTLY) && defined(MCUBOOT_FLASH_ASYNC_READ)
+    uint8_t *next_buf;
 #endif
 #ifdef MCUBOOT_HASH_STORAGE_DIRECTLY
     uintptr_t base = 0;
@@ -71,6 +255,11 @@ bootutil_img_hash(struct boot_loader_state *state,
 #if defined(MCUBOOT_SWAP_USING_OFFSET)
     uint32_t sector_off = 0;
 #endif
+#ifdef MCUBOOT_SECTOR_HASHES
+    struct bootutil_sector_hash sh;
+    int sh_rc;
+    FIH_DECLARE(fih_rc, FIH_FAILURE);
+#endif
 
 #if (BOOT_IMAGE_NUMBER == 1) || !defined(MCUBOOT_ENC_IMAGES) || \
     defined(MCUBOOT_RAM_LOAD)
@@ -80,11 +269,17 @@ bootutil_img_hash(struct boot_loader_state *state,
     (void)tlv_off;
 #ifdef MCUBOOT_RAM_LOAD
     (void)blk_sz;
+    (void)next_sz;
+    (void)chunk_sz;
+    (void)buf;
     (void)off;
     (void)rc;
     (void)fap;
     (void)tmp_buf;
     (void)tmp_buf_sz;
+#ifdef MCUBOOT_FLASH_ASYNC_READ
+    (void)next_buf;
+#endif
 #endif
 #endif
     BOOT_LOG_DBG("bootutil_img_hash");
@@ -143,31 +338,68 @@ bootutil_img_hash(struct boot_loader_state *state,
                         (void*)(IMAGE_RAM_BASE + hdr->ih_load_addr),
                         size);
 #else
-    for (off = 0; off < size; off += blk_sz) {
-        blk_sz = size - off;
-        if (blk_sz > tmp_buf_sz) {
-            blk_sz = tmp_buf_sz;
-        }
-#ifdef MCUBOOT_ENC_IMAGES
-        /* The only data that is encrypted in an image is the payload;
-         * both header and TLVs (when protected) are not.
-         */
-        if ((off < hdr_size) && ((off + blk_sz) > hdr_size)) {
-            /* read only the header */
-            blk_sz = hdr_size - off;
+#ifdef MCUBOOT_SECTOR_HASHES
+    /* The per-block hashes are not trusted until the image signature is
+     * verified, but a block that does not match means the image can not
+     * validate either, which is found without hashing the rest of it.
+     */
+    sh_rc = bootutil_sector_hash_init(&sh, state, hdr, fap);
+    if (sh_rc < 0) {
+        bootutil_sha_drop(&sha_ctx);
+        return sh_rc;
+    }
+#endif
+
+    buf = tmp_buf;
+#ifdef MCUBOOT_FLASH_ASYNC_READ
+    /* Each half of the buffer holds one chunk: the next chunk is read into
+     * one half while the other one is being decrypted and hashed.
+     */
+    chunk_sz = tmp_buf_sz / 2;
+    next_buf = tmp_buf + chunk_sz;
+#else
+    chunk_sz = tmp_buf_sz;
+#endif
+
+    blk_sz = bootutil_img_hash_blk_sz(0, size, chunk_sz, hdr_size, tlv_off);
+#ifdef MCUBOOT_FLASH_ASYNC_READ
+#if defined(MCUBOOT_SWAP_USING_OFFSET)
+    rc = flash_area_read_async(fap, sector_off, buf, blk_sz);
+#else
+    rc = flash_area_read_async(fap, 0, buf, blk_sz);
+#endif
+#endif
+
+    for (off = 0; off < size; off += blk_sz, blk_sz = next_sz) {
+        next_sz = 0;
+        if (off + blk_sz < size) {
+            next_sz = bootutil_img_hash_blk_sz(off + blk_sz, size, chunk_sz,
+                                               hdr_size, tlv_off);
         }
-        if ((off < tlv_off) && ((off + blk_sz) > tlv_off)) {
-            /* read only up to the end of the image payload */
-            blk_sz = tlv_off - off;
+#ifdef MCUBOOT_FLASH_ASYNC_READ
+        if (rc == 0) {
+            rc = flash_area_read_wait(fap);
         }
-#endif
+        if (rc == 0 && next_sz > 0) {
 #if defined(MCUBOOT_SWAP_USING_OFFSET)
-        rc = flash_area_read(fap, off + sector_off, tmp_buf, blk_sz);
+            rc = flash_area_read_async(fap, off + blk_sz + sector_off, next_buf,
+                                       next_sz);
+#else
+            rc = flash_area_read_async(fap, off + blk_sz, next_buf, next_sz);
+#endif
+        }
+#elif defined(MCUBOOT_SWAP_USING_OFFSET)
+        rc = flash_area_read(fap, off + sector_off, buf, blk_sz);
 #else
-        rc = flash_area_read(fap, off, tmp_buf, blk_sz);
+        rc = flash_area_read(fap, off, buf, blk_sz);
 #endif
         if (rc) {
             bootutil_sha_drop(&sha_ctx);
+#ifdef MCUBOOT_SECTOR_HASHES
+            if (sh_rc == 0) {
+                bootutil_sha_drop(&sh.sha);
+            }
+#endif
             BOOT_LOG_DBG("bootutil_img_validate Error %d reading data chunk "
                          "%p %" PRIu32 " %" PRIu32,
                          rc, fap, off, blk_sz);
@@ -182,12 +414,36 @@ bootutil_img_hash(struct boot_loader_state *state,
             if (off >= hdr_size && off < tlv_off) {
                 blk_off = (off - hdr_size) & 0xf;
                 boot_enc_decrypt(BOOT_CURR_ENC_SLOT(state, slot), off - hdr_size,
-                                 blk_sz, blk_off, tmp_buf);
+                                 blk_sz, blk_off, buf);
             }
         }
 #endif
-        bootutil_sha_update(&sha_ctx, tmp_buf, blk_sz);
+        bootutil_sha_update(&sha_ctx, buf, blk_sz);
+#ifdef MCUBOOT_SECTOR_HASHES
+        if (sh_rc == 0) {
+            FIH_CALL(bootutil_sector_hash_update, fih_rc, &sh, buf, blk_sz);
+            if (FIH_NOT_EQ(fih_rc, FIH_SUCCESS)) {
+#ifdef MCUBOOT_FLASH_ASYNC_READ
+                if (next_sz > 0) {
+                    (void)flash_area_read_wait(fap);
+                }
+#endif
+                bootutil_sha_drop(&sh.sha);
+                bootutil_sha_drop(&sha_ctx);
+                return -1;
+            }
+        }
+#endif
+#ifdef MCUBOOT_FLASH_ASYNC_READ
+        next_buf = buf;
+        buf = tmp_buf + ((buf == tmp_buf) ? chunk_sz : 0);
+#endif
+    }
+#ifdef MCUBOOT_SECTOR_HASHES
+    if (sh_rc == 0) {
+        bootutil_sha_drop(&sh.sha);
     }
+#endif
 #endif /* MCUBOOT_RAM_LOAD */
 #endif /* MCUBOOT_HASH_STORAGE_DIRECTLY */
     bootutil_sha_finish(&sha_ctx, hash_result);
@@ -73,7 +73,7 @@ bootutil_get_img_security_cnt(struct boot_loader_state *state, int slot,
     it.start_off = boot_get_state_secondary_offset(state, fap);
 #endif
 
-    rc = bootutil_tlv_iter_begin(&it, boot_img_hdr(state, slot), fap, IMAGE_TLV_SEC_CNT, true);
+    rc = boot_tlv_iter_begin(state, &it, boot_img_hdr(state, slot), fap, IMAGE_TLV_SEC_CNT, true);
     if (rc) {
         return rc;
     }
@@ -32,6 +32,8 @@
  * running.
  */
 
+#include <string.h>
+
 #include "bootutil_loader.h"
 #include "bootutil/boot_record.h"
 #include "bootutil/boot_hooks.h"
@@ -41,6 +43,13 @@
 #ifdef MCUBOOT_HW_ROLLBACK_PROT
 #include "bootutil/security_cnt.h"
 #endif
+#ifdef MCUBOOT_DECOMPRESS_IMAGES
+#include "bootutil_decompress.h"
+#endif
+#ifdef MCUBOOT_VALIDATION_CACHE
+#include "bootutil/crypto/sha.h"
+#include "bootutil/validation_cache.h"
+#endif
 #if defined(MCUBOOT_SWAP_USING_MOVE) || defined(MCUBOOT_SWAP_USING_OFFSET) || \
     defined(MCUBOOT_SWAP_USING_SCRATCH)
 #include "swap_priv.h"
@@ -111,6 +120,12 @@ boot_check_header_valid(struct boot_loader_state *state, int slot)
     }
 #endif
 
+#if !defined(MCUBOOT_DELTA_IMAGES)
+    if (IS_DELTA(hdr)) {
+        return false;
+    }
+#endif
+
 #if !defined(MCUBOOT_DECOMPRESS_IMAGES)
     if (IS_COMPRESSED(hdr)) {
         return false;
@@ -133,6 +148,7 @@ boot_read_image_headers(struct boot_loader_state *state, bool require_all, struc
     int i;
 
     for (i = 0; i < BOOT_NUM_SLOTS; i++) {
+        BOOT_TLV_DIR_INVALIDATE(state, i);
         rc = BOOT_HOOK_CALL(boot_read_image_header_hook, BOOT_HOOK_REGULAR,
                             BOOT_CURR_IMG(state), i, boot_img_hdr(state, i));
         if (rc == BOOT_HOOK_REGULAR)
@@ -157,10 +173,82 @@ boot_read_image_headers(struct boot_loader_state *state, bool require_all, struc
     return 0;
 }
 
+#ifdef MCUBOOT_HASH_IMAGE_COPY
+#if defined(MCUBOOT_SIGN_PURE) || \
+    (!defined(MCUBOOT_OVERWRITE_ONLY) && !defined(MCUBOOT_BOOTSTRAP) && \
+     !defined(MCUBOOT_SWAP_USING_MOVE) && !defined(MCUBOOT_SWAP_USING_OFFSET))
+#error "MCUBOOT_HASH_IMAGE_COPY requires a hashed signature and overwrite-only, bootstrap, swap-move or swap-offset upgrades"
+#endif
+#endif
+
+#ifdef MCUBOOT_VALIDATION_CACHE
+#if defined(MCUBOOT_SIGN_PURE) || defined(MCUBOOT_RAM_LOAD) || defined(MCUBOOT_DIRECT_XIP)
+#error "MCUBOOT_VALIDATION_CACHE requires a hashed signature and an upgrade mode with a primary slot"
+#endif
+
+/*
+ * Checks the image in the primary slot against its validation record: the
+ * header and write generation must be those recorded and the recorded hash
+ * must pass all the checks bootutil_img_validate() does on a computed one.
+ */
+static fih_ret
+boot_validation_cache_check(struct boot_loader_state *state, int slot)
+{
+    TARGET_STATIC struct boot_validation_record rec;
+    struct image_header *hdr = boot_img_hdr(state, slot);
+    uint32_t generation;
+    FIH_DECLARE(fih_rc, FIH_FAILURE);
+
+    if (boot_validation_record_read(BOOT_CURR_IMG(state), &rec) != 0 ||
+        rec.magic != BOOT_VALIDATION_RECORD_MAGIC) {
+        FIH_RET(fih_rc);
+    }
+
+    if (boot_validation_generation_get(BOOT_CURR_IMG(state), &generation) != 0 ||
+        rec.generation != generation ||
+        memcmp(&rec.hdr, hdr, sizeof(rec.hdr)) != 0) {
+        BOOT_LOG_DBG("boot_validation_cache_check: stale record");
+        FIH_RET(fih_rc);
+    }
+
+    FIH_CALL(bootutil_img_validate_digest, fih_rc, state, hdr,
+             BOOT_IMG_AREA(state, slot), rec.hash);
+
+    FIH_RET(fih_rc);
+}
+
+/*
+ * Records the hash of the image in the primary slot once it has been fully
+ * validated. Failing to do so only means the next boot validates it in full.
+ * Nothing is recorded on a boot that swapped or copied the image, so that an
+ * upgrade still ends with the trailer flags; the next boot records it.
+ */
+static void
+boot_validation_cache_store(struct boot_loader_state *state, int slot,
+                            const uint8_t *hash)
+{
+    if (BOOT_SWAP_TYPE(state) != BOOT_SWAP_TYPE_NONE) {
+        return;
+    }
+
+    if (boot_validation_cache_record(BOOT_CURR_IMG(state), boot_img_hdr(state, slot),
+                                     hash) != 0) {
+        BOOT_LOG_WRN("Image %d: failed to store validation record",
+                     BOOT_CURR_IMG(state));
+    }
+}
+#endif /* MCUBOOT_VALIDATION_CACHE */
+
 fih_ret
 boot_check_image(struct boot_loader_state *state, struct boot_status *bs, int slot)
 {
     TARGET_STATIC uint8_t tmpbuf[BOOT_TMPBUF_SZ];
+#ifdef MCUBOOT_VALIDATION_CACHE
+    uint8_t hash[IMAGE_HASH_SIZE];
+    uint8_t *out_hash = (slot == BOOT_SLOT_PRIMARY) ? hash : NULL;
+#else
+    uint8_t *out_hash = NULL;
+#endif
     int rc;
     FIH_DECLARE(fih_rc, FIH_FAILURE);
     const struct flash_area *fap = NULL;
@@ -190,8 +278,50 @@ boot_check_image(struct boot_loader_state *state, struct boot_status *bs, int sl
     }
 #endif
 
-    FIH_CALL(bootutil_img_validate, fih_rc, state, hdr, fap, tmpbuf, BOOT_TMPBUF_SZ,
-             NULL, 0, NULL);
+#ifdef MCUBOOT_VALIDATION_CACHE
+    if (slot == BOOT_SLOT_PRIMARY) {
+        FIH_CALL(boot_validation_cache_check, fih_rc, state, slot);
+        if (FIH_EQ(fih_rc, FIH_SUCCESS)) {
+            BOOT_LOG_DBG("Image %d: primary slot validated from its record",
+                         BOOT_CURR_IMG(state));
+            FIH_RET(fih_rc);
+        }
+    }
+#endif
+
+#ifdef MCUBOOT_HASH_IMAGE_COPY
+    if (slot == BOOT_SLOT_PRIMARY && state->copy_hash[BOOT_CURR_IMG(state)].valid) {
+        /* The image was hashed while being copied in, only its TLVs need to
+         * be read back.
+         */
+        FIH_CALL(bootutil_img_validate_digest, fih_rc, state, hdr, fap,
+                 state->copy_hash[BOOT_CURR_IMG(state)].hash);
+        if (out_hash != NULL && FIH_EQ(fih_rc, FIH_SUCCESS)) {
+            memcpy(out_hash, state->copy_hash[BOOT_CURR_IMG(state)].hash, IMAGE_HASH_SIZE);
+        }
+    } else
+#endif
+    {
+        FIH_CALL(bootutil_img_validate, fih_rc, state, hdr, fap, tmpbuf, BOOT_TMPBUF_SZ,
+                 NULL, 0, out_hash);
+    }
+
+#ifdef MCUBOOT_VALIDATION_CACHE
+    if (out_hash != NULL && FIH_EQ(fih_rc, FIH_SUCCESS)) {
+        boot_validation_cache_store(state, slot, out_hash);
+    }
+#endif
+
+#ifdef MCUBOOT_DECOMPRESS_IMAGES
+    /* Reject a compressed image that could not be installed up front, before
+     * anything in the primary slot gets erased.
+     */
+    if (FIH_EQ(fih_rc, FIH_SUCCESS) && MUST_DECOMPRESS(fap, BOOT_CURR_IMG(state), hdr)) {
+        if (boot_decompress_check_image(state, slot) != 0) {
+            FIH_SET(fih_rc, FIH_FAILURE);
+        }
+    }
+#endif
 
     FIH_RET(fih_rc);
 }
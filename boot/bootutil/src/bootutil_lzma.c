@@ -0,0 +1,787 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Streaming decoder for the raw LZMA2 streams produced by imgtool, with
+ * optional ARM-Thumb BCJ post-filter. The range decoder and LZMA model follow
+ * the public domain reference decoder (LzmaSpec) and the LZMA2 chunk framing
+ * and BCJ filter follow xz. All state is statically allocated: the sliding
+ * dictionary takes MCUBOOT_DECOMPRESS_DICT_SIZE bytes and the probability
+ * model about 28 KiB.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "mcuboot_config/mcuboot_config.h"
+#include "bootutil_lzma.h"
+
+#ifdef MCUBOOT_DECOMPRESS_IMAGES
+
+#if MCUBOOT_DECOMPRESS_DICT_SIZE < 4096
+#error "MCUBOOT_DECOMPRESS_DICT_SIZE must be at least 4096 bytes"
+#endif
+
+#define LZMA_IN_BUF_SZ          256
+#define LZMA_OUT_BUF_SZ         256
+
+#define LZMA_PROB_BITS          11
+#define LZMA_PROB_INIT          (1 << (LZMA_PROB_BITS - 1))
+#define LZMA_MOVE_BITS          5
+#define LZMA_TOP_VALUE          (1UL << 24)
+#define LZMA_RC_INIT_BYTES      5
+
+#define LZMA_STATES             12
+#define LZMA_LIT_STATES         7
+#define LZMA_POS_BITS_MAX       4
+#define LZMA_POS_STATES_MAX     (1 << LZMA_POS_BITS_MAX)
+
+#define LZMA_LEN_LOW_BITS       3
+#define LZMA_LEN_MID_BITS       3
+#define LZMA_LEN_HIGH_BITS      8
+#define LZMA_LEN_LOW_SYMBOLS    (1 << LZMA_LEN_LOW_BITS)
+#define LZMA_LEN_MID_SYMBOLS    (1 << LZMA_LEN_MID_BITS)
+
+#define LZMA_DIST_STATES        4
+#define LZMA_DIST_SLOT_BITS     6
+#define LZMA_DIST_MODEL_START   4
+#define LZMA_DIST_MODEL_END     14
+#define LZMA_FULL_DISTANCES     (1 << (LZMA_DIST_MODEL_END >> 1))
+#define LZMA_ALIGN_BITS         4
+
+#define LZMA_LITERAL_CODER_SIZE 0x300
+#define LZMA_PROPS_MAX          ((4 * 5 + 4) * 9 + 8)
+
+/* LZMA2 properties header: largest dictionary size code (4 GiB - 1). */
+#define LZMA2_DICT_CODE_MAX     40
+
+typedef uint16_t lzma_prob;
+
+struct lzma_len_dec {
+    lzma_prob choice;
+    lzma_prob choice2;
+    lzma_prob low[LZMA_POS_STATES_MAX][LZMA_LEN_LOW_SYMBOLS];
+    lzma_prob mid[LZMA_POS_STATES_MAX][LZMA_LEN_MID_SYMBOLS];
+    lzma_prob high[1 << LZMA_LEN_HIGH_BITS];
+};
+
+/* Every member is a probability so the model can be reset as one array. */
+struct lzma_probs {
+    lzma_prob is_match[LZMA_STATES][LZMA_POS_STATES_MAX];
+    lzma_prob is_rep[LZMA_STATES];
+    lzma_prob is_rep0[LZMA_STATES];
+    lzma_prob is_rep1[LZMA_STATES];
+    lzma_prob is_rep2[LZMA_STATES];
+    lzma_prob is_rep0_long[LZMA_STATES][LZMA_POS_STATES_MAX];
+    lzma_prob dist_slot[LZMA_DIST_STATES][1 << LZMA_DIST_SLOT_BITS];
+    lzma_prob dist_special[1 + LZMA_FULL_DISTANCES - LZMA_DIST_MODEL_END];
+    lzma_prob dist_align[1 << LZMA_ALIGN_BITS];
+    struct lzma_len_dec match_len;
+    struct lzma_len_dec rep_len;
+    lzma_prob literal[LZMA_LITERAL_CODER_SIZE << BOOTUTIL_LZMA_LCLP_MAX];
+};
+
+struct lzma_dec {
+    const struct bootutil_lzma_io *io;
+    int err;
+
+    /* Input buffering. */
+    uint32_t in_pos;
+    uint32_t in_len;
+    uint32_t in_total;
+
+    /* Range decoder. */
+    uint32_t range;
+    uint32_t code;
+
+    /* Sliding dictionary. */
+    uint32_t dict_pos;
+    uint32_t dict_full;
+    uint32_t dict_flushed;
+    uint32_t pos;
+    uint32_t decoded;
+
+    /* LZMA state. */
+    uint32_t reps[4];
+    uint32_t state;
+    uint32_t lc;
+    uint32_t lp_mask;
+    uint32_t pb_mask;
+
+    /* Output stage. */
+    bool arm_thumb;
+    uint32_t out_len;
+    uint32_t out_total;
+    uint32_t bcj_len;
+
+    struct lzma_probs probs;
+    uint8_t in_buf[LZMA_IN_BUF_SZ];
+    uint8_t bcj_buf[LZMA_OUT_BUF_SZ];
+};
+
+static struct lzma_dec lzma_dec;
+static uint8_t lzma_dict[MCUBOOT_DECOMPRESS_DICT_SIZE];
+
+static uint32_t
+lzma2_dict_size(uint8_t code)
+{
+    if (code == LZMA2_DICT_CODE_MAX) {
+        return UINT32_MAX;
+    }
+
+    return (2UL | (code & 1)) << (code / 2 + 11);
+}
+
+int
+bootutil_lzma2_check_header(const uint8_t hdr[BOOTUTIL_LZMA2_HDR_SZ],
+                            uint32_t out_len)
+{
+    uint32_t window;
+
+    if (hdr[0] > LZMA2_DICT_CODE_MAX || hdr[1] > LZMA_PROPS_MAX) {
+        return BOOTUTIL_LZMA_EFORMAT;
+    }
+
+    /* The dictionary never needs to be larger than the output itself. */
+    window = lzma2_dict_size(hdr[0]);
+    if (window > out_len) {
+        window = out_len;
+    }
+
+    if (window > MCUBOOT_DECOMPRESS_DICT_SIZE) {
+        return BOOTUTIL_LZMA_EUNSUPP;
+    }
+
+    return BOOTUTIL_LZMA_OK;
+}
+
+/*
+ * Output stage.
+ */
+
+/*
+ * Reverts the ARM-Thumb BCJ filter on buf, whose first byte is at offset
+ * pos of the output. Returns how many bytes were processed; the remaining
+ * (at most 3) bytes may be the start of a BL instruction and must be kept
+ * until more data is available.
+ */
+static uint32_t
+lzma_bcj_armthumb(uint8_t *buf, uint32_t len, uint32_t pos)
+{
+    uint32_t i;
+    uint32_t src;
+    uint32_t dest;
+
+    for (i = 0; i + 4 <= len; i += 2) {
+        if ((buf[i + 1] & 0xF8) == 0xF0 && (buf[i + 3] & 0xF8) == 0xF8) {
+            src = (((uint32_t)buf[i + 1] & 7) << 19) |
+                  ((uint32_t)buf[i + 0] << 11) |
+                  (((uint32_t)buf[i + 3] & 7) << 8) |
+                  (uint32_t)buf[i + 2];
+            src <<= 1;
+            dest = (src - (pos + i + 4)) >> 1;
+
+            buf[i + 1] = (uint8_t)(0xF0 | ((dest >> 19) & 0x7));
+            buf[i + 0] = (uint8_t)(dest >> 11);
+            buf[i + 3] = (uint8_t)(0xF8 | ((dest >> 8) & 0x7));
+            buf[i + 2] = (uint8_t)dest;
+            i += 2;
+        }
+    }
+
+    return i;
+}
+
+static void
+lzma_emit(struct lzma_dec *dec, const uint8_t *buf, uint32_t len)
+{
+    if (dec->err == BOOTUTIL_LZMA_OK && len > 0 &&
+        dec->io->write(dec->io->out_ctx, buf, len) != 0) {
+        dec->err = BOOTUTIL_LZMA_EIO;
+    }
+}
+
+/* Runs the BCJ filter over the staging buffer and emits what is final. */
+static void
+lzma_bcj_flush(struct lzma_dec *dec, bool last)
+{
+    uint32_t done;
+
+    done = lzma_bcj_armthumb(dec->bcj_buf, dec->bcj_len,
+                             dec->out_total - dec->bcj_len);
+    if (last) {
+        done = dec->bcj_len;
+    }
+
+    lzma_emit(dec, dec->bcj_buf, done);
+    memmove(dec->bcj_buf, &dec->bcj_buf[done], dec->bcj_len - done);
+    dec->bcj_len -= done;
+}
+
+static void
+lzma_output(struct lzma_dec *dec, const uint8_t *buf, uint32_t len)
+{
+    uint32_t chunk;
+
+    if (!dec->arm_thumb) {
+        dec->out_total += len;
+        lzma_emit(dec, buf, len);
+        return;
+    }
+
+    while (len > 0) {
+        chunk = LZMA_OUT_BUF_SZ - dec->bcj_len;
+        if (chunk > len) {
+            chunk = len;
+        }
+
+        memcpy(&dec->bcj_buf[dec->bcj_len], buf, chunk);
+        dec->bcj_len += chunk;
+        dec->out_total += chunk;
+        buf += chunk;
+        len -= chunk;
+
+        if (dec->bcj_len == LZMA_OUT_BUF_SZ) {
+            lzma_bcj_flush(dec, false);
+        }
+    }
+}
+
+/*
+ * Dictionary.
+ */
+
+static void
+lzma_dict_flush(struct lzma_dec *dec)
+{
+    lzma_output(dec, &lzma_dict[dec->dict_flushed],
+                dec->dict_pos - dec->dict_flushed);
+    dec->dict_flushed = dec->dict_pos;
+}
+
+static void
+lzma_dict_reset(struct lzma_dec *dec)
+{
+    lzma_dict_flush(dec);
+    dec->dict_pos = 0;
+    dec->dict_full = 0;
+    dec->dict_flushed = 0;
+    dec->pos = 0;
+}
+
+static inline void
+lzma_dict_put(struct lzma_dec *dec, uint8_t b)
+{
+    lzma_dict[dec->dict_pos++] = b;
+    if (dec->dict_full < MCUBOOT_DECOMPRESS_DICT_SIZE) {
+        dec->dict_full++;
+    }
+    dec->pos++;
+    dec->decoded++;
+
+    if (dec->dict_pos == MCUBOOT_DECOMPRESS_DICT_SIZE) {
+        lzma_dict_flush(dec);
+        dec->dict_pos = 0;
+        dec->dict_flushed = 0;
+    }
+}
+
+/* Returns the byte dist + 1 positions back; dist must be below dict_full. */
+static inline uint8_t
+lzma_dict_get(const struct lzma_dec *dec, uint32_t dist)
+{
+    uint32_t off;
+
+    if (dec->dict_pos > dist) {
+        off = dec->dict_pos - dist - 1;
+    } else {
+        off = dec->dict_pos + MCUBOOT_DECOMPRESS_DICT_SIZE - dist - 1;
+    }
+
+    return lzma_dict[off];
+}
+
+/*
+ * Input and range decoder.
+ */
+
+static uint8_t
+lzma_read_byte(struct lzma_dec *dec)
+{
+    int rc;
+
+    if (dec->in_pos == dec->in_len) {
+        rc = (dec->err == BOOTUTIL_LZMA_OK) ?
+             dec->io->read(dec->io->in_ctx, dec->in_buf, LZMA_IN_BUF_SZ) : 0;
+        if (rc <= 0) {
+            if (dec->err == BOOTUTIL_LZMA_OK) {
+                dec->err = (rc < 0) ? BOOTUTIL_LZMA_EIO : BOOTUTIL_LZMA_EFORMAT;
+            }
+            return 0;
+        }
+        dec->in_pos = 0;
+        dec->in_len = (uint32_t)rc;
+    }
+
+    dec->in_total++;
+    return dec->in_buf[dec->in_pos++];
+}
+
+static void
+lzma_rc_init(struct lzma_dec *dec)
+{
+    int i;
+
+    dec->range = UINT32_MAX;
+    dec->code = 0;
+
+    if (lzma_read_byte(dec) != 0) {
+        dec->err = BOOTUTIL_LZMA_EFORMAT;
+    }
+
+    for (i = 1; i < LZMA_RC_INIT_BYTES; i++) {
+        dec->code = (dec->code << 8) | lzma_read_byte(dec);
+    }
+
+    if (dec->code == dec->range) {
+        dec->err = BOOTUTIL_LZMA_EFORMAT;
+    }
+}
+
+static inline void
+lzma_rc_normalize(struct lzma_dec *dec)
+{
+    if (dec->range < LZMA_TOP_VALUE) {
+        dec->range <<= 8;
+        dec->code = (dec->code << 8) | lzma_read_byte(dec);
+    }
+}
+
+static inline uint32_t
+lzma_rc_bit(struct lzma_dec *dec, lzma_prob *prob)
+{
+    uint32_t bound;
+    uint32_t bit;
+
+    bound = (dec->range >> LZMA_PROB_BITS) * *prob;
+    if (dec->code < bound) {
+        dec->range = bound;
+        *prob += ((1 << LZMA_PROB_BITS) - *prob) >> LZMA_MOVE_BITS;
+        bit = 0;
+    } else {
+        dec->range -= bound;
+        dec->code -= bound;
+        *prob -= *prob >> LZMA_MOVE_BITS;
+        bit = 1;
+    }
+
+    lzma_rc_normalize(dec);
+    return bit;
+}
+
+static uint32_t
+lzma_rc_bittree(struct lzma_dec *dec, lzma_prob *probs, uint32_t bits)
+{
+    uint32_t m = 1;
+    uint32_t i;
+
+    for (i = 0; i < bits; i++) {
+        m = (m << 1) | lzma_rc_bit(dec, &probs[m]);
+    }
+
+    return m - (1UL << bits);
+}
+
+static uint32_t
+lzma_rc_bittree_reverse(struct lzma_dec *dec, lzma_prob *probs, uint32_t bits)
+{
+    uint32_t m = 1;
+    uint32_t sym = 0;
+    uint32_t bit;
+    uint32_t i;
+
+    for (i = 0; i < bits; i++) {
+        bit = lzma_rc_bit(dec, &probs[m]);
+        m = (m << 1) | bit;
+        sym |= bit << i;
+    }
+
+    return sym;
+}
+
+static uint32_t
+lzma_rc_direct(struct lzma_dec *dec, uint32_t bits)
+{
+    uint32_t res = 0;
+    uint32_t mask;
+
+    while (bits-- > 0) {
+        dec->range >>= 1;
+        dec->code -= dec->range;
+        mask = 0U - (dec->code >> 31);
+        dec->code += dec->range & mask;
+        if (dec->code == dec->range) {
+            dec->err = BOOTUTIL_LZMA_EFORMAT;
+        }
+        lzma_rc_normalize(dec);
+        res = (res << 1) + (mask + 1);
+    }
+
+    return res;
+}
+
+/*
+ * LZMA decoder.
+ */
+
+static void
+lzma_reset_state(struct lzma_dec *dec)
+{
+    lzma_prob *probs = (lzma_prob *)&dec->probs;
+    size_t i;
+
+    for (i = 0; i < sizeof(dec->probs) / sizeof(lzma_prob); i++) {
+        probs[i] = LZMA_PROB_INIT;
+    }
+
+    dec->state = 0;
+    dec->reps[0] = 0;
+    dec->reps[1] = 0;
+    dec->reps[2] = 0;
+    dec->reps[3] = 0;
+}
+
+static int
+lzma_set_props(struct lzma_dec *dec, uint8_t props)
+{
+    uint32_t lc;
+    uint32_t lp;
+    uint32_t pb;
+
+    if (props > LZMA_PROPS_MAX) {
+        return BOOTUTIL_LZMA_EFORMAT;
+    }
+
+    lc = props % 9;
+    props /= 9;
+    lp = props % 5;
+    pb = props / 5;
+
+    if (lc + lp > BOOTUTIL_LZMA_LCLP_MAX) {
+        return BOOTUTIL_LZMA_EFORMAT;
+    }
+
+    dec->lc = lc;
+    dec->lp_mask = (1UL << lp) - 1;
+    dec->pb_mask = (1UL << pb) - 1;
+
+    return BOOTUTIL_LZMA_OK;
+}
+
+static uint32_t
+lzma_decode_len(struct lzma_dec *dec, struct lzma_len_dec *ld, uint32_t pos_state)
+{
+    if (lzma_rc_bit(dec, &ld->choice) == 0) {
+        return lzma_rc_bittree(dec, ld->low[pos_state], LZMA_LEN_LOW_BITS);
+    }
+
+    if (lzma_rc_bit(dec, &ld->choice2) == 0) {
+        return LZMA_LEN_LOW_SYMBOLS +
+               lzma_rc_bittree(dec, ld->mid[pos_state], LZMA_LEN_MID_BITS);
+    }
+
+    return LZMA_LEN_LOW_SYMBOLS + LZMA_LEN_MID_SYMBOLS +
+           lzma_rc_bittree(dec, ld->high, LZMA_LEN_HIGH_BITS);
+}
+
+static uint32_t
+lzma_decode_dist(struct lzma_dec *dec, uint32_t len)
+{
+    uint32_t len_state;
+    uint32_t slot;
+    uint32_t bits;
+    uint32_t dist;
+
+    len_state = (len < LZMA_DIST_STATES - 1) ? len : LZMA_DIST_STATES - 1;
+    slot = lzma_rc_bittree(dec, dec->probs.dist_slot[len_state],
+                           LZMA_DIST_SLOT_BITS);
+    if (slot < LZMA_DIST_MODEL_START) {
+        return slot;
+    }
+
+    bits = (slot >> 1) - 1;
+    dist = (2 | (slot & 1)) << bits;
+
+    if (slot < LZMA_DIST_MODEL_END) {
+        dist += lzma_rc_bittree_reverse(dec, &dec->probs.dist_special[dist - slot],
+                                        bits);
+    } else {
+        dist += lzma_rc_direct(dec, bits - LZMA_ALIGN_BITS) << LZMA_ALIGN_BITS;
+        dist += lzma_rc_bittree_reverse(dec, dec->probs.dist_align, LZMA_ALIGN_BITS);
+    }
+
+    return dist;
+}
+
+static void
+lzma_decode_literal(struct lzma_dec *dec)
+{
+    lzma_prob *probs;
+    uint32_t prev;
+    uint32_t match;
+    uint32_t match_bit;
+    uint32_t sym = 1;
+    uint32_t bit;
+
+    prev = (dec->dict_full > 0) ? lzma_dict_get(dec, 0) : 0;
+    probs = &dec->probs.literal[LZMA_LITERAL_CODER_SIZE *
+                                (((dec->pos & dec->lp_mask) << dec->lc) +
+                                 (prev >> (8 - dec->lc)))];
+
+    if (dec->state >= LZMA_LIT_STATES) {
+        match = lzma_dict_get(dec, dec->reps[0]);
+        do {
+            match_bit = (match >> 7) & 1;
+            match <<= 1;
+            bit = lzma_rc_bit(dec, &probs[((1 + match_bit) << 8) + sym]);
+            sym = (sym << 1) | bit;
+            if (match_bit != bit) {
+                break;
+            }
+        } while (sym < 0x100);
+    }
+
+    while (sym < 0x100) {
+        sym = (sym << 1) | lzma_rc_bit(dec, &probs[sym]);
+    }
+
+    lzma_dict_put(dec, (uint8_t)sym);
+
+    if (dec->state < 4) {
+        dec->state = 0;
+    } else if (dec->state < 10) {
+        dec->state -= 3;
+    } else {
+        dec->state -= 6;
+    }
+}
+
+/* Decodes one LZMA chunk producing exactly unpacked bytes. */
+static void
+lzma_decode_chunk(struct lzma_dec *dec, uint32_t unpacked)
+{
+    struct lzma_probs *p = &dec->probs;
+    uint32_t pos_state;
+    uint32_t state;
+    uint32_t dist;
+    uint32_t len;
+
+    while (unpacked > 0 && dec->err == BOOTUTIL_LZMA_OK) {
+        state = dec->state;
+        pos_state = dec->pos & dec->pb_mask;
+
+        if (lzma_rc_bit(dec, &p->is_match[state][pos_state]) == 0) {
+            lzma_decode_literal(dec);
+            unpacked--;
+            continue;
+        }
+
+        if (lzma_rc_bit(dec, &p->is_rep[state]) == 0) {
+            len = lzma_decode_len(dec, &p->match_len, pos_state);
+            dec->state = (state < LZMA_LIT_STATES) ? 7 : 10;
+            dist = lzma_decode_dist(dec, len);
+            dec->reps[3] = dec->reps[2];
+            dec->reps[2] = dec->reps[1];
+            dec->reps[1] = dec->reps[0];
+            dec->reps[0] = dist;
+        } else {
+            if (lzma_rc_bit(dec, &p->is_rep0[state]) == 0) {
+                if (lzma_rc_bit(dec, &p->is_rep0_long[state][pos_state]) == 0) {
+                    /* Short rep: a single byte at distance rep0. */
+                    if (dec->dict_full <= dec->reps[0]) {
+                        dec->err = BOOTUTIL_LZMA_EFORMAT;
+                        break;
+                    }
+                    dec->state = (state < LZMA_LIT_STATES) ? 9 : 11;
+                    lzma_dict_put(dec, lzma_dict_get(dec, dec->reps[0]));
+                    unpacked--;
+                    continue;
+                }
+            } else {
+                if (lzma_rc_bit(dec, &p->is_rep1[state]) == 0) {
+                    dist = dec->reps[1];
+                } else {
+                    if (lzma_rc_bit(dec, &p->is_rep2[state]) == 0) {
+                        dist = dec->reps[2];
+                    } else {
+                        dist = dec->reps[3];
+                        dec->reps[3] = dec->reps[2];
+                    }
+                    dec->reps[2] = dec->reps[1];
+                }
+                dec->reps[1] = dec->reps[0];
+                dec->reps[0] = dist;
+            }
+            len = lzma_decode_len(dec, &p->rep_len, pos_state);
+            dec->state = (state < LZMA_LIT_STATES) ? 8 : 11;
+        }
+
+        /*
+         * LZMA2 chunks never carry an end marker, so any distance must point
+         * inside the data decoded so far and the match must fit the chunk.
+         */
+        len += 2;
+        if (dec->reps[0] >= dec->dict_full || len > unpacked) {
+            dec->err = BOOTUTIL_LZMA_EFORMAT;
+            break;
+        }
+
+        unpacked -= len;
+        while (len-- > 0) {
+            lzma_dict_put(dec, lzma_dict_get(dec, dec->reps[0]));
+        }
+    }
+}
+
+/*
+ * LZMA2 framing.
+ */
+
+#define LZMA2_CTRL_END              0x00
+#define LZMA2_CTRL_COPY_RESET_DICT  0x01
+#define LZMA2_CTRL_COPY             0x02
+#define LZMA2_CTRL_LZMA             0x80
+#define LZMA2_CTRL_RESET_STATE      0xA0
+#define LZMA2_CTRL_NEW_PROPS        0xC0
+#define LZMA2_CTRL_RESET_DICT       0xE0
+
+static int
+lzma2_decode(struct lzma_dec *dec)
+{
+    bool need_dict_reset = true;
+    bool need_props = true;
+    uint32_t unpacked;
+    uint32_t packed;
+    uint32_t start;
+    uint8_t ctrl;
+    int rc;
+
+    while (dec->err == BOOTUTIL_LZMA_OK) {
+        ctrl = lzma_read_byte(dec);
+        if (dec->err != BOOTUTIL_LZMA_OK || ctrl == LZMA2_CTRL_END) {
+            break;
+        }
+
+        if (ctrl >= LZMA2_CTRL_RESET_DICT || ctrl == LZMA2_CTRL_COPY_RESET_DICT) {
+            need_props = true;
+            need_dict_reset = false;
+            lzma_dict_reset(dec);
+        } else if (need_dict_reset) {
+            return BOOTUTIL_LZMA_EFORMAT;
+        }
+
+        if (ctrl < LZMA2_CTRL_LZMA) {
+            if (ctrl > LZMA2_CTRL_COPY) {
+                return BOOTUTIL_LZMA_EFORMAT;
+            }
+
+            /* Uncompressed chunk, copied through the dictionary. */
+            unpacked = (uint32_t)lzma_read_byte(dec) << 8;
+            unpacked += (uint32_t)lzma_read_byte(dec) + 1;
+            if (unpacked > dec->out_len - dec->decoded) {
+                return BOOTUTIL_LZMA_EFORMAT;
+            }
+
+            while (unpacked-- > 0) {
+                lzma_dict_put(dec, lzma_read_byte(dec));
+            }
+            continue;
+        }
+
+        unpacked = (uint32_t)(ctrl & 0x1F) << 16;
+        unpacked += (uint32_t)lzma_read_byte(dec) << 8;
+        unpacked += (uint32_t)lzma_read_byte(dec) + 1;
+        packed = (uint32_t)lzma_read_byte(dec) << 8;
+        packed += (uint32_t)lzma_read_byte(dec) + 1;
+
+        if (ctrl >= LZMA2_CTRL_NEW_PROPS) {
+            rc = lzma_set_props(dec, lzma_read_byte(dec));
+            if (rc != BOOTUTIL_LZMA_OK) {
+                return rc;
+            }
+            need_props = false;
+        } else if (need_props) {
+            return BOOTUTIL_LZMA_EFORMAT;
+        }
+
+        if (ctrl >= LZMA2_CTRL_RESET_STATE) {
+            lzma_reset_state(dec);
+        }
+
+        if (unpacked > dec->out_len - dec->decoded || packed < LZMA_RC_INIT_BYTES) {
+            return BOOTUTIL_LZMA_EFORMAT;
+        }
+
+        /* Every LZMA chunk restarts the range decoder. */
+        start = dec->in_total;
+        lzma_rc_init(dec);
+        lzma_decode_chunk(dec, unpacked);
+
+        if (dec->err == BOOTUTIL_LZMA_OK &&
+            (dec->in_total - start != packed || dec->code != 0)) {
+            return BOOTUTIL_LZMA_EFORMAT;
+        }
+    }
+
+    return dec->err;
+}
+
+int
+bootutil_lzma2_decode(const struct bootutil_lzma_io *io,
+                      const uint8_t hdr[BOOTUTIL_LZMA2_HDR_SZ],
+                      bool arm_thumb, uint32_t out_len)
+{
+    struct lzma_dec *dec = &lzma_dec;
+    int rc;
+
+    rc = bootutil_lzma2_check_header(hdr, out_len);
+    if (rc != BOOTUTIL_LZMA_OK) {
+        return rc;
+    }
+
+    memset(dec, 0, offsetof(struct lzma_dec, probs));
+    dec->io = io;
+    dec->arm_thumb = arm_thumb;
+    dec->out_len = out_len;
+
+    rc = lzma2_decode(dec);
+    if (rc == BOOTUTIL_LZMA_OK) {
+        lzma_dict_flush(dec);
+        if (arm_thumb) {
+            lzma_bcj_flush(dec, true);
+        }
+        rc = dec->err;
+    }
+
+    if (rc == BOOTUTIL_LZMA_OK && dec->decoded != out_len) {
+        rc = BOOTUTIL_LZMA_EFORMAT;
+    }
+
+    return rc;
+}
+
+#endif /* MCUBOOT_DECOMPRESS_IMAGES */
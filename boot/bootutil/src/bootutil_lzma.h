@@ -0,0 +1,116 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef H_BOOTUTIL_LZMA_
+#define H_BOOTUTIL_LZMA_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "mcuboot_config/mcuboot_config.h"
+
+#ifndef MCUBOOT_DECOMPRESS_DICT_SIZE
+#define MCUBOOT_DECOMPRESS_DICT_SIZE    (128 * 1024)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Size of the LZMA2 properties header that imgtool prepends to the stream. */
+#define BOOTUTIL_LZMA2_HDR_SZ       2
+
+/*
+ * Largest value of lc + lp accepted by the decoder. LZMA2 forbids anything
+ * above 4 and bounding it here bounds the literal probability table size.
+ */
+#define BOOTUTIL_LZMA_LCLP_MAX      4
+
+#define BOOTUTIL_LZMA_OK            0
+#define BOOTUTIL_LZMA_EIO           1   /* Input or output callback failed */
+#define BOOTUTIL_LZMA_EFORMAT       2   /* Corrupt or truncated stream */
+#define BOOTUTIL_LZMA_EUNSUPP       3   /* Stream parameters not supported */
+
+/**
+ * Reads compressed data.
+ *
+ * @param ctx   The in_ctx given in @ref bootutil_lzma_io.
+ * @param buf   Buffer to fill.
+ * @param len   Maximum number of bytes to read.
+ *
+ * @return Number of bytes read, 0 once the input is exhausted, negative
+ *         on failure.
+ */
+typedef int (*bootutil_lzma_read_t)(void *ctx, uint8_t *buf, uint32_t len);
+
+/**
+ * Consumes decompressed data.
+ *
+ * @param ctx   The out_ctx given in @ref bootutil_lzma_io.
+ * @param buf   Decompressed data.
+ * @param len   Number of bytes in @p buf.
+ *
+ * @return 0 on success; nonzero on failure, which aborts decoding.
+ */
+typedef int (*bootutil_lzma_write_t)(void *ctx, const uint8_t *buf, uint32_t len);
+
+struct bootutil_lzma_io {
+    bootutil_lzma_read_t read;
+    bootutil_lzma_write_t write;
+    void *in_ctx;
+    void *out_ctx;
+};
+
+/**
+ * Checks that a stream carrying the given LZMA2 properties header and
+ * expanding to @p out_len bytes can be decoded with the statically allocated
+ * dictionary of MCUBOOT_DECOMPRESS_DICT_SIZE bytes.
+ *
+ * @param hdr      The LZMA2 properties header written by imgtool.
+ * @param out_len  Size of the decompressed stream.
+ *
+ * @return BOOTUTIL_LZMA_OK if the stream can be decoded,
+ *         BOOTUTIL_LZMA_EFORMAT or BOOTUTIL_LZMA_EUNSUPP otherwise.
+ */
+int bootutil_lzma2_check_header(const uint8_t hdr[BOOTUTIL_LZMA2_HDR_SZ],
+                                uint32_t out_len);
+
+/**
+ * Decodes a raw LZMA2 stream, optionally followed by the ARM-Thumb BCJ
+ * filter, pushing the output through @p io as it is produced.
+ *
+ * The decoder state and the sliding dictionary are statically allocated, so
+ * the function is not reentrant.
+ *
+ * @param io         Input and output callbacks; the input starts right
+ *                   after the properties header.
+ * @param hdr        The LZMA2 properties header of the stream.
+ * @param arm_thumb  Whether to undo the ARM-Thumb BCJ filter on the output.
+ * @param out_len    Expected size of the decompressed stream; a stream that
+ *                   expands to anything else is rejected.
+ *
+ * @return BOOTUTIL_LZMA_OK on success, one of the BOOTUTIL_LZMA_E* codes
+ *         otherwise.
+ */
+int bootutil_lzma2_decode(const struct bootutil_lzma_io *io,
+                          const uint8_t hdr[BOOTUTIL_LZMA2_HDR_SZ],
+                          bool arm_thumb, uint32_t out_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* H_BOOTUTIL_LZMA_ */
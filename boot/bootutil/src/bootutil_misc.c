@@ -39,9 +39,14 @@
 #include "bootutil_misc.h"
 #include "bootutil/bootutil_log.h"
 #include "bootutil/fault_injection_hardening.h"
+#include "bootutil/boot_public_hooks.h"
 #ifdef MCUBOOT_ENC_IMAGES
 #include "bootutil/enc_key.h"
 #endif
+#ifdef MCUBOOT_VALIDATION_CACHE
+#include "bootutil/crypto/sha.h"
+#include "bootutil/validation_cache.h"
+#endif
 #if defined(MCUBOOT_SWAP_USING_MOVE) || defined(MCUBOOT_SWAP_USING_OFFSET) || \
     defined(MCUBOOT_SWAP_USING_SCRATCH)
 #include "swap_priv.h"
@@ -291,6 +296,63 @@ boot_read_enc_key(const struct flash_area *fap, uint8_t slot, struct boot_status
 }
 #endif
 
+#ifdef MCUBOOT_SWAP_STATE_CACHE
+int
+boot_read_slot_swap_state(struct boot_loader_state *state, int slot,
+                          struct boot_swap_state *swap_state)
+{
+    int rc;
+
+    if (BOOT_IMG(state, slot).swap_state.valid &&
+        BOOT_IMG(state, slot).swap_state.gen == boot_trailer_writes) {
+        *swap_state = BOOT_IMG(state, slot).swap_state.state;
+        return 0;
+    }
+
+    rc = boot_read_swap_state(BOOT_IMG_AREA(state, slot), swap_state);
+    if (rc == 0) {
+        BOOT_IMG(state, slot).swap_state.state = *swap_state;
+        BOOT_IMG(state, slot).swap_state.gen = boot_trailer_writes;
+        BOOT_IMG(state, slot).swap_state.valid = true;
+    }
+
+    return rc;
+}
+
+int
+boot_swap_type_state(struct boot_loader_state *state)
+{
+    struct boot_swap_state primary_slot;
+    struct boot_swap_state secondary_slot;
+    int image_index = BOOT_CURR_IMG(state);
+    int rc;
+
+    rc = BOOT_HOOK_CALL(boot_read_swap_state_primary_slot_hook,
+                        BOOT_HOOK_REGULAR, image_index, &primary_slot);
+    if (rc == BOOT_HOOK_REGULAR) {
+        rc = boot_read_slot_swap_state(state, BOOT_SLOT_PRIMARY, &primary_slot);
+    }
+    if (rc) {
+        return BOOT_SWAP_TYPE_PANIC;
+    }
+
+    rc = boot_read_slot_swap_state(state, BOOT_SLOT_SECONDARY, &secondary_slot);
+    if (rc == BOOT_EFLASH) {
+        BOOT_LOG_INF("Secondary image of image pair (%d) is unreachable. Treat it as empty",
+                     image_index);
+        secondary_slot.magic = BOOT_MAGIC_UNSET;
+        secondary_slot.swap_type = BOOT_SWAP_TYPE_NONE;
+        secondary_slot.copy_done = BOOT_FLAG_UNSET;
+        secondary_slot.image_ok = BOOT_FLAG_UNSET;
+        secondary_slot.image_num = 0;
+    } else if (rc) {
+        return BOOT_SWAP_TYPE_PANIC;
+    }
+
+    return boot_swap_type_decode(image_index, &primary_slot, &secondary_slot);
+}
+#endif
+
 int
 boot_write_swap_size(const struct flash_area *fap, uint32_t swap_size)
 {
@@ -362,7 +424,11 @@ uint32_t bootutil_max_image_size(struct boot_loader_state *state, const struct f
     return app_max_size(state);
 #elif defined(MCUBOOT_OVERWRITE_ONLY)
     (void) state;
+#ifdef MCUBOOT_VALIDATION_CACHE
+    return boot_validation_cache_off(fap);
+#else
     return boot_swap_info_off(fap);
+#endif
 #elif defined(MCUBOOT_DIRECT_XIP)
     (void) state;
     return boot_swap_info_off(fap);
@@ -660,7 +726,200 @@ void boot_state_clear(struct boot_loader_state *state)
             boot_enc_drop(&state->enc[image][slot]);
         }
     }
+#if defined(MCUBOOT_ENC_KEY_CACHE)
+    boot_enc_key_cache_clear(state);
+#endif
 #else
     (void)state;
 #endif
 }
+
+#ifdef MCUBOOT_VALIDATION_CACHE
+uint32_t
+boot_validation_cache_off(const struct flash_area *fap)
+{
+#ifdef MCUBOOT_ENC_IMAGES
+    return boot_enc_key_off(fap, BOOT_SLOT_SECONDARY) - BOOT_VALIDATION_CACHE_SIZE;
+#else
+    return boot_swap_size_off(fap) - BOOT_VALIDATION_CACHE_SIZE;
+#endif
+}
+
+/*
+ * Counts the records written to the trailer of a primary slot; they are
+ * appended from the lowest offset up until the slot is erased.
+ */
+static int
+boot_validation_cache_count(const struct flash_area *fap, uint32_t *count)
+{
+    uint8_t buf[BOOT_VALIDATION_RECORD_ALIGN_SIZE];
+    uint32_t off;
+    uint32_t i;
+    int rc;
+
+    off = boot_validation_cache_off(fap);
+    for (i = 0; i < MCUBOOT_VALIDATION_CACHE_RECORDS; i++) {
+        rc = flash_area_read(fap, off + i * BOOT_VALIDATION_RECORD_ALIGN_SIZE, buf,
+                             sizeof(buf));
+        if (rc != 0) {
+            return BOOT_EFLASH;
+        }
+        if (bootutil_buffer_is_erased(fap, buf, sizeof(buf))) {
+            break;
+        }
+    }
+
+    *count = i;
+    return 0;
+}
+
+int
+boot_validation_record_read(uint32_t image_index, struct boot_validation_record *rec)
+{
+    const struct flash_area *fap;
+    uint32_t count;
+    int rc;
+
+    rc = flash_area_open(FLASH_AREA_IMAGE_PRIMARY(image_index), &fap);
+    if (rc != 0) {
+        return BOOT_EFLASH;
+    }
+
+    rc = boot_validation_cache_count(fap, &count);
+    if (rc == 0 && count == 0) {
+        rc = -1;
+    }
+    if (rc == 0) {
+        /* The last record written is the current one. */
+        rc = flash_area_read(fap, boot_validation_cache_off(fap) +
+                             (count - 1) * BOOT_VALIDATION_RECORD_ALIGN_SIZE,
+                             rec, sizeof(*rec));
+        if (rc != 0) {
+            rc = BOOT_EFLASH;
+        }
+    }
+
+    flash_area_close(fap);
+    return rc;
+}
+
+int
+boot_validation_record_write(uint32_t image_index, const struct boot_validation_record *rec)
+{
+    uint8_t buf[BOOT_VALIDATION_RECORD_ALIGN_SIZE];
+    struct boot_validation_record last;
+    const struct flash_area *fap;
+    uint32_t count;
+    uint32_t off;
+    int rc;
+
+    rc = flash_area_open(FLASH_AREA_IMAGE_PRIMARY(image_index), &fap);
+    if (rc != 0) {
+        return BOOT_EFLASH;
+    }
+
+    rc = boot_validation_cache_count(fap, &count);
+    if (rc != 0) {
+        goto done;
+    }
+
+    off = boot_validation_cache_off(fap);
+    if (rec->magic != BOOT_VALIDATION_RECORD_MAGIC) {
+        /* Nothing to do unless the current record is a valid one. */
+        if (count == 0) {
+            goto done;
+        }
+        rc = flash_area_read(fap, off + (count - 1) * BOOT_VALIDATION_RECORD_ALIGN_SIZE,
+                             &last, sizeof(last));
+        if (rc != 0) {
+            rc = BOOT_EFLASH;
+            goto done;
+        }
+        if (last.magic != BOOT_VALIDATION_RECORD_MAGIC) {
+            goto done;
+        }
+    } else if (count >= MCUBOOT_VALIDATION_CACHE_RECORDS - 1) {
+        /* The last entry is kept for invalidating this record. */
+        rc = -1;
+        goto done;
+    }
+
+    if (count == MCUBOOT_VALIDATION_CACHE_RECORDS) {
+        rc = -1;
+        goto done;
+    }
+
+    if (rec->magic == BOOT_VALIDATION_RECORD_MAGIC) {
+        memset(buf, flash_area_erased_val(fap), sizeof(buf));
+        memcpy(buf, rec, sizeof(*rec));
+    } else {
+        /* Whatever the erased value, an invalidation must not read as erased. */
+        memset(buf, (uint8_t)~flash_area_erased_val(fap), sizeof(buf));
+    }
+
+    off += count * BOOT_VALIDATION_RECORD_ALIGN_SIZE;
+    BOOT_LOG_DBG("writing validation record; fa_id=%d off=0x%lx (0x%lx)",
+                 flash_area_get_id(fap), (unsigned long)off,
+                 (unsigned long)flash_area_get_off(fap) + off);
+    rc = flash_area_write(fap, off, buf, sizeof(buf));
+    if (rc != 0) {
+        rc = BOOT_EFLASH;
+    }
+
+done:
+    flash_area_close(fap);
+    return rc;
+}
+
+int
+boot_validation_generation_get(uint32_t image_index, uint32_t *generation)
+{
+    struct boot_swap_state swap_state;
+    int rc;
+
+    rc = boot_read_swap_state_by_id(FLASH_AREA_IMAGE_PRIMARY(image_index), &swap_state);
+    if (rc != 0) {
+        return rc;
+    }
+
+    /* Every write of the trailer fields starts a new generation, and erasing
+     * the slot takes the records away with the trailer.
+     */
+    *generation = (uint32_t)swap_state.magic |
+                  ((uint32_t)swap_state.swap_type << 8) |
+                  ((uint32_t)swap_state.copy_done << 16) |
+                  ((uint32_t)swap_state.image_ok << 24);
+
+    return 0;
+}
+
+int
+boot_validation_cache_invalidate(uint32_t image_index)
+{
+    struct boot_validation_record rec;
+
+    memset(&rec, 0, sizeof(rec));
+
+    return boot_validation_record_write(image_index, &rec);
+}
+
+int
+boot_validation_cache_record(uint32_t image_index, const struct image_header *hdr,
+                             const uint8_t *hash)
+{
+    struct boot_validation_record rec;
+    int rc;
+
+    memset(&rec, 0, sizeof(rec));
+    rc = boot_validation_generation_get(image_index, &rec.generation);
+    if (rc != 0) {
+        return rc;
+    }
+
+    rec.magic = BOOT_VALIDATION_RECORD_MAGIC;
+    memcpy(&rec.hdr, hdr, sizeof(rec.hdr));
+    memcpy(rec.hash, hash, IMAGE_HASH_SIZE);
+
+    return boot_validation_record_write(image_index, &rec);
+}
+#endif /* MCUBOOT_VALIDATION_CACHE */
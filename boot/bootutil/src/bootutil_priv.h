@@ -44,13 +44,54 @@
 #include "bootutil/enc_key.h"
 #endif
 
+#ifdef MCUBOOT_HASH_IMAGE_COPY
+#include "bootutil/crypto/sha.h"
+#endif
+
+#ifdef MCUBOOT_VALIDATION_CACHE
+#include "bootutil/validation_cache.h"
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 struct flash_area;
 
-#define BOOT_TMPBUF_SZ  256
+/*
+ * Size of the chunks the image is read in while it is hashed. Larger chunks
+ * mean fewer flash reads, which matters on external flash where every read
+ * has a fixed setup cost. The buffer holding them (two of them with
+ * asynchronous reads) is on the stack in some configurations, hence the
+ * limit.
+ */
+#ifndef MCUBOOT_IMG_HASH_CHUNK_SIZE
+#define MCUBOOT_IMG_HASH_CHUNK_SIZE     256
+#endif
+
+#if MCUBOOT_IMG_HASH_CHUNK_SIZE < 16 || MCUBOOT_IMG_HASH_CHUNK_SIZE > 4096
+#error "MCUBOOT_IMG_HASH_CHUNK_SIZE must be between 16 and 4096 bytes"
+#endif
+
+#ifdef MCUBOOT_FLASH_ASYNC_READ
+/* Two chunks: one being read while the other one is hashed. */
+#define BOOT_TMPBUF_SZ  (2 * MCUBOOT_IMG_HASH_CHUNK_SIZE)
+
+/*
+ * Asynchronous flash reads, provided by the flash map backend when
+ * MCUBOOT_FLASH_ASYNC_READ is set. flash_area_read_async() starts reading
+ * `len` bytes at `off` into `dst` and may return before the data is
+ * available; flash_area_read_wait() blocks until the read started last on
+ * `fa` has completed and returns its result. At most one read is
+ * outstanding per flash area and `dst` must not be accessed until it
+ * completes. Both return 0 on success.
+ */
+int flash_area_read_async(const struct flash_area *fa, uint32_t off,
+                          void *dst, uint32_t len);
+int flash_area_read_wait(const struct flash_area *fa);
+#else
+#define BOOT_TMPBUF_SZ  MCUBOOT_IMG_HASH_CHUNK_SIZE
+#endif
 
 /** Number of image slots in flash; currently limited to two. */
 #if defined(MCUBOOT_SINGLE_APPLICATION_SLOT) || defined(MCUBOOT_SINGLE_APPLICATION_SLOT_RAM_LOAD)
@@ -216,6 +257,54 @@ typedef struct flash_sector boot_sector_t;
 typedef struct flash_area boot_sector_t;
 #endif
 
+#ifdef MCUBOOT_TLV_DIR_CACHE
+#ifdef MCUBOOT_RAM_LOAD
+#error "MCUBOOT_TLV_DIR_CACHE is not supported with MCUBOOT_RAM_LOAD"
+#endif
+
+/* Maximum number of TLVs of an image served from its TLV directory. */
+#ifndef MCUBOOT_TLV_DIR_ENTRIES
+#define MCUBOOT_TLV_DIR_ENTRIES         16
+#endif
+
+#define BOOT_TLV_DIR_EMPTY              0
+#define BOOT_TLV_DIR_VALID              1
+/* The TLV area could not be cached, it is walked in flash instead. */
+#define BOOT_TLV_DIR_UNUSABLE           2
+
+/* Location of a TLV, as listed in a TLV directory. */
+struct boot_tlv_dir_entry {
+    uint32_t off;               /* Offset of the TLV payload in the flash area */
+    uint16_t len;
+    uint16_t type;
+};
+
+/*
+ * Directory of the TLVs of the image in a slot, built with a few bulk reads
+ * of the TLV area when it is first iterated. TLV iterations started with
+ * boot_tlv_iter_begin() are then served from it without reading the flash.
+ */
+struct boot_tlv_dir {
+    uint8_t status;
+    uint8_t count;
+    uint32_t tlv_off;           /* Start of the TLV area */
+    uint32_t prot_end;
+    uint32_t tlv_end;
+    struct boot_tlv_dir_entry entries[MCUBOOT_TLV_DIR_ENTRIES];
+};
+#endif
+
+#ifdef MCUBOOT_ENC_KEY_CACHE
+/* Size of the tag binding a cached key to the TLV it was unwrapped from. */
+#define BOOT_ENC_KEY_CACHE_TAG_SIZE 16
+
+struct boot_enc_key_cache_entry {
+    uint8_t tag[BOOT_ENC_KEY_CACHE_TAG_SIZE];
+    uint8_t key[BOOT_ENC_KEY_SIZE];
+    bool valid;
+};
+#endif
+
 /** Private state maintained during boot. */
 struct boot_loader_state {
     struct {
@@ -225,6 +314,17 @@ struct boot_loader_state {
         uint32_t num_sectors;
 #if defined(MCUBOOT_SWAP_USING_OFFSET)
         uint16_t unprotected_tlv_size;
+#endif
+#if defined(MCUBOOT_TLV_DIR_CACHE)
+        struct boot_tlv_dir tlv_dir;
+#endif
+#if defined(MCUBOOT_SWAP_STATE_CACHE)
+        /* Snapshot of the trailer, valid while boot_trailer_writes is gen */
+        struct {
+            struct boot_swap_state state;
+            uint32_t gen;
+            bool valid;
+        } swap_state;
 #endif
     } imgs[BOOT_IMAGE_NUMBER][BOOT_NUM_SLOTS];
 
@@ -248,6 +348,10 @@ struct boot_loader_state {
 
 #if defined(MCUBOOT_ENC_IMAGES)
     struct enc_key_data enc[BOOT_IMAGE_NUMBER][BOOT_NUM_SLOTS];
+#if defined(MCUBOOT_ENC_KEY_CACHE)
+    /* Keys unwrapped during this boot, tagged by the TLV they come from */
+    struct boot_enc_key_cache_entry enc_key_cache[BOOT_IMAGE_NUMBER][BOOT_NUM_SLOTS];
+#endif
 #endif
 
 #if (BOOT_IMAGE_NUMBER > 1)
@@ -255,6 +359,14 @@ struct boot_loader_state {
     bool img_mask[BOOT_IMAGE_NUMBER];
 #endif
 
+#if defined(MCUBOOT_HASH_IMAGE_COPY)
+    /* Hash of the image written to the primary slot by an upgrade */
+    struct {
+        uint8_t hash[IMAGE_HASH_SIZE];
+        bool valid;
+    } copy_hash[BOOT_IMAGE_NUMBER];
+#endif
+
 #if defined(MCUBOOT_DIRECT_XIP) || defined(MCUBOOT_RAM_LOAD)
     struct slot_usage_t {
         /* Index of the slot chosen to be loaded */
@@ -299,6 +411,9 @@ int boot_status_entries(int image_index, const struct flash_area *fap);
 uint32_t boot_status_off(const struct flash_area *fap);
 int boot_read_swap_state(const struct flash_area *fap,
                          struct boot_swap_state *state);
+int boot_swap_type_decode(int image_index,
+                          const struct boot_swap_state *primary_slot,
+                          const struct boot_swap_state *secondary_slot);
 int boot_write_magic(const struct flash_area *fap);
 int boot_write_status(const struct boot_loader_state *state, struct boot_status *bs);
 int boot_write_copy_done(const struct flash_area *fap);
@@ -334,6 +449,53 @@ int boot_copy_region(struct boot_loader_state *state,
 #endif
 bool boot_status_is_reset(const struct boot_status *bs);
 
+struct boot_copy_hash;
+
+#ifdef MCUBOOT_HASH_IMAGE_COPY
+/* Hash of the data written by boot_copy_region_hash(), over the first `len`
+ * bytes of the destination slot.
+ */
+struct boot_copy_hash {
+    bootutil_sha_context sha;
+    uint32_t len;
+    uint32_t off;
+};
+
+void boot_copy_hash_start(struct boot_copy_hash *hash, const struct image_header *hdr);
+int boot_copy_hash_finish(struct boot_copy_hash *hash, uint8_t *digest);
+int boot_copy_region_hash(struct boot_loader_state *state,
+                          const struct flash_area *fap_src,
+                          const struct flash_area *fap_dst,
+                          uint32_t off_src, uint32_t off_dst, uint32_t sz,
+                          uint32_t sector_off, struct boot_copy_hash *hash);
+#endif
+
+#ifdef MCUBOOT_SWAP_SKIP_UNCHANGED
+bool boot_copy_region_unchanged(struct boot_loader_state *state,
+                                const struct flash_area *fap_src,
+                                const struct flash_area *fap_dst,
+                                uint32_t off_src, uint32_t off_dst, uint32_t sz,
+                                struct boot_copy_hash *hash);
+#else
+static inline bool
+boot_copy_region_unchanged(struct boot_loader_state *state,
+                           const struct flash_area *fap_src,
+                           const struct flash_area *fap_dst,
+                           uint32_t off_src, uint32_t off_dst, uint32_t sz,
+                           struct boot_copy_hash *hash)
+{
+    (void)state;
+    (void)fap_src;
+    (void)fap_dst;
+    (void)off_src;
+    (void)off_dst;
+    (void)sz;
+    (void)hash;
+
+    return false;
+}
+#endif
+
 #ifdef MCUBOOT_ENC_IMAGES
 int boot_write_enc_keys(const struct flash_area *fap, const struct boot_status *bs);
 bool boot_read_enc_key(const struct flash_area *fap, uint8_t slot,
@@ -439,6 +601,26 @@ static inline bool boot_u16_safe_add(uint16_t *dest, uint16_t a, uint16_t b)
 #define BOOT_WRITE_SZ(state) ((state)->write_sz[BOOT_CURR_IMG(state)])
 #define BOOT_SWAP_TYPE(state) ((state)->swap_type[BOOT_CURR_IMG(state)])
 #define BOOT_TLV_OFF(hdr) ((hdr)->ih_hdr_size + (hdr)->ih_img_size)
+#ifdef MCUBOOT_TLV_DIR_CACHE
+/* Must be used whenever the header of a slot is (re)loaded. */
+#define BOOT_TLV_DIR_INVALIDATE(state, slot) \
+    (BOOT_IMG(state, slot).tlv_dir.status = BOOT_TLV_DIR_EMPTY)
+#else
+#define BOOT_TLV_DIR_INVALIDATE(state, slot)
+#endif
+
+#ifdef MCUBOOT_SWAP_STATE_CACHE
+/*
+ * Count of the writes and erases which may change the end of a trailer. The
+ * snapshots of the trailers kept in boot_loader_state are only used while it
+ * is unchanged.
+ */
+extern uint32_t boot_trailer_writes;
+/* Must be used by anything writing or erasing the end of a trailer. */
+#define BOOT_SWAP_STATE_INVALIDATE() (boot_trailer_writes++)
+#else
+#define BOOT_SWAP_STATE_INVALIDATE()
+#endif
 
 #define BOOT_IS_UPGRADE(swap_type)             \
     (((swap_type) == BOOT_SWAP_TYPE_TEST) ||   \
@@ -543,6 +725,95 @@ int boot_load_image_to_sram(struct boot_loader_state *state);
 
 uint32_t bootutil_max_image_size(struct boot_loader_state *state, const struct flash_area *fap);
 
+#ifdef MCUBOOT_SWAP_STATE_CACHE
+/*
+ * Same as boot_read_swap_state() for a slot of the current image, served from
+ * a snapshot kept in `state` until bootutil writes or erases a trailer.
+ */
+int boot_read_slot_swap_state(struct boot_loader_state *state, int slot,
+                              struct boot_swap_state *swap_state);
+
+/*
+ * Same as boot_swap_type_multi() for the current image, reading the trailers
+ * with boot_read_slot_swap_state().
+ */
+int boot_swap_type_state(struct boot_loader_state *state);
+#else
+static inline int
+boot_read_slot_swap_state(struct boot_loader_state *state, int slot,
+                          struct boot_swap_state *swap_state)
+{
+    return boot_read_swap_state(BOOT_IMG_AREA(state, slot), swap_state);
+}
+
+static inline int
+boot_swap_type_state(struct boot_loader_state *state)
+{
+    (void)state;
+    return boot_swap_type_multi(BOOT_CURR_IMG(state));
+}
+#endif
+
+#ifdef MCUBOOT_TLV_DIR_CACHE
+/*
+ * Same as bootutil_tlv_iter_begin(), but when `hdr` is the header of a slot in
+ * `state`, the iteration is served from the TLV directory of that slot.
+ * `state` may be NULL.
+ */
+int boot_tlv_iter_begin(struct boot_loader_state *state, struct image_tlv_iter *it,
+                        const struct image_header *hdr, const struct flash_area *fap,
+                        uint16_t type, bool prot);
+#else
+static inline int
+boot_tlv_iter_begin(struct boot_loader_state *state, struct image_tlv_iter *it,
+                    const struct image_header *hdr, const struct flash_area *fap,
+                    uint16_t type, bool prot)
+{
+    (void)state;
+    return bootutil_tlv_iter_begin(it, hdr, fap, type, prot);
+}
+#endif
+
+#ifdef MCUBOOT_VALIDATION_CACHE
+/*
+ * Number of validation records the primary slot trailer has room for. They
+ * are appended until the slot is erased, the last one being kept for an
+ * invalidation.
+ */
+#ifndef MCUBOOT_VALIDATION_CACHE_RECORDS
+#define MCUBOOT_VALIDATION_CACHE_RECORDS    4
+#endif
+
+#if MCUBOOT_VALIDATION_CACHE_RECORDS < 2
+#error "MCUBOOT_VALIDATION_CACHE_RECORDS must be at least 2"
+#endif
+
+#define BOOT_VALIDATION_RECORD_ALIGN_SIZE \
+    ALIGN_UP(sizeof(struct boot_validation_record), BOOT_MAX_ALIGN)
+#define BOOT_VALIDATION_CACHE_SIZE \
+    (MCUBOOT_VALIDATION_CACHE_RECORDS * BOOT_VALIDATION_RECORD_ALIGN_SIZE)
+
+/*
+ * Offset of the validation records in a slot, right below the encryption
+ * keys of the trailer.
+ */
+uint32_t boot_validation_cache_off(const struct flash_area *fap);
+
+/*
+ * Invalidates the validation record of an image's primary slot. Must be
+ * called before the primary slot gets written to, so that a partially written
+ * slot is never accepted on the strength of a stale record.
+ */
+int boot_validation_cache_invalidate(uint32_t image_index);
+
+/*
+ * Records hash as that of the fully validated image with header hdr in an
+ * image's primary slot, at the current write generation of the slot.
+ */
+int boot_validation_cache_record(uint32_t image_index, const struct image_header *hdr,
+                                 const uint8_t *hash);
+#endif
+
 int boot_read_image_size(struct boot_loader_state *state, int slot,
                          uint32_t *size);
 
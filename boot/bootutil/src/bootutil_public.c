@@ -78,6 +78,10 @@ const union boot_img_magic_t boot_img_magic = {
 };
 #endif
 
+#if defined(MCUBOOT_SWAP_STATE_CACHE)
+uint32_t boot_trailer_writes;
+#endif
+
 struct boot_swap_table {
     uint8_t magic_primary_slot;
     uint8_t magic_secondary_slot;
@@ -214,6 +218,16 @@ bool bootutil_buffer_is_erased(const struct flash_area *area,
     return true;
 }
 
+/* Decodes a flag read from a trailer, as a BOOT_FLAG_[...] value. */
+static uint8_t
+boot_flag_parse(const struct flash_area *fap, uint8_t flag)
+{
+    if (bootutil_buffer_is_erased(fap, &flag, sizeof flag)) {
+        return BOOT_FLAG_UNSET;
+    }
+    return boot_flag_decode(flag);
+}
+
 static int
 boot_read_flag(const struct flash_area *fap, uint8_t *flag, uint32_t off)
 {
@@ -223,47 +237,48 @@ boot_read_flag(const struct flash_area *fap, uint8_t *flag, uint32_t off)
     if (rc < 0) {
         return BOOT_EFLASH;
     }
-    if (bootutil_buffer_is_erased(fap, flag, sizeof *flag)) {
-        *flag = BOOT_FLAG_UNSET;
-    } else {
-        *flag = boot_flag_decode(*flag);
-    }
+    *flag = boot_flag_parse(fap, *flag);
 
     return 0;
 }
 
-static inline int
-boot_read_copy_done(const struct flash_area *fap, uint8_t *copy_done)
-{
-    return boot_read_flag(fap, copy_done, boot_copy_done_off(fap));
-}
-
+/*
+ * Largest size of the end of a trailer holding the swap state, from the swap
+ * info to the magic, including the padding of the fields. This is one more
+ * alignment unit than needed when the flash area size is aligned.
+ */
+#define BOOT_SWAP_STATE_MAX_SZ  (4 * BOOT_MAX_ALIGN + BOOT_MAGIC_ALIGN_SIZE)
 
 int
 boot_read_swap_state(const struct flash_area *fap,
                      struct boot_swap_state *state)
 {
-    uint8_t magic[BOOT_MAGIC_SZ];
+    uint8_t buf[BOOT_SWAP_STATE_MAX_SZ];
+    const uint8_t *magic;
     uint32_t off;
+    uint32_t len;
     uint8_t swap_info;
     int rc;
 
-    off = boot_magic_off(fap);
-    rc = flash_area_read(fap, off, magic, BOOT_MAGIC_SZ);
+    /* The fields are read at once, as the end of the trailer. */
+    off = boot_swap_info_off(fap);
+    len = flash_area_get_size(fap) - off;
+    if (len > sizeof(buf)) {
+        return BOOT_EFLASH;
+    }
+    rc = flash_area_read(fap, off, buf, len);
     if (rc < 0) {
         return BOOT_EFLASH;
     }
+
+    magic = &buf[boot_magic_off(fap) - off];
     if (bootutil_buffer_is_erased(fap, magic, BOOT_MAGIC_SZ)) {
         state->magic = BOOT_MAGIC_UNSET;
     } else {
         state->magic = boot_magic_decode(magic);
     }
 
-    off = boot_swap_info_off(fap);
-    rc = flash_area_read(fap, off, &swap_info, sizeof swap_info);
-    if (rc < 0) {
-        return BOOT_EFLASH;
-    }
+    swap_info = buf[0];
 
     /* Extract the swap type and image number */
     state->swap_type = BOOT_GET_SWAP_TYPE(swap_info);
@@ -275,12 +290,10 @@ boot_read_swap_state(const struct flash_area *fap,
         state->image_num = 0;
     }
 
-    rc = boot_read_copy_done(fap, &state->copy_done);
-    if (rc) {
-        return BOOT_EFLASH;
-    }
+    state->copy_done = boot_flag_parse(fap, buf[boot_copy_done_off(fap) - off]);
+    state->image_ok = boot_flag_parse(fap, buf[boot_image_ok_off(fap) - off]);
 
-    return boot_read_image_ok(fap, &state->image_ok);
+    return 0;
 }
 
 int
@@ -327,6 +340,7 @@ boot_write_magic(const struct flash_area *fap)
     BOOT_LOG_DBG("boot_write_magic: fa_id=%d off=0x%lx (0x%lx)",
                  flash_area_get_id(fap), (unsigned long)off,
                  (unsigned long)(flash_area_get_off(fap) + off));
+    BOOT_SWAP_STATE_INVALIDATE();
     rc = flash_area_write(fap, pad_off, &magic[0], BOOT_MAGIC_ALIGN_SIZE);
 
     if (rc != 0) {
@@ -365,6 +379,7 @@ boot_write_trailer(const struct flash_area *fap, uint32_t off,
     memcpy(buf, inbuf, inlen);
     memset(&buf[inlen], erased_val, align - inlen);
 
+    BOOT_SWAP_STATE_INVALIDATE();
     rc = flash_area_write(fap, off, buf, align);
     if (rc != 0) {
         return BOOT_EFLASH;
@@ -424,11 +439,9 @@ boot_write_swap_info(const struct flash_area *fap, uint8_t swap_type,
 int
 boot_swap_type_multi(int image_index)
 {
-    const struct boot_swap_table *table;
     struct boot_swap_state primary_slot;
     struct boot_swap_state secondary_slot;
     int rc;
-    size_t i;
 
     rc = BOOT_HOOK_CALL(boot_read_swap_state_primary_slot_hook,
                         BOOT_HOOK_REGULAR, image_index, &primary_slot);
@@ -455,22 +468,33 @@ boot_swap_type_multi(int image_index)
         return BOOT_SWAP_TYPE_PANIC;
     }
 
+    return boot_swap_type_decode(image_index, &primary_slot, &secondary_slot);
+}
+
+int
+boot_swap_type_decode(int image_index,
+                      const struct boot_swap_state *primary_slot,
+                      const struct boot_swap_state *secondary_slot)
+{
+    const struct boot_swap_table *table;
+    size_t i;
+
     for (i = 0; i < BOOT_SWAP_TABLES_COUNT; i++) {
         table = boot_swap_tables + i;
 
         if (boot_magic_compatible_check(table->magic_primary_slot,
-                                        primary_slot.magic) &&
+                                        primary_slot->magic) &&
             boot_magic_compatible_check(table->magic_secondary_slot,
-                                        secondary_slot.magic) &&
+                                        secondary_slot->magic) &&
             (table->image_ok_primary_slot == BOOT_FLAG_ANY   ||
-                table->image_ok_primary_slot == primary_slot.image_ok) &&
+                table->image_ok_primary_slot == primary_slot->image_ok) &&
             (table->image_ok_secondary_slot == BOOT_FLAG_ANY ||
-                table->image_ok_secondary_slot == secondary_slot.image_ok) &&
+                table->image_ok_secondary_slot == secondary_slot->image_ok) &&
             (table->copy_done_primary_slot == BOOT_FLAG_ANY  ||
-                table->copy_done_primary_slot == primary_slot.copy_done)
+                table->copy_done_primary_slot == primary_slot->copy_done)
 #if defined(MCUBOOT_SWAP_USING_OFFSET)
             && (table->copy_done_secondary_slot == BOOT_FLAG_ANY  ||
-                table->copy_done_secondary_slot == secondary_slot.copy_done)
+                table->copy_done_secondary_slot == secondary_slot->copy_done)
 #endif
             ) {
             BOOT_LOG_INF("Image index: %d, Swap type: %s", image_index,
@@ -83,6 +83,15 @@ uint32_t bootutil_get_caps(void)
 #if defined(MCUBOOT_HW_ROLLBACK_PROT)
     res |= BOOTUTIL_CAP_HW_ROLLBACK_PROT;
 #endif
+#if defined(MCUBOOT_DECOMPRESS_IMAGES)
+    res |= BOOTUTIL_CAP_DECOMPRESS_IMAGES;
+#endif
+#if defined(MCUBOOT_VALIDATION_CACHE)
+    res |= BOOTUTIL_CAP_VALIDATION_CACHE;
+#endif
+#if defined(MCUBOOT_DELTA_IMAGES)
+    res |= BOOTUTIL_CAP_DELTA_IMAGES;
+#endif
 
     return res;
 }
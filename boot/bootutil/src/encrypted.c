@@ -39,6 +39,10 @@
 #endif
 #endif
 
+#if defined(MCUBOOT_ENC_KEY_CACHE)
+#include "bootutil/crypto/sha.h"
+#endif
+
 #include "bootutil/image.h"
 #include "bootutil/enc_key.h"
 #include "bootutil/sign_key.h"
@@ -565,6 +569,26 @@ boot_decrypt_key(const uint8_t *buf, uint8_t *enckey)
 }
 #endif /* CONFIG_BOOT_ED25519_PSA  && CONFIG_BOOT_ECDSA_PSA */
 
+#ifdef MCUBOOT_ENC_KEY_CACHE
+/*
+ * The tag binding a cached key to the encryption TLV it is unwrapped from,
+ * the start of the hash of the TLV.
+ */
+static void
+boot_enc_key_cache_tag(const uint8_t *tlv, uint8_t *tag)
+{
+    bootutil_sha_context sha_ctx;
+    uint8_t hash[IMAGE_HASH_SIZE];
+
+    bootutil_sha_init(&sha_ctx);
+    bootutil_sha_update(&sha_ctx, tlv, BOOT_ENC_TLV_SIZE);
+    bootutil_sha_finish(&sha_ctx, hash);
+    bootutil_sha_drop(&sha_ctx);
+
+    memcpy(tag, hash, BOOT_ENC_KEY_CACHE_TAG_SIZE);
+}
+#endif
+
 /*
  * Load encryption key.
  */
@@ -581,6 +605,10 @@ boot_enc_load(struct boot_loader_state *state, int slot,
     uint8_t *buf;
 #else
     uint8_t buf[BOOT_ENC_TLV_SIZE];
+#endif
+#ifdef MCUBOOT_ENC_KEY_CACHE
+    uint8_t tag[BOOT_ENC_KEY_CACHE_TAG_SIZE];
+    struct boot_enc_key_cache_entry *cache;
 #endif
     int rc;
 
@@ -599,7 +627,7 @@ boot_enc_load(struct boot_loader_state *state, int slot,
     it.start_off = boot_get_state_secondary_offset(state, fap);
 #endif
 
-    rc = bootutil_tlv_iter_begin(&it, hdr, fap, BOOT_ENC_TLV, false);
+    rc = boot_tlv_iter_begin(state, &it, hdr, fap, BOOT_ENC_TLV, false);
     if (rc) {
         return -1;
     }
@@ -623,8 +651,40 @@ boot_enc_load(struct boot_loader_state *state, int slot,
         return -1;
     }
 
+#ifdef MCUBOOT_ENC_KEY_CACHE
+    cache = &state->enc_key_cache[BOOT_CURR_IMG(state)][slot];
+    boot_enc_key_cache_tag(buf, tag);
+    if (cache->valid && memcmp(cache->tag, tag, sizeof(tag)) == 0) {
+        BOOT_LOG_DBG("boot_enc_load: key read from the cache");
+        memcpy(bs->enckey[slot], cache->key, BOOT_ENC_KEY_SIZE);
+        return 0;
+    }
+
+    rc = boot_decrypt_key(buf, bs->enckey[slot]);
+    if (rc == 0) {
+        memcpy(cache->tag, tag, sizeof(tag));
+        memcpy(cache->key, bs->enckey[slot], BOOT_ENC_KEY_SIZE);
+        cache->valid = true;
+    }
+    return rc;
+#else
     return boot_decrypt_key(buf, bs->enckey[slot]);
+#endif
+}
+
+#ifdef MCUBOOT_ENC_KEY_CACHE
+void
+boot_enc_key_cache_clear(struct boot_loader_state *state)
+{
+    volatile uint8_t *p = (volatile uint8_t *)state->enc_key_cache;
+    size_t n = sizeof(state->enc_key_cache);
+
+    /* Not a plain memset, which may be dropped when state is freed next. */
+    while (n--) {
+        *p++ = 0;
+    }
 }
+#endif
 
 int
 boot_enc_init(struct enc_key_data *enc_state)
@@ -54,6 +54,9 @@ bootutil_verify_sig(uint8_t *hash, uint32_t hlen, uint8_t *sig, size_t slen,
     pubkey = (uint8_t *)bootutil_keys[key_id].key;
     end = pubkey + *bootutil_keys[key_id].len;
     bootutil_ecdsa_init(&ctx);
+#if defined(MCUBOOT_ECDSA_COMB_TABLES)
+    bootutil_ecdsa_set_table(&ctx, bootutil_keys[key_id].ecdsa_table);
+#endif
 
     rc = bootutil_ecdsa_parse_public_key(&ctx, &pubkey, end);
     if (rc) {
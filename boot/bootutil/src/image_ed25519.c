@@ -33,6 +33,12 @@ BOOT_LOG_MODULE_DECLARE(mcuboot);
 extern int ED25519_verify(const uint8_t *message, size_t message_len,
                           const uint8_t signature[EDDSA_SIGNATURE_LENGTH],
                           const uint8_t public_key[NUM_ED25519_BYTES]);
+#if defined(MCUBOOT_ED25519_PRECOMP_TABLES)
+extern int ED25519_verify_precomp(const uint8_t *message, size_t message_len,
+                                  const uint8_t signature[EDDSA_SIGNATURE_LENGTH],
+                                  const uint8_t public_key[NUM_ED25519_BYTES],
+                                  const void *public_table);
+#endif
 
 #if !defined(MCUBOOT_BUILTIN_KEY) && !defined(MCUBOOT_KEY_IMPORT_BYPASS_ASN)
 /*
@@ -139,6 +145,12 @@ bootutil_verify_sig(uint8_t *msg, uint32_t mlen, uint8_t *sig, size_t slen,
 #endif
 #endif
 
+#if defined(MCUBOOT_ED25519_PRECOMP_TABLES)
+    if (bootutil_keys[key_id].ed25519_table != NULL) {
+        rc = ED25519_verify_precomp(msg, mlen, sig, pubkey,
+                                    bootutil_keys[key_id].ed25519_table);
+    } else
+#endif
     rc = ED25519_verify(msg, mlen, sig, pubkey);
 
     if (rc == 0) {
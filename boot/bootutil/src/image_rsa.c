@@ -115,36 +115,18 @@ pss_mgf1(uint8_t *mask, const uint8_t *hash)
 }
 
 /*
- * Validate an RSA signature, using RSA-PSS, as described in PKCS #1
- * v2.2, section 9.1.2, with many parameters required to have fixed
- * values. RSASSA-PSS-VERIFY RFC8017 section 8.1.2
+ * Check the encoded message em = sig^E mod N of an RSA-PSS signature of
+ * hash, whose length is PSS_HLEN.
  */
 static fih_ret
-bootutil_cmp_rsasig(bootutil_rsa_context *ctx, uint8_t *hash, uint32_t hlen,
-  uint8_t *sig, size_t slen)
+bootutil_cmp_pss(const uint8_t *em, const uint8_t *hash)
 {
     bootutil_sha_context shactx;
-    uint8_t em[MBEDTLS_MPI_MAX_SIZE];
     uint8_t db_mask[PSS_MASK_LEN];
     uint8_t h2[PSS_HLEN];
     int i;
     FIH_DECLARE(fih_rc, FIH_FAILURE);
 
-    /* The caller has already verified that slen == bootutil_rsa_get_len(ctx) */
-    if (slen != PSS_EMLEN ||
-        PSS_EMLEN > MBEDTLS_MPI_MAX_SIZE) {
-        goto out;
-    }
-
-    if (hlen != PSS_HLEN) {
-        goto out;
-    }
-
-    /* Apply RSAVP1 to produce em = sig^E mod N using the public key */
-    if (bootutil_rsa_public(ctx, sig, em)) {
-        goto out;
-    }
-
     /*
      * PKCS #1 v2.2, 9.1.2 EMSA-PSS-Verify
      *
@@ -238,8 +220,239 @@ out:
     FIH_RET(fih_rc);
 }
 
+/*
+ * Validate an RSA signature, using RSA-PSS, as described in PKCS #1
+ * v2.2, section 9.1.2, with many parameters required to have fixed
+ * values. RSASSA-PSS-VERIFY RFC8017 section 8.1.2
+ */
+static fih_ret
+bootutil_cmp_rsasig(bootutil_rsa_context *ctx, uint8_t *hash, uint32_t hlen,
+  uint8_t *sig, size_t slen)
+{
+    uint8_t em[MBEDTLS_MPI_MAX_SIZE];
+    FIH_DECLARE(fih_rc, FIH_FAILURE);
+
+    /* The caller has already verified that slen == bootutil_rsa_get_len(ctx) */
+    if (slen != PSS_EMLEN ||
+        PSS_EMLEN > MBEDTLS_MPI_MAX_SIZE) {
+        goto out;
+    }
+
+    if (hlen != PSS_HLEN) {
+        goto out;
+    }
+
+    /* Apply RSAVP1 to produce em = sig^E mod N using the public key */
+    if (bootutil_rsa_public(ctx, sig, em)) {
+        goto out;
+    }
+
+    FIH_CALL(bootutil_cmp_pss, fih_rc, em, hash);
+
+out:
+    FIH_RET(fih_rc);
+}
+
+#if defined(MCUBOOT_RSA_PRECOMP_TABLES)
+/*
+ * Lean RSAVP1 for keys with a table precomputed at build time by
+ * `imgtool getpub --with-table`, holding as 32-bit words, least
+ * significant first:
+ * - the modulus N, RSA_WORDS words,
+ * - R^2 mod N, with R = 2^MCUBOOT_SIGN_RSA_LEN, RSA_WORDS words,
+ * - -N^-1 mod 2^32, one word.
+ * The public exponent must be 65537, the only one imgtool generates, so
+ * that sig^E mod N takes 19 Montgomery multiplications, without parsing
+ * the key nor setting up Montgomery constants.
+ */
+#define RSA_WORDS (MCUBOOT_SIGN_RSA_LEN / 32)
+#define RSA_TABLE_RR     RSA_WORDS
+#define RSA_TABLE_N0INV  (2 * RSA_WORDS)
+
+/* r = a * b / R mod N, with a and b less than N. r may alias a or b. */
+static void
+bootutil_rsa_mont_mul(uint32_t *r, const uint32_t *a, const uint32_t *b,
+                      const unsigned int *table)
+{
+    uint32_t t[RSA_WORDS + 2];
+    uint64_t c;
+    uint32_t m;
+    uint32_t borrow;
+    int i;
+    int j;
+
+    memset(t, 0, sizeof(t));
+    for (i = 0; i < RSA_WORDS; i++) {
+        /* t += a * b[i] */
+        c = 0;
+        for (j = 0; j < RSA_WORDS; j++) {
+            c += (uint64_t)a[j] * b[i] + t[j];
+            t[j] = (uint32_t)c;
+            c >>= 32;
+        }
+        c += t[RSA_WORDS];
+        t[RSA_WORDS] = (uint32_t)c;
+        t[RSA_WORDS + 1] = (uint32_t)(c >> 32);
+
+        /* t = (t + m * N) / 2^32, m making the division exact */
+        m = t[0] * (uint32_t)table[RSA_TABLE_N0INV];
+        c = ((uint64_t)m * table[0] + t[0]) >> 32;
+        for (j = 1; j < RSA_WORDS; j++) {
+            c += (uint64_t)m * table[j] + t[j];
+            t[j - 1] = (uint32_t)c;
+            c >>= 32;
+        }
+        c += t[RSA_WORDS];
+        t[RSA_WORDS - 1] = (uint32_t)c;
+        t[RSA_WORDS] = t[RSA_WORDS + 1] + (uint32_t)(c >> 32);
+    }
+
+    /* t < 2N, subtract N if t >= N */
+    borrow = 0;
+    for (j = 0; j < RSA_WORDS; j++) {
+        c = (uint64_t)t[j] - table[j] - borrow;
+        r[j] = (uint32_t)c;
+        borrow = (uint32_t)(c >> 32) & 1;
+    }
+    if (borrow > t[RSA_WORDS]) {
+        memcpy(r, t, RSA_WORDS * sizeof(uint32_t));
+    }
+}
+
+/* em = sig^65537 mod N, both big-endian. */
+static int
+bootutil_rsa_public_table(const unsigned int *table, const uint8_t *sig,
+                          uint8_t *em)
+{
+    uint32_t s[RSA_WORDS];
+    uint32_t x[RSA_WORDS];
+    uint32_t y[RSA_WORDS];
+    int i;
+
+    /* The table must hold a MCUBOOT_SIGN_RSA_LEN bit odd modulus. */
+    if ((table[RSA_WORDS - 1] & 0x80000000) == 0 || (table[0] & 1) == 0) {
+        return -1;
+    }
+
+    for (i = 0; i < RSA_WORDS; i++) {
+        s[RSA_WORDS - 1 - i] = ((uint32_t)sig[4 * i] << 24) |
+                               ((uint32_t)sig[4 * i + 1] << 16) |
+                               ((uint32_t)sig[4 * i + 2] << 8) |
+                               sig[4 * i + 3];
+    }
+
+    /* The signature representative must be less than N. */
+    for (i = RSA_WORDS - 1; i >= 0; i--) {
+        if (s[i] != table[i]) {
+            break;
+        }
+    }
+    if (i < 0 || s[i] > table[i]) {
+        return -1;
+    }
+
+    for (i = 0; i < RSA_WORDS; i++) {
+        y[i] = table[RSA_TABLE_RR + i];
+    }
+    bootutil_rsa_mont_mul(x, s, y, table);      /* x = s * R */
+    memcpy(y, x, sizeof(y));
+    for (i = 0; i < 16; i++) {
+        bootutil_rsa_mont_mul(y, y, y, table);  /* y = s^(2^16) * R */
+    }
+    bootutil_rsa_mont_mul(y, y, x, table);      /* y = s^65537 * R */
+    memset(x, 0, sizeof(x));
+    x[0] = 1;
+    bootutil_rsa_mont_mul(y, y, x, table);      /* y = s^65537 */
+
+    for (i = 0; i < RSA_WORDS; i++) {
+        em[4 * i] = (uint8_t)(y[RSA_WORDS - 1 - i] >> 24);
+        em[4 * i + 1] = (uint8_t)(y[RSA_WORDS - 1 - i] >> 16);
+        em[4 * i + 2] = (uint8_t)(y[RSA_WORDS - 1 - i] >> 8);
+        em[4 * i + 3] = (uint8_t)y[RSA_WORDS - 1 - i];
+    }
+
+    return 0;
+}
+
+/*
+ * Check that the table was generated for the DER encoded public key it comes
+ * with: the modulus must be the same and the public exponent 65537.
+ */
+static int
+bootutil_rsa_table_check(const unsigned int *table, uint8_t *cp, uint8_t *end)
+{
+    size_t len;
+    int exp;
+    int i;
+
+    if (mbedtls_asn1_get_tag(&cp, end, &len,
+                             MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE) ||
+        mbedtls_asn1_get_tag(&cp, end, &len, MBEDTLS_ASN1_INTEGER)) {
+        return -1;
+    }
+
+    /* Skip the sign byte of the modulus. */
+    if (len == PSS_EMLEN + 1 && *cp == 0) {
+        cp++;
+        len--;
+    }
+    if (len != PSS_EMLEN) {
+        return -1;
+    }
+
+    for (i = 0; i < RSA_WORDS; i++) {
+        if (table[RSA_WORDS - 1 - i] != (((uint32_t)cp[4 * i] << 24) |
+                                         ((uint32_t)cp[4 * i + 1] << 16) |
+                                         ((uint32_t)cp[4 * i + 2] << 8) |
+                                         cp[4 * i + 3])) {
+            return -1;
+        }
+    }
+    cp += len;
+
+    if (mbedtls_asn1_get_int(&cp, end, &exp) || exp != 65537) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Same as bootutil_cmp_rsasig(), for a key with a precomputed table. */
+static fih_ret
+bootutil_cmp_rsasig_table(uint8_t key_id, uint8_t *hash, uint32_t hlen,
+  uint8_t *sig, size_t slen)
+{
+    const unsigned int *table = bootutil_keys[key_id].rsa_table;
+    uint8_t *cp = (uint8_t *)bootutil_keys[key_id].key;
+    uint8_t em[PSS_EMLEN];
+    FIH_DECLARE(fih_rc, FIH_FAILURE);
+
+    if (slen != PSS_EMLEN || hlen != PSS_HLEN) {
+        goto out;
+    }
+
+    if (bootutil_rsa_table_check(table, cp, cp + *bootutil_keys[key_id].len)) {
+        BOOT_LOG_ERR("RSA key %d: table does not match the key", key_id);
+        goto out;
+    }
+
+    if (bootutil_rsa_public_table(table, sig, em)) {
+        goto out;
+    }
+
+    FIH_CALL(bootutil_cmp_pss, fih_rc, em, hash);
+
+out:
+    FIH_RET(fih_rc);
+}
+#endif /* MCUBOOT_RSA_PRECOMP_TABLES */
+
 #else /* MCUBOOT_USE_PSA_CRYPTO */
 
+#if defined(MCUBOOT_RSA_PRECOMP_TABLES)
+#error "MCUBOOT_RSA_PRECOMP_TABLES is not supported with PSA Crypto"
+#endif
+
 static fih_ret
 bootutil_cmp_rsasig(bootutil_rsa_context *ctx, uint8_t *hash, uint32_t hlen,
   uint8_t *sig, size_t slen)
@@ -272,6 +485,14 @@ bootutil_verify_sig(uint8_t *hash, uint32_t hlen, uint8_t *sig, size_t slen,
 
     BOOT_LOG_DBG("bootutil_verify_sig: RSA key_id %d", key_id);
 
+#if defined(MCUBOOT_RSA_PRECOMP_TABLES)
+    if (bootutil_keys[key_id].rsa_table != NULL) {
+        FIH_CALL(bootutil_cmp_rsasig_table, fih_rc, key_id, hash, hlen,
+                 sig, slen);
+        FIH_RET(fih_rc);
+    }
+#endif
+
     bootutil_rsa_init(&ctx);
 
     cp = (uint8_t *)bootutil_keys[key_id].key;
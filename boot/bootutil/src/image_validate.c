@@ -54,6 +54,9 @@ BOOT_LOG_MODULE_DECLARE(mcuboot);
 #include "bootutil/enc_key.h"
 #endif
 #include "bootutil_priv.h"
+#ifdef MCUBOOT_DECOMPRESS_IMAGES
+#include "bootutil_decompress.h"
+#endif
 
 /*
  * Currently, we only support being able to verify one type of
@@ -194,15 +197,15 @@ static const uint16_t allowed_unprot_tlvs[] = {
 #endif
 
 /*
- * Verify the integrity of the image.
+ * Verify the integrity of the image. If `digest` is not NULL, it is taken as
+ * the hash of the image instead of hashing the image from flash.
  * Return non-zero if image could not be validated/does not validate.
  */
-fih_ret
-bootutil_img_validate(struct boot_loader_state *state,
-                      struct image_header *hdr, const struct flash_area *fap,
-                      uint8_t *tmp_buf, uint32_t tmp_buf_sz, uint8_t *seed,
-                      int seed_len, uint8_t *out_hash
-                     )
+static fih_ret
+bootutil_img_validate_common(struct boot_loader_state *state,
+                             struct image_header *hdr, const struct flash_area *fap,
+                             uint8_t *tmp_buf, uint32_t tmp_buf_sz, uint8_t *seed,
+                             int seed_len, uint8_t *out_hash, const uint8_t *digest)
 {
 #if (defined(EXPECTED_KEY_TLV) && defined(MCUBOOT_HW_KEY)) || \
     (defined(EXPECTED_SIG_TLV) && defined(MCUBOOT_BUILTIN_KEY)) || \
@@ -256,9 +259,13 @@ bootutil_img_validate(struct boot_loader_state *state,
     BOOT_LOG_DBG("bootutil_img_validate: flash area %p", fap);
 
 #if defined(EXPECTED_HASH_TLV) && !defined(MCUBOOT_SIGN_PURE)
-    rc = bootutil_img_hash(state, hdr, fap, tmp_buf, tmp_buf_sz, hash, seed, seed_len);
-    if (rc) {
-        goto out;
+    if (digest != NULL) {
+        memcpy(hash, digest, IMAGE_HASH_SIZE);
+    } else {
+        rc = bootutil_img_hash(state, hdr, fap, tmp_buf, tmp_buf_sz, hash, seed, seed_len);
+        if (rc) {
+            goto out;
+        }
     }
 
     if (out_hash) {
@@ -283,7 +290,7 @@ bootutil_img_validate(struct boot_loader_state *state,
     }
 #endif
 
-    rc = bootutil_tlv_iter_begin(&it, hdr, fap, IMAGE_TLV_ANY, false);
+    rc = boot_tlv_iter_begin(state, &it, hdr, fap, IMAGE_TLV_ANY, false);
     if (rc) {
         BOOT_LOG_DBG("bootutil_img_validate: TLV iteration failed %d", rc);
         goto out;
@@ -589,3 +596,190 @@ out:
 
     FIH_RET(fih_rc);
 }
+
+/*
+ * Verify the integrity of the image.
+ * Return non-zero if image could not be validated/does not validate.
+ */
+fih_ret
+bootutil_img_validate(struct boot_loader_state *state,
+                      struct image_header *hdr, const struct flash_area *fap,
+                      uint8_t *tmp_buf, uint32_t tmp_buf_sz, uint8_t *seed,
+                      int seed_len, uint8_t *out_hash
+                     )
+{
+    FIH_DECLARE(fih_rc, FIH_FAILURE);
+
+    FIH_CALL(bootutil_img_validate_common, fih_rc, state, hdr, fap, tmp_buf,
+             tmp_buf_sz, seed, seed_len, out_hash, NULL);
+
+    FIH_RET(fih_rc);
+}
+
+#if defined(MCUBOOT_VALIDATION_CACHE) || defined(MCUBOOT_HASH_IMAGE_COPY) || \
+    defined(MCUBOOT_SERIAL_UPLOAD_HASH)
+/*
+ * Verify the image as bootutil_img_validate() does, but take `digest` as its
+ * hash instead of hashing it from flash: the digest must match the image
+ * hash TLV and the signatures and other TLV checks must pass.
+ * Return non-zero if image does not validate.
+ */
+fih_ret
+bootutil_img_validate_digest(struct boot_loader_state *state,
+                             struct image_header *hdr, const struct flash_area *fap,
+                             const uint8_t *digest)
+{
+    FIH_DECLARE(fih_rc, FIH_FAILURE);
+
+    FIH_CALL(bootutil_img_validate_common, fih_rc, state, hdr, fap, NULL, 0,
+             NULL, 0, NULL, digest);
+
+    FIH_RET(fih_rc);
+}
+#endif /* MCUBOOT_VALIDATION_CACHE || MCUBOOT_HASH_IMAGE_COPY || MCUBOOT_SERIAL_UPLOAD_HASH */
+
+#ifdef MCUBOOT_DECOMPRESS_IMAGES
+/*
+ * Verify the hash of a decompressed image against the decompressed image
+ * hash and signature TLVs of the compressed image it was produced from.
+ * Return non-zero if the hash does not match or the signature is invalid.
+ */
+fih_ret
+bootutil_img_validate_decomp(struct boot_loader_state *state,
+                             struct image_header *hdr, const struct flash_area *fap,
+                             uint8_t *hash)
+{
+#if (defined(EXPECTED_KEY_TLV) && defined(MCUBOOT_HW_KEY)) || \
+    (defined(EXPECTED_SIG_TLV) && defined(MCUBOOT_BUILTIN_KEY))
+    int image_index = (state == NULL ? 0 : BOOT_CURR_IMG(state));
+#endif
+    uint32_t off;
+    uint16_t len;
+    uint16_t type;
+#ifdef EXPECTED_SIG_TLV
+    FIH_DECLARE(valid_signature, FIH_FAILURE);
+#ifndef MCUBOOT_BUILTIN_KEY
+    int key_id = -1;
+#else
+    int key_id = image_index;
+#endif /* !MCUBOOT_BUILTIN_KEY */
+#ifdef MCUBOOT_HW_KEY
+    uint8_t key_buf[KEY_BUF_SIZE];
+#endif
+#endif /* EXPECTED_SIG_TLV */
+    struct image_tlv_iter it;
+    uint8_t buf[SIG_BUF_SIZE];
+    int image_hash_valid = 0;
+    int rc = 0;
+    FIH_DECLARE(fih_rc, FIH_FAILURE);
+
+    (void)state;
+
+#ifdef EXPECTED_KEY_TLV
+    /*
+     * The key TLV lives in the unprotected area, after the decompressed image
+     * signature, so look it up first.
+     */
+    rc = boot_tlv_iter_begin(state, &it, hdr, fap, EXPECTED_KEY_TLV, false);
+    if (rc) {
+        goto out;
+    }
+
+    rc = bootutil_tlv_iter_next(&it, &off, &len, NULL);
+    if (rc) {
+        rc = -1;
+        goto out;
+    }
+
+    if (len > KEY_BUF_SIZE) {
+        rc = -1;
+        goto out;
+    }
+#ifndef MCUBOOT_HW_KEY
+    rc = LOAD_IMAGE_DATA(hdr, fap, off, buf, len);
+    if (rc) {
+        goto out;
+    }
+    key_id = bootutil_find_key(buf, len);
+#else
+    rc = LOAD_IMAGE_DATA(hdr, fap, off, key_buf, len);
+    if (rc) {
+        goto out;
+    }
+    key_id = bootutil_find_key(image_index, key_buf, len);
+#endif /* !MCUBOOT_HW_KEY */
+#endif /* EXPECTED_KEY_TLV */
+
+    /* Both TLVs must be in the protected area, covered by the image signature. */
+    rc = boot_tlv_iter_begin(state, &it, hdr, fap, IMAGE_TLV_ANY, true);
+    if (rc) {
+        goto out;
+    }
+
+    while (true) {
+        rc = bootutil_tlv_iter_next(&it, &off, &len, &type);
+        if (rc < 0) {
+            goto out;
+        } else if (rc > 0) {
+            break;
+        }
+
+        switch(type) {
+        case IMAGE_TLV_DECOMP_SHA:
+        {
+            if (len != IMAGE_HASH_SIZE) {
+                rc = -1;
+                goto out;
+            }
+            rc = LOAD_IMAGE_DATA(hdr, fap, off, buf, IMAGE_HASH_SIZE);
+            if (rc) {
+                goto out;
+            }
+
+            FIH_CALL(boot_fih_memequal, fih_rc, hash, buf, IMAGE_HASH_SIZE);
+            if (FIH_NOT_EQ(fih_rc, FIH_SUCCESS)) {
+                FIH_SET(fih_rc, FIH_FAILURE);
+                goto out;
+            }
+
+            image_hash_valid = 1;
+            break;
+        }
+#ifdef EXPECTED_SIG_TLV
+        case IMAGE_TLV_DECOMP_SIGNATURE:
+        {
+            if (key_id < 0 || key_id >= bootutil_key_cnt) {
+                continue;
+            }
+            if (!EXPECTED_SIG_LEN(len) || len > sizeof(buf)) {
+                rc = -1;
+                goto out;
+            }
+            rc = LOAD_IMAGE_DATA(hdr, fap, off, buf, len);
+            if (rc) {
+                goto out;
+            }
+            FIH_CALL(bootutil_verify_sig, valid_signature, hash, IMAGE_HASH_SIZE,
+                                                           buf, len, key_id);
+            break;
+        }
+#endif /* EXPECTED_SIG_TLV */
+        }
+    }
+
+    rc = !image_hash_valid;
+    if (rc) {
+        goto out;
+    }
+#ifdef EXPECTED_SIG_TLV
+    FIH_SET(fih_rc, valid_signature);
+#endif
+
+out:
+    if (rc) {
+        FIH_SET(fih_rc, FIH_FAILURE);
+    }
+
+    FIH_RET(fih_rc);
+}
+#endif /* MCUBOOT_DECOMPRESS_IMAGES */
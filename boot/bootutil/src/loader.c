@@ -55,6 +55,10 @@
 #include "bootutil/enc_key.h"
 #endif
 
+#ifdef MCUBOOT_DECOMPRESS_IMAGES
+#include "bootutil_decompress.h"
+#endif
+
 #if !defined(MCUBOOT_DIRECT_XIP) && !defined(MCUBOOT_RAM_LOAD)
 #include <os/os_malloc.h>
 #endif
@@ -313,7 +317,7 @@ boot_verify_slot_dependencies(struct boot_loader_state *state, uint32_t slot)
     it.start_off = boot_get_state_secondary_offset(state, fap);
 #endif
 
-    rc = bootutil_tlv_iter_begin(&it, boot_img_hdr(state, slot), fap,
+    rc = boot_tlv_iter_begin(state, &it, boot_img_hdr(state, slot), fap,
             IMAGE_TLV_DEPENDENCY, true);
     if (rc != 0) {
         goto done;
@@ -573,7 +577,7 @@ boot_validate_slot(struct boot_loader_state *state, int slot,
 
 #if defined(MCUBOOT_SWAP_USING_MOVE)
             if (bs->swap_type == BOOT_SWAP_TYPE_REVERT ||
-                boot_swap_type_multi(BOOT_CURR_IMG(state)) == BOOT_SWAP_TYPE_REVERT) {
+                boot_swap_type_state(state) == BOOT_SWAP_TYPE_REVERT) {
                 const struct flash_area *fap_pri = BOOT_IMG_AREA(state, BOOT_SLOT_PRIMARY);
 
                 assert(fap_pri != NULL);
@@ -731,7 +735,7 @@ boot_validated_swap_type(struct boot_loader_state *state,
     int swap_type;
     FIH_DECLARE(fih_rc, FIH_FAILURE);
 
-    swap_type = boot_swap_type_multi(BOOT_CURR_IMG(state));
+    swap_type = boot_swap_type_state(state);
     if (BOOT_IS_UPGRADE(swap_type)) {
         /* Boot loader wants to switch to the secondary slot.
          * Ensure image is valid.
@@ -766,34 +770,39 @@ static void like_mbedtls_zeroize(void *p, size_t n)
 }
 #endif
 
+#ifdef MCUBOOT_HASH_IMAGE_COPY
+/*
+ * Feeds `len` bytes written at offset `off` of the destination into `hash`.
+ * Only the header, image and protected TLVs are hashed, and only when written
+ * in order; a gap leaves the hash incomplete.
+ */
+static void
+boot_copy_hash_update(struct boot_copy_hash *hash, uint32_t off, const uint8_t *buf,
+                      uint32_t len)
+{
+    if (hash != NULL && off == hash->off && hash->off < hash->len) {
+        if (len > hash->len - hash->off) {
+            len = hash->len - hash->off;
+        }
+        bootutil_sha_update(&hash->sha, buf, len);
+        hash->off += len;
+    }
+}
+#endif
+
 /**
- * Copies the contents of one flash region to another.  You must erase the
- * destination region prior to calling this function.
- *
- * @param flash_area_id_src     The ID of the source flash area.
- * @param flash_area_id_dst     The ID of the destination flash area.
- * @param off_src               The offset within the source flash area to
- *                                  copy from.
- * @param off_dst               The offset within the destination flash area to
- *                                  copy to.
- * @param sz                    The number of bytes to copy.
- * @param sector_off            (Swap using offset with encryption only) the
- *                                  sector offset for encryption/decryption
+ * Copies the contents of one flash region to another, see boot_copy_region().
  *
- * @return                      0 on success; nonzero on failure.
+ * @param hash                  If not NULL, hash of the data as it is written
+ *                                  to the destination (only with
+ *                                  MCUBOOT_HASH_IMAGE_COPY).
  */
-int
-#if defined(MCUBOOT_SWAP_USING_OFFSET) && defined(MCUBOOT_ENC_IMAGES)
-boot_copy_region(struct boot_loader_state *state,
-                 const struct flash_area *fap_src,
-                 const struct flash_area *fap_dst,
-                 uint32_t off_src, uint32_t off_dst, uint32_t sz, uint32_t sector_off)
-#else
-boot_copy_region(struct boot_loader_state *state,
-                 const struct flash_area *fap_src,
-                 const struct flash_area *fap_dst,
-                 uint32_t off_src, uint32_t off_dst, uint32_t sz)
-#endif
+static int
+boot_copy_region_common(struct boot_loader_state *state,
+                        const struct flash_area *fap_src,
+                        const struct flash_area *fap_dst,
+                        uint32_t off_src, uint32_t off_dst, uint32_t sz,
+                        uint32_t sector_off, struct boot_copy_hash *hash)
 {
     uint32_t bytes_copied;
     int chunk_sz;
@@ -820,9 +829,17 @@ boot_copy_region(struct boot_loader_state *state,
 #else
     (void)state;
 #endif
+#if !defined(MCUBOOT_SWAP_USING_OFFSET) || !defined(MCUBOOT_ENC_IMAGES)
+    (void)sector_off;
+#endif
+#ifndef MCUBOOT_HASH_IMAGE_COPY
+    (void)hash;
+#endif
 
     TARGET_STATIC uint8_t buf[BUF_SZ] __attribute__((aligned(4)));
 
+    BOOT_SWAP_STATE_INVALIDATE();
+
 #ifdef MCUBOOT_ENC_IMAGES
     encrypted_src = (flash_area_get_id(fap_src) != FLASH_AREA_IMAGE_PRIMARY(image_index));
     encrypted_dst = (flash_area_get_id(fap_dst) != FLASH_AREA_IMAGE_PRIMARY(image_index));
@@ -908,6 +925,10 @@ boot_copy_region(struct boot_loader_state *state,
         }
 #endif
 
+#ifdef MCUBOOT_HASH_IMAGE_COPY
+        boot_copy_hash_update(hash, off_dst + bytes_copied, buf, chunk_sz);
+#endif
+
         rc = flash_area_write(fap_dst, off_dst + bytes_copied, buf, chunk_sz);
         if (rc != 0) {
             return BOOT_EFLASH;
@@ -921,6 +942,186 @@ boot_copy_region(struct boot_loader_state *state,
     return 0;
 }
 
+/**
+ * Copies the contents of one flash region to another.  You must erase the
+ * destination region prior to calling this function.
+ *
+ * @param flash_area_id_src     The ID of the source flash area.
+ * @param flash_area_id_dst     The ID of the destination flash area.
+ * @param off_src               The offset within the source flash area to
+ *                                  copy from.
+ * @param off_dst               The offset within the destination flash area to
+ *                                  copy to.
+ * @param sz                    The number of bytes to copy.
+ * @param sector_off            (Swap using offset with encryption only) the
+ *                                  sector offset for encryption/decryption
+ *
+ * @return                      0 on success; nonzero on failure.
+ */
+int
+#if defined(MCUBOOT_SWAP_USING_OFFSET) && defined(MCUBOOT_ENC_IMAGES)
+boot_copy_region(struct boot_loader_state *state,
+                 const struct flash_area *fap_src,
+                 const struct flash_area *fap_dst,
+                 uint32_t off_src, uint32_t off_dst, uint32_t sz, uint32_t sector_off)
+{
+    return boot_copy_region_common(state, fap_src, fap_dst, off_src, off_dst, sz,
+                                   sector_off, NULL);
+}
+#else
+boot_copy_region(struct boot_loader_state *state,
+                 const struct flash_area *fap_src,
+                 const struct flash_area *fap_dst,
+                 uint32_t off_src, uint32_t off_dst, uint32_t sz)
+{
+    return boot_copy_region_common(state, fap_src, fap_dst, off_src, off_dst, sz,
+                                   0, NULL);
+}
+#endif
+
+#ifdef MCUBOOT_HASH_IMAGE_COPY
+/**
+ * Starts hashing the image described by `hdr` as it gets copied to the start
+ * of a slot by boot_copy_region_hash().
+ */
+void
+boot_copy_hash_start(struct boot_copy_hash *hash, const struct image_header *hdr)
+{
+    hash->len = hdr->ih_hdr_size + hdr->ih_img_size + hdr->ih_protect_tlv_size;
+    hash->off = 0;
+    bootutil_sha_init(&hash->sha);
+}
+
+/**
+ * Completes a hash started by boot_copy_hash_start().
+ *
+ * @param digest                Buffer of IMAGE_HASH_SIZE bytes for the
+ *                                  digest.
+ *
+ * @return                      0 if the whole image was hashed; nonzero
+ *                                  otherwise.
+ */
+int
+boot_copy_hash_finish(struct boot_copy_hash *hash, uint8_t *digest)
+{
+    int rc = -1;
+
+    /* The crypto backends do not agree on what bootutil_sha_finish()
+     * returns, so, as elsewhere, it is not checked.
+     */
+    if (hash->off == hash->len) {
+        bootutil_sha_finish(&hash->sha, digest);
+        rc = 0;
+    }
+    bootutil_sha_drop(&hash->sha);
+
+    return rc;
+}
+
+/**
+ * Same as boot_copy_region(), also feeding the data written to the
+ * destination into `hash` (may be NULL).
+ */
+int
+boot_copy_region_hash(struct boot_loader_state *state,
+                      const struct flash_area *fap_src,
+                      const struct flash_area *fap_dst,
+                      uint32_t off_src, uint32_t off_dst, uint32_t sz,
+                      uint32_t sector_off, struct boot_copy_hash *hash)
+{
+    return boot_copy_region_common(state, fap_src, fap_dst, off_src, off_dst, sz,
+                                   sector_off, hash);
+}
+#endif
+
+#ifdef MCUBOOT_SWAP_SKIP_UNCHANGED
+#if !defined(MCUBOOT_SWAP_USING_MOVE) && !defined(MCUBOOT_SWAP_USING_OFFSET)
+#error "MCUBOOT_SWAP_SKIP_UNCHANGED requires swap-move or swap-offset upgrades"
+#endif
+
+/**
+ * Checks whether copying a flash region with boot_copy_region() would leave
+ * the destination unchanged, so that erasing and copying it can be skipped.
+ * Copies that encrypt or decrypt the data are never reported as unchanged.
+ *
+ * @param hash                  If not NULL and the region is unchanged, the
+ *                                  destination data is fed into it as
+ *                                  boot_copy_region_hash() would have done
+ *                                  (only with MCUBOOT_HASH_IMAGE_COPY).
+ *
+ * @return                      true if the destination already holds the
+ *                                  data that would be copied; false otherwise.
+ */
+bool
+boot_copy_region_unchanged(struct boot_loader_state *state,
+                           const struct flash_area *fap_src,
+                           const struct flash_area *fap_dst,
+                           uint32_t off_src, uint32_t off_dst, uint32_t sz,
+                           struct boot_copy_hash *hash)
+{
+    uint32_t off;
+    uint32_t chunk_sz;
+#ifdef MCUBOOT_ENC_IMAGES
+    uint8_t image_index = BOOT_CURR_IMG(state);
+    bool encrypted_src;
+    bool encrypted_dst;
+#else
+    (void)state;
+#endif
+#ifndef MCUBOOT_HASH_IMAGE_COPY
+    (void)hash;
+#endif
+
+    TARGET_STATIC uint8_t buf[2][BUF_SZ / 2] __attribute__((aligned(4)));
+
+#ifdef MCUBOOT_ENC_IMAGES
+    encrypted_src = (flash_area_get_id(fap_src) != FLASH_AREA_IMAGE_PRIMARY(image_index));
+    encrypted_dst = (flash_area_get_id(fap_dst) != FLASH_AREA_IMAGE_PRIMARY(image_index));
+
+    if (encrypted_src != encrypted_dst &&
+        IS_ENCRYPTED(boot_img_hdr(state, encrypted_dst ? BOOT_SLOT_PRIMARY :
+                                                         BOOT_SLOT_SECONDARY))) {
+        return false;
+    }
+#endif
+
+    for (off = 0; off < sz; off += chunk_sz) {
+        chunk_sz = sz - off;
+        if (chunk_sz > sizeof(buf[0])) {
+            chunk_sz = sizeof(buf[0]);
+        }
+
+        if (flash_area_read(fap_src, off_src + off, buf[0], chunk_sz) != 0 ||
+            flash_area_read(fap_dst, off_dst + off, buf[1], chunk_sz) != 0 ||
+            memcmp(buf[0], buf[1], chunk_sz) != 0) {
+            return false;
+        }
+
+        MCUBOOT_WATCHDOG_FEED();
+    }
+
+#ifdef MCUBOOT_HASH_IMAGE_COPY
+    /* The data is only hashed once the whole region is known to match, as a
+     * mismatch leaves it to boot_copy_region_hash().
+     */
+    for (off = 0; hash != NULL && off < sz; off += chunk_sz) {
+        chunk_sz = sz - off;
+        if (chunk_sz > sizeof(buf[0])) {
+            chunk_sz = sizeof(buf[0]);
+        }
+
+        if (flash_area_read(fap_dst, off_dst + off, buf[0], chunk_sz) != 0) {
+            /* Leaves the hash incomplete */
+            break;
+        }
+        boot_copy_hash_update(hash, off_dst + off, buf[0], chunk_sz);
+    }
+#endif
+
+    return true;
+}
+#endif
+
 /**
  * Overwrite primary slot with the image contained in the secondary slot.
  * If a prior copy operation was interrupted by a system reset, this function
@@ -947,24 +1148,61 @@ boot_copy_image(struct boot_loader_state *state, struct boot_status *bs)
     const struct flash_area *fap_primary_slot;
     const struct flash_area *fap_secondary_slot;
     uint8_t image_index;
+#ifdef MCUBOOT_HW_ROLLBACK_PROT
+    int hdr_slot = BOOT_SLOT_SECONDARY;
+#endif
+#ifdef MCUBOOT_DECOMPRESS_IMAGES
+    bool decompress = IS_COMPRESSED(boot_img_hdr(state, BOOT_SLOT_SECONDARY));
+#ifdef MCUBOOT_DELTA_IMAGES
+    bool delta = IS_DELTA(boot_img_hdr(state, BOOT_SLOT_SECONDARY));
+#else
+    bool delta = false;
+#endif
+#endif
+#ifdef MCUBOOT_HASH_IMAGE_COPY
+    TARGET_STATIC struct boot_copy_hash copy_hash;
+    struct image_header *hdr;
+    FIH_DECLARE(fih_rc, FIH_FAILURE);
+#endif
 
 #if defined(MCUBOOT_OVERWRITE_ONLY_FAST)
     uint32_t sector;
     uint32_t trailer_sz;
     uint32_t off;
     uint32_t sz;
+#elif defined(MCUBOOT_VALIDATION_CACHE)
+    uint32_t records_off;
+    uint32_t tail_off;
 #endif
 
     (void)bs;
 
 #if defined(MCUBOOT_OVERWRITE_ONLY_FAST)
     uint32_t src_size = 0;
-    rc = boot_read_image_size(state, BOOT_SLOT_SECONDARY, &src_size);
+#ifdef MCUBOOT_DECOMPRESS_IMAGES
+    if (decompress) {
+        /* Only as much as the decompressed image needs is erased. */
+        rc = boot_decompress_image_size(state, BOOT_SLOT_SECONDARY, &src_size);
+    } else
+#endif
+    {
+        rc = boot_read_image_size(state, BOOT_SLOT_SECONDARY, &src_size);
+    }
     assert(rc == 0);
 #endif
 
     image_index = BOOT_CURR_IMG(state);
 
+#ifdef MCUBOOT_VALIDATION_CACHE
+    rc = boot_validation_cache_invalidate(image_index);
+    if (rc != 0) {
+        return rc;
+    }
+#endif
+#ifdef MCUBOOT_HASH_IMAGE_COPY
+    state->copy_hash[image_index].valid = false;
+#endif
+
     BOOT_LOG_INF("Image %d upgrade secondary slot -> primary slot", image_index);
     BOOT_LOG_INF("Erasing the primary slot");
 
@@ -975,6 +1213,12 @@ boot_copy_image(struct boot_loader_state *state, struct boot_status *bs)
     assert(fap_secondary_slot != NULL);
 
     sect_count = boot_img_num_sectors(state, BOOT_SLOT_PRIMARY);
+#ifdef MCUBOOT_DECOMPRESS_IMAGES
+    if (delta) {
+        /* A delta image is applied to the image in the primary slot. */
+        sect_count = 0;
+    }
+#endif
     for (sect = 0, size = 0; sect < sect_count; sect++) {
         this_size = boot_img_sector_size(state, BOOT_SLOT_PRIMARY, sect);
         rc = boot_erase_region(fap_primary_slot, size, this_size, false);
@@ -1012,6 +1256,17 @@ boot_copy_image(struct boot_loader_state *state, struct boot_status *bs)
     }
 #endif
 
+#if !defined(MCUBOOT_OVERWRITE_ONLY_FAST) && defined(MCUBOOT_VALIDATION_CACHE)
+    /* The whole slot is copied, but for the validation records of the
+     * secondary slot, which would leave no room for those of the new image.
+     */
+    records_off = boot_validation_cache_off(fap_primary_slot);
+    tail_off = records_off + BOOT_VALIDATION_CACHE_SIZE;
+    if (size > records_off) {
+        size = records_off;
+    }
+#endif
+
 #if defined(MCUBOOT_OVERWRITE_ONLY_FAST)
     trailer_sz = boot_trailer_sz(BOOT_WRITE_SZ(state));
     sector = boot_img_num_sectors(state, BOOT_SLOT_PRIMARY) - 1;
@@ -1041,16 +1296,100 @@ boot_copy_image(struct boot_loader_state *state, struct boot_status *bs)
     }
 #endif
 
-    BOOT_LOG_INF("Image %d copying the secondary slot to the primary slot: 0x%zx bytes",
-                 image_index, size);
+#ifdef MCUBOOT_DECOMPRESS_IMAGES
+#ifdef MCUBOOT_DELTA_IMAGES
+    if (delta) {
+        /* On failure, the primary slot is left for the validation to reject,
+         * or for the patch to be resumed on the next boot.
+         */
+        rc = boot_delta_image(state, fap_secondary_slot, fap_primary_slot);
+        if (rc != 0) {
+            return rc;
+        }
+    } else
+#endif
+    if (decompress) {
+        rc = boot_decompress_image(state, fap_secondary_slot, fap_primary_slot);
+        if (rc != 0) {
+            /* Never leave a partially written image behind. */
+            boot_scramble_slot(fap_primary_slot, BOOT_SLOT_PRIMARY);
+            return rc;
+        }
+    }
+
+    if (decompress || delta) {
+        /* The secondary slot header does not describe the primary slot image. */
+        BOOT_TLV_DIR_INVALIDATE(state, BOOT_SLOT_PRIMARY);
+        rc = boot_read_image_header(state, BOOT_SLOT_PRIMARY,
+                                    boot_img_hdr(state, BOOT_SLOT_PRIMARY), bs);
+        if (rc != 0) {
+            return rc;
+        }
+#ifdef MCUBOOT_HW_ROLLBACK_PROT
+        hdr_slot = BOOT_SLOT_PRIMARY;
+#endif
+    } else
+#endif
+    {
+        BOOT_LOG_INF("Image %d copying the secondary slot to the primary slot: 0x%zx bytes",
+                     image_index, size);
+#ifdef MCUBOOT_HASH_IMAGE_COPY
+        /* The image is hashed as it is written, so the primary slot can be
+         * certified without reading it back.
+         */
+        hdr = boot_img_hdr(state, BOOT_SLOT_SECONDARY);
+        boot_copy_hash_start(&copy_hash, hdr);
+
 #if defined(MCUBOOT_SWAP_USING_OFFSET)
-    rc = BOOT_COPY_REGION(state, fap_secondary_slot, fap_primary_slot,
-                          boot_img_sector_size(state, BOOT_SLOT_SECONDARY, 0), 0, size, 0);
+        rc = boot_copy_region_hash(state, fap_secondary_slot, fap_primary_slot,
+                                   boot_img_sector_size(state, BOOT_SLOT_SECONDARY, 0),
+                                   0, size, 0, &copy_hash);
 #else
-    rc = boot_copy_region(state, fap_secondary_slot, fap_primary_slot, 0, 0, size);
+        rc = boot_copy_region_hash(state, fap_secondary_slot, fap_primary_slot,
+                                   0, 0, size, 0, &copy_hash);
+#endif
+        if (boot_copy_hash_finish(&copy_hash, state->copy_hash[image_index].hash) != 0 &&
+            rc == 0) {
+            rc = BOOT_EBADIMAGE;
+        }
+        if (rc != 0) {
+            return rc;
+        }
+
+        /* Compare the digest of what was written with the hash TLV of the
+         * copied image, and check its signature, before the trailer is
+         * written.
+         */
+        FIH_CALL(bootutil_img_validate_digest, fih_rc, state, hdr, fap_primary_slot,
+                 state->copy_hash[image_index].hash);
+        if (FIH_NOT_EQ(fih_rc, FIH_SUCCESS)) {
+            BOOT_LOG_ERR("Image %d: copied image does not match its hash",
+                         image_index);
+            boot_scramble_slot(fap_primary_slot, BOOT_SLOT_PRIMARY);
+            return BOOT_EBADIMAGE;
+        }
+        state->copy_hash[image_index].valid = true;
+#else
+#if defined(MCUBOOT_SWAP_USING_OFFSET)
+        rc = BOOT_COPY_REGION(state, fap_secondary_slot, fap_primary_slot,
+                              boot_img_sector_size(state, BOOT_SLOT_SECONDARY, 0), 0, size, 0);
+#else
+        rc = boot_copy_region(state, fap_secondary_slot, fap_primary_slot, 0, 0, size);
+#endif
+        if (rc != 0) {
+            return rc;
+        }
+#endif /* MCUBOOT_HASH_IMAGE_COPY */
+
+#if !defined(MCUBOOT_OVERWRITE_ONLY_FAST) && defined(MCUBOOT_VALIDATION_CACHE)
+        if (size == records_off) {
+            rc = BOOT_COPY_REGION(state, fap_secondary_slot, fap_primary_slot, tail_off,
+                                  tail_off, flash_area_get_size(fap_primary_slot) - tail_off, 0);
+            if (rc != 0) {
+                return rc;
+            }
+        }
 #endif
-    if (rc != 0) {
-        return rc;
     }
 
 #if defined(MCUBOOT_OVERWRITE_ONLY_FAST)
@@ -1070,9 +1409,10 @@ boot_copy_image(struct boot_loader_state *state, struct boot_status *bs)
     /* Update the stored security counter with the new image's security counter
      * value. Both slots hold the new image at this point, but the secondary
      * slot's image header must be passed since the image headers in the
-     * boot_data structure have not been updated yet.
+     * boot_data structure have not been updated yet, unless the image was
+     * decompressed and the primary slot header already re-read.
      */
-    rc = boot_update_security_counter(state, BOOT_SLOT_PRIMARY, BOOT_SLOT_SECONDARY);
+    rc = boot_update_security_counter(state, BOOT_SLOT_PRIMARY, hdr_slot);
     if (rc != 0) {
         BOOT_LOG_ERR("Security counter update failed after image upgrade: %d", rc);
         return rc;
@@ -1094,11 +1434,23 @@ boot_copy_image(struct boot_loader_state *state, struct boot_status *bs)
 
     last_sector = boot_img_num_sectors(state, BOOT_SLOT_SECONDARY) - 1;
     BOOT_LOG_DBG("erasing secondary trailer");
-    rc = boot_scramble_region(fap_secondary_slot,
-                              boot_img_sector_off(state, BOOT_SLOT_SECONDARY,
-                                    last_sector),
-                              boot_img_sector_size(state, BOOT_SLOT_SECONDARY,
-                                    last_sector), false);
+#ifdef MCUBOOT_DECOMPRESS_IMAGES
+    if (delta) {
+        /* The patch progress is kept in the whole swap status area. */
+        uint32_t status_off = boot_status_off(fap_secondary_slot);
+
+        rc = boot_scramble_region(fap_secondary_slot, status_off,
+                                  flash_area_get_size(fap_secondary_slot) - status_off,
+                                  false);
+    } else
+#endif
+    {
+        rc = boot_scramble_region(fap_secondary_slot,
+                                  boot_img_sector_off(state, BOOT_SLOT_SECONDARY,
+                                        last_sector),
+                                  boot_img_sector_size(state, BOOT_SLOT_SECONDARY,
+                                        last_sector), false);
+    }
     assert(rc == 0);
 
     /* TODO: Perhaps verify the primary slot's signature again? */
@@ -1138,6 +1490,13 @@ boot_swap_image(struct boot_loader_state *state, struct boot_status *bs)
     size = copy_size = 0;
     image_index = BOOT_CURR_IMG(state);
 
+#ifdef MCUBOOT_VALIDATION_CACHE
+    rc = boot_validation_cache_invalidate(image_index);
+    if (rc != 0) {
+        return rc;
+    }
+#endif
+
     if (boot_status_is_reset(bs)) {
         /*
          * No swap ever happened, so need to find the largest image which
@@ -1612,12 +1971,9 @@ boot_update_hw_rollback_protection(struct boot_loader_state *state)
 {
 #ifdef MCUBOOT_HW_ROLLBACK_PROT
     int rc;
-    uint8_t image_index;
     struct boot_swap_state swap_state;
 
-    image_index = BOOT_CURR_IMG(state);
-
-    rc = boot_read_swap_state_by_id(FLASH_AREA_IMAGE_PRIMARY(image_index), &swap_state);
+    rc = boot_read_slot_swap_state(state, BOOT_SLOT_PRIMARY, &swap_state);
     if (rc != 0) {
         return rc;
     }
@@ -2193,7 +2549,7 @@ boot_select_or_erase(struct boot_loader_state *state)
     active_swap_state = &(state->slot_usage[BOOT_CURR_IMG(state)].swap_state);
 
     memset(active_swap_state, 0, sizeof(struct boot_swap_state));
-    rc = boot_read_swap_state(fap, active_swap_state);
+    rc = boot_read_slot_swap_state(state, active_slot, active_swap_state);
     assert(rc == 0);
 
     if (active_swap_state->magic != BOOT_MAGIC_GOOD ||
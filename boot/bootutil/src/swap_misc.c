@@ -154,6 +154,57 @@ swap_status_init(const struct boot_loader_state *state,
     return 0;
 }
 
+/*
+ * Size of the buffer through which status areas are read; it must hold at
+ * least one entry of the largest write size that fits a uint8_t.
+ */
+#define BOOT_STATUS_READ_SZ     256
+
+int
+swap_read_status_entries(const struct flash_area *fap, uint8_t write_sz,
+                         int entries, uint32_t *written)
+{
+    uint8_t buf[BOOT_STATUS_READ_SZ];
+    uint8_t erased_val;
+    uint32_t off;
+    int per_read;
+    int count;
+    int rc;
+    int i;
+    int j;
+
+    if (entries > BOOT_STATUS_BITMAP_WORDS * 32 || write_sz == 0) {
+        return BOOT_EBADARGS;
+    }
+
+    memset(written, 0, BOOT_STATUS_BITMAP_WORDS * sizeof(*written));
+    erased_val = flash_area_erased_val(fap);
+    off = boot_status_off(fap);
+    per_read = sizeof(buf) / write_sz;
+
+    for (i = 0; i < entries; i += count) {
+        count = entries - i;
+        if (count > per_read) {
+            count = per_read;
+        }
+
+        /* Only the first byte of the last entry is needed. */
+        rc = flash_area_read(fap, off + i * write_sz, buf,
+                             (count - 1) * write_sz + 1);
+        if (rc < 0) {
+            return BOOT_EFLASH;
+        }
+
+        for (j = 0; j < count; j++) {
+            if (buf[j * write_sz] != erased_val) {
+                written[(i + j) / 32] |= 1U << ((i + j) % 32);
+            }
+        }
+    }
+
+    return 0;
+}
+
 int
 swap_read_status(struct boot_loader_state *state, struct boot_status *bs)
 {
@@ -138,11 +138,9 @@ int
 swap_read_status_bytes(const struct flash_area *fap,
         struct boot_loader_state *state, struct boot_status *bs)
 {
-    uint32_t off;
-    uint8_t status;
+    uint32_t written[BOOT_STATUS_BITMAP_WORDS];
     int max_entries;
     int found_idx;
-    uint8_t write_sz;
     int move_entries;
     int rc;
     int last_rc;
@@ -154,19 +152,18 @@ swap_read_status_bytes(const struct flash_area *fap,
         return BOOT_EBADARGS;
     }
 
+    rc = swap_read_status_entries(fap, BOOT_WRITE_SZ(state), max_entries, written);
+    if (rc != 0) {
+        return rc;
+    }
+
     erased_sections = 0;
     found_idx = -1;
     /* skip erased sectors at the end */
     last_rc = 1;
-    write_sz = BOOT_WRITE_SZ(state);
-    off = boot_status_off(fap);
+    rc = 0;
     for (i = max_entries; i > 0; i--) {
-        rc = flash_area_read(fap, off + (i - 1) * write_sz, &status, 1);
-        if (rc < 0) {
-            return BOOT_EFLASH;
-        }
-
-        if (bootutil_buffer_is_erased(fap, &status, 1)) {
+        if (!swap_status_entry_written(written, i - 1)) {
             if (rc != last_rc) {
                 erased_sections++;
             }
@@ -314,22 +311,14 @@ swap_status_source(struct boot_loader_state *state)
     struct boot_swap_state state_primary_slot;
     struct boot_swap_state state_secondary_slot;
     int rc;
-    uint8_t image_index;
-
-#if (BOOT_IMAGE_NUMBER == 1)
-    (void)state;
-#endif
 
-    image_index = BOOT_CURR_IMG(state);
-
-    rc = boot_read_swap_state(state->imgs[image_index][BOOT_SLOT_PRIMARY].area,
-                              &state_primary_slot);
+    rc = boot_read_slot_swap_state(state, BOOT_SLOT_PRIMARY, &state_primary_slot);
     assert(rc == 0);
 
     BOOT_LOG_SWAP_STATE("Primary image", &state_primary_slot);
 
-    rc = boot_read_swap_state(state->imgs[image_index][BOOT_SLOT_SECONDARY].area,
-                              &state_secondary_slot);
+    rc = boot_read_slot_swap_state(state, BOOT_SLOT_SECONDARY,
+                                   &state_secondary_slot);
     assert(rc == 0);
 
     BOOT_LOG_SWAP_STATE("Secondary image", &state_secondary_slot);
@@ -384,11 +373,15 @@ boot_move_sector_up(int idx, uint32_t sz, struct boot_loader_state *state,
         assert(rc == 0);
     }
 
-    rc = boot_erase_region(fap_pri, new_off, sz, false);
-    assert(rc == 0);
+    if (boot_copy_region_unchanged(state, fap_pri, fap_pri, old_off, new_off, sz, NULL)) {
+        BOOT_LOG_DBG("Skipping move of unchanged primary 0x%x", new_off);
+    } else {
+        rc = boot_erase_region(fap_pri, new_off, sz, false);
+        assert(rc == 0);
 
-    rc = boot_copy_region(state, fap_pri, fap_pri, old_off, new_off, sz);
-    assert(rc == 0);
+        rc = boot_copy_region(state, fap_pri, fap_pri, old_off, new_off, sz);
+        assert(rc == 0);
+    }
 
     rc = boot_write_status(state, bs);
 
@@ -399,23 +392,35 @@ boot_move_sector_up(int idx, uint32_t sz, struct boot_loader_state *state,
 static void
 boot_swap_sectors(int idx, uint32_t sz, struct boot_loader_state *state,
         struct boot_status *bs, const struct flash_area *fap_pri,
-        const struct flash_area *fap_sec)
+        const struct flash_area *fap_sec, struct boot_copy_hash *hash)
 {
     uint32_t pri_off;
     uint32_t pri_up_off;
     uint32_t sec_off;
     int rc;
 
+#ifndef MCUBOOT_HASH_IMAGE_COPY
+    (void)hash;
+#endif
+
     pri_up_off = boot_img_sector_off(state, BOOT_SLOT_PRIMARY, idx);
     pri_off = boot_img_sector_off(state, BOOT_SLOT_PRIMARY, idx - 1);
     sec_off = boot_img_sector_off(state, BOOT_SLOT_SECONDARY, idx - 1);
 
     if (bs->state == BOOT_STATUS_STATE_0) {
-        rc = boot_erase_region(fap_pri, pri_off, sz, false);
-        assert(rc == 0);
+        if (boot_copy_region_unchanged(state, fap_sec, fap_pri, sec_off, pri_off, sz, hash)) {
+            BOOT_LOG_DBG("Skipping copy to unchanged primary 0x%x", pri_off);
+        } else {
+            rc = boot_erase_region(fap_pri, pri_off, sz, false);
+            assert(rc == 0);
 
-        rc = boot_copy_region(state, fap_sec, fap_pri, sec_off, pri_off, sz);
-        assert(rc == 0);
+#ifdef MCUBOOT_HASH_IMAGE_COPY
+            rc = boot_copy_region_hash(state, fap_sec, fap_pri, sec_off, pri_off, sz, 0, hash);
+#else
+            rc = boot_copy_region(state, fap_sec, fap_pri, sec_off, pri_off, sz);
+#endif
+            assert(rc == 0);
+        }
 
         rc = boot_write_status(state, bs);
         bs->state = BOOT_STATUS_STATE_1;
@@ -423,11 +428,15 @@ boot_swap_sectors(int idx, uint32_t sz, struct boot_loader_state *state,
     }
 
     if (bs->state == BOOT_STATUS_STATE_1) {
-        rc = boot_erase_region(fap_sec, sec_off, sz, false);
-        assert(rc == 0);
+        if (boot_copy_region_unchanged(state, fap_pri, fap_sec, pri_up_off, sec_off, sz, NULL)) {
+            BOOT_LOG_DBG("Skipping copy to unchanged secondary 0x%x", sec_off);
+        } else {
+            rc = boot_erase_region(fap_sec, sec_off, sz, false);
+            assert(rc == 0);
 
-        rc = boot_copy_region(state, fap_pri, fap_sec, pri_up_off, sec_off, sz);
-        assert(rc == 0);
+            rc = boot_copy_region(state, fap_pri, fap_sec, pri_up_off, sec_off, sz);
+            assert(rc == 0);
+        }
 
         rc = boot_write_status(state, bs);
         bs->idx++;
@@ -497,6 +506,10 @@ swap_run(struct boot_loader_state *state, struct boot_status *bs,
     uint32_t last_idx;
     const struct flash_area *fap_pri;
     const struct flash_area *fap_sec;
+#ifdef MCUBOOT_HASH_IMAGE_COPY
+    struct boot_copy_hash copy_hash;
+#endif
+    struct boot_copy_hash *hash = NULL;
 
     BOOT_LOG_INF("Starting swap using move algorithm.");
 
@@ -550,13 +563,29 @@ swap_run(struct boot_loader_state *state, struct boot_status *bs,
 
     bs->op = BOOT_STATUS_OP_SWAP;
 
+#ifdef MCUBOOT_HASH_IMAGE_COPY
+    /* Only a swap started from its first sector writes the whole image. */
+    state->copy_hash[BOOT_CURR_IMG(state)].valid = false;
+    if (bs->idx == BOOT_STATUS_IDX_0 && bs->state == BOOT_STATUS_STATE_0) {
+        boot_copy_hash_start(&copy_hash, boot_img_hdr(state, BOOT_SLOT_SECONDARY));
+        hash = &copy_hash;
+    }
+#endif
+
     idx = 1;
     while (idx <= last_idx) {
         if (idx >= bs->idx) {
-            boot_swap_sectors(idx, sector_sz, state, bs, fap_pri, fap_sec);
+            boot_swap_sectors(idx, sector_sz, state, bs, fap_pri, fap_sec, hash);
         }
         idx++;
     }
+
+#ifdef MCUBOOT_HASH_IMAGE_COPY
+    if (hash != NULL &&
+        boot_copy_hash_finish(hash, state->copy_hash[BOOT_CURR_IMG(state)].hash) == 0) {
+        state->copy_hash[BOOT_CURR_IMG(state)].valid = true;
+    }
+#endif
 }
 
 int app_max_size(struct boot_loader_state *state)
@@ -96,7 +96,7 @@ int boot_read_image_header(struct boot_loader_state *state, int slot,
         fap = BOOT_IMG_AREA(state, slot);
 
         if (slot == BOOT_SLOT_SECONDARY &&
-            boot_swap_type_multi(BOOT_CURR_IMG(state)) != BOOT_SWAP_TYPE_REVERT) {
+            boot_swap_type_state(state) != BOOT_SWAP_TYPE_REVERT) {
             off = boot_img_sector_size(state, BOOT_SLOT_SECONDARY, 0);
         }
     } else {
@@ -117,7 +117,7 @@ int boot_read_image_header(struct boot_loader_state *state, int slot,
              * be found for the steps where it is moved or swapped.
              */
             if (bs->swap_type == BOOT_SWAP_TYPE_REVERT ||
-                boot_swap_type_multi(BOOT_CURR_IMG(state)) == BOOT_SWAP_TYPE_REVERT) {
+                boot_swap_type_state(state) == BOOT_SWAP_TYPE_REVERT) {
                 if (slot == 0) {
                     if (((bs->idx - BOOT_STATUS_IDX_0) > last_idx ||
                          ((bs->idx - BOOT_STATUS_IDX_0) == last_idx &&
@@ -166,7 +166,7 @@ int boot_read_image_header(struct boot_loader_state *state, int slot,
             fap = BOOT_IMG_AREA(state, slot);
 
             if (bs->swap_type == BOOT_SWAP_TYPE_REVERT ||
-                boot_swap_type_multi(BOOT_CURR_IMG(state)) == BOOT_SWAP_TYPE_REVERT) {
+                boot_swap_type_state(state) == BOOT_SWAP_TYPE_REVERT) {
                 off = 0;
             }
             else if (slot == BOOT_SLOT_SECONDARY) {
@@ -185,7 +185,7 @@ int boot_read_image_header(struct boot_loader_state *state, int slot,
 
     if (check_other_sector == true && out_hdr->ih_magic != IMAGE_MAGIC &&
         slot == BOOT_SLOT_SECONDARY) {
-        if (boot_swap_type_multi(BOOT_CURR_IMG(state)) != BOOT_SWAP_TYPE_REVERT) {
+        if (boot_swap_type_state(state) != BOOT_SWAP_TYPE_REVERT) {
             off = 0;
         } else {
             off = boot_img_sector_size(state, BOOT_SLOT_SECONDARY, 0);
@@ -223,11 +223,9 @@ done:
 int swap_read_status_bytes(const struct flash_area *fap, struct boot_loader_state *state,
                            struct boot_status *bs)
 {
-    uint32_t off;
-    uint8_t status;
+    uint32_t written[BOOT_STATUS_BITMAP_WORDS];
     int max_entries;
     int found_idx;
-    uint8_t write_sz;
     int rc;
     int last_rc;
     int erased_sections;
@@ -239,19 +237,18 @@ int swap_read_status_bytes(const struct flash_area *fap, struct boot_loader_stat
         return BOOT_EBADARGS;
     }
 
+    rc = swap_read_status_entries(fap, BOOT_WRITE_SZ(state), max_entries, written);
+    if (rc != 0) {
+        return rc;
+    }
+
     erased_sections = 0;
     found_idx = -1;
     /* Skip erased sectors at the end */
     last_rc = 1;
-    write_sz = BOOT_WRITE_SZ(state);
-    off = boot_status_off(fap);
+    rc = 0;
     for (i = max_entries; i > 0; i--) {
-        rc = flash_area_read(fap, off + (i - 1) * write_sz, &status, 1);
-        if (rc < 0) {
-            return BOOT_EFLASH;
-        }
-
-        if (bootutil_buffer_is_erased(fap, &status, 1)) {
+        if (!swap_status_entry_written(written, i - 1)) {
             if (rc != last_rc) {
                 erased_sections++;
             }
@@ -388,20 +385,13 @@ int swap_status_source(struct boot_loader_state *state)
     struct boot_swap_state state_primary_slot;
     struct boot_swap_state state_secondary_slot;
     int rc;
-    uint8_t image_index;
-
-#if (BOOT_IMAGE_NUMBER == 1)
-    (void)state;
-#endif
 
-    image_index = BOOT_CURR_IMG(state);
-    rc = boot_read_swap_state(state->imgs[image_index][BOOT_SLOT_PRIMARY].area,
-                              &state_primary_slot);
+    rc = boot_read_slot_swap_state(state, BOOT_SLOT_PRIMARY, &state_primary_slot);
     assert(rc == 0);
     BOOT_LOG_SWAP_STATE("Primary image", &state_primary_slot);
 
-    rc = boot_read_swap_state(state->imgs[image_index][BOOT_SLOT_SECONDARY].area,
-                              &state_secondary_slot);
+    rc = boot_read_slot_swap_state(state, BOOT_SLOT_SECONDARY,
+                                   &state_secondary_slot);
     assert(rc == 0);
     BOOT_LOG_SWAP_STATE("Secondary image", &state_secondary_slot);
 
@@ -420,12 +410,15 @@ int swap_status_source(struct boot_loader_state *state)
 static void boot_swap_sectors(int idx, uint32_t sz, struct boot_loader_state *state,
                               struct boot_status *bs, const struct flash_area *fap_pri,
                               const struct flash_area *fap_sec, bool skip_primary,
-                              bool skip_secondary)
+                              bool skip_secondary, struct boot_copy_hash *hash)
 {
     uint32_t pri_off;
     uint32_t sec_off;
     uint32_t sec_up_off;
     int rc = 0;
+#ifndef MCUBOOT_HASH_IMAGE_COPY
+    (void)hash;
+#endif
 
     pri_off = boot_img_sector_off(state, BOOT_SLOT_PRIMARY, idx);
     sec_off = boot_img_sector_off(state, BOOT_SLOT_SECONDARY, idx);
@@ -435,6 +428,9 @@ static void boot_swap_sectors(int idx, uint32_t sz, struct boot_loader_state *st
         if (skip_primary == true) {
             BOOT_LOG_DBG("Skipping erase of secondary 0x%x and copy from primary 0x%x", sec_off,
                          pri_off);
+        } else if (boot_copy_region_unchanged(state, fap_pri, fap_sec, pri_off, sec_off, sz,
+                                              NULL)) {
+            BOOT_LOG_DBG("Skipping copy to unchanged secondary 0x%x", sec_off);
         } else {
             /* Copy from slot 0 X to slot 1 X */
             BOOT_LOG_DBG("Erasing secondary 0x%x of 0x%x", sec_off, sz);
@@ -455,6 +451,9 @@ static void boot_swap_sectors(int idx, uint32_t sz, struct boot_loader_state *st
         if (skip_secondary == true) {
             BOOT_LOG_DBG("Skipping erase of primary 0x%x and copy from secondary 0x%x", pri_off,
                          sec_up_off);
+        } else if (boot_copy_region_unchanged(state, fap_sec, fap_pri, sec_up_off, pri_off, sz,
+                                              hash)) {
+            BOOT_LOG_DBG("Skipping copy to unchanged primary 0x%x", pri_off);
         } else {
             /* Erase slot 0 X */
             BOOT_LOG_DBG("Erasing primary 0x%x of 0x%x", pri_off, sz);
@@ -464,7 +463,11 @@ static void boot_swap_sectors(int idx, uint32_t sz, struct boot_loader_state *st
             /* Copy from slot 1 (X + 1) to slot 0 X */
             BOOT_LOG_DBG("Copying secondary 0x%x -> primary 0x%x of 0x%x", sec_up_off, pri_off,
                          sz);
+#ifdef MCUBOOT_HASH_IMAGE_COPY
+            rc = boot_copy_region_hash(state, fap_sec, fap_pri, sec_up_off, pri_off, sz, 0, hash);
+#else
             rc = BOOT_COPY_REGION(state, fap_sec, fap_pri, sec_up_off, pri_off, sz, 0);
+#endif
             assert(rc == 0);
         }
 
@@ -496,6 +499,9 @@ static void boot_swap_sectors_revert(int idx, uint32_t sz, struct boot_loader_st
         if (skip_primary == true) {
             BOOT_LOG_DBG("Skipping erase of secondary 0x%x and copy from primary 0x%x", sec_off,
                          pri_off);
+        } else if (boot_copy_region_unchanged(state, fap_pri, fap_sec, pri_off, sec_off, sz,
+                                              NULL)) {
+            BOOT_LOG_DBG("Skipping copy to unchanged secondary 0x%x", sec_off);
         } else {
             /* Copy from slot 0 X to slot 1 X */
             BOOT_LOG_DBG("Erasing secondary 0x%x of 0x%x", sec_off, sz);
@@ -516,6 +522,9 @@ static void boot_swap_sectors_revert(int idx, uint32_t sz, struct boot_loader_st
         if (skip_secondary == true) {
             BOOT_LOG_DBG("Skipping erase of primary 0x%x and copy from secondary 0x%x", pri_off,
                          sec_up_off);
+        } else if (boot_copy_region_unchanged(state, fap_sec, fap_pri, sec_up_off, pri_off, sz,
+                                              NULL)) {
+            BOOT_LOG_DBG("Skipping copy to unchanged primary 0x%x", pri_off);
         } else {
             /* Erase slot 0 X */
             BOOT_LOG_DBG("Erasing primary 0x%x of 0x%x", pri_off, sz);
@@ -595,6 +604,10 @@ void swap_run(struct boot_loader_state *state, struct boot_status *bs,
     int rc;
     uint16_t unprotected_tlv_size_pri;
     uint16_t unprotected_tlv_size_sec;
+#ifdef MCUBOOT_HASH_IMAGE_COPY
+    struct boot_copy_hash copy_hash;
+#endif
+    struct boot_copy_hash *hash = NULL;
 
     BOOT_LOG_INF("Starting swap using offset algorithm.");
 
@@ -670,8 +683,12 @@ void swap_run(struct boot_loader_state *state, struct boot_status *bs,
         state->imgs[BOOT_CURR_IMG(state)][BOOT_SLOT_SECONDARY].hdr.ih_img_size) + sector_sz - 1) /
         sector_sz;
 
+#ifdef MCUBOOT_HASH_IMAGE_COPY
+    state->copy_hash[BOOT_CURR_IMG(state)].valid = false;
+#endif
+
     if (bs->swap_type == BOOT_SWAP_TYPE_REVERT ||
-        boot_swap_type_multi(BOOT_CURR_IMG(state)) == BOOT_SWAP_TYPE_REVERT) {
+        boot_swap_type_state(state) == BOOT_SWAP_TYPE_REVERT) {
         while (idx <= last_idx) {
             if (idx >= (bs->idx - BOOT_STATUS_IDX_0)) {
                 uint32_t mirror_idx = last_idx - idx;
@@ -695,15 +712,30 @@ void swap_run(struct boot_loader_state *state, struct boot_status *bs,
         rc = swap_scramble_trailer_sectors(state, fap_sec);
         assert(rc == 0);
     } else {
+#ifdef MCUBOOT_HASH_IMAGE_COPY
+        /* Only a swap started from its first sector writes the whole image. */
+        if (bs->idx == BOOT_STATUS_IDX_0 && bs->state == BOOT_STATUS_STATE_0) {
+            boot_copy_hash_start(&copy_hash, boot_img_hdr(state, BOOT_SLOT_SECONDARY));
+            hash = &copy_hash;
+        }
+#endif
+
         while (idx <= last_idx) {
             if (idx >= (bs->idx - BOOT_STATUS_IDX_0)) {
                 boot_swap_sectors(idx, sector_sz, state, bs, fap_pri, fap_sec,
                                   (idx > used_sectors_pri ? true : false),
-                                  (idx > used_sectors_sec ? true : false));
+                                  (idx > used_sectors_sec ? true : false), hash);
             }
 
             idx++;
         }
+
+#ifdef MCUBOOT_HASH_IMAGE_COPY
+        if (hash != NULL &&
+            boot_copy_hash_finish(hash, state->copy_hash[BOOT_CURR_IMG(state)].hash) == 0) {
+            state->copy_hash[BOOT_CURR_IMG(state)].valid = true;
+        }
+#endif
     }
 }
 
@@ -77,6 +77,23 @@ int swap_read_status_bytes(const struct flash_area *fap,
                            struct boot_loader_state *state,
                            struct boot_status *bs);
 
+/* Words of a bitmap with a bit per entry of a status area. */
+#define BOOT_STATUS_BITMAP_WORDS \
+    ((BOOT_STATUS_STATE_COUNT * BOOT_STATUS_MAX_ENTRIES + 31) / 32)
+
+/**
+ * Reads the first `entries` swap status entries of the given flash_area, with
+ * a few bulk reads, and sets bit i of `written` if entry i is written.
+ */
+int swap_read_status_entries(const struct flash_area *fap, uint8_t write_sz,
+                             int entries, uint32_t *written);
+
+static inline bool
+swap_status_entry_written(const uint32_t *written, int idx)
+{
+    return (written[idx / 32] >> (idx % 32)) & 1;
+}
+
 /**
  * Marks the image in the primary slot as fully copied.
  */
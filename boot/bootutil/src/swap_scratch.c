@@ -178,6 +178,7 @@ static size_t app_max_size_adjust_to_trailer(struct boot_loader_state *state, si
 #endif /* MCUBOOT_SWAP_USING_SCRATCH */
 
 #if !defined(MCUBOOT_DIRECT_XIP) && !defined(MCUBOOT_RAM_LOAD)
+#if MCUBOOT_SWAP_USING_SCRATCH
 /**
  * Reads the status of a partially-completed swap, if any.  This is necessary
  * to recover in case the boot lodaer was reset in the middle of a swap
@@ -187,8 +188,7 @@ int
 swap_read_status_bytes(const struct flash_area *fap,
         struct boot_loader_state *state, struct boot_status *bs)
 {
-    uint32_t off;
-    uint8_t status;
+    uint32_t written[BOOT_STATUS_BITMAP_WORDS];
     int max_entries;
     int found;
     int found_idx;
@@ -196,23 +196,21 @@ swap_read_status_bytes(const struct flash_area *fap,
     int rc;
     int i;
 
-    off = boot_status_off(fap);
     max_entries = boot_status_entries(BOOT_CURR_IMG(state), fap);
     if (max_entries < 0) {
         return BOOT_EBADARGS;
     }
 
+    rc = swap_read_status_entries(fap, BOOT_WRITE_SZ(state), max_entries, written);
+    if (rc != 0) {
+        return rc;
+    }
+
     found = 0;
     found_idx = 0;
     invalid = 0;
     for (i = 0; i < max_entries; i++) {
-        rc = flash_area_read(fap, off + i * BOOT_WRITE_SZ(state),
-                &status, 1);
-        if (rc < 0) {
-            return BOOT_EFLASH;
-        }
-
-        if (bootutil_buffer_is_erased(fap, &status, 1)) {
+        if (!swap_status_entry_written(written, i)) {
             if (found && !found_idx) {
                 found_idx = i;
             }
@@ -250,6 +248,7 @@ swap_read_status_bytes(const struct flash_area *fap,
 
     return 0;
 }
+#endif /* MCUBOOT_SWAP_USING_SCRATCH */
 
 uint32_t
 boot_status_internal_off(const struct boot_status *bs, int elem_sz)
@@ -479,15 +478,8 @@ swap_status_source(struct boot_loader_state *state)
     int rc;
     size_t i;
     uint8_t source;
-    uint8_t image_index;
-
-#if (BOOT_IMAGE_NUMBER == 1)
-    (void)state;
-#endif
 
-    image_index = BOOT_CURR_IMG(state);
-    rc = boot_read_swap_state(state->imgs[image_index][BOOT_SLOT_PRIMARY].area,
-                              &state_primary_slot);
+    rc = boot_read_slot_swap_state(state, BOOT_SLOT_PRIMARY, &state_primary_slot);
     assert(rc == 0);
 
 #if MCUBOOT_SWAP_USING_SCRATCH
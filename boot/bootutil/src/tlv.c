@@ -88,9 +88,229 @@ bootutil_tlv_iter_begin(struct image_tlv_iter *it, const struct image_header *hd
     it->tlv_end = off_ + it->hdr->ih_protect_tlv_size + info.it_tlv_tot;
     // position on first TLV
     it->tlv_off = off_ + sizeof(info);
+#if defined(MCUBOOT_TLV_DIR_CACHE)
+    it->dir = NULL;
+#endif
+    return 0;
+}
+
+#if defined(MCUBOOT_TLV_DIR_CACHE)
+/* Size of the buffer the TLV area is read through when building a directory. */
+#define BOOT_TLV_DIR_READ_SZ    128
+
+struct boot_tlv_dir_reader {
+    const struct flash_area *fap;
+    uint32_t buf_off;
+    uint32_t buf_len;
+    uint8_t buf[BOOT_TLV_DIR_READ_SZ];
+};
+
+/*
+ * Copy `len` bytes at `off` of the flash area, served from the reader's buffer,
+ * which is refilled starting at `off` when they are not all in it.
+ */
+static int
+boot_tlv_dir_read(struct boot_tlv_dir_reader *r, uint32_t off, void *dst, uint32_t len)
+{
+    uint32_t size = flash_area_get_size(r->fap);
+
+    if (off > size || size - off < len) {
+        return -1;
+    }
+
+    if (off < r->buf_off || off + len > r->buf_off + r->buf_len) {
+        r->buf_off = off;
+        r->buf_len = size - off < sizeof(r->buf) ? size - off : sizeof(r->buf);
+
+        if (flash_area_read(r->fap, r->buf_off, r->buf, r->buf_len)) {
+            r->buf_len = 0;
+            return -1;
+        }
+    }
+
+    memcpy(dst, &r->buf[off - r->buf_off], len);
     return 0;
 }
 
+/*
+ * Build the directory of the TLV area starting at `off`. On failure, or when
+ * the area holds more TLVs than the directory does, the directory is left
+ * unusable and the TLVs are walked in flash instead.
+ */
+static void
+boot_tlv_dir_load(struct boot_tlv_dir *dir, const struct image_header *hdr,
+                  const struct flash_area *fap, uint32_t off)
+{
+    struct boot_tlv_dir_reader r;
+    struct image_tlv_info info;
+    struct image_tlv tlv;
+    uint32_t prot_end;
+    uint32_t tlv_end;
+    uint32_t tlv_off;
+
+    r.fap = fap;
+    r.buf_off = 0;
+    r.buf_len = 0;
+
+    dir->status = BOOT_TLV_DIR_UNUSABLE;
+    dir->count = 0;
+    dir->tlv_off = off;
+    dir->prot_end = off + hdr->ih_protect_tlv_size;
+
+    if (boot_tlv_dir_read(&r, off, &info, sizeof(info))) {
+        return;
+    }
+
+    prot_end = off;
+    if (info.it_magic == IMAGE_TLV_PROT_INFO_MAGIC) {
+        if (hdr->ih_protect_tlv_size != info.it_tlv_tot) {
+            return;
+        }
+
+        prot_end += info.it_tlv_tot;
+        if (boot_tlv_dir_read(&r, prot_end, &info, sizeof(info))) {
+            return;
+        }
+    } else if (hdr->ih_protect_tlv_size != 0) {
+        return;
+    }
+
+    if (info.it_magic != IMAGE_TLV_INFO_MAGIC) {
+        return;
+    }
+
+    tlv_end = prot_end + info.it_tlv_tot;
+    tlv_off = off + sizeof(info);
+
+    while (tlv_off < tlv_end) {
+        if (hdr->ih_protect_tlv_size > 0 && tlv_off == prot_end) {
+            tlv_off += sizeof(struct image_tlv_info);
+            continue;
+        }
+
+        if (dir->count == MCUBOOT_TLV_DIR_ENTRIES) {
+            BOOT_LOG_DBG("boot_tlv_dir_load: more than %d TLVs, not cached",
+                         MCUBOOT_TLV_DIR_ENTRIES);
+            return;
+        }
+
+        if (boot_tlv_dir_read(&r, tlv_off, &tlv, sizeof(tlv))) {
+            return;
+        }
+
+        dir->entries[dir->count].off = tlv_off + sizeof(tlv);
+        dir->entries[dir->count].len = tlv.it_len;
+        dir->entries[dir->count].type = tlv.it_type;
+        dir->count++;
+
+        tlv_off += sizeof(tlv) + tlv.it_len;
+    }
+
+    dir->tlv_end = tlv_end;
+    dir->status = BOOT_TLV_DIR_VALID;
+}
+
+/* Find the TLV directory of the slot whose header is `hdr`, if any. */
+static struct boot_tlv_dir *
+boot_tlv_dir_find(struct boot_loader_state *state, const struct image_header *hdr,
+                  const struct flash_area *fap)
+{
+    int image;
+    int slot;
+
+    if (state == NULL) {
+        return NULL;
+    }
+
+    for (image = 0; image < BOOT_IMAGE_NUMBER; image++) {
+        for (slot = 0; slot < BOOT_NUM_SLOTS; slot++) {
+            if (&state->imgs[image][slot].hdr == hdr &&
+                state->imgs[image][slot].area != NULL &&
+                flash_area_get_id(state->imgs[image][slot].area) == flash_area_get_id(fap)) {
+                return &state->imgs[image][slot].tlv_dir;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+int
+boot_tlv_iter_begin(struct boot_loader_state *state, struct image_tlv_iter *it,
+                    const struct image_header *hdr, const struct flash_area *fap,
+                    uint16_t type, bool prot)
+{
+    struct boot_tlv_dir *dir;
+    uint32_t off_;
+
+    if (it == NULL || hdr == NULL || fap == NULL) {
+        return -1;
+    }
+
+    dir = boot_tlv_dir_find(state, hdr, fap);
+    if (dir == NULL) {
+        return bootutil_tlv_iter_begin(it, hdr, fap, type, prot);
+    }
+
+#if defined(MCUBOOT_SWAP_USING_OFFSET)
+    off_ = BOOT_TLV_OFF(hdr) + it->start_off;
+#else
+    off_ = BOOT_TLV_OFF(hdr);
+#endif
+
+    if (dir->status == BOOT_TLV_DIR_EMPTY || dir->tlv_off != off_ ||
+        dir->prot_end != off_ + hdr->ih_protect_tlv_size) {
+        boot_tlv_dir_load(dir, hdr, fap, off_);
+    }
+
+    if (dir->status != BOOT_TLV_DIR_VALID) {
+        return bootutil_tlv_iter_begin(it, hdr, fap, type, prot);
+    }
+
+    it->hdr = hdr;
+    it->fap = fap;
+    it->type = type;
+    it->prot = prot;
+    it->prot_end = dir->prot_end;
+    it->tlv_end = dir->tlv_end;
+    it->tlv_off = off_ + sizeof(struct image_tlv_info);
+    it->dir = dir;
+    it->dir_idx = 0;
+    return 0;
+}
+
+/* bootutil_tlv_iter_next() for an iteration served from a TLV directory. */
+static int
+boot_tlv_dir_iter_next(struct image_tlv_iter *it, uint32_t *off, uint16_t *len,
+                       uint16_t *type)
+{
+    const struct boot_tlv_dir_entry *entry;
+
+    while (it->dir_idx < it->dir->count) {
+        entry = &it->dir->entries[it->dir_idx];
+
+        /* No more TLVs in the protected area */
+        if (it->prot && entry->off >= it->prot_end) {
+            return 1;
+        }
+
+        it->dir_idx++;
+        it->tlv_off = entry->off + entry->len;
+
+        if (it->type == IMAGE_TLV_ANY || entry->type == it->type) {
+            if (type != NULL) {
+                *type = entry->type;
+            }
+            *off = entry->off;
+            *len = entry->len;
+            return 0;
+        }
+    }
+
+    return 1;
+}
+#endif /* MCUBOOT_TLV_DIR_CACHE */
+
 /*
  * Find next TLV
  *
@@ -114,6 +334,12 @@ bootutil_tlv_iter_next(struct image_tlv_iter *it, uint32_t *off, uint16_t *len,
         return -1;
     }
 
+#if defined(MCUBOOT_TLV_DIR_CACHE)
+    if (it->dir != NULL) {
+        return boot_tlv_dir_iter_next(it, off, len, type);
+    }
+#endif
+
     BOOT_LOG_DBG("bootutil_tlv_iter_next: searching for %d (%d is any) "
                  "starting at %" PRIu32 " ending at %" PRIu32,
                  it->type, IMAGE_TLV_ANY, it->tlv_off, it->tlv_end);
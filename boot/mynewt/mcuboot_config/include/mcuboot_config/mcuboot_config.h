@@ -35,6 +35,20 @@
 #if MYNEWT_VAL(BOOT_SERIAL_MGMT_ECHO)
 #define MCUBOOT_BOOT_MGMT_ECHO 1
 #endif
+#if MYNEWT_VAL(BOOT_SERIAL_UPLOAD_WINDOW)
+#define MCUBOOT_SERIAL_UPLOAD_WINDOW MYNEWT_VAL(BOOT_SERIAL_UPLOAD_WINDOW)
+#endif
+#if MYNEWT_VAL(BOOT_SERIAL_UPLOAD_HASH)
+#define MCUBOOT_SERIAL_UPLOAD_HASH 1
+#endif
+#if MYNEWT_VAL(BOOT_SERIAL_UPLOAD_COMPRESSION)
+#define MCUBOOT_SERIAL_UPLOAD_COMPRESSION 1
+#define MCUBOOT_SERIAL_UPLOAD_COMPRESSION_WINDOW_BITS \
+        MYNEWT_VAL(BOOT_SERIAL_UPLOAD_COMPRESSION)
+#endif
+#if MYNEWT_VAL(BOOT_SERIAL_BINARY_FRAMING)
+#define MCUBOOT_SERIAL_BINARY_FRAMING 1
+#endif
 #if MYNEWT_VAL(BOOTUTIL_VALIDATE_SLOT0)
 #define MCUBOOT_VALIDATE_PRIMARY_SLOT 1
 #endif
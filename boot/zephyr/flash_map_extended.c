@@ -212,3 +212,15 @@ int flash_area_get_sector(const struct flash_area *fap, off_t off,
 
     return rc;
 }
+
+#ifdef CONFIG_BOOT_FLASH_MULTI_SECTOR_ERASE
+/* Zephyr flash drivers erase any page aligned range in one call, using their
+ * largest erase command that fits.
+ */
+__weak uint32_t flash_area_erase_size(const struct flash_area *fap, uint32_t off)
+{
+    (void)fap;
+    (void)off;
+    return CONFIG_BOOT_FLASH_MULTI_SECTOR_ERASE_MAX_SIZE;
+}
+#endif
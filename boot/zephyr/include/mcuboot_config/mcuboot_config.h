@@ -79,6 +79,11 @@
 #define MCUBOOT_VALIDATE_PRIMARY_SLOT_ONCE
 #endif
 
+#ifdef CONFIG_BOOT_VALIDATION_CACHE
+#define MCUBOOT_VALIDATION_CACHE
+#define MCUBOOT_VALIDATION_CACHE_RECORDS CONFIG_BOOT_VALIDATION_CACHE_RECORDS
+#endif
+
 #ifdef CONFIG_BOOT_UPGRADE_ONLY
 #define MCUBOOT_OVERWRITE_ONLY
 #define MCUBOOT_OVERWRITE_ONLY_FAST
@@ -171,6 +176,10 @@
 #define MCUBOOT_ENCRYPT_X25519
 #endif
 
+#ifdef CONFIG_BOOT_ENCRYPT_KEY_CACHE
+#define MCUBOOT_ENC_KEY_CACHE
+#endif
+
 #ifdef CONFIG_BOOT_ENCRYPT_ALG_AES_128
 #define MCUBOOT_AES_128
 #endif
@@ -195,8 +204,33 @@
 #define MCUBOOT_BYPASS_KEY_MATCH
 #endif
 
+/* Use key hashes generated along with the built in keys, instead of
+ * hashing each key to find the one an image is signed with.
+ */
+#ifdef CONFIG_BOOT_KEY_HASH_TABLE
+#define MCUBOOT_KEY_HASH_TABLE
+#endif
+
+#ifdef CONFIG_BOOT_ECDSA_COMB_TABLES
+#define MCUBOOT_ECDSA_COMB_TABLES
+#endif
+
+#ifdef CONFIG_BOOT_ED25519_PRECOMP_TABLES
+#define MCUBOOT_ED25519_PRECOMP_TABLES
+#endif
+
+#ifdef CONFIG_BOOT_RSA_PRECOMP_TABLES
+#define MCUBOOT_RSA_PRECOMP_TABLES
+#endif
+
 #ifdef CONFIG_BOOT_DECOMPRESSION
 #define MCUBOOT_DECOMPRESS_IMAGES
+#define MCUBOOT_DECOMPRESS_BUFFER_SIZE CONFIG_BOOT_DECOMPRESSION_BUFFER_SIZE
+#define MCUBOOT_DECOMPRESS_DICT_SIZE CONFIG_BOOT_DECOMPRESSION_DICT_SIZE
+#endif
+
+#ifdef CONFIG_BOOT_DELTA_IMAGES
+#define MCUBOOT_DELTA_IMAGES
 #endif
 
 /* Invoke hashing functions directly on storage device. This requires the device
@@ -206,6 +240,30 @@
 #define MCUBOOT_HASH_STORAGE_DIRECTLY
 #endif
 
+#ifdef CONFIG_BOOT_IMG_HASH_CHUNK_SIZE
+#define MCUBOOT_IMG_HASH_CHUNK_SIZE CONFIG_BOOT_IMG_HASH_CHUNK_SIZE
+#endif
+
+#ifdef CONFIG_BOOT_FLASH_ASYNC_READ
+#define MCUBOOT_FLASH_ASYNC_READ
+#endif
+
+#ifdef CONFIG_BOOT_TLV_DIR_CACHE
+#define MCUBOOT_TLV_DIR_CACHE
+#endif
+
+#ifdef CONFIG_BOOT_SWAP_STATE_CACHE
+#define MCUBOOT_SWAP_STATE_CACHE
+#endif
+
+#ifdef CONFIG_BOOT_FLASH_MULTI_SECTOR_ERASE
+#define MCUBOOT_FLASH_MULTI_SECTOR_ERASE
+#endif
+
+#ifdef CONFIG_BOOT_ERASE_SKIP_BLANK
+#define MCUBOOT_ERASE_SKIP_BLANK
+#endif
+
 #ifdef CONFIG_BOOT_SIGNATURE_TYPE_PURE
 #define MCUBOOT_SIGN_PURE
 #endif
@@ -214,6 +272,18 @@
 #define MCUBOOT_BOOTSTRAP 1
 #endif
 
+#ifdef CONFIG_BOOT_HASH_IMAGE_COPY
+#define MCUBOOT_HASH_IMAGE_COPY
+#endif
+
+#ifdef CONFIG_BOOT_SECTOR_HASHES
+#define MCUBOOT_SECTOR_HASHES
+#endif
+
+#ifdef CONFIG_BOOT_SWAP_SKIP_UNCHANGED
+#define MCUBOOT_SWAP_SKIP_UNCHANGED
+#endif
+
 #ifdef CONFIG_BOOT_USE_BENCH
 #define MCUBOOT_USE_BENCH 1
 #endif
@@ -369,6 +439,14 @@
 #define MCUBOOT_ERASE_PROGRESSIVELY
 #endif
 
+/*
+ * Erase the flash for the next chunks of a serial upload while the client
+ * sends them, instead of delaying the response to the chunk that needs it.
+ */
+#ifdef CONFIG_BOOT_SERIAL_ERASE_AHEAD
+#define MCUBOOT_SERIAL_ERASE_AHEAD
+#endif
+
 /*
  * Devices that do not require erase prior to write or do not support
  * erase should avoid emulation of erase by additional write.
@@ -428,6 +506,28 @@
 #define MCUBOOT_SERIAL_UNALIGNED_BUFFER_SIZE CONFIG_BOOT_SERIAL_UNALIGNED_BUFFER_SIZE
 #endif
 
+#ifdef CONFIG_BOOT_MAX_LINE_INPUT_LEN
+#define MCUBOOT_SERIAL_MAX_LINE_INPUT_LEN CONFIG_BOOT_MAX_LINE_INPUT_LEN
+#endif
+
+#ifdef CONFIG_BOOT_SERIAL_BINARY_FRAMING
+#define MCUBOOT_SERIAL_BINARY_FRAMING
+#endif
+
+#if defined(CONFIG_BOOT_SERIAL_UPLOAD_WINDOW) && CONFIG_BOOT_SERIAL_UPLOAD_WINDOW > 0
+#define MCUBOOT_SERIAL_UPLOAD_WINDOW CONFIG_BOOT_SERIAL_UPLOAD_WINDOW
+#endif
+
+#ifdef CONFIG_BOOT_SERIAL_UPLOAD_HASH
+#define MCUBOOT_SERIAL_UPLOAD_HASH
+#endif
+
+#ifdef CONFIG_BOOT_SERIAL_UPLOAD_COMPRESSION
+#define MCUBOOT_SERIAL_UPLOAD_COMPRESSION
+#define MCUBOOT_SERIAL_UPLOAD_COMPRESSION_WINDOW_BITS \
+        CONFIG_BOOT_SERIAL_UPLOAD_COMPRESSION_WINDOW_BITS
+#endif
+
 #if defined(MCUBOOT_DATA_SHARING) && defined(ZEPHYR_VER_INCLUDE)
 #include <zephyr/app_version.h>
 
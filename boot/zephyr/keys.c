@@ -34,19 +34,44 @@
 #if defined(MCUBOOT_SIGN_RSA)
 extern const unsigned char rsa_pub_key[];
 extern unsigned int rsa_pub_key_len;
+#if defined(MCUBOOT_KEY_HASH_TABLE)
+extern const unsigned char rsa_pub_key_hash[];
+extern unsigned int rsa_pub_key_hash_len;
+#endif
+#if defined(MCUBOOT_RSA_PRECOMP_TABLES)
+extern const unsigned int rsa_pub_key_table[];
+#endif
 #elif defined(MCUBOOT_SIGN_EC256)
 extern const unsigned char ecdsa_pub_key[];
 extern unsigned int ecdsa_pub_key_len;
+#if defined(MCUBOOT_KEY_HASH_TABLE)
+extern const unsigned char ecdsa_pub_key_hash[];
+extern unsigned int ecdsa_pub_key_hash_len;
+#endif
+#if defined(MCUBOOT_ECDSA_COMB_TABLES)
+extern const unsigned int ecdsa_pub_key_table[];
+#endif
 #elif defined(MCUBOOT_SIGN_ED25519)
 extern const unsigned char ed25519_pub_key[];
 extern unsigned int ed25519_pub_key_len;
+#if defined(MCUBOOT_KEY_HASH_TABLE)
+extern const unsigned char ed25519_pub_key_hash[];
+extern unsigned int ed25519_pub_key_hash_len;
+#endif
+#if defined(MCUBOOT_ED25519_PRECOMP_TABLES)
+extern const unsigned int ed25519_pub_key_table[];
+#endif
 #endif
 #endif
 
 /*
  * NOTE: *_pub_key and *_pub_key_len are autogenerated based on the provided
  *       key file. If no key file was configured, the array and length must be
- *       provided and added to the build manually.
+ *       provided and added to the build manually. The same goes for
+ *       *_pub_key_hash and *_pub_key_hash_len with MCUBOOT_KEY_HASH_TABLE,
+ *       and for ecdsa_pub_key_table with MCUBOOT_ECDSA_COMB_TABLES,
+ *       ed25519_pub_key_table with MCUBOOT_ED25519_PRECOMP_TABLES and
+ *       rsa_pub_key_table with MCUBOOT_RSA_PRECOMP_TABLES.
  */
 #if defined(HAVE_KEYS)
 const struct bootutil_key bootutil_keys[] = {
@@ -54,12 +79,33 @@ const struct bootutil_key bootutil_keys[] = {
 #if defined(MCUBOOT_SIGN_RSA)
         .key = rsa_pub_key,
         .len = &rsa_pub_key_len,
+#if defined(MCUBOOT_KEY_HASH_TABLE)
+        .hash = rsa_pub_key_hash,
+        .hash_len = &rsa_pub_key_hash_len,
+#endif
+#if defined(MCUBOOT_RSA_PRECOMP_TABLES)
+        .rsa_table = rsa_pub_key_table,
+#endif
 #elif defined(MCUBOOT_SIGN_EC256)
         .key = ecdsa_pub_key,
         .len = &ecdsa_pub_key_len,
+#if defined(MCUBOOT_KEY_HASH_TABLE)
+        .hash = ecdsa_pub_key_hash,
+        .hash_len = &ecdsa_pub_key_hash_len,
+#endif
+#if defined(MCUBOOT_ECDSA_COMB_TABLES)
+        .ecdsa_table = ecdsa_pub_key_table,
+#endif
 #elif defined(MCUBOOT_SIGN_ED25519)
         .key = ed25519_pub_key,
         .len = &ed25519_pub_key_len,
+#if defined(MCUBOOT_KEY_HASH_TABLE)
+        .hash = ed25519_pub_key_hash,
+        .hash_len = &ed25519_pub_key_hash_len,
+#endif
+#if defined(MCUBOOT_ED25519_PRECOMP_TABLES)
+        .ed25519_table = ed25519_pub_key_table,
+#endif
 #endif
     },
 };
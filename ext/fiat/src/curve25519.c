@@ -461,6 +461,60 @@ int x25519_ge_frombytes_vartime(ge_p3 *h, const uint8_t s[32]) {
   return 1;
 }
 
+// ge_precomp_is_neg_key returns one if |p| is the negation of the point that
+// |s| encodes, as x25519_ge_frombytes_vartime decodes it, and zero otherwise.
+// Unlike x25519_ge_frombytes_vartime, it does not need a square root.
+static int ge_precomp_is_neg_key(const ge_precomp *p, const uint8_t s[32]) {
+  fe y;
+  fe x;
+  fe yplusx;
+  fe yminusx;
+  fe xy2d;
+  fe xx;
+  fe yy;
+  fe t;
+  fe_loose check;
+
+  fe_frombytes(&y, s);
+  fe_carry(&yplusx, &p->yplusx);
+  fe_carry(&yminusx, &p->yminusx);
+  fe_carry(&xy2d, &p->xy2d);
+
+  fe_sub(&check, &yplusx, &y);  // x = -(yplusx - y)
+  fe_carry(&x, &check);
+  fe_sub(&check, &y, &x);
+  fe_carry(&t, &check);
+  fe_sub(&check, &t, &yminusx);  // yminusx = y - (-x)
+  if (fe_isnonzero(&check)) {
+    return 0;
+  }
+
+  fe_mul_ttt(&t, &x, &y);
+  fe_mul_ttt(&t, &t, &d2);
+  fe_sub(&check, &t, &xy2d);  // xy2d = 2d(-x)y
+  if (fe_isnonzero(&check)) {
+    return 0;
+  }
+
+  fe_sq_tt(&xx, &x);
+  fe_sq_tt(&yy, &y);
+  fe_mul_ttt(&t, &xx, &yy);
+  fe_mul_ttt(&t, &t, &d);
+  fe_add(&check, &t, &xx);
+  fe_carry(&t, &check);
+  fe_1(&xx);
+  fe_add(&check, &t, &xx);
+  fe_carry(&t, &check);
+  fe_sub(&check, &yy, &t);  // -x^2 + y^2 = 1 + dx^2y^2
+  if (fe_isnonzero(&check)) {
+    return 0;
+  }
+
+  fe_neg(&check, &x);
+  fe_carry(&x, &check);
+  return fe_isnegative(&x) == (s[31] >> 7);
+}
+
 static void ge_p2_0(ge_p2 *h) {
   fe_0(&h->X);
   fe_1(&h->Y);
@@ -700,6 +754,61 @@ static void ge_double_scalarmult_vartime(ge_p2 *r, const uint8_t *a,
   }
 }
 
+// ED25519_verify_precomp splits the scalars into ED25519_TABLE_PARTS parts of
+// ED25519_TABLE_SPACING bits, and so needs tables of odd multiples of
+// 2^(ED25519_TABLE_SPACING*k)*A and 2^(ED25519_TABLE_SPACING*k)*B.
+#define ED25519_TABLE_PARTS 4
+#define ED25519_TABLE_SPACING (256 / ED25519_TABLE_PARTS)
+
+_Static_assert(sizeof(Bi_spaced) / sizeof(Bi_spaced[0]) ==
+                   ED25519_TABLE_PARTS - 1,
+               "Bi_spaced is inconsistent with ED25519_TABLE_PARTS");
+
+// ge_madd_digit sets r = r + digit * P, with Pi the odd multiples of P.
+static void ge_madd_digit(ge_p1p1 *r, const ge_precomp Pi[8],
+                          signed char digit) {
+  ge_p3 u;
+
+  if (digit > 0) {
+    x25519_ge_p1p1_to_p3(&u, r);
+    ge_madd(r, &u, &Pi[digit / 2]);
+  } else if (digit < 0) {
+    x25519_ge_p1p1_to_p3(&u, r);
+    ge_msub(r, &u, &Pi[(-digit) / 2]);
+  }
+}
+
+// r = a * A + b * B, as ge_double_scalarmult_vartime.
+// Ai[k][i] = (2*i+1)*2^(ED25519_TABLE_SPACING*k)*A
+// The digits of the scalars at bit i of each part are added in the same
+// iteration, which only needs ED25519_TABLE_SPACING doublings instead of 256.
+static void ge_double_scalarmult_precomp_vartime(ge_p2 *r, const uint8_t *a,
+                                                 const ge_precomp Ai[][8],
+                                                 const uint8_t *b) {
+  signed char aslide[256];
+  signed char bslide[256];
+  ge_p1p1 t;
+  int i;
+  int k;
+
+  slide(aslide, a);
+  slide(bslide, b);
+
+  ge_p2_0(r);
+
+  for (i = ED25519_TABLE_SPACING - 1; i >= 0; --i) {
+    ge_p2_dbl(&t, r);
+
+    for (k = 0; k < ED25519_TABLE_PARTS; ++k) {
+      ge_madd_digit(&t, Ai[k], aslide[k * ED25519_TABLE_SPACING + i]);
+      ge_madd_digit(&t, k == 0 ? Bi : Bi_spaced[k - 1],
+                    bslide[k * ED25519_TABLE_SPACING + i]);
+    }
+
+    x25519_ge_p1p1_to_p2(r, &t);
+  }
+}
+
 // int64_lshift21 returns |a << 21| but is defined when shifting bits into the
 // sign bit. This works around a language flaw in C.
 static inline int64_t int64_lshift21(int64_t a) {
@@ -1049,24 +1158,12 @@ void x25519_sc_reduce(uint8_t s[64]) {
   s[31] = s11 >> 17;
 }
 
-int ED25519_verify(const uint8_t *message, size_t message_len,
-                   const uint8_t signature[64], const uint8_t public_key[32]) {
-  ge_p3 A;
-  if ((signature[63] & 224) != 0 ||
-      !x25519_ge_frombytes_vartime(&A, public_key)) {
-    return 0;
-  }
-
-  fe_loose t;
-  fe_neg(&t, &A.X);
-  fe_carry(&A.X, &t);
-  fe_neg(&t, &A.T);
-  fe_carry(&A.T, &t);
-
-  uint8_t pkcopy[32];
-  memcpy(pkcopy, public_key, 32);
-  uint8_t rcopy[32];
-  memcpy(rcopy, signature, 32);
+// ed25519_hram checks that the scalar s of |signature| is in range, and sets
+// |h| to the reduced hash of R, the public key and the message. It returns one
+// on success and zero otherwise.
+static int ed25519_hram(uint8_t h[64], const uint8_t *message,
+                        size_t message_len, const uint8_t signature[64],
+                        const uint8_t public_key[32]) {
   union {
     uint64_t u64[4];
     uint8_t u8[32];
@@ -1110,7 +1207,6 @@ int ED25519_verify(const uint8_t *message, size_t message_len,
   ret = mbedtls_sha512_update_ret(&ctx, message, message_len);
   assert(ret == 0);
 
-  uint8_t h[SHA512_DIGEST_LENGTH];
   ret = mbedtls_sha512_finish_ret(&ctx, h);
   assert(ret == 0);
   mbedtls_sha512_free(&ctx);
@@ -1130,16 +1226,75 @@ int ED25519_verify(const uint8_t *message, size_t message_len,
   rc = tc_sha512_update(&s, message, message_len);
   assert(rc == TC_CRYPTO_SUCCESS);
 
-  uint8_t h[TC_SHA512_DIGEST_SIZE];
   rc = tc_sha512_final(h, &s);
   assert(rc == TC_CRYPTO_SUCCESS);
 
 #endif
 
   x25519_sc_reduce(h);
+  return 1;
+}
+
+int ED25519_verify(const uint8_t *message, size_t message_len,
+                   const uint8_t signature[64], const uint8_t public_key[32]) {
+  ge_p3 A;
+  if ((signature[63] & 224) != 0 ||
+      !x25519_ge_frombytes_vartime(&A, public_key)) {
+    return 0;
+  }
+
+  fe_loose t;
+  fe_neg(&t, &A.X);
+  fe_carry(&A.X, &t);
+  fe_neg(&t, &A.T);
+  fe_carry(&A.T, &t);
+
+  uint8_t rcopy[32];
+  memcpy(rcopy, signature, 32);
+  uint8_t scopy[32];
+  memcpy(scopy, signature + 32, 32);
+
+  uint8_t h[SHA512_DIGEST_LENGTH];
+  if (!ed25519_hram(h, message, message_len, signature, public_key)) {
+    return 0;
+  }
+
+  ge_p2 R;
+  ge_double_scalarmult_vartime(&R, h, &A, scopy);
+
+  uint8_t rcheck[32];
+  x25519_ge_tobytes(rcheck, &R);
+
+  return CRYPTO_memcmp(rcheck, rcopy, sizeof(rcheck)) == 0;
+}
+
+// ED25519_verify_precomp is ED25519_verify with |public_table| the table of
+// odd multiples of the negated public key -A that
+// ge_double_scalarmult_precomp_vartime uses, ED25519_TABLE_PARTS*8 ge_precomp
+// as 32-bit words, which imgtool's getpub command generates. It rejects a
+// table whose first entry is not -A.
+int ED25519_verify_precomp(const uint8_t *message, size_t message_len,
+                           const uint8_t signature[64],
+                           const uint8_t public_key[32],
+                           const void *public_table) {
+  const ge_precomp (*Ai)[8] = (const ge_precomp (*)[8])public_table;
+  if ((signature[63] & 224) != 0 ||
+      !ge_precomp_is_neg_key(&Ai[0][0], public_key)) {
+    return 0;
+  }
+
+  uint8_t rcopy[32];
+  memcpy(rcopy, signature, 32);
+  uint8_t scopy[32];
+  memcpy(scopy, signature + 32, 32);
+
+  uint8_t h[SHA512_DIGEST_LENGTH];
+  if (!ed25519_hram(h, message, message_len, signature, public_key)) {
+    return 0;
+  }
 
   ge_p2 R;
-  ge_double_scalarmult_vartime(&R, h, &A, scopy.u8);
+  ge_double_scalarmult_precomp_vartime(&R, h, Ai, scopy);
 
   uint8_t rcheck[32];
   x25519_ge_tobytes(rcheck, &R);
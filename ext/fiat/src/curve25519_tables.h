@@ -105,3 +105,205 @@ static const ge_precomp Bi[8] = {
           17317989, 34647629, 21263748}},
     },
 };
+
+// Bi_spaced[k][i] = (2*i+1)*2^(64*(k+1))*B
+static const ge_precomp Bi_spaced[3][8] = {
+    {
+        {
+            {{64091413, 10058205, 1980837, 3964243, 22160966, 12322533,
+              60677741, 20936246, 12228556, 26550755}},
+            {{32944382, 14922211, 44263970, 5188527, 21913450, 24834489,
+              4001464, 13238564, 60994061, 8653814}},
+            {{22865569, 28901697, 27603667, 21009037, 14348957, 8234005,
+              24808405, 5719875, 28483275, 2841751}},
+        },
+        {
+            {{16650902, 22516500, 66044685, 1570628, 58779118, 7352752,
+              66806440, 16271224, 43059443, 26862581}},
+            {{45197768, 27626490, 62497547, 27994275, 35364760, 22769138,
+              24123613, 15193618, 45456747, 16815042}},
+            {{57172930, 29264984, 41829040, 4372841, 2087473, 10399484,
+              31870908, 14690798, 17361620, 11864968}},
+        },
+        {
+            {{30625386, 28825032, 41552902, 20761565, 46624288, 7695098,
+              17097188, 17250936, 39109084, 1803631}},
+            {{63555773, 9865098, 61880298, 4272700, 61435032, 16864731,
+              14911343, 12196514, 45703375, 7047411}},
+            {{20093258, 9920966, 55970670, 28210574, 13161586, 12044805,
+              34252013, 4124600, 34765036, 23296865}},
+        },
+        {
+            {{17960970, 21778898, 62967895, 23851901, 58232301, 32143814,
+              54201480, 24894499, 37532563, 1903855}},
+            {{23134274, 19275300, 56426866, 31942495, 20684484, 15770816,
+              54119114, 3190295, 26955097, 14109738}},
+            {{15308788, 5320727, 36995055, 19235554, 22902007, 7767164,
+              29425325, 22276870, 31960941, 11934971}},
+        },
+        {
+            {{31254118, 1247520, 56638492, 23373442, 12534958, 28970853,
+              66585430, 24451521, 60383370, 1591912}},
+            {{10664735, 32173947, 54728115, 8227995, 47858629, 2075899,
+              61224056, 30136513, 57011003, 19820314}},
+            {{57881498, 14760024, 34448359, 19821882, 41323741, 23451510,
+              46398205, 14040923, 47357663, 375536}},
+        },
+        {
+            {{26386175, 15886398, 6210213, 24865034, 57735685, 28309883,
+              61987132, 25272539, 44140267, 450833}},
+            {{45781502, 28872641, 62523285, 2316979, 33472401, 22310431,
+              47352236, 17859960, 39399155, 21422828}},
+            {{24302215, 31687736, 25077846, 21843473, 4576488, 6205251,
+              66790496, 24122107, 14983489, 23667881}},
+        },
+        {
+            {{14479701, 2381808, 36560813, 2277485, 33012704, 13943292,
+              61151209, 32528175, 27749741, 13850694}},
+            {{25966520, 29935467, 52299635, 7457132, 38028618, 32502166,
+              4133330, 23395153, 32438961, 8439490}},
+            {{39718878, 4486571, 12338909, 13455409, 39801236, 22140515,
+              28446883, 12884658, 13018871, 32846332}},
+        },
+        {
+            {{21433628, 6625422, 8699590, 10066105, 20194138, 5122663, 2202520,
+              25519278, 62879418, 6986090}},
+            {{39328095, 22469201, 58705582, 3782864, 25115577, 24182206,
+              43060233, 2921967, 41070353, 18058371}},
+            {{49052869, 11715196, 19430228, 12171900, 9863652, 30872862,
+              2615688, 8658395, 26868595, 4633822}},
+        },
+    },
+    {
+        {
+            {{11374242, 12660715, 17861383, 21013599, 10935567, 1099227,
+              53222788, 24462691, 39381819, 11358503}},
+            {{54378055, 10311866, 1510375, 10778093, 64989409, 24408729,
+              32676002, 11149336, 40985213, 4985767}},
+            {{48012542, 341146, 60911379, 33315398, 15756972, 24757770,
+              66125820, 13794113, 47694557, 17933176}},
+        },
+        {
+            {{17747446, 10039260, 19368299, 29503841, 46478228, 17513145,
+              31992682, 17696456, 37848500, 28042460}},
+            {{31932008, 28568291, 47496481, 16366579, 22023614, 88450, 11371999,
+              29810185, 4882241, 22927527}},
+            {{29796488, 37186, 19818052, 10115756, 55279832, 3352735, 18551198,
+              3272828, 61917932, 29392022}},
+        },
+        {
+            {{28425966, 27718999, 66531773, 28857233, 52891308, 6870929,
+              7921550, 26986645, 26333139, 14267664}},
+            {{56041645, 11871230, 27385719, 22994888, 62522949, 22365119,
+              10004785, 24844944, 45347639, 8930323}},
+            {{45911060, 17158396, 25654215, 31829035, 12282011, 11008919,
+              1541940, 4757911, 40617363, 17145491}},
+        },
+        {
+            {{24579768, 3711570, 1342322, 22374306, 40103728, 14124955,
+              44564335, 14074918, 21964432, 8235257}},
+            {{60580251, 31142934, 9442965, 27628844, 12025639, 32067012,
+              64127349, 31885225, 13006805, 2355433}},
+            {{50803946, 19949172, 60476436, 28412082, 16974358, 22643349,
+              27202043, 1719366, 1141648, 20758196}},
+        },
+        {
+            {{37210315, 10468803, 55519480, 9292687, 52808360, 17552182,
+              21586883, 945403, 11163707, 15669892}},
+            {{31206520, 15824593, 16020985, 1311600, 11901613, 18681950,
+              17190048, 20972874, 36367312, 16736695}},
+            {{57913035, 17785021, 13803590, 19987782, 53527313, 27679244,
+              51081104, 8751993, 57229443, 21797682}},
+        },
+        {
+            {{13818433, 33318056, 61724740, 27489984, 64579957, 29864077,
+              41055840, 6764058, 21868286, 20265729}},
+            {{30168086, 8879691, 8082410, 20908532, 49048412, 1925828, 36719081,
+              18852706, 45403594, 13481125}},
+            {{20368198, 29299801, 56989850, 18531975, 6143432, 18332713,
+              22947777, 26680478, 52840559, 5738077}},
+        },
+        {
+            {{63338752, 21992361, 57848361, 10016489, 45383174, 5115819,
+              23891454, 31807629, 41897809, 9032829}},
+            {{1787335, 11391558, 5886665, 12683293, 60262716, 18956364,
+              47438617, 31589710, 22825755, 12694491}},
+            {{33951444, 14270088, 4920710, 22678367, 26741607, 22171118,
+              23619815, 25557760, 19219336, 29816249}},
+        },
+        {
+            {{61220352, 828559, 66089103, 13184163, 25007774, 21496788, 6882751,
+              29070952, 62931443, 26042728}},
+            {{21329464, 2335990, 20644175, 1930420, 56815309, 32391427,
+              15310865, 28790024, 54737184, 4184911}},
+            {{26287248, 13875740, 41814500, 13003275, 7041512, 17215295,
+              42960689, 20033689, 37163595, 12870103}},
+        },
+    },
+    {
+        {
+            {{793280, 24323954, 8836301, 27318725, 39747955, 31184838, 33152842,
+              28669181, 57202663, 32932579}},
+            {{5666214, 525582, 20782575, 25516013, 42570364, 14657739, 16099374,
+              1468826, 60937436, 18367850}},
+            {{62249590, 29775088, 64191105, 26806412, 7778749, 11688288,
+              36704511, 23683193, 65549940, 23690785}},
+        },
+        {
+            {{43627235, 4867225, 39861736, 3900520, 29838369, 25342141,
+              35219464, 23512650, 7340520, 18144364}},
+            {{4646495, 25543308, 44342840, 22021777, 23184552, 8566613,
+              31366726, 32173371, 52042079, 23179239}},
+            {{49838347, 12723031, 50115803, 14878793, 21619651, 27356856,
+              27584816, 3093888, 58265170, 3849920}},
+        },
+        {
+            {{49773116, 24447374, 42577584, 9434952, 58636780, 32971069,
+              54018092, 455840, 20461858, 5491305}},
+            {{13669229, 17458950, 54626889, 23351392, 52539093, 21661233,
+              42112877, 11293806, 38520660, 24132599}},
+            {{28497909, 6272777, 34085870, 14470569, 8906179, 32328802,
+              18504673, 19389266, 29867744, 24758489}},
+        },
+        {
+            {{38476072, 12763727, 46662418, 7577503, 33001348, 20536687,
+              17558841, 25681542, 23896953, 29240187}},
+            {{47103464, 21542479, 31520463, 605201, 2543521, 5991821, 64163800,
+              7229063, 57189218, 24727572}},
+            {{28816026, 298879, 38943848, 17633493, 19000927, 31888542,
+              54428030, 30605106, 49057085, 31471516}},
+        },
+        {
+            {{49033867, 30604764, 18508182, 26166427, 67089987, 8802067,
+              52433338, 29486390, 45591740, 16506630}},
+            {{52215021, 19737297, 17234467, 18659555, 24356872, 15424511,
+              4255716, 26305154, 59875612, 5880932}},
+            {{32118458, 23656466, 63173388, 18243642, 39829002, 5564342,
+              34922034, 10932076, 35197474, 5452626}},
+        },
+        {
+            {{42164607, 6156247, 4728227, 2583055, 59565474, 27911367, 28779889,
+              13407360, 62097003, 17920595}},
+            {{65873588, 29284665, 47704024, 31631120, 42460503, 14524346,
+              44639049, 8161089, 742813, 13445044}},
+            {{13576582, 12369038, 24572692, 17672008, 7391516, 22667200,
+              52457363, 18772455, 43737802, 10953320}},
+        },
+        {
+            {{12537000, 9586916, 30794582, 13437793, 61304640, 9417527, 8930996,
+              27972268, 57996360, 16748978}},
+            {{49790629, 23490317, 22118586, 18462596, 18841425, 20994485,
+              14812429, 13594971, 56989572, 32150960}},
+            {{49578831, 18617209, 49167014, 17903158, 45212709, 18763940,
+              31097065, 8701514, 1375133, 17561316}},
+        },
+        {
+            {{55528004, 26487725, 48856645, 22437963, 5236679, 9183541, 9555739,
+              29336616, 45332190, 16236806}},
+            {{55339741, 19273661, 12010219, 7718535, 25699388, 7081486,
+              58976950, 21903733, 22999792, 27616316}},
+            {{8261526, 12422694, 52624918, 9652374, 2711069, 8531175, 50424423,
+              5992277, 12694564, 31043219}},
+        },
+    },
+};
@@ -34,7 +34,7 @@
 #include <tinycrypt/constants.h>
 #include <tinycrypt/utils.h>
 
-static void compress(uint64_t *iv, const uint8_t *data);
+static void compress(uint64_t *iv, const uint8_t *data, size_t blocks);
 
 int tc_sha512_init(TCSha512State_t s)
 {
@@ -64,6 +64,8 @@ int tc_sha512_init(TCSha512State_t s)
 
 int tc_sha512_update(TCSha512State_t s, const uint8_t *data, size_t datalen)
 {
+	size_t len;
+
 	/* input sanity check: */
 	if (s == (TCSha512State_t) 0 || data == (void *) 0) {
 		return TC_CRYPTO_FAIL;
@@ -71,13 +73,27 @@ int tc_sha512_update(TCSha512State_t s, const uint8_t *data, size_t datalen)
 		return TC_CRYPTO_SUCCESS;
 	}
 
-	while (datalen-- > 0) {
-		s->leftover[s->leftover_offset++] = *(data++);
-		if (s->leftover_offset >= TC_SHA512_BLOCK_SIZE) {
-			compress(s->iv, s->leftover);
-			s->leftover_offset = 0;
-			s->bits_hashed += (TC_SHA512_BLOCK_SIZE << 3);
+	while (datalen > 0) {
+		if (s->leftover_offset == 0 && datalen >= TC_SHA512_BLOCK_SIZE) {
+			/* hash whole blocks straight from the input */
+			len = datalen - (datalen % TC_SHA512_BLOCK_SIZE);
+			compress(s->iv, data, len / TC_SHA512_BLOCK_SIZE);
+			s->bits_hashed += ((uint64_t)len << 3);
+		} else {
+			len = TC_SHA512_BLOCK_SIZE - s->leftover_offset;
+			if (len > datalen) {
+				len = datalen;
+			}
+			(void)_copy(s->leftover + s->leftover_offset, len, data, len);
+			s->leftover_offset += len;
+			if (s->leftover_offset == TC_SHA512_BLOCK_SIZE) {
+				compress(s->iv, s->leftover, 1);
+				s->leftover_offset = 0;
+				s->bits_hashed += (TC_SHA512_BLOCK_SIZE << 3);
+			}
 		}
+		data += len;
+		datalen -= len;
 	}
 
 	return TC_CRYPTO_SUCCESS;
@@ -99,7 +115,7 @@ int tc_sha512_final(uint8_t *digest, TCSha512State_t s)
 		/* there is not room for all the padding in this block */
 		_set(s->leftover + s->leftover_offset, 0x00,
 		     sizeof(s->leftover) - s->leftover_offset);
-		compress(s->iv, s->leftover);
+		compress(s->iv, s->leftover, 1);
 		s->leftover_offset = 0;
 	}
 
@@ -122,7 +138,7 @@ int tc_sha512_final(uint8_t *digest, TCSha512State_t s)
 	s->leftover[sizeof(s->leftover) - 8]  = (uint8_t)(s->bits_hashed >> 56);
 
 	/* hash the padding and length */
-	compress(s->iv, s->leftover);
+	compress(s->iv, s->leftover, 1);
 
 	/* copy the iv out to digest */
 	for (i = 0; i < TC_SHA512_STATE_BLOCKS; ++i) {
@@ -195,40 +211,51 @@ static inline uint64_t BigEndian(const uint8_t **c)
 	return n;
 }
 
-static void compress(uint64_t *iv, const uint8_t *data)
+/*
+ * One round, computing the new a into h and the new e into d, so that the
+ * eight working variables rotate by renaming instead of moving.
+ */
+#define ROUND(a, b, c, d, e, f, g, h, i) \
+	do { \
+		t1 = (h) + Sigma1(e) + Ch(e, f, g) + k512[i] + W(i); \
+		(d) += t1; \
+		(h) = t1 + Sigma0(a) + Maj(a, b, c); \
+	} while (0)
+
+#define W(i) (work_space[(i) & 0xf])
+
+static void compress(uint64_t *iv, const uint8_t *data, size_t blocks)
 {
 	uint64_t a, b, c, d, e, f, g, h;
-	uint64_t s0, s1;
-	uint64_t t1, t2;
+	uint64_t t1;
 	uint64_t work_space[16];
-	uint64_t n;
 	unsigned int i;
+	unsigned int j;
 
-	a = iv[0]; b = iv[1]; c = iv[2]; d = iv[3];
-	e = iv[4]; f = iv[5]; g = iv[6]; h = iv[7];
+	for (; blocks > 0; --blocks) {
+		a = iv[0]; b = iv[1]; c = iv[2]; d = iv[3];
+		e = iv[4]; f = iv[5]; g = iv[6]; h = iv[7];
 
-	for (i = 0; i < 16; ++i) {
-		n = BigEndian(&data);
-		t1 = work_space[i] = n;
-		t1 += h + Sigma1(e) + Ch(e, f, g) + k512[i];
-		t2 = Sigma0(a) + Maj(a, b, c);
-		h = g; g = f; f = e; e = d + t1;
-		d = c; c = b; b = a; a = t1 + t2;
-	}
+		for (i = 0; i < 16; ++i) {
+			work_space[i] = BigEndian(&data);
+		}
 
-	for ( ; i < 80; ++i) {
-		s0 = work_space[(i+1)&0x0f];
-		s0 = sigma0(s0);
-		s1 = work_space[(i+14)&0x0f];
-		s1 = sigma1(s1);
-
-		t1 = work_space[i&0xf] += s0 + s1 + work_space[(i+9)&0xf];
-		t1 += h + Sigma1(e) + Ch(e, f, g) + k512[i];
-		t2 = Sigma0(a) + Maj(a, b, c);
-		h = g; g = f; f = e; e = d + t1;
-		d = c; c = b; b = a; a = t1 + t2;
-	}
+		for (i = 0; i < 80; i += 8) {
+			/* message words of the next eight rounds */
+			for (j = i; i >= 16 && j < i + 8; ++j) {
+				W(j) += sigma0(W(j + 1)) + sigma1(W(j + 14)) + W(j + 9);
+			}
+			ROUND(a, b, c, d, e, f, g, h, i);
+			ROUND(h, a, b, c, d, e, f, g, i + 1);
+			ROUND(g, h, a, b, c, d, e, f, i + 2);
+			ROUND(f, g, h, a, b, c, d, e, i + 3);
+			ROUND(e, f, g, h, a, b, c, d, i + 4);
+			ROUND(d, e, f, g, h, a, b, c, i + 5);
+			ROUND(c, d, e, f, g, h, a, b, i + 6);
+			ROUND(b, c, d, e, f, g, h, a, i + 7);
+		}
 
-	iv[0] += a; iv[1] += b; iv[2] += c; iv[3] += d;
-	iv[4] += e; iv[5] += f; iv[6] += g; iv[7] += h;
+		iv[0] += a; iv[1] += b; iv[2] += c; iv[3] += d;
+		iv[4] += e; iv[5] += f; iv[6] += g; iv[7] += h;
+	}
 }
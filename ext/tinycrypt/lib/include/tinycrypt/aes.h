@@ -93,6 +93,28 @@ int tc_aes128_set_encrypt_key(TCAesKeySched_t s, const uint8_t *k);
 int tc_aes_encrypt(uint8_t *out, const uint8_t *in, 
 		   const TCAesKeySched_t s);
 
+/**
+ *  @brief AES-128 Encryption procedure for consecutive blocks
+ *  Encrypts the blocks 16 byte blocks of in buffer into out buffer under
+ *  key schedule s. This is faster than calling tc_aes_encrypt for each
+ *  block when the AES instructions are used (TC_AES_NI).
+ *  @note Assumes s was initialized by aes_set_encrypt_key;
+ *              out and in point to blocks * 16 byte buffers, which may be
+ *              the same buffer
+ *  @note The implementation is selected at build time: TC_AES_NI uses the
+ *              x86 AES instructions, TC_AES_TTABLE uses 32-bit lookup
+ *              tables, which are faster than the default byte oriented
+ *              implementation but leak more through the data cache
+ *  @return  returns TC_CRYPTO_SUCCESS (1)
+ *           returns TC_CRYPTO_FAIL (0) if: out == NULL or in == NULL or s == NULL
+ *  @param out IN/OUT -- buffer to receive ciphertext blocks
+ *  @param in IN -- plaintext blocks to encrypt
+ *  @param blocks IN -- number of blocks to encrypt
+ *  @param s IN -- initialized AES key schedule
+ */
+int tc_aes_encrypt_blocks(uint8_t *out, const uint8_t *in, unsigned int blocks,
+			  const TCAesKeySched_t s);
+
 /**
  *  @brief Set the AES-128 decryption key
  *  Uses key k to initialize s
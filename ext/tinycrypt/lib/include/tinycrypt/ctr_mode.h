@@ -85,12 +85,17 @@ extern "C" {
  *                sched == NULL or
  *                inlen == 0 or
  *                outlen == 0 or
- *                inlen != outlen
+ *                inlen != outlen or
+ *                *blk_off >= TC_AES_BLOCK_SIZE
  *  @note Assumes:- The current value in ctr has NOT been used with sched
  *              - out points to inlen bytes
  *              - in points to inlen bytes
  *              - ctr is an integer counter in littleEndian format
  *              - sched was initialized by aes_set_encrypt_key
+ *  @note The first byte processed is byte *blk_off of the keystream block of
+ *        ctr. On return, ctr and *blk_off designate the byte following the
+ *        last one processed, so that a stream can be processed in pieces.
+ *        The keystream is generated several blocks at a time.
  * @param out OUT -- produced ciphertext (plaintext)
  * @param outlen IN -- length of ciphertext buffer in bytes
  * @param in IN -- data to encrypt (or decrypt)
@@ -132,6 +132,51 @@ int uECC_sign_with_k(const uint8_t *private_key, const uint8_t *message_hash,
 int uECC_verify(const uint8_t *p_public_key, const uint8_t *p_message_hash,
 		unsigned int p_hash_size, const uint8_t *p_signature, uECC_Curve curve);
 
+/*
+ * Fixed-base comb tables used by uECC_verify_comb(). The table of point P
+ * holds the 2^uECC_COMB_TEETH - 1 points i * P, for i the sums of distinct
+ * 2^(uECC_COMB_SPACING * j), in affine coordinates: entry i - 1 is the sum
+ * of 2^(uECC_COMB_SPACING * j) * P for all bits j set in i. Entry 0 is P.
+ */
+#define uECC_COMB_TEETH 4
+#define uECC_COMB_SPACING (NUM_ECC_WORDS * uECC_WORD_BITS / uECC_COMB_TEETH)
+#define uECC_COMB_TABLE_WORDS (((1 << uECC_COMB_TEETH) - 1) * 2 * NUM_ECC_WORDS)
+
+/**
+ * @brief Compute the comb table of a public key.
+ * @return returns TC_CRYPTO_SUCCESS (1) if the table was computed
+ *         returns TC_CRYPTO_FAIL (0) if the public key is not a valid point.
+ *
+ * @param p_public_key IN -- The public key.
+ * @param p_table OUT -- The table, uECC_COMB_TABLE_WORDS words.
+ *
+ * @note Tables of built in keys are meant to be generated ahead of time; this
+ * is equivalent to imgtool's generator, for tests and keys only known at run
+ * time.
+ */
+int uECC_compute_comb_table(const uint8_t *p_public_key, uECC_word_t *p_table,
+			    uECC_Curve curve);
+
+/**
+ * @brief Verify an ECDSA signature using precomputed comb tables.
+ * @return returns TC_SUCCESS (1) if the signature is valid
+ * 	   returns TC_FAIL (0) if the signature is invalid, or if the table
+ * 	   is not the one of p_public_key.
+ *
+ * @param p_public_key IN -- The signer's public key.
+ * @param p_public_table IN -- The comb table of p_public_key.
+ * @param p_message_hash IN -- The hash of the signed data.
+ * @param p_hash_size IN -- The size of p_message_hash in bytes.
+ * @param p_signature IN -- The signature values.
+ *
+ * @note Same as uECC_verify(), computing u1 * G + u2 * Q with the comb tables
+ * of G and Q instead of Shamir's trick: uECC_COMB_SPACING doublings instead
+ * of one per bit of the scalars.
+ */
+int uECC_verify_comb(const uint8_t *p_public_key, const uECC_word_t *p_public_table,
+		     const uint8_t *p_message_hash, unsigned int p_hash_size,
+		     const uint8_t *p_signature, uECC_Curve curve);
+
 #ifdef __cplusplus
 }
 #endif
@@ -122,6 +122,19 @@ int tc_sha256_update (TCSha256State_t s, const uint8_t *data, size_t datalen);
  */
 int tc_sha256_final(uint8_t *digest, TCSha256State_t s);
 
+/*
+ * With GCC or Clang on x86, tc_sha256_update_ni() and tc_sha256_final_ni()
+ * compress with the SHA extensions instead; they must only be used on CPUs
+ * that have them. Both use the same state and give the same digest.
+ */
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define TC_SHA256_NI_AVAILABLE 1
+
+int tc_sha256_update_ni(TCSha256State_t s, const uint8_t *data, size_t datalen);
+
+int tc_sha256_final_ni(uint8_t *digest, TCSha256State_t s);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -33,15 +33,40 @@
 #include <tinycrypt/constants.h>
 #include <tinycrypt/ctr_mode.h>
 #include <tinycrypt/utils.h>
+#include <string.h>
+
+/* Number of keystream blocks generated by one call to tc_aes_encrypt_blocks. */
+#define TC_CTR_BLOCKS (4)
+
+/* XORs len bytes of in with the keystream, a word at a time. */
+static void ctr_xor(uint8_t *out, const uint8_t *in, const uint8_t *ks,
+		    unsigned int len)
+{
+	uint32_t a;
+	uint32_t b;
+	unsigned int i;
+
+	for (i = 0; i + sizeof(a) <= len; i += sizeof(a)) {
+		memcpy(&a, in + i, sizeof(a));
+		memcpy(&b, ks + i, sizeof(b));
+		a ^= b;
+		memcpy(out + i, &a, sizeof(a));
+	}
+	for (; i < len; ++i) {
+		out[i] = in[i] ^ ks[i];
+	}
+}
 
 int tc_ctr_mode(uint8_t *out, unsigned int outlen, const uint8_t *in,
 		unsigned int inlen, uint8_t *ctr, uint32_t *blk_off,
 		const TCAesKeySched_t sched)
 {
 
-	uint8_t buffer[TC_AES_BLOCK_SIZE];
+	uint8_t buffer[TC_CTR_BLOCKS * TC_AES_BLOCK_SIZE];
 	uint8_t nonce[TC_AES_BLOCK_SIZE];
 	unsigned int block_num;
+	unsigned int blocks;
+	unsigned int len;
 	unsigned int i;
 	uint32_t n;
 
@@ -53,7 +78,8 @@ int tc_ctr_mode(uint8_t *out, unsigned int outlen, const uint8_t *in,
 	    sched == (TCAesKeySched_t) 0 ||
 	    inlen == 0 ||
 	    outlen == 0 ||
-	    outlen != inlen) {
+	    outlen != inlen ||
+	    *blk_off >= TC_AES_BLOCK_SIZE) {
 		return TC_CRYPTO_FAIL;
 	}
 
@@ -64,28 +90,48 @@ int tc_ctr_mode(uint8_t *out, unsigned int outlen, const uint8_t *in,
 	block_num = (nonce[12] << 24) | (nonce[13] << 16) |
 		    (nonce[14] << 8) | (nonce[15]);
 	n = *blk_off;
-	for (i = 0; i < inlen; ++i) {
-		if (n == 0) {
-			/* encrypt data using the current nonce */
-			if (tc_aes_encrypt(buffer, nonce, sched)) {
-				block_num++;
-				nonce[12] = (uint8_t)(block_num >> 24);
-				nonce[13] = (uint8_t)(block_num >> 16);
-				nonce[14] = (uint8_t)(block_num >> 8);
-				nonce[15] = (uint8_t)(block_num);
-			} else {
-				return TC_CRYPTO_FAIL;
-			}
+	while (inlen > 0) {
+		/* keystream for the blocks holding the next bytes, n onwards */
+		blocks = (n + inlen + TC_AES_BLOCK_SIZE - 1) / TC_AES_BLOCK_SIZE;
+		if (blocks > TC_CTR_BLOCKS) {
+			blocks = TC_CTR_BLOCKS;
+		}
+		for (i = 0; i < blocks; ++i) {
+			(void)_copy(&buffer[i * TC_AES_BLOCK_SIZE],
+				    TC_AES_BLOCK_SIZE, nonce, TC_AES_BLOCK_SIZE);
+			buffer[i * TC_AES_BLOCK_SIZE + 12] = (uint8_t)((block_num + i) >> 24);
+			buffer[i * TC_AES_BLOCK_SIZE + 13] = (uint8_t)((block_num + i) >> 16);
+			buffer[i * TC_AES_BLOCK_SIZE + 14] = (uint8_t)((block_num + i) >> 8);
+			buffer[i * TC_AES_BLOCK_SIZE + 15] = (uint8_t)(block_num + i);
 		}
+		if (tc_aes_encrypt_blocks(buffer, buffer, blocks, sched) !=
+		    TC_CRYPTO_SUCCESS) {
+			return TC_CRYPTO_FAIL;
+		}
+
 		/* update the output */
-		*out++ = buffer[n] ^ *in++;
-		n = (n + 1) % TC_AES_BLOCK_SIZE;
+		len = blocks * TC_AES_BLOCK_SIZE - n;
+		if (len > inlen) {
+			len = inlen;
+		}
+		ctr_xor(out, in, &buffer[n], len);
+		out += len;
+		in += len;
+		inlen -= len;
+
+		/* move on to the block holding the next byte */
+		n += len;
+		block_num += n / TC_AES_BLOCK_SIZE;
+		n %= TC_AES_BLOCK_SIZE;
 	}
 	*blk_off = n;
 
 	/* update the counter */
-	ctr[12] = nonce[12]; ctr[13] = nonce[13];
-	ctr[14] = nonce[14]; ctr[15] = nonce[15];
+	ctr[12] = (uint8_t)(block_num >> 24); ctr[13] = (uint8_t)(block_num >> 16);
+	ctr[14] = (uint8_t)(block_num >> 8); ctr[15] = (uint8_t)(block_num);
+
+	/* zeroing out the keystream */
+	_set(buffer, TC_ZERO_BYTE, sizeof(buffer));
 
 	return TC_CRYPTO_SUCCESS;
 }
@@ -34,7 +34,16 @@
 #include <tinycrypt/constants.h>
 #include <tinycrypt/utils.h>
 
-static void compress(unsigned int *iv, const uint8_t *data);
+#if defined(TC_SHA256_NI_AVAILABLE)
+#include <immintrin.h>
+#endif
+
+typedef void (*compress_fn)(unsigned int *iv, const uint8_t *data, size_t blocks);
+
+static void compress(unsigned int *iv, const uint8_t *data, size_t blocks);
+#if defined(TC_SHA256_NI_AVAILABLE)
+static void compress_ni(unsigned int *iv, const uint8_t *data, size_t blocks);
+#endif
 
 int tc_sha256_init(TCSha256State_t s)
 {
@@ -62,8 +71,11 @@ int tc_sha256_init(TCSha256State_t s)
 	return TC_CRYPTO_SUCCESS;
 }
 
-int tc_sha256_update(TCSha256State_t s, const uint8_t *data, size_t datalen)
+static inline int sha256_update(TCSha256State_t s, const uint8_t *data,
+				size_t datalen, compress_fn compress)
 {
+	size_t len;
+
 	/* input sanity check: */
 	if (s == (TCSha256State_t) 0 ||
 	    data == (void *) 0) {
@@ -72,19 +84,34 @@ int tc_sha256_update(TCSha256State_t s, const uint8_t *data, size_t datalen)
 		return TC_CRYPTO_SUCCESS;
 	}
 
-	while (datalen-- > 0) {
-		s->leftover[s->leftover_offset++] = *(data++);
-		if (s->leftover_offset >= TC_SHA256_BLOCK_SIZE) {
-			compress(s->iv, s->leftover);
-			s->leftover_offset = 0;
-			s->bits_hashed += (TC_SHA256_BLOCK_SIZE << 3);
+	while (datalen > 0) {
+		if (s->leftover_offset == 0 && datalen >= TC_SHA256_BLOCK_SIZE) {
+			/* hash whole blocks straight from the input */
+			len = datalen - (datalen % TC_SHA256_BLOCK_SIZE);
+			compress(s->iv, data, len / TC_SHA256_BLOCK_SIZE);
+			s->bits_hashed += ((uint64_t)len << 3);
+		} else {
+			len = TC_SHA256_BLOCK_SIZE - s->leftover_offset;
+			if (len > datalen) {
+				len = datalen;
+			}
+			(void)_copy(s->leftover + s->leftover_offset, len, data, len);
+			s->leftover_offset += len;
+			if (s->leftover_offset == TC_SHA256_BLOCK_SIZE) {
+				compress(s->iv, s->leftover, 1);
+				s->leftover_offset = 0;
+				s->bits_hashed += (TC_SHA256_BLOCK_SIZE << 3);
+			}
 		}
+		data += len;
+		datalen -= len;
 	}
 
 	return TC_CRYPTO_SUCCESS;
 }
 
-int tc_sha256_final(uint8_t *digest, TCSha256State_t s)
+static inline int sha256_final(uint8_t *digest, TCSha256State_t s,
+			       compress_fn compress)
 {
 	unsigned int i;
 
@@ -101,7 +128,7 @@ int tc_sha256_final(uint8_t *digest, TCSha256State_t s)
 		/* there is not room for all the padding in this block */
 		_set(s->leftover + s->leftover_offset, 0x00,
 		     sizeof(s->leftover) - s->leftover_offset);
-		compress(s->iv, s->leftover);
+		compress(s->iv, s->leftover, 1);
 		s->leftover_offset = 0;
 	}
 
@@ -118,7 +145,7 @@ int tc_sha256_final(uint8_t *digest, TCSha256State_t s)
 	s->leftover[sizeof(s->leftover) - 8] = (uint8_t)(s->bits_hashed >> 56);
 
 	/* hash the padding and length */
-	compress(s->iv, s->leftover);
+	compress(s->iv, s->leftover, 1);
 
 	/* copy the iv out to digest */
 	for (i = 0; i < TC_SHA256_STATE_BLOCKS; ++i) {
@@ -135,6 +162,28 @@ int tc_sha256_final(uint8_t *digest, TCSha256State_t s)
 	return TC_CRYPTO_SUCCESS;
 }
 
+int tc_sha256_update(TCSha256State_t s, const uint8_t *data, size_t datalen)
+{
+	return sha256_update(s, data, datalen, compress);
+}
+
+int tc_sha256_final(uint8_t *digest, TCSha256State_t s)
+{
+	return sha256_final(digest, s, compress);
+}
+
+#if defined(TC_SHA256_NI_AVAILABLE)
+int tc_sha256_update_ni(TCSha256State_t s, const uint8_t *data, size_t datalen)
+{
+	return sha256_update(s, data, datalen, compress_ni);
+}
+
+int tc_sha256_final_ni(uint8_t *digest, TCSha256State_t s)
+{
+	return sha256_final(digest, s, compress_ni);
+}
+#endif
+
 /*
  * Initializing SHA-256 Hash constant words K.
  * These values correspond to the first 32 bits of the fractional parts of the
@@ -178,40 +227,106 @@ static inline unsigned int BigEndian(const uint8_t **c)
 	return n;
 }
 
-static void compress(unsigned int *iv, const uint8_t *data)
+#if defined(TC_SHA256_NI_AVAILABLE)
+/*
+ * Compression with the x86 SHA extensions. The instructions keep the state
+ * as ABEF and CDGH, and each sha256rnds2 does two rounds.
+ */
+__attribute__((target("sha,sse4.1")))
+static void compress_ni(unsigned int *iv, const uint8_t *data, size_t blocks)
+{
+	const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL,
+					    0x0405060700010203ULL);
+	__m128i state0, state1, abef, cdgh;
+	__m128i msg[4];
+	__m128i t;
+	unsigned int i;
+
+	t = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&iv[0]), 0xb1);
+	state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&iv[4]), 0x1b);
+	state0 = _mm_alignr_epi8(t, state1, 8);
+	state1 = _mm_blend_epi16(state1, t, 0xf0);
+
+	for (; blocks > 0; --blocks, data += TC_SHA256_BLOCK_SIZE) {
+		abef = state0;
+		cdgh = state1;
+
+		for (i = 0; i < 4; ++i) {
+			msg[i] = _mm_shuffle_epi8(
+				_mm_loadu_si128((const __m128i *)(data + 16 * i)), mask);
+		}
+
+		for (i = 0; i < 16; ++i) {
+			t = _mm_add_epi32(msg[i & 3],
+					  _mm_loadu_si128((const __m128i *)&k256[4 * i]));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, t);
+			state0 = _mm_sha256rnds2_epu32(state0, state1,
+						       _mm_shuffle_epi32(t, 0x0e));
+			if (i < 12) {
+				/* the message words of four rounds later */
+				t = _mm_add_epi32(
+					_mm_sha256msg1_epu32(msg[i & 3], msg[(i + 1) & 3]),
+					_mm_alignr_epi8(msg[(i + 3) & 3], msg[(i + 2) & 3], 4));
+				msg[i & 3] = _mm_sha256msg2_epu32(t, msg[(i + 3) & 3]);
+			}
+		}
+
+		state0 = _mm_add_epi32(state0, abef);
+		state1 = _mm_add_epi32(state1, cdgh);
+	}
+
+	t = _mm_shuffle_epi32(state0, 0x1b);
+	state1 = _mm_shuffle_epi32(state1, 0xb1);
+	_mm_storeu_si128((__m128i *)&iv[0], _mm_blend_epi16(t, state1, 0xf0));
+	_mm_storeu_si128((__m128i *)&iv[4], _mm_alignr_epi8(state1, t, 8));
+}
+#endif
+
+/*
+ * One round, computing the new a into h and the new e into d, so that the
+ * eight working variables rotate by renaming instead of moving.
+ */
+#define ROUND(a, b, c, d, e, f, g, h, i) \
+	do { \
+		t1 = (h) + Sigma1(e) + Ch(e, f, g) + k256[i] + W(i); \
+		(d) += t1; \
+		(h) = t1 + Sigma0(a) + Maj(a, b, c); \
+	} while (0)
+
+#define W(i) (work_space[(i) & 0xf])
+
+static void compress(unsigned int *iv, const uint8_t *data, size_t blocks)
 {
 	unsigned int a, b, c, d, e, f, g, h;
-	unsigned int s0, s1;
-	unsigned int t1, t2;
+	unsigned int t1;
 	unsigned int work_space[16];
-	unsigned int n;
 	unsigned int i;
+	unsigned int j;
 
-	a = iv[0]; b = iv[1]; c = iv[2]; d = iv[3];
-	e = iv[4]; f = iv[5]; g = iv[6]; h = iv[7];
+	for (; blocks > 0; --blocks) {
+		a = iv[0]; b = iv[1]; c = iv[2]; d = iv[3];
+		e = iv[4]; f = iv[5]; g = iv[6]; h = iv[7];
 
-	for (i = 0; i < 16; ++i) {
-		n = BigEndian(&data);
-		t1 = work_space[i] = n;
-		t1 += h + Sigma1(e) + Ch(e, f, g) + k256[i];
-		t2 = Sigma0(a) + Maj(a, b, c);
-		h = g; g = f; f = e; e = d + t1;
-		d = c; c = b; b = a; a = t1 + t2;
-	}
+		for (i = 0; i < 16; ++i) {
+			work_space[i] = BigEndian(&data);
+		}
 
-	for ( ; i < 64; ++i) {
-		s0 = work_space[(i+1)&0x0f];
-		s0 = sigma0(s0);
-		s1 = work_space[(i+14)&0x0f];
-		s1 = sigma1(s1);
-
-		t1 = work_space[i&0xf] += s0 + s1 + work_space[(i+9)&0xf];
-		t1 += h + Sigma1(e) + Ch(e, f, g) + k256[i];
-		t2 = Sigma0(a) + Maj(a, b, c);
-		h = g; g = f; f = e; e = d + t1;
-		d = c; c = b; b = a; a = t1 + t2;
-	}
+		for (i = 0; i < 64; i += 8) {
+			/* message words of the next eight rounds */
+			for (j = i; i >= 16 && j < i + 8; ++j) {
+				W(j) += sigma0(W(j + 1)) + sigma1(W(j + 14)) + W(j + 9);
+			}
+			ROUND(a, b, c, d, e, f, g, h, i);
+			ROUND(h, a, b, c, d, e, f, g, i + 1);
+			ROUND(g, h, a, b, c, d, e, f, i + 2);
+			ROUND(f, g, h, a, b, c, d, e, i + 3);
+			ROUND(e, f, g, h, a, b, c, d, i + 4);
+			ROUND(d, e, f, g, h, a, b, c, i + 5);
+			ROUND(c, d, e, f, g, h, a, b, i + 6);
+			ROUND(b, c, d, e, f, g, h, a, i + 7);
+		}
 
-	iv[0] += a; iv[1] += b; iv[2] += c; iv[3] += d;
-	iv[4] += e; iv[5] += f; iv[6] += g; iv[7] += h;
+		iv[0] += a; iv[1] += b; iv[2] += c; iv[3] += d;
+		iv[4] += e; iv[5] += f; iv[6] += g; iv[7] += h;
+	}
 }
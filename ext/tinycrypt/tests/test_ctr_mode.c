@@ -125,6 +125,97 @@ unsigned int test_1_and_2(void)
         return result;
 }
 
+/*
+ * Checks pieces of a stream starting and ending anywhere in a block against
+ * the keystream computed a block at a time, in place or not.
+ */
+unsigned int test_3(void)
+{
+        const uint8_t key[16] = {
+		0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88,
+		0x09, 0xcf, 0x4f, 0x3c
+        };
+        const uint8_t iv[16] = {
+		0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb,
+		0xfc, 0xfd, 0xff, 0xfd
+        };
+        struct tc_aes_key_sched_struct sched;
+        uint8_t plaintext[200];
+        uint8_t expected[200];
+        uint8_t out[200];
+        uint8_t ctr[16];
+        unsigned int result = TC_PASS;
+        unsigned int start;
+        unsigned int len;
+        unsigned int i;
+        uint32_t block_num;
+        uint32_t off;
+
+        TC_PRINT("CTR test #3 (unaligned pieces of a stream):\n");
+        (void)tc_aes128_set_encrypt_key(&sched, key);
+
+        for (i = 0; i < sizeof(plaintext); ++i) {
+                plaintext[i] = (uint8_t)(i * 7 + 1);
+        }
+        (void)memcpy(ctr, iv, sizeof(ctr));
+        for (i = 0; i < sizeof(expected); i += TC_AES_BLOCK_SIZE) {
+                (void)tc_aes_encrypt(&expected[i], ctr, &sched);
+                block_num = ((uint32_t)ctr[12] << 24) | (ctr[13] << 16) |
+                            (ctr[14] << 8) | ctr[15];
+                block_num++;
+                ctr[12] = (uint8_t)(block_num >> 24);
+                ctr[13] = (uint8_t)(block_num >> 16);
+                ctr[14] = (uint8_t)(block_num >> 8);
+                ctr[15] = (uint8_t)(block_num);
+        }
+        for (i = 0; i < sizeof(expected); ++i) {
+                expected[i] ^= plaintext[i];
+        }
+
+        for (start = 0; start < 40; ++start) {
+                for (len = 1; start + len <= sizeof(plaintext); len += 3) {
+                        (void)memcpy(ctr, iv, sizeof(ctr));
+                        block_num = ((uint32_t)ctr[12] << 24) | (ctr[13] << 16) |
+                                    (ctr[14] << 8) | ctr[15];
+                        block_num += start / TC_AES_BLOCK_SIZE;
+                        ctr[12] = (uint8_t)(block_num >> 24);
+                        ctr[13] = (uint8_t)(block_num >> 16);
+                        ctr[14] = (uint8_t)(block_num >> 8);
+                        ctr[15] = (uint8_t)(block_num);
+                        off = start % TC_AES_BLOCK_SIZE;
+
+                        /* the first piece out of place, the rest in place */
+                        (void)memcpy(out, plaintext, sizeof(out));
+                        if (tc_ctr_mode(&out[start], (len + 1) / 2,
+                                        &plaintext[start], (len + 1) / 2,
+                                        ctr, &off, &sched) == 0 ||
+                            (len > 1 &&
+                             tc_ctr_mode(&out[start + (len + 1) / 2], len / 2,
+                                         &out[start + (len + 1) / 2], len / 2,
+                                         ctr, &off, &sched) == 0)) {
+                                TC_ERROR("CTR test #3 failed in %s.\n", __func__);
+                                result = TC_FAIL;
+                                goto exitTest3;
+                        }
+
+                        block_num += (start % TC_AES_BLOCK_SIZE + len) /
+                                     TC_AES_BLOCK_SIZE;
+                        if (off != (start + len) % TC_AES_BLOCK_SIZE ||
+                            ctr[15] != (uint8_t)(block_num) ||
+                            memcmp(&out[start], &expected[start], len) != 0) {
+                                TC_ERROR("CTR test #3 mismatch at %u+%u.\n",
+                                         start, len);
+                                result = TC_FAIL;
+                                goto exitTest3;
+                        }
+                }
+        }
+
+ exitTest3:
+        TC_END_RESULT(result);
+        return result;
+}
+
 /*
  * Main task to test AES
  */
@@ -142,6 +233,12 @@ int main(void)
                 goto exitTest;
         }
 
+        result = test_3();
+        if (result == TC_FAIL) { /* terminate test */
+                TC_ERROR("CTR test #3 failed.\n");
+                goto exitTest;
+        }
+
         TC_PRINT("All CTR tests succeeded!\n");
 
  exitTest:
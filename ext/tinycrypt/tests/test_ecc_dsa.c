@@ -67,6 +67,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include <fcntl.h>
 
@@ -632,6 +633,146 @@ int montecarlo_signverify(int num_tests, bool verbose)
 	return TC_PASS;
 }
 
+int montecarlo_comb(int num_tests, bool verbose)
+{
+	printf("Test #4: Monte Carlo (%d Randomized EC-DSA signatures) ", num_tests);
+	printf("NIST-p256, SHA2-256, comb tables\n  ");
+	int i;
+	uint8_t private[NUM_ECC_BYTES];
+	uint8_t public[2*NUM_ECC_BYTES];
+	uint8_t other[2*NUM_ECC_BYTES];
+	uint8_t hash[NUM_ECC_BYTES];
+	unsigned int hash_words[NUM_ECC_WORDS];
+	uint8_t sig[2*NUM_ECC_BYTES];
+	uECC_word_t table[uECC_COMB_TABLE_WORDS];
+	uECC_word_t other_table[uECC_COMB_TABLE_WORDS];
+
+	const struct uECC_Curve_t * curve = uECC_secp256r1();
+
+	for (i = 0; i < num_tests; ++i) {
+		if (verbose) {
+			TC_PRINT(".");
+			fflush(stdout);
+		}
+
+		uECC_generate_random_int(hash_words, curve->n, BITS_TO_WORDS(curve->num_n_bits));
+		uECC_vli_nativeToBytes(hash, NUM_ECC_BYTES, hash_words);
+
+		if (!uECC_make_key(other, private, curve) ||
+		    !uECC_make_key(public, private, curve)) {
+			TC_ERROR("uECC_make_key() failed\n");
+			return TC_FAIL;
+		}
+
+		if (!uECC_compute_comb_table(public, table, curve) ||
+		    !uECC_compute_comb_table(other, other_table, curve)) {
+			TC_ERROR("uECC_compute_comb_table() failed\n");
+			return TC_FAIL;
+		}
+
+		if (!uECC_sign(private, hash, sizeof(hash), sig, curve)) {
+			TC_ERROR("uECC_sign() failed\n");
+			return TC_FAIL;
+		}
+
+		if (!uECC_verify_comb(public, table, hash, sizeof(hash), sig, curve)) {
+			TC_ERROR("uECC_verify_comb() failed\n");
+			return TC_FAIL;
+		}
+
+		/* The table of another key must be rejected. */
+		if (uECC_verify_comb(public, other_table, hash, sizeof(hash), sig, curve)) {
+			TC_ERROR("uECC_verify_comb() accepted the wrong table\n");
+			return TC_FAIL;
+		}
+
+		sig[i % sizeof(sig)] ^= 0x01;
+		if (uECC_verify_comb(public, table, hash, sizeof(hash), sig, curve) ||
+		    uECC_verify(public, hash, sizeof(hash), sig, curve)) {
+			TC_ERROR("uECC_verify_comb() accepted a bad signature\n");
+			return TC_FAIL;
+		}
+		if (verbose) {
+			fflush(stdout);
+			printf(".");
+		}
+	}
+	TC_PRINT("\n");
+	return TC_PASS;
+}
+
+int comb_generator_table(void)
+{
+	const struct uECC_Curve_t * curve = uECC_secp256r1();
+	uint8_t g[2*NUM_ECC_BYTES];
+	uECC_word_t table[uECC_COMB_TABLE_WORDS];
+	uint8_t hash[NUM_ECC_BYTES] = { 1 };
+	uint8_t sig[2*NUM_ECC_BYTES];
+	uint8_t private[NUM_ECC_BYTES] = { 0 };
+
+	/* With the private key 1, the public key is G: checks the built in
+	 * table of G against the one computed at run time.
+	 */
+	private[NUM_ECC_BYTES - 1] = 1;
+	uECC_vli_nativeToBytes(g, NUM_ECC_BYTES, curve->G);
+	uECC_vli_nativeToBytes(g + NUM_ECC_BYTES, NUM_ECC_BYTES,
+			       curve->G + NUM_ECC_WORDS);
+	if (!uECC_compute_comb_table(g, table, curve) ||
+	    !uECC_sign(private, hash, sizeof(hash), sig, curve) ||
+	    !uECC_verify_comb(g, table, hash, sizeof(hash), sig, curve)) {
+		TC_ERROR("comb table of G failed\n");
+		return TC_FAIL;
+	}
+	return TC_PASS;
+}
+
+/*
+ * Compares the time taken by uECC_verify() and uECC_verify_comb() on the host,
+ * which is representative of the ratio of cycles on targets, both doing the
+ * same big number operations.
+ */
+int benchmark_comb(int iterations)
+{
+	const struct uECC_Curve_t * curve = uECC_secp256r1();
+	uint8_t private[NUM_ECC_BYTES];
+	uint8_t public[2*NUM_ECC_BYTES];
+	uint8_t hash[NUM_ECC_BYTES];
+	uint8_t sig[2*NUM_ECC_BYTES];
+	uECC_word_t table[uECC_COMB_TABLE_WORDS];
+	clock_t start;
+	double plain;
+	double comb;
+	int i;
+
+	memset(hash, 0x5a, sizeof(hash));
+	if (!uECC_make_key(public, private, curve) ||
+	    !uECC_sign(private, hash, sizeof(hash), sig, curve) ||
+	    !uECC_compute_comb_table(public, table, curve)) {
+		return TC_FAIL;
+	}
+
+	start = clock();
+	for (i = 0; i < iterations; ++i) {
+		if (!uECC_verify(public, hash, sizeof(hash), sig, curve)) {
+			return TC_FAIL;
+		}
+	}
+	plain = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+	for (i = 0; i < iterations; ++i) {
+		if (!uECC_verify_comb(public, table, hash, sizeof(hash), sig, curve)) {
+			return TC_FAIL;
+		}
+	}
+	comb = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	TC_PRINT("uECC_verify:      %8.1f us per signature\n", plain * 1e6 / iterations);
+	TC_PRINT("uECC_verify_comb: %8.1f us per signature (%.2fx faster)\n",
+		 comb * 1e6 / iterations, comb > 0 ? plain / comb : 0.0);
+	return TC_PASS;
+}
+
 int main()
 {
 	unsigned int result = TC_PASS;
@@ -661,6 +802,25 @@ int main()
 	goto exitTest;
 	}
 
+	TC_PRINT("Performing montecarlo_comb test:\n");
+	result = montecarlo_comb(10, verbose);
+	if (result == TC_FAIL) {
+		TC_ERROR("montecarlo_comb test failed.\n");
+		goto exitTest;
+	}
+	TC_PRINT("Performing comb_generator_table test:\n");
+	result = comb_generator_table();
+	if (result == TC_FAIL) {
+		TC_ERROR("comb_generator_table test failed.\n");
+		goto exitTest;
+	}
+	TC_PRINT("Performing benchmark_comb:\n");
+	result = benchmark_comb(200);
+	if (result == TC_FAIL) {
+		TC_ERROR("benchmark_comb failed.\n");
+		goto exitTest;
+	}
+
 	TC_PRINT("\nAll ECC-DSA tests succeeded.\n");
 
  exitTest:
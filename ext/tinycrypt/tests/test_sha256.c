@@ -407,6 +407,100 @@ unsigned int test_14(void)
         return result;
 }
 
+/*
+ * Hashes a message in pieces of varying sizes, from an unaligned buffer, so
+ * that whole blocks are hashed both from the input and from the leftover.
+ */
+unsigned int test_15(void)
+{
+        unsigned int result = TC_PASS;
+        TC_PRINT("SHA256 test #15:\n");
+        const uint8_t expected[32] = {
+		0x09, 0x5e, 0xcb, 0x62, 0xe3, 0x07, 0x93, 0xab, 0x4b, 0x95, 0x4c, 0xd6,
+		0xa0, 0x58, 0x6d, 0x0c, 0xc9, 0x1f, 0x7e, 0xa5, 0xb1, 0x33, 0x26, 0x94,
+		0xd8, 0xda, 0x78, 0x0e, 0x98, 0x67, 0x6d, 0x78
+        };
+        const size_t pieces[] = { 1, 63, 64, 65, 3, 128, 200, 7 };
+        uint8_t m[1001];
+        uint8_t digest[32];
+        struct tc_sha256_state_struct s;
+        size_t off;
+        size_t len;
+        unsigned int i;
+
+        for (i = 0; i < 1000; ++i) {
+                m[i + 1] = (uint8_t)(i * 7 + 1);
+        }
+
+        (void)tc_sha256_init(&s);
+        for (off = 0, i = 0; off < 1000; off += len, ++i) {
+                len = pieces[i % (sizeof(pieces) / sizeof(pieces[0]))];
+                if (len > 1000 - off) {
+                        len = 1000 - off;
+                }
+                (void)tc_sha256_update(&s, &m[1 + off], len);
+        }
+        (void)tc_sha256_final(digest, &s);
+
+        result = check_result(15, expected, sizeof(expected),
+			      digest, sizeof(digest));
+        TC_END_RESULT(result);
+        return result;
+}
+
+#if defined(TC_SHA256_NI_AVAILABLE)
+#include <cpuid.h>
+
+/*
+ * Hashes the message of test #15 with the SHA extensions, when the CPU has
+ * them, and checks that the digest is the same.
+ */
+unsigned int test_16(void)
+{
+        unsigned int result = TC_PASS;
+        TC_PRINT("SHA256 test #16:\n");
+        const size_t pieces[] = { 1, 63, 64, 65, 3, 128, 200, 7 };
+        uint8_t m[1001];
+        uint8_t expected[32];
+        uint8_t digest[32];
+        struct tc_sha256_state_struct s;
+        unsigned int eax, ebx, ecx, edx;
+        size_t off;
+        size_t len;
+        unsigned int i;
+
+        if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) ||
+            !(ebx & (1 << 29))) {
+                TC_PRINT("no SHA extensions, skipped\n");
+                TC_END_RESULT(result);
+                return result;
+        }
+
+        for (i = 0; i < 1000; ++i) {
+                m[i + 1] = (uint8_t)(i * 7 + 1);
+        }
+
+        (void)tc_sha256_init(&s);
+        (void)tc_sha256_update(&s, &m[1], 1000);
+        (void)tc_sha256_final(expected, &s);
+
+        (void)tc_sha256_init(&s);
+        for (off = 0, i = 0; off < 1000; off += len, ++i) {
+                len = pieces[i % (sizeof(pieces) / sizeof(pieces[0]))];
+                if (len > 1000 - off) {
+                        len = 1000 - off;
+                }
+                (void)tc_sha256_update_ni(&s, &m[1 + off], len);
+        }
+        (void)tc_sha256_final_ni(digest, &s);
+
+        result = check_result(16, expected, sizeof(expected),
+			      digest, sizeof(digest));
+        TC_END_RESULT(result);
+        return result;
+}
+#endif
+
 /*
  * Main task to test AES
  */
@@ -501,6 +595,20 @@ int main(void)
                 TC_ERROR("SHA256 test #14 failed.\n");
                 goto exitTest;
         }
+        result = test_15();
+        if (result == TC_FAIL) {
+		/* terminate test */
+                TC_ERROR("SHA256 test #15 failed.\n");
+                goto exitTest;
+        }
+#if defined(TC_SHA256_NI_AVAILABLE)
+        result = test_16();
+        if (result == TC_FAIL) {
+		/* terminate test */
+                TC_ERROR("SHA256 test #16 failed.\n");
+                goto exitTest;
+        }
+#endif
 
         TC_PRINT("All SHA256 tests succeeded!\n");
 
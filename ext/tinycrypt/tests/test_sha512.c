@@ -0,0 +1,220 @@
+/*  test_sha512.c - TinyCrypt implementation of some SHA-512 tests */
+
+/*
+ *  Copyright (C) 2017 by Intel Corporation, All Rights Reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *    - Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *    - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ *    - Neither the name of Intel Corporation nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+  DESCRIPTION
+  This module tests the following SHA512 routines:
+
+  Scenarios tested include:
+  - NIST SHA512 test vectors
+  - hashing a message in pieces of varying sizes
+*/
+
+#include <tinycrypt/sha512.h>
+#include <tinycrypt/constants.h>
+#include <test_utils.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/*
+ * NIST SHA512 test vector 1, one block.
+ */
+unsigned int test_1(void)
+{
+        unsigned int result = TC_PASS;
+
+        TC_PRINT("SHA512 test #1:\n");
+        const uint8_t expected[64] = {
+		0xdd, 0xaf, 0x35, 0xa1, 0x93, 0x61, 0x7a, 0xba, 0xcc, 0x41, 0x73, 0x49,
+		0xae, 0x20, 0x41, 0x31, 0x12, 0xe6, 0xfa, 0x4e, 0x89, 0xa9, 0x7e, 0xa2,
+		0x0a, 0x9e, 0xee, 0xe6, 0x4b, 0x55, 0xd3, 0x9a, 0x21, 0x92, 0x99, 0x2a,
+		0x27, 0x4f, 0xc1, 0xa8, 0x36, 0xba, 0x3c, 0x23, 0xa3, 0xfe, 0xeb, 0xbd,
+		0x45, 0x4d, 0x44, 0x23, 0x64, 0x3c, 0xe8, 0x0e, 0x2a, 0x9a, 0xc9, 0x4f,
+		0xa5, 0x4c, 0xa4, 0x9f
+        };
+        const char *m = "abc";
+        uint8_t digest[64];
+        struct tc_sha512_state_struct s;
+
+        (void)tc_sha512_init(&s);
+        tc_sha512_update(&s, (const uint8_t *) m, strlen(m));
+        (void)tc_sha512_final(digest, &s);
+        result = check_result(1, expected, sizeof(expected),
+			      digest, sizeof(digest));
+        TC_END_RESULT(result);
+        return result;
+}
+
+/*
+ * NIST SHA512 test vector 2, two blocks.
+ */
+unsigned int test_2(void)
+{
+        unsigned int result = TC_PASS;
+
+        TC_PRINT("SHA512 test #2:\n");
+        const uint8_t expected[64] = {
+		0x8e, 0x95, 0x9b, 0x75, 0xda, 0xe3, 0x13, 0xda, 0x8c, 0xf4, 0xf7, 0x28,
+		0x14, 0xfc, 0x14, 0x3f, 0x8f, 0x77, 0x79, 0xc6, 0xeb, 0x9f, 0x7f, 0xa1,
+		0x72, 0x99, 0xae, 0xad, 0xb6, 0x88, 0x90, 0x18, 0x50, 0x1d, 0x28, 0x9e,
+		0x49, 0x00, 0xf7, 0xe4, 0x33, 0x1b, 0x99, 0xde, 0xc4, 0xb5, 0x43, 0x3a,
+		0xc7, 0xd3, 0x29, 0xee, 0xb6, 0xdd, 0x26, 0x54, 0x5e, 0x96, 0xe5, 0x5b,
+		0x87, 0x4b, 0xe9, 0x09
+        };
+        const char *m = "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmn"
+                        "hijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu";
+        uint8_t digest[64];
+        struct tc_sha512_state_struct s;
+
+        (void)tc_sha512_init(&s);
+        tc_sha512_update(&s, (const uint8_t *) m, strlen(m));
+        (void)tc_sha512_final(digest, &s);
+        result = check_result(2, expected, sizeof(expected),
+			      digest, sizeof(digest));
+        TC_END_RESULT(result);
+        return result;
+}
+
+/*
+ * Empty message.
+ */
+unsigned int test_3(void)
+{
+        unsigned int result = TC_PASS;
+
+        TC_PRINT("SHA512 test #3:\n");
+        const uint8_t expected[64] = {
+		0xcf, 0x83, 0xe1, 0x35, 0x7e, 0xef, 0xb8, 0xbd, 0xf1, 0x54, 0x28, 0x50,
+		0xd6, 0x6d, 0x80, 0x07, 0xd6, 0x20, 0xe4, 0x05, 0x0b, 0x57, 0x15, 0xdc,
+		0x83, 0xf4, 0xa9, 0x21, 0xd3, 0x6c, 0xe9, 0xce, 0x47, 0xd0, 0xd1, 0x3c,
+		0x5d, 0x85, 0xf2, 0xb0, 0xff, 0x83, 0x18, 0xd2, 0x87, 0x7e, 0xec, 0x2f,
+		0x63, 0xb9, 0x31, 0xbd, 0x47, 0x41, 0x7a, 0x81, 0xa5, 0x38, 0x32, 0x7a,
+		0xf9, 0x27, 0xda, 0x3e
+        };
+        uint8_t digest[64];
+        struct tc_sha512_state_struct s;
+
+        (void)tc_sha512_init(&s);
+        (void)tc_sha512_final(digest, &s);
+        result = check_result(3, expected, sizeof(expected),
+			      digest, sizeof(digest));
+        TC_END_RESULT(result);
+        return result;
+}
+
+/*
+ * Hashes a message in pieces of varying sizes, from an unaligned buffer, so
+ * that whole blocks are hashed both from the input and from the leftover.
+ */
+unsigned int test_4(void)
+{
+        unsigned int result = TC_PASS;
+        TC_PRINT("SHA512 test #4:\n");
+        const uint8_t expected[64] = {
+		0x76, 0xf1, 0xe7, 0x66, 0xac, 0x03, 0xde, 0xff, 0x8c, 0x61, 0x47, 0x80,
+		0xdc, 0x1f, 0x26, 0x82, 0x5a, 0xd7, 0x62, 0xf9, 0x2f, 0xbb, 0xa0, 0x9e,
+		0x25, 0x52, 0xcd, 0x70, 0xb2, 0xd6, 0x33, 0x38, 0x16, 0xe7, 0xed, 0xec,
+		0x5d, 0x88, 0x20, 0xe8, 0x46, 0x06, 0x01, 0xea, 0x18, 0xd5, 0x5b, 0x4f,
+		0xb1, 0x54, 0x52, 0x8d, 0xb9, 0x9a, 0x0b, 0xf1, 0x76, 0x70, 0xf1, 0x5f,
+		0x74, 0xc8, 0x2c, 0xb7
+        };
+        const size_t pieces[] = { 1, 127, 128, 129, 3, 256, 200, 7 };
+        uint8_t m[1001];
+        uint8_t digest[64];
+        struct tc_sha512_state_struct s;
+        size_t off;
+        size_t len;
+        unsigned int i;
+
+        for (i = 0; i < 1000; ++i) {
+                m[i + 1] = (uint8_t)(i * 7 + 1);
+        }
+
+        (void)tc_sha512_init(&s);
+        for (off = 0, i = 0; off < 1000; off += len, ++i) {
+                len = pieces[i % (sizeof(pieces) / sizeof(pieces[0]))];
+                if (len > 1000 - off) {
+                        len = 1000 - off;
+                }
+                (void)tc_sha512_update(&s, &m[1 + off], len);
+        }
+        (void)tc_sha512_final(digest, &s);
+
+        result = check_result(4, expected, sizeof(expected),
+			      digest, sizeof(digest));
+        TC_END_RESULT(result);
+        return result;
+}
+
+/*
+ * Main task to test SHA512
+ */
+
+int main(void)
+{
+        unsigned int result = TC_PASS;
+        TC_START("Performing SHA512 tests (NIST tests vectors):");
+
+        result = test_1();
+        if (result == TC_FAIL) {
+		/* terminate test */
+                TC_ERROR("SHA512 test #1 failed.\n");
+                goto exitTest;
+        }
+        result = test_2();
+        if (result == TC_FAIL) {
+		/* terminate test */
+                TC_ERROR("SHA512 test #2 failed.\n");
+                goto exitTest;
+        }
+        result = test_3();
+        if (result == TC_FAIL) {
+		/* terminate test */
+                TC_ERROR("SHA512 test #3 failed.\n");
+                goto exitTest;
+        }
+        result = test_4();
+        if (result == TC_FAIL) {
+		/* terminate test */
+                TC_ERROR("SHA512 test #4 failed.\n");
+                goto exitTest;
+        }
+
+        TC_PRINT("All SHA512 tests succeeded!\n");
+
+exitTest:
+        TC_END_RESULT(result);
+        TC_END_REPORT(result);
+}
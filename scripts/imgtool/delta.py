@@ -0,0 +1,209 @@
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+Patches for delta images, applied in place by the bootloader.
+
+A patch builds the body of the new image, which starts at offset out_off of
+the primary slot, from the base image, which the bootloader first moves up
+by shift bytes. It is a sequence of commands, each a command byte followed
+by a LEB128 encoded argument:
+
+- COPY n: copies n bytes of the base image from the current base position,
+  which is advanced by n.
+- LITERAL n: copies the n bytes following the command.
+- SEEK d: moves the base position by d, zigzag encoded.
+
+As the primary slot is overwritten while the patch is applied, data can
+only be copied from an offset of the moved base image which is at least
+that of the output.
+"""
+
+import struct
+
+COPY = 0x00
+LITERAL = 0x01
+SEEK = 0x02
+
+# Shortest matches worth a COPY, continuing from the base position or not.
+MIN_CONTINUATION = 8
+MIN_MATCH = 16
+KEY_SIZE = 8
+MAX_CANDIDATES = 8
+
+IMAGE_MAGIC = 0x96f3b83d
+TLV_INFO_MAGIC = 0x6907
+TLV_PROT_INFO_MAGIC = 0x6908
+HASH_TLVS = (0x10, 0x11, 0x12)
+
+
+class DeltaError(Exception):
+    pass
+
+
+def _varint(value):
+    out = bytearray()
+    while True:
+        byte = value & 0x7f
+        value >>= 7
+        if value:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return bytes(out)
+
+
+def _read_varint(data, off):
+    value = 0
+    shift = 0
+    while True:
+        byte = data[off]
+        off += 1
+        value |= (byte & 0x7f) << shift
+        shift += 7
+        if not byte & 0x80:
+            return value, off
+
+
+def _zigzag(value):
+    return (value << 1) if value >= 0 else ((-value - 1) << 1) | 1
+
+
+def _unzigzag(value):
+    return -((value >> 1) + 1) if value & 1 else value >> 1
+
+
+def _match_len(a, a_off, b, b_off, limit):
+    n = 0
+    while n < limit:
+        chunk = min(64, limit - n)
+        if a[a_off + n:a_off + n + chunk] == b[b_off + n:b_off + n + chunk]:
+            n += chunk
+            continue
+        while a[a_off + n] == b[b_off + n]:
+            n += 1
+        break
+    return n
+
+
+def make_patch(base, new, out_off, shift):
+    """Computes the patch turning base into new, new going at out_off."""
+    index = {}
+    for pos in range(len(base) - KEY_SIZE + 1):
+        positions = index.setdefault(base[pos:pos + KEY_SIZE], [])
+        if len(positions) < MAX_CANDIDATES:
+            positions.append(pos)
+
+    patch = bytearray()
+    literal = bytearray()
+    base_pos = 0
+    i = 0
+
+    def flush_literal():
+        if literal:
+            patch.extend(bytes([LITERAL]) + _varint(len(literal)) + literal)
+            literal.clear()
+
+    while i < len(new):
+        # Base data must be read from at or after the output offset.
+        first = max(out_off + i - shift, 0)
+        best_len = 0
+        best_pos = 0
+        if base_pos >= first and base_pos < len(base):
+            best_len = _match_len(base, base_pos, new, i,
+                                  min(len(base) - base_pos, len(new) - i))
+            best_pos = base_pos
+            if best_len < MIN_CONTINUATION:
+                best_len = 0
+        for pos in index.get(new[i:i + KEY_SIZE], ()):
+            if pos < first or pos == base_pos:
+                continue
+            n = _match_len(base, pos, new, i, min(len(base) - pos, len(new) - i))
+            if n >= MIN_MATCH and n > best_len:
+                best_len = n
+                best_pos = pos
+
+        if best_len == 0:
+            literal.append(new[i])
+            i += 1
+            continue
+
+        flush_literal()
+        if best_pos != base_pos:
+            patch.extend(bytes([SEEK]) + _varint(_zigzag(best_pos - base_pos)))
+        patch.extend(bytes([COPY]) + _varint(best_len))
+        base_pos = best_pos + best_len
+        i += best_len
+
+    flush_literal()
+    return bytes(patch)
+
+
+def apply_patch(base, patch, out_off, shift, size):
+    """Applies a patch the way the bootloader does, checking its rules."""
+    out = bytearray()
+    base_pos = 0
+    off = 0
+    while len(out) < size:
+        cmd = patch[off]
+        arg, off = _read_varint(patch, off + 1)
+        if cmd == SEEK:
+            base_pos += _unzigzag(arg)
+            if not 0 <= base_pos <= len(base):
+                raise DeltaError("seek out of the base image")
+        elif cmd == LITERAL:
+            out += patch[off:off + arg]
+            off += arg
+        elif cmd == COPY:
+            if base_pos + arg > len(base):
+                raise DeltaError("copy out of the base image")
+            if base_pos + shift < out_off + len(out):
+                raise DeltaError("copy from overwritten data")
+            out += base[base_pos:base_pos + arg]
+            base_pos += arg
+        else:
+            raise DeltaError(f"unknown command {cmd}")
+    if len(out) != size or off != len(patch):
+        raise DeltaError("patch size mismatch")
+    return bytes(out)
+
+
+def read_base(data, endian='little'):
+    """Returns the size and hash of a signed image, to patch against."""
+    e = '<' if endian == 'little' else '>'
+    magic, _, hdr_size, prot_size, img_size = struct.unpack_from(
+        e + 'IIHHI', data, 0)
+    if magic != IMAGE_MAGIC:
+        raise DeltaError("base image has no image header")
+    off = hdr_size + img_size
+    if prot_size:
+        tlv_magic, tlv_tot = struct.unpack_from(e + 'HH', data, off)
+        if tlv_magic != TLV_PROT_INFO_MAGIC or tlv_tot != prot_size:
+            raise DeltaError("invalid base image protected TLVs")
+        off += prot_size
+    tlv_magic, tlv_tot = struct.unpack_from(e + 'HH', data, off)
+    if tlv_magic != TLV_INFO_MAGIC:
+        raise DeltaError("invalid base image TLVs")
+    end = off + tlv_tot
+    image_hash = None
+    off += 4
+    while off < end:
+        tlv_type, tlv_len = struct.unpack_from(e + 'HH', data, off)
+        off += 4
+        if tlv_type in HASH_TLVS:
+            image_hash = bytes(data[off:off + tlv_len])
+        off += tlv_len
+    if image_hash is None:
+        raise DeltaError("base image has no hash")
+    return end, image_hash
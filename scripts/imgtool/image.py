@@ -66,6 +66,7 @@ IMAGE_F = {
         'COMPRESSED_LZMA1':      0x0000200,
         'COMPRESSED_LZMA2':      0x0000400,
         'COMPRESSED_ARM_THUMB':  0x0000800,
+        'DELTA':                 0x0001000,
 }
 
 TLV_VALUES = {
@@ -93,6 +94,8 @@ TLV_VALUES = {
         'COMP_DEC_SIZE' : 0x73,
         'UUID_VID': 0x74,
         'UUID_CID': 0x75,
+        'SECTOR_HASHES': 0x76,
+        'DELTA_BASE': 0x77,
 }
 
 TLV_SIZE = 4
@@ -292,7 +295,8 @@ class Image:
                  overwrite_only=False, endian="little", load_addr=0,
                  rom_fixed=None, erased_val=None, save_enctlv=False,
                  security_counter=None, max_align=None,
-                 non_bootable=False, vid=None, cid=None):
+                 non_bootable=False, vid=None, cid=None,
+                 sector_hash_size=None):
 
         if load_addr and rom_fixed:
             raise click.UsageError("Can not set rom_fixed and load_addr at the same time")
@@ -324,6 +328,7 @@ class Image:
         self.non_bootable = non_bootable
         self.vid = vid
         self.cid = cid
+        self.sector_hash_size = sector_hash_size
 
         if self.max_align == DEFAULT_MAX_ALIGN:
             self.boot_magic = bytes([
@@ -598,6 +603,16 @@ class Image:
             for value in custom_tlvs.values():
                 protected_tlv_size += TLV_SIZE + len(value)
 
+        if self.sector_hash_size is not None:
+            # Block size ('I') followed by one digest per block of the
+            # image header and body, once padded for encryption
+            covered = len(self.payload)
+            if self.enckey is not None and dont_encrypt is False:
+                covered = align_up(covered, 16)
+            blocks = (covered + self.sector_hash_size - 1) // self.sector_hash_size
+            protected_tlv_size += TLV_SIZE + 4 + \
+                blocks * hash_algorithm().digest_size
+
         if protected_tlv_size != 0:
             # Add the size of the TLV info header
             protected_tlv_size += TLV_INFO_SIZE
@@ -620,6 +635,8 @@ class Image:
             compression_flags = IMAGE_F['COMPRESSED_LZMA2']
             if compression_type == "lzma2armthumb":
                 compression_flags |= IMAGE_F['COMPRESSED_ARM_THUMB']
+        elif compression_tlvs is not None and compression_type == "delta":
+            compression_flags = IMAGE_F['DELTA']
         # This adds the header to the payload as well
         if encrypt_keylen == 256:
             self.add_header(enckey, protected_tlv_size, compression_flags, 256)
@@ -676,6 +693,14 @@ class Image:
                 for tag, value in custom_tlvs.items():
                     prot_tlv.add(tag, value)
 
+            if self.sector_hash_size is not None:
+                payload = struct.pack(e + 'I', self.sector_hash_size)
+                for off in range(0, len(self.payload), self.sector_hash_size):
+                    sha = hash_algorithm()
+                    sha.update(self.payload[off:off + self.sector_hash_size])
+                    payload += sha.digest()
+                prot_tlv.add('SECTOR_HASHES', payload)
+
             protected_tlv_off = len(self.payload)
 
             self.payload += prot_tlv.get()
@@ -18,6 +18,60 @@ class ECDSAUsageError(Exception):
     pass
 
 
+# NIST P-256 parameters, for the verification tables.
+P256_P = 0xffffffff00000001000000000000000000000000ffffffffffffffffffffffff
+P256_GX = 0x6b17d1f2e12c4247f8bce6e563a440f277037d812deb33a0f4a13945d898c296
+P256_GY = 0x4fe342e2fe1a7f9b8ee7eb4a7c0f9e162bce33576b315ececbb6406837bf51f5
+
+# Layout of the fixed-base comb tables of MCUBOOT_ECDSA_COMB_TABLES, which
+# must match uECC_COMB_TEETH in tinycrypt/ecc_dsa.h.
+COMB_TEETH = 4
+COMB_SPACING = 256 // COMB_TEETH
+WORD_BITS = 32
+
+
+def _p256_add(p1, p2):
+    """Adds two distinct affine points, neither of them being the infinity."""
+    (x1, y1), (x2, y2) = p1, p2
+    if x1 == x2:
+        if (y1 + y2) % P256_P == 0:
+            raise ValueError("point at infinity")
+        lam = (3 * x1 * x1 - 3) * pow(2 * y1, -1, P256_P)
+    else:
+        lam = (y2 - y1) * pow(x2 - x1, -1, P256_P)
+    lam %= P256_P
+    x3 = (lam * lam - x1 - x2) % P256_P
+    return x3, (lam * (x1 - x3) - y1) % P256_P
+
+
+def p256_comb_table(x, y):
+    """Returns the comb table of point (x, y) as 32-bit words.
+
+    Entry i - 1, for i from 1 to 2^COMB_TEETH - 1, is the sum of
+    2^(COMB_SPACING * j) * (x, y) for all bits j set in i, as the affine x
+    and y coordinates, least significant word first.
+    """
+    bases = [(x, y)]
+    for _ in range(COMB_TEETH - 1):
+        point = bases[-1]
+        for _ in range(COMB_SPACING):
+            point = _p256_add(point, point)
+        bases.append(point)
+
+    points = [None]
+    for i in range(1, 1 << COMB_TEETH):
+        low = (i & -i).bit_length() - 1
+        rest = i & (i - 1)
+        points.append(_p256_add(points[rest], bases[low]) if rest else bases[low])
+
+    words = []
+    for px, py in points[1:]:
+        for coord in (px, py):
+            words.extend((coord >> (WORD_BITS * n)) & 0xffffffff
+                         for n in range(256 // WORD_BITS))
+    return words
+
+
 class ECDSAPublicKey(KeyClass):
     """
     Wrapper around an ECDSA public key.
@@ -151,6 +205,10 @@ class ECDSA256P1Public(ECDSAPublicKey):
     def shortname(self):
         return "ecdsa"
 
+    def get_public_table(self):
+        numbers = self._get_public().public_numbers()
+        return p256_comb_table(numbers.x, numbers.y)
+
     def sig_type(self):
         return "ECDSA256_SHA256"
 
@@ -14,6 +14,77 @@ class Ed25519UsageError(Exception):
     pass
 
 
+# Curve25519 parameters, for the verification tables.
+ED25519_P = 2**255 - 19
+ED25519_D = -121665 * pow(121666, -1, ED25519_P) % ED25519_P
+
+# Layout of the tables of MCUBOOT_ED25519_PRECOMP_TABLES, which must match
+# ED25519_TABLE_PARTS in ext/fiat/src/curve25519.c.
+TABLE_PARTS = 4
+TABLE_SPACING = 256 // TABLE_PARTS
+TABLE_MULTIPLES = 8
+
+
+def _ed25519_decode(data):
+    """Decodes an encoded point into its affine coordinates."""
+    p = ED25519_P
+    y = int.from_bytes(data, 'little') & ((1 << 255) - 1)
+    xx = (y * y - 1) * pow(ED25519_D * y * y + 1, -1, p) % p
+    x = pow(xx, (p + 3) // 8, p)
+    if (x * x - xx) % p:
+        x = x * pow(2, (p - 1) // 4, p) % p
+    if (x * x - xx) % p:
+        raise ValueError("invalid point")
+    if x & 1 != data[31] >> 7:
+        x = p - x
+    return x, y
+
+
+def _ed25519_add(p1, p2):
+    """Adds two affine points."""
+    p = ED25519_P
+    (x1, y1), (x2, y2) = p1, p2
+    dxy = ED25519_D * x1 * x2 * y1 * y2 % p
+    return ((x1 * y2 + x2 * y1) * pow(1 + dxy, -1, p) % p,
+            (y1 * y2 + x1 * x2) * pow(1 - dxy, -1, p) % p)
+
+
+def _fe_words(value):
+    """Returns a field element as the 10 limbs of the fiat fe type."""
+    words = []
+    for n in range(10):
+        bits = 25 if n & 1 else 26
+        words.append(value & ((1 << bits) - 1))
+        value >>= bits
+    return words
+
+
+def ed25519_table(public_bytes):
+    """Returns the verification table of an encoded public key A as 32-bit
+    words.
+
+    Entry i of part k, for i from 0 to TABLE_MULTIPLES - 1, is
+    (2 * i + 1) * 2^(TABLE_SPACING * k) * -A, as the ge_precomp y + x, y - x
+    and 2 * d * x * y.
+    """
+    p = ED25519_P
+    x, y = _ed25519_decode(public_bytes)
+    base = (p - x, y)
+    words = []
+    for _ in range(TABLE_PARTS):
+        double = _ed25519_add(base, base)
+        point = base
+        for _ in range(TABLE_MULTIPLES):
+            px, py = point
+            for coord in ((py + px) % p, (py - px) % p,
+                          2 * ED25519_D * px * py % p):
+                words.extend(_fe_words(coord))
+            point = _ed25519_add(point, double)
+        for _ in range(TABLE_SPACING):
+            base = _ed25519_add(base, base)
+    return words
+
+
 class Ed25519Public(KeyClass):
     def __init__(self, key):
         self.key = key
@@ -33,6 +104,11 @@ class Ed25519Public(KeyClass):
                 encoding=serialization.Encoding.DER,
                 format=serialization.PublicFormat.SubjectPublicKeyInfo)
 
+    def get_public_table(self):
+        return ed25519_table(self._get_public().public_bytes(
+            encoding=serialization.Encoding.Raw,
+            format=serialization.PublicFormat.Raw))
+
     def get_public_pem(self):
         return self._get_public().public_bytes(
             encoding=serialization.Encoding.PEM,
@@ -2,11 +2,10 @@
 
 # SPDX-License-Identifier: Apache-2.0
 
+import hashlib
 import os
 import sys
 
-from cryptography.hazmat.primitives.hashes import SHA256, Hash
-
 AUTOGEN_MESSAGE = "/* Autogenerated by imgtool.py, do not edit. */"
 
 
@@ -32,19 +31,19 @@ class KeyClass:
     def _emit(self, header, trailer, encoded_bytes, indent, file=sys.stdout,
               len_format=None):
         with FileHandler(file, 'w') as file:
+            print(AUTOGEN_MESSAGE, file=file)
             self._emit_to_output(header, trailer, encoded_bytes, indent,
                                      file, len_format)
 
     def _emit_to_output(self, header, trailer, encoded_bytes, indent, file,
-                        len_format):
-        print(AUTOGEN_MESSAGE, file=file)
+                        len_format, item_format="0x{:02x}", per_line=8):
         print(header, end='', file=file)
         for count, b in enumerate(encoded_bytes):
-            if count % 8 == 0:
+            if count % per_line == 0:
                 print("\n" + indent, end='', file=file)
             else:
                 print(" ", end='', file=file)
-            print(f"0x{b:02x},", end='', file=file)
+            print(item_format.format(b) + ",", end='', file=file)
         print("\n" + trailer, file=file)
         if len_format is not None:
             print(len_format.format(len(encoded_bytes)), file=file)
@@ -59,37 +58,63 @@ class KeyClass:
                 # raw binary data, can be for example io.BytesIO
                 file.write(encoded_bytes)
 
-    def emit_c_public(self, file=sys.stdout):
-        self._emit(
-                header=f"const unsigned char {self.shortname()}_pub_key[] = {{"
-                       ,
-                trailer="};",
-                encoded_bytes=self.get_public_bytes(),
-                indent="    ",
-                len_format=f"const unsigned int {self.shortname()}_pub_key_len = {{}};"
-                           ,
-                file=file)
+    def get_public_hash(self, hash_alg=hashlib.sha256):
+        """Digest of the public key, as put in the KEYHASH TLV of images."""
+        return hash_alg(self.get_public_bytes()).digest()
 
-    def emit_c_public_hash(self, file=sys.stdout):
-        digest = Hash(SHA256())
-        digest.update(self.get_public_bytes())
-        self._emit(
+    def get_public_table(self):
+        """Precomputed verification table of the key, if it has one."""
+        return None
+
+    def emit_c_public(self, file=sys.stdout, hash_alg=None, table=False):
+        """Emits the public key, followed by its digest if hash_alg is set
+        and by its verification table if table is set."""
+        with FileHandler(file, 'w') as file:
+            print(AUTOGEN_MESSAGE, file=file)
+            self._emit_to_output(
+                    header=f"const unsigned char {self.shortname()}_pub_key[] = {{"
+                           ,
+                    trailer="};",
+                    encoded_bytes=self.get_public_bytes(),
+                    indent="    ",
+                    len_format=f"const unsigned int {self.shortname()}_pub_key_len = {{}};"
+                               ,
+                    file=file)
+            if hash_alg is not None:
+                self._emit_c_public_hash_to_output(hash_alg, file)
+            if table:
+                self._emit_to_output(
+                        header=f"const unsigned int {self.shortname()}_pub_key_table[] = {{"
+                               ,
+                        trailer="};",
+                        encoded_bytes=self.get_public_table(),
+                        indent="    ",
+                        len_format=None,
+                        item_format="0x{:08x}",
+                        per_line=4,
+                        file=file)
+
+    def _emit_c_public_hash_to_output(self, hash_alg, file):
+        self._emit_to_output(
                 header=f"const unsigned char {self.shortname()}_pub_key_hash[] = {{"
                        ,
                 trailer="};",
-                encoded_bytes=digest.finalize(),
+                encoded_bytes=self.get_public_hash(hash_alg),
                 indent="    ",
                 len_format=f"const unsigned int {self.shortname()}_pub_key_hash_len = {{}};"
                            ,
                 file=file)
 
+    def emit_c_public_hash(self, file=sys.stdout, hash_alg=hashlib.sha256):
+        with FileHandler(file, 'w') as file:
+            print(AUTOGEN_MESSAGE, file=file)
+            self._emit_c_public_hash_to_output(hash_alg, file)
+
     def emit_raw_public(self, file=sys.stdout):
         self._emit_raw(self.get_public_bytes(), file=file)
 
-    def emit_raw_public_hash(self, file=sys.stdout):
-        digest = Hash(SHA256())
-        digest.update(self.get_public_bytes())
-        self._emit_raw(digest.finalize(), file=file)
+    def emit_raw_public_hash(self, file=sys.stdout, hash_alg=hashlib.sha256):
+        self._emit_raw(self.get_public_hash(hash_alg), file=file)
 
     def emit_rust_public(self, file=sys.stdout):
         self._emit(
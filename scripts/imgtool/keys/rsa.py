@@ -16,6 +16,23 @@ from .privatebytes import PrivateBytesMixin
 # Sizes that bootutil will recognize
 RSA_KEY_SIZES = [2048, 3072]
 
+# The only public exponent MCUBOOT_RSA_PRECOMP_TABLES supports.
+RSA_TABLE_EXPONENT = 65537
+
+
+def rsa_table(n, e, key_size):
+    """Returns the table of MCUBOOT_RSA_PRECOMP_TABLES as 32-bit words, least
+    significant first: N, R^2 mod N with R = 2^key_size, and -N^-1 mod 2^32,
+    or None if the key cannot use it."""
+    if e != RSA_TABLE_EXPONENT or key_size not in RSA_KEY_SIZES:
+        return None
+    count = key_size // 32
+    rr = pow(2, 2 * key_size, n)
+    words = [(n >> (32 * i)) & 0xffffffff for i in range(count)]
+    words += [(rr >> (32 * i)) & 0xffffffff for i in range(count)]
+    words.append(-pow(n, -1, 1 << 32) % (1 << 32))
+    return words
+
 
 class RSAUsageError(Exception):
     pass
@@ -44,6 +61,10 @@ class RSAPublic(KeyClass):
                 encoding=serialization.Encoding.DER,
                 format=serialization.PublicFormat.PKCS1)
 
+    def get_public_table(self):
+        numbers = self._get_public().public_numbers()
+        return rsa_table(numbers.n, numbers.e, self.key_size())
+
     def get_public_pem(self):
         return self._get_public().public_bytes(
                 encoding=serialization.Encoding.PEM,
@@ -19,6 +19,7 @@
 
 import base64
 import getpass
+import hashlib
 import lzma
 import re
 import struct
@@ -29,6 +30,7 @@ import click
 
 import imgtool.keys as keys
 from imgtool import image, imgtool_version
+from imgtool.delta import DeltaError, make_patch, read_base
 from imgtool.dumpinfo import dump_imginfo
 from imgtool.version import decode_version
 
@@ -141,26 +143,48 @@ def keygen(type, key, password):
 @click.option('-e', '--encoding', metavar='encoding',
               type=click.Choice(valid_encodings),
               help='Valid encodings: {}'.format(', '.join(valid_encodings)))
+@click.option('--sha', 'user_sha', type=click.Choice(valid_sha), default='auto',
+              help='sha algorithm of the key hash emitted with --with-hash; '
+              'this must be the one images are signed with, and defaults to '
+              '"auto", which is the default for the key type')
+@click.option('--with-table', default=False, is_flag=True,
+              help='Also emit the precomputed verification table of the '
+                   'public key, for MCUBOOT_ECDSA_COMB_TABLES, '
+                   'MCUBOOT_ED25519_PRECOMP_TABLES or '
+                   'MCUBOOT_RSA_PRECOMP_TABLES. Only supported for ECDSA '
+                   'P-256, Ed25519 and RSA keys, with the lang-c encoding')
+@click.option('--with-hash', default=False, is_flag=True,
+              help='Also emit the hash of the public key, as found in the '
+                   'KEYHASH TLV of images, for MCUBOOT_KEY_HASH_TABLE. Only '
+                   'supported with the lang-c encoding')
 @click.option('-k', '--key', metavar='filename', required=True)
 @click.option('-o', '--output', metavar='output', required=False,
               help='Specify the output file\'s name. \
                     The stdout is used if it is not provided.')
 @click.command(help='Dump public key from keypair')
-def getpub(key, encoding, lang, output):
+def getpub(key, encoding, lang, output, with_hash, with_table, user_sha):
     if encoding and lang:
         raise click.UsageError('Please use only one of `--encoding/-e` or `--lang/-l`')
     elif not encoding and not lang:
         # Preserve old behavior defaulting to `c`. If `lang` is removed,
         # `default=valid_encodings[0]` should be added to `-e` param.
         lang = valid_langs[0]
+    if (with_hash or with_table) and not (lang == 'c' or encoding == 'lang-c'):
+        raise click.UsageError('--with-hash and --with-table are only supported '
+                               'with the lang-c encoding')
     key = load_key(key)
+    if with_table and key is not None and key.get_public_table() is None:
+        raise click.UsageError(f'--with-table is not supported for {key.sig_type()} keys')
 
     if not output:
         output = sys.stdout
     if key is None:
         print("Invalid passphrase")
     elif lang == 'c' or encoding == 'lang-c':
-        key.emit_c_public(file=output)
+        hash_alg = None
+        if with_hash:
+            hash_alg, _ = image.key_and_user_sha_to_alg_and_tlv(key, user_sha)
+        key.emit_c_public(file=output, hash_alg=hash_alg, table=with_table)
     elif lang == 'rust' or encoding == 'lang-rust':
         key.emit_rust_public(file=output)
     elif encoding == 'pem':
@@ -181,8 +205,12 @@ def getpub(key, encoding, lang, output):
 @click.option('-o', '--output', metavar='output', required=False,
               help='Specify the output file\'s name. \
                     The stdout is used if it is not provided.')
-@click.command(help='Dump the SHA256 hash of the public key')
-def getpubhash(key, output, encoding):
+@click.option('--sha', 'user_sha', type=click.Choice(valid_sha),
+              help='sha algorithm to use, which must be the one images are '
+              'signed with; "auto" is the default for the key type. '
+              'Defaults to 256')
+@click.command(help='Dump the hash of the public key')
+def getpubhash(key, output, encoding, user_sha):
     if not encoding:
         encoding = valid_hash_encodings[0]
     key = load_key(key)
@@ -191,10 +219,14 @@ def getpubhash(key, output, encoding):
         output = sys.stdout
     if key is None:
         print("Invalid passphrase")
-    elif encoding == 'lang-c':
-        key.emit_c_public_hash(file=output)
+        return
+    hash_alg = hashlib.sha256
+    if user_sha:
+        hash_alg, _ = image.key_and_user_sha_to_alg_and_tlv(key, user_sha)
+    if encoding == 'lang-c':
+        key.emit_c_public_hash(file=output, hash_alg=hash_alg)
     elif encoding == 'raw':
-        key.emit_raw_public_hash(file=output)
+        key.emit_raw_public_hash(file=output, hash_alg=hash_alg)
     else:
         raise click.UsageError()
 
@@ -293,6 +325,13 @@ def validate_header_size(ctx, param, value):
     return value
 
 
+def validate_sector_hash_size(ctx, param, value):
+    if value is not None and (value <= 0 or value & (value - 1)):
+        raise click.BadParameter(
+            "--sector-hashes must be a power of two")
+    return value
+
+
 def get_dependencies(ctx, param, value):
     if value is not None:
         versions = []
@@ -458,13 +497,29 @@ class BasedIntParamType(click.ParamType):
               help='Unique vendor identifier, format: (<raw_uuid>|<domain_name)>')
 @click.option('--cid', default=None, required=False,
               help='Unique image class identifier, format: (<raw_uuid>|<image_class_name>)')
+@click.option('--sector-hashes', 'sector_hash_size', type=BasedIntParamType(),
+              callback=validate_sector_hash_size, required=False,
+              metavar='block_size',
+              help='Add a protected TLV holding the hash of every block_size '
+              'bytes of the image header and body, so that the bootloader can '
+              'verify parts of the image independently. Usually the flash '
+              'sector size.')
+@click.option('--delta-base', metavar='filename', type=click.Path(exists=True),
+              help='Create a delta image, patching the given signed image, '
+              'which must be the one in the primary slot when upgrading. '
+              'Requires overwrite-only upgrades.')
+@click.option('--delta-shift', type=BasedIntParamType(), default='0',
+              help='Number of bytes the bootloader moves the base image up '
+              'by before patching it, so that more of it can be reused. '
+              'Must be a multiple of the primary slot sector size.')
 def sign(key, public_key_format, align, version, pad_sig, header_size,
          pad_header, slot_size, pad, confirm, test, max_sectors, overwrite_only,
          endian, encrypt_keylen, encrypt, compression, infile, outfile,
          dependencies, load_addr, hex_addr, erased_val, save_enctlv,
          security_counter, boot_record, custom_tlv, custom_tlv_file, rom_fixed, max_align,
          clear, fix_sig, fix_sig_pubkey, sig_out, user_sha, hmac_sha, is_pure,
-         vector_to_sign, non_bootable, vid, cid):
+         vector_to_sign, non_bootable, vid, cid, sector_hash_size, delta_base,
+         delta_shift):
 
     if confirm or test:
         # Confirmed but non-padded images don't make much sense, because
@@ -477,7 +532,8 @@ def sign(key, public_key_format, align, version, pad_sig, header_size,
                       endian=endian, load_addr=load_addr, rom_fixed=rom_fixed,
                       erased_val=erased_val, save_enctlv=save_enctlv,
                       security_counter=security_counter, max_align=max_align,
-                      non_bootable=non_bootable, vid=vid, cid=cid)
+                      non_bootable=non_bootable, vid=vid, cid=cid,
+                      sector_hash_size=sector_hash_size)
     compression_tlvs = {}
     img.load(infile)
     key = load_key(key) if key else None
@@ -539,7 +595,63 @@ def sign(key, public_key_format, align, version, pad_sig, header_size,
             'Pure signatures, currently, enforces preferred hash algorithm, '
             'and forbids sha selection by user.')
 
-    if compression in ["lzma2", "lzma2armthumb"]:
+    if sector_hash_size is not None and compression != 'disabled':
+        # The table would cover the compressed payload, the image installed
+        # in the primary slot is the decompressed one.
+        raise click.UsageError(
+            'Compressed images cannot carry sector hashes')
+
+    if delta_base is not None:
+        if compression != 'disabled' or enckey is not None or is_pure:
+            raise click.UsageError(
+                'Delta images cannot be compressed, encrypted or use pure '
+                'signatures')
+        if sector_hash_size is not None:
+            raise click.UsageError(
+                'Delta images cannot carry sector hashes')
+        with open(delta_base, 'rb') as f:
+            base_data = f.read()
+        try:
+            base_size, base_hash = read_base(base_data, endian)
+        except DeltaError as e:
+            raise click.UsageError(f'--delta-base: {e}') from None
+        img.create(key, public_key_format, enckey, dependencies, boot_record,
+               custom_tlvs, compression_tlvs, None, int(encrypt_keylen), clear,
+               baked_signature, pub_key, vector_to_sign, user_sha=user_sha,
+               hmac_sha=hmac_sha, is_pure=is_pure, keep_comp_size=False, dont_encrypt=True)
+        if len(base_hash) != len(img.image_hash):
+            raise click.UsageError(
+                '--delta-base: the base image uses another hash algorithm')
+        infile_offset = 0 if pad_header else header_size
+        patch = make_patch(base_data[:base_size],
+                           img.get_infile_data()[infile_offset:],
+                           header_size, delta_shift)
+        print(f"delta image patch size: {len(patch)} bytes")
+        compression_tlvs["DECOMP_SIZE"] = struct.pack(
+            img.get_struct_endian() + 'L', img.image_size)
+        compression_tlvs["DECOMP_SHA"] = img.image_hash
+        if img.get_signature():
+            compression_tlvs["DECOMP_SIGNATURE"] = img.get_signature()
+        compression_tlvs["DELTA_BASE"] = struct.pack(
+            img.get_struct_endian() + 'LL', base_size, delta_shift) + base_hash
+        delta_img = image.Image(version=decode_version(version),
+                  header_size=header_size, pad_header=pad_header,
+                  pad=pad, confirm=confirm, align=int(align),
+                  slot_size=slot_size, max_sectors=max_sectors,
+                  overwrite_only=overwrite_only, endian=endian,
+                  load_addr=load_addr, rom_fixed=rom_fixed,
+                  erased_val=erased_val, save_enctlv=save_enctlv,
+                  security_counter=security_counter, max_align=max_align,
+                  non_bootable=non_bootable, vid=vid, cid=cid)
+        delta_img.load_compressed(patch, b'')
+        delta_img.base_addr = img.base_addr
+        delta_img.create(key, public_key_format, enckey,
+               dependencies, boot_record, custom_tlvs, compression_tlvs,
+               'delta', int(encrypt_keylen), clear, baked_signature,
+               pub_key, vector_to_sign, user_sha=user_sha, hmac_sha=hmac_sha,
+               is_pure=is_pure, keep_comp_size=False)
+        img = delta_img
+    elif compression in ["lzma2", "lzma2armthumb"]:
         img.create(key, public_key_format, enckey, dependencies, boot_record,
                custom_tlvs, compression_tlvs, None, int(encrypt_keylen), clear,
                baked_signature, pub_key, vector_to_sign, user_sha=user_sha,
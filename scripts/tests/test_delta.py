@@ -0,0 +1,139 @@
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import random
+import struct
+from pathlib import Path
+
+import pytest
+from click.testing import CliRunner
+from imgtool.delta import DeltaError, apply_patch, make_patch, read_base
+from imgtool.image import IMAGE_F, TLV_VALUES, Image, VerifyResult
+from imgtool.main import imgtool
+
+VERSION = '2.0.0'
+HEADER_SIZE = 0x200
+SLOT_SIZE = 0x7a000
+
+
+@pytest.fixture
+def key_file() -> Path:
+    return Path(__file__).parents[2] / 'root-ec-p256.pem'
+
+
+def make_images():
+    rng = random.Random(1234)
+    base = bytes(rng.getrandbits(8) for _ in range(0x6000))
+    # Patched code: an insertion, a changed block and a removal.
+    new = base[:0x1000] + b'inserted' * 40 + base[0x1000:0x3000] + \
+        bytes(rng.getrandbits(8) for _ in range(0x100)) + base[0x3100:0x5000]
+    return base, new
+
+
+@pytest.mark.parametrize('shift', [0, 0x1000, 0x4000])
+def test_patch_roundtrip(shift: int):
+    base, new = make_images()
+    patch = make_patch(base, new, HEADER_SIZE, shift)
+    assert apply_patch(base, patch, HEADER_SIZE, shift, len(new)) == new
+    if shift >= 0x1000:
+        # Enough room to reuse most of the base image.
+        assert len(patch) < len(new) // 8
+
+
+def test_patch_overwritten():
+    base, new = make_images()
+    patch = make_patch(base, new, HEADER_SIZE, 0x4000)
+    with pytest.raises(DeltaError):
+        apply_patch(base, patch, HEADER_SIZE, 0, len(new))
+
+
+def sign(tmpdir: Path, key_file: Path, data: bytes, name: str, *args):
+    in_file = tmpdir / f'{name}.bin'
+    in_file.write_binary(data)
+    out_file = tmpdir / f'{name}_signed.bin'
+    result = CliRunner().invoke(
+        imgtool,
+        [
+            'sign',
+            str(in_file),
+            str(out_file),
+            f'--header-size={HEADER_SIZE}',
+            f'--slot-size={SLOT_SIZE}',
+            f'--version={VERSION}',
+            '--pad-header',
+            f'--key={key_file}',
+            *args
+        ],
+    )
+    return result, out_file
+
+
+def find_prot_tlv(data: bytes, kind: int) -> bytes:
+    hdr_size, prot_size, img_size = struct.unpack_from('<HHI', data, 8)
+    off = hdr_size + img_size
+    end = off + prot_size
+    off += 4
+    while off < end:
+        tlv_type, tlv_len = struct.unpack_from('<HH', data, off)
+        off += 4
+        if tlv_type == kind:
+            return data[off:off + tlv_len]
+        off += tlv_len
+    return None
+
+
+def test_delta_image(tmpdir: Path, key_file: Path):
+    """
+    Check that ``imgtool sign --delta-base`` produces a signed delta image
+    carrying the patch and what the bootloader needs to check its result.
+    """
+    base, new = make_images()
+    result, base_file = sign(tmpdir, key_file, base, 'base')
+    assert result.exit_code == 0, result.output
+    result, full_file = sign(tmpdir, key_file, new, 'full')
+    assert result.exit_code == 0, result.output
+    result, delta_file = sign(tmpdir, key_file, new, 'delta',
+                              f'--delta-base={base_file}',
+                              '--delta-shift=0x1000')
+    assert result.exit_code == 0, result.output
+
+    base_data = base_file.read_binary()
+    data = delta_file.read_binary()
+    flags = struct.unpack_from('<I', data, 16)[0]
+    assert flags & IMAGE_F['DELTA']
+
+    base_size, base_hash = read_base(base_data)
+    info = find_prot_tlv(data, TLV_VALUES['DELTA_BASE'])
+    assert info == struct.pack('<LL', base_size, 0x1000) + base_hash
+
+    full = full_file.read_binary()
+    _, _, img_size = struct.unpack_from('<HHI', full, 8)
+    assert find_prot_tlv(data, TLV_VALUES['DECOMP_SIZE']) == struct.pack('<L', img_size)
+
+    hdr_size, _, patch_size = struct.unpack_from('<HHI', data, 8)
+    patch = data[hdr_size:hdr_size + patch_size]
+    body = apply_patch(base_data[:base_size], patch, HEADER_SIZE, 0x1000, img_size)
+    assert body == full[HEADER_SIZE:HEADER_SIZE + img_size]
+
+    ret, _, _, _ = Image.verify(str(delta_file), None)
+    assert ret == VerifyResult.OK
+
+
+def test_delta_image_compressed(tmpdir: Path, key_file: Path):
+    base, new = make_images()
+    result, base_file = sign(tmpdir, key_file, base, 'base')
+    assert result.exit_code == 0, result.output
+    result, _ = sign(tmpdir, key_file, new, 'delta', f'--delta-base={base_file}',
+                     '--compression=lzma2')
+    assert result.exit_code != 0
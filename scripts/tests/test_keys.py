@@ -12,15 +12,21 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+import re
+import struct
 import subprocess
 
 import pytest
 from click.testing import CliRunner
 from imgtool import main as imgtool_main
+from imgtool.image import TLV_VALUES
+from imgtool.keys.ecdsa import P256_P
+from imgtool.keys.ed25519 import ED25519_D, ED25519_P
 from imgtool.main import imgtool
 
 # all supported key types for 'keygen'
 KEY_TYPES = [*imgtool_main.keygens]
+SIGN_KEY_TYPES = [k for k in KEY_TYPES if k != "x25519"]
 KEY_ENCODINGS = [*imgtool_main.valid_encodings]
 PUB_HASH_ENCODINGS = [*imgtool_main.valid_hash_encodings]
 PVT_KEY_FORMATS = [*imgtool_main.valid_formats]
@@ -177,6 +183,152 @@ def test_getpubhash(key_type, encoding, tmp_path_persistent):
     assert pub_key_hash.stat().st_size > 0
 
 
+def read_keyhash_tlv(data):
+    hdr_size, prot_size, img_size = struct.unpack_from("<HHI", data, 8)
+    off = hdr_size + img_size + prot_size
+    _, tlv_tot = struct.unpack_from("<HH", data, off)
+    end = off + tlv_tot
+    off += 4
+    while off < end:
+        tlv_type, tlv_len = struct.unpack_from("<HH", data, off)
+        off += 4
+        if tlv_type == TLV_VALUES["KEYHASH"]:
+            return data[off:off + tlv_len]
+        off += tlv_len
+    return None
+
+
+@pytest.mark.parametrize("key_type", SIGN_KEY_TYPES)
+def test_getpub_with_hash(key_type, tmp_path_persistent, tmp_path):
+    """The key hash emitted with the public key matches the one in images"""
+    runner = CliRunner()
+
+    gen_key = tmp_name(tmp_path_persistent, key_type, GEN_KEY_EXT)
+    result = runner.invoke(
+        imgtool, ["getpub", "--key", str(gen_key), "--with-hash"]
+    )
+    assert result.exit_code == 0
+    code = result.output
+    assert "_pub_key_len = " in code
+    hash_code = code[code.index("_pub_key_hash[] = {"):]
+    keyhash = bytes(
+        int(b, 16) for b in re.findall(r"0x([0-9a-f]{2})",
+                                       hash_code[:hash_code.index("};")])
+    )
+    assert f"_pub_key_hash_len = {len(keyhash)};" in code
+
+    image = tmp_path / "image.bin"
+    image_signed = tmp_path / "image.signed"
+    image.write_bytes(b"\x00" * 1024)
+    result = runner.invoke(
+        imgtool,
+        [
+            "sign",
+            "--key",
+            str(gen_key),
+            "--version",
+            "1.0.0",
+            "--header-size",
+            "0x400",
+            "--slot-size",
+            "0x10000",
+            "--pad-header",
+            str(image),
+            str(image_signed),
+        ],
+    )
+    assert result.exit_code == 0
+    assert read_keyhash_tlv(image_signed.read_bytes()) == keyhash
+
+    # --with-hash only makes sense for C code
+    result = runner.invoke(
+        imgtool,
+        ["getpub", "--key", str(gen_key), "--with-hash", "--encoding", "pem"],
+    )
+    assert result.exit_code != 0
+
+
+def check_ed25519_table(words, public):
+    """Checks the table of an Ed25519 key, holding ge_precomp entries of 30
+    words, radix 2^25.5 limbs"""
+    assert len(words) == 4 * 8 * 30
+
+    def fe(n):
+        value, shift = 0, 0
+        for i, w in enumerate(words[10 * n:10 * n + 10]):
+            value += w << shift
+            shift += 25 if i & 1 else 26
+        return value
+
+    p, d = ED25519_P, ED25519_D
+    for i in range(4 * 8):
+        yplusx, yminusx, xy2d = fe(3 * i), fe(3 * i + 1), fe(3 * i + 2)
+        x = (yplusx - yminusx) * pow(2, -1, p) % p
+        y = (yplusx + yminusx) * pow(2, -1, p) % p
+        assert (y * y - x * x - 1 - d * x * x * y * y) % p == 0
+        assert (2 * d * x * y - xy2d) % p == 0
+        if i == 0:
+            # The first entry is the negated key
+            x = p - x
+            assert public == (y | (x & 1) << 255).to_bytes(32, "little")
+
+
+def check_rsa_table(words, key):
+    """Checks the modulus and Montgomery constants of an RSA key"""
+    numbers = key.public_numbers()
+    count = key.key_size // 32
+    assert len(words) == 2 * count + 1
+
+    def number(n):
+        return sum(w << (32 * i) for i, w in enumerate(words[n:n + count]))
+
+    n = number(0)
+    assert n == numbers.n
+    assert number(count) == pow(2, 2 * key.key_size, n)
+    assert (words[2 * count] * n) % (1 << 32) == (1 << 32) - 1
+
+
+@pytest.mark.parametrize("key_type", KEY_TYPES)
+def test_getpub_with_table(key_type, tmp_path_persistent):
+    """The tables emitted for ECDSA P-256 and Ed25519 keys hold points of the
+    key, the one of RSA keys its modulus and Montgomery constants"""
+    runner = CliRunner()
+
+    gen_key = tmp_name(tmp_path_persistent, key_type, GEN_KEY_EXT)
+    result = runner.invoke(
+        imgtool, ["getpub", "--key", str(gen_key), "--with-table"]
+    )
+    if key_type not in ("ecdsa-p256", "ed25519", "rsa-2048", "rsa-3072"):
+        assert result.exit_code != 0
+        return
+    assert result.exit_code == 0
+
+    code = result.output
+    table_code = code[code.index("_pub_key_table[] = {"):]
+    words = [int(w, 16) for w in
+             re.findall(r"0x([0-9a-f]{8})", table_code[:table_code.index("};")])]
+    public = imgtool_main.load_key(str(gen_key)).get_public_bytes()
+    if key_type == "ed25519":
+        check_ed25519_table(words, public[-32:])
+        return
+    if key_type.startswith("rsa"):
+        check_rsa_table(words, imgtool_main.load_key(str(gen_key))._get_public())
+        return
+    assert len(words) == 15 * 16
+
+    def coord(n):
+        return sum(w << (32 * i) for i, w in enumerate(words[8 * n:8 * n + 8]))
+
+    p, b = P256_P, 0x5ac635d8aa3a93e7b3ebbd55769886bc651d06b0cc53b0f63bce3c3e27d2604b
+    for i in range(15):
+        x, y = coord(2 * i), coord(2 * i + 1)
+        assert (y * y - (x * x * x - 3 * x + b)) % p == 0
+
+    # The first entry is the key itself, as found in the DER encoded key
+    assert public[-64:] == (coord(0).to_bytes(32, "big") +
+                            coord(1).to_bytes(32, "big"))
+
+
 @pytest.mark.parametrize("key_type", KEY_TYPES)
 def test_sign_verify(key_type, tmp_path_persistent):
     """Test basic sign and verify"""
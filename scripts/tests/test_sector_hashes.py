@@ -0,0 +1,137 @@
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import hashlib
+import struct
+from pathlib import Path
+
+import pytest
+from click.testing import CliRunner
+from imgtool.image import TLV_VALUES, Image, VerifyResult
+from imgtool.main import imgtool
+
+VERSION = '2.0.0'
+HEADER_SIZE = 0x200
+SLOT_SIZE = 0x7a000
+
+
+@pytest.fixture
+def key_file() -> Path:
+    return Path(__file__).parents[2] / 'root-ec-p256.pem'
+
+
+def find_prot_tlv(data: bytes, hdr_size: int, img_size: int, kind: int) -> bytes:
+    off = hdr_size + img_size
+    magic, total = struct.unpack_from('<HH', data, off)
+    assert magic == 0x6908
+    end = off + total
+    off += 4
+    while off < end:
+        tlv_type, tlv_len = struct.unpack_from('<HH', data, off)
+        off += 4
+        if tlv_type == kind:
+            return data[off:off + tlv_len]
+        off += tlv_len
+    return None
+
+
+@pytest.mark.parametrize('block_size', [0x100, 0x1000])
+def test_sector_hashes(tmpdir: Path, key_file: Path, block_size: int):
+    """
+    Check that ``imgtool sign --sector-hashes`` emits one hash per block
+    of the image header and body, and that the image still verifies.
+    """
+    in_file = tmpdir / 'zephyr.bin'
+    with in_file.open("wb") as f:
+        f.write(bytes(range(256)) * 33)
+    out_file: Path = tmpdir / 'zephyr_signed.bin'
+
+    runner = CliRunner()
+    result = runner.invoke(
+        imgtool,
+        [
+            'sign',
+            str(in_file),
+            str(out_file),
+            f'--header-size={HEADER_SIZE}',
+            f'--slot-size={SLOT_SIZE}',
+            f'--version={VERSION}',
+            '--pad-header',
+            f'--sector-hashes={block_size:#x}',
+            f'--key={key_file}'
+        ],
+    )
+    assert result.exit_code == 0, result.output
+
+    data = out_file.read_binary()
+    hdr_size, prot_size, img_size = struct.unpack_from('<HHI', data, 8)
+    table = find_prot_tlv(data, hdr_size, img_size, TLV_VALUES['SECTOR_HASHES'])
+    assert table is not None
+    assert struct.unpack_from('<I', table)[0] == block_size
+
+    covered = data[:hdr_size + img_size]
+    expected = b''.join(hashlib.sha256(covered[off:off + block_size]).digest()
+                        for off in range(0, len(covered), block_size))
+    assert table[4:] == expected
+
+    ret, _, _, _ = Image.verify(str(out_file), None)
+    assert ret == VerifyResult.OK
+
+
+def test_sector_hashes_bad_size(tmpdir: Path, key_file: Path):
+    in_file = tmpdir / 'zephyr.bin'
+    in_file.write_binary(b'\x00' * 1024)
+    runner = CliRunner()
+    result = runner.invoke(
+        imgtool,
+        [
+            'sign',
+            str(in_file),
+            str(tmpdir / 'out.bin'),
+            f'--header-size={HEADER_SIZE}',
+            f'--slot-size={SLOT_SIZE}',
+            f'--version={VERSION}',
+            '--pad-header',
+            '--sector-hashes=1000',
+            f'--key={key_file}'
+        ],
+    )
+    assert result.exit_code != 0
+
+
+def test_sector_hashes_compressed(tmpdir: Path, key_file: Path):
+    """
+    Compressed images are installed decompressed, which a table of the
+    compressed payload does not describe: the combination is rejected.
+    """
+    in_file = tmpdir / 'zephyr.bin'
+    in_file.write_binary(b'\x00' * 4096)
+    runner = CliRunner()
+    result = runner.invoke(
+        imgtool,
+        [
+            'sign',
+            str(in_file),
+            str(tmpdir / 'out.bin'),
+            f'--header-size={HEADER_SIZE}',
+            f'--slot-size={SLOT_SIZE}',
+            f'--version={VERSION}',
+            '--pad-header',
+            '--compression=lzma2',
+            '--sector-hashes=0x100',
+            f'--key={key_file}'
+        ],
+    )
+    assert result.exit_code != 0
+    assert 'Compressed images cannot carry sector hashes' in result.output
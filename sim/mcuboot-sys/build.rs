@@ -41,6 +41,24 @@ fn main() {
     let max_align_32 = env::var("CARGO_FEATURE_MAX_ALIGN_32").is_ok();
     let hw_rollback_protection = env::var("CARGO_FEATURE_HW_ROLLBACK_PROTECTION").is_ok();
     let check_load_addr = env::var("CARGO_FEATURE_CHECK_LOAD_ADDR").is_ok();
+    let flash_async_read = env::var("CARGO_FEATURE_FLASH_ASYNC_READ").is_ok();
+    let hash_image_copy = env::var("CARGO_FEATURE_HASH_IMAGE_COPY").is_ok();
+    let swap_skip_unchanged = env::var("CARGO_FEATURE_SWAP_SKIP_UNCHANGED").is_ok();
+    let flash_multi_sector_erase = env::var("CARGO_FEATURE_FLASH_MULTI_SECTOR_ERASE").is_ok();
+    let erase_skip_blank = env::var("CARGO_FEATURE_ERASE_SKIP_BLANK").is_ok();
+    let tlv_dir_cache = env::var("CARGO_FEATURE_TLV_DIR_CACHE").is_ok();
+    let key_hash_table = env::var("CARGO_FEATURE_KEY_HASH_TABLE").is_ok();
+    let ecdsa_comb_tables = env::var("CARGO_FEATURE_ECDSA_COMB_TABLES").is_ok();
+    let ed25519_precomp_tables = env::var("CARGO_FEATURE_ED25519_PRECOMP_TABLES").is_ok();
+    let rsa_precomp_tables = env::var("CARGO_FEATURE_RSA_PRECOMP_TABLES").is_ok();
+    let aes_ctr_ttable = env::var("CARGO_FEATURE_AES_CTR_TTABLE").is_ok();
+    let aes_ctr_ni = env::var("CARGO_FEATURE_AES_CTR_NI").is_ok();
+    let sha_ni = env::var("CARGO_FEATURE_SHA_NI").is_ok();
+    let enc_key_cache = env::var("CARGO_FEATURE_ENC_KEY_CACHE").is_ok();
+    let swap_state_cache = env::var("CARGO_FEATURE_SWAP_STATE_CACHE").is_ok();
+    let decompress = env::var("CARGO_FEATURE_DECOMPRESS").is_ok();
+    let delta = env::var("CARGO_FEATURE_DELTA").is_ok();
+    let validation_cache = env::var("CARGO_FEATURE_VALIDATION_CACHE").is_ok();
 
     let mut conf = CachedBuild::new();
     conf.conf.define("__BOOTSIM__", None);
@@ -76,6 +94,126 @@ fn main() {
         conf.conf.define("MCUBOOT_VALIDATE_PRIMARY_SLOT", None);
     }
 
+    if flash_async_read {
+        conf.conf.define("MCUBOOT_FLASH_ASYNC_READ", None);
+        conf.conf.define("MCUBOOT_IMG_HASH_CHUNK_SIZE", Some("1024"));
+    }
+
+    if hash_image_copy {
+        if !(overwrite_only || bootstrap || swap_move || swap_offset) {
+            panic!("hash-image-copy requires overwrite-only, bootstrap, swap-move or swap-offset");
+        }
+        conf.conf.define("MCUBOOT_HASH_IMAGE_COPY", None);
+    }
+
+    if swap_skip_unchanged {
+        if !(swap_move || swap_offset) {
+            panic!("swap-skip-unchanged requires swap-move or swap-offset");
+        }
+        conf.conf.define("MCUBOOT_SWAP_SKIP_UNCHANGED", None);
+    }
+
+    if flash_multi_sector_erase {
+        conf.conf.define("MCUBOOT_FLASH_MULTI_SECTOR_ERASE", None);
+    }
+
+    if erase_skip_blank {
+        conf.conf.define("MCUBOOT_ERASE_SKIP_BLANK", None);
+    }
+
+    if tlv_dir_cache {
+        if ram_load {
+            panic!("tlv-dir-cache is not supported with ram-load");
+        }
+        conf.conf.define("MCUBOOT_TLV_DIR_CACHE", None);
+    }
+
+    if key_hash_table {
+        conf.conf.define("MCUBOOT_KEY_HASH_TABLE", None);
+    }
+
+    if ecdsa_comb_tables {
+        if !sig_ecdsa {
+            panic!("ecdsa-comb-tables requires sig-ecdsa");
+        }
+        conf.conf.define("MCUBOOT_ECDSA_COMB_TABLES", None);
+    }
+
+    if ed25519_precomp_tables {
+        if !sig_ed25519 {
+            panic!("ed25519-precomp-tables requires sig-ed25519");
+        }
+        conf.conf.define("MCUBOOT_ED25519_PRECOMP_TABLES", None);
+    }
+
+    if rsa_precomp_tables {
+        if !(sig_rsa || sig_rsa3072) {
+            panic!("rsa-precomp-tables requires sig-rsa or sig-rsa3072");
+        }
+        conf.conf.define("MCUBOOT_RSA_PRECOMP_TABLES", None);
+    }
+
+    if aes_ctr_ttable || aes_ctr_ni {
+        if !(enc_ec256 || enc_x25519 || (enc_kw && sig_ecdsa)) {
+            panic!("aes-ctr-ttable and aes-ctr-ni require enc-ec256, enc-x25519 or enc-kw with sig-ecdsa");
+        }
+        if aes_ctr_ni {
+            let arch = env::var("CARGO_CFG_TARGET_ARCH").unwrap();
+            if arch != "x86_64" && arch != "x86" {
+                panic!("aes-ctr-ni requires an x86 target");
+            }
+            conf.conf.define("TC_AES_NI", None);
+            conf.conf.flag("-maes");
+        } else {
+            conf.conf.define("TC_AES_TTABLE", None);
+        }
+    }
+
+    if sha_ni {
+        if !(sig_ecdsa || sig_ed25519 || enc_ec256 || enc_x25519) {
+            panic!("sha-ni requires sig-ecdsa, sig-ed25519, enc-ec256 or enc-x25519");
+        }
+        let arch = env::var("CARGO_CFG_TARGET_ARCH").unwrap();
+        if arch != "x86_64" && arch != "x86" {
+            panic!("sha-ni requires an x86 target");
+        }
+        conf.conf.define("MCUBOOT_SHA256_NI", None);
+    }
+
+    if swap_state_cache {
+        conf.conf.define("MCUBOOT_SWAP_STATE_CACHE", None);
+    }
+
+    if enc_key_cache {
+        if !(enc_rsa || enc_aes256_rsa || enc_kw || enc_aes256_kw || enc_ec256 ||
+             enc_ec256_mbedtls || enc_aes256_ec256 || enc_x25519 || enc_aes256_x25519) {
+            panic!("enc-key-cache requires an image encryption feature");
+        }
+        conf.conf.define("MCUBOOT_ENC_KEY_CACHE", None);
+    }
+
+    if decompress {
+        if !overwrite_only {
+            panic!("decompress requires overwrite-only");
+        }
+        if enc_rsa || enc_aes256_rsa || enc_kw || enc_aes256_kw || enc_ec256 ||
+           enc_ec256_mbedtls || enc_aes256_ec256 || enc_x25519 || enc_aes256_x25519 {
+            panic!("decompress does not support encrypted images");
+        }
+        conf.conf.define("MCUBOOT_DECOMPRESS_IMAGES", None);
+    }
+
+    if delta {
+        conf.conf.define("MCUBOOT_DELTA_IMAGES", None);
+    }
+
+    if validation_cache {
+        if !validate_primary_slot || ram_load || direct_xip {
+            panic!("validation-cache requires validate-primary-slot and a primary slot upgrade mode");
+        }
+        conf.conf.define("MCUBOOT_VALIDATION_CACHE", None);
+    }
+
     if downgrade_prevention {
         conf.conf.define("MCUBOOT_DOWNGRADE_PREVENTION", None);
     }
@@ -499,6 +637,13 @@ fn main() {
     conf.file("../../boot/bootutil/src/bootutil_loader.c");
     conf.file("../../boot/bootutil/src/bootutil_public.c");
     conf.file("../../boot/bootutil/src/tlv.c");
+    if decompress {
+        conf.file("../../boot/bootutil/src/bootutil_decompress.c");
+        conf.file("../../boot/bootutil/src/bootutil_lzma.c");
+    }
+    if delta {
+        conf.file("../../boot/bootutil/src/bootutil_delta.c");
+    }
     conf.file("../../boot/bootutil/src/fault_injection_hardening.c");
     conf.file("csupport/run.c");
     conf.conf.include("../../boot/bootutil/include");
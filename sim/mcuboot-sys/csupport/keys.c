@@ -50,6 +50,52 @@ const unsigned char root_pub_der[] = {
     0xc9, 0x02, 0x03, 0x01, 0x00, 0x01
 };
 const unsigned int root_pub_der_len = 270;
+#if defined(MCUBOOT_KEY_HASH_TABLE)
+const unsigned char root_pub_der_hash[] = {
+    0xfc, 0x57, 0x01, 0xdc, 0x61, 0x35, 0xe1, 0x32,
+    0x38, 0x47, 0xbd, 0xc4, 0x0f, 0x04, 0xd2, 0xe5,
+    0xbe, 0xe5, 0x83, 0x3b, 0x23, 0xc2, 0x9f, 0x93,
+    0x59, 0x3d, 0x00, 0x01, 0x8c, 0xfa, 0x99, 0x94,
+};
+const unsigned int root_pub_der_hash_len = 32;
+#endif
+#if defined(MCUBOOT_RSA_PRECOMP_TABLES)
+const unsigned int root_pub_der_table[] = {
+    0x62e1d1c9, 0xefb14b2c, 0xd167c647, 0xaf5c3aa7,
+    0xfa0d119d, 0x666435ec, 0xdcce681b, 0x59f81cab,
+    0xf81a2466, 0x1a1dfee8, 0xab873e93, 0x692723f3,
+    0x8217f28a, 0x31ad5fb0, 0x4cc88881, 0x5818f65e,
+    0x2bd0d308, 0x54f43ee1, 0xe0fa8237, 0x2abeafb8,
+    0xfeb8cefa, 0xa76a9df9, 0xa3aed20f, 0x1339833f,
+    0xffb7fdf3, 0xe4530d2f, 0x85d55c4a, 0x3ec80ed7,
+    0xf8656e64, 0x896924fb, 0xbe7b7221, 0xdb7773d4,
+    0x7eb7e115, 0x35ca6261, 0x4baa8d38, 0xc3776754,
+    0x7e473c94, 0xb4a9c888, 0x6fe75bba, 0xf8cf3d1e,
+    0x5c14dff2, 0xac414d9e, 0x698c2f5f, 0xb43c10e6,
+    0x2849a701, 0x4160ed15, 0x840baa77, 0x99dfe04d,
+    0x5ceeecb3, 0x080f0dbb, 0x2c44d167, 0x435e0d57,
+    0x7f10537e, 0xdb42e78c, 0xcbf3bc74, 0xf09c341b,
+    0x188019f9, 0xd35ae96d, 0xaad24b18, 0xbbee5ef9,
+    0x0da34f1f, 0xe8fbfdf7, 0x18442c18, 0xd106081a,
+    0xa46d7e40, 0x61d887b3, 0x1af6c61d, 0xa0bf6f48,
+    0xb8cec2e8, 0x6f6895e7, 0x723eaea3, 0x9f4cf49b,
+    0xc1648e24, 0x4933b156, 0xb620cc9e, 0x6a3d596a,
+    0xd7607b1c, 0xb9c7f122, 0x05a7314e, 0xfabdabfa,
+    0xb7ee0465, 0x9d9422c6, 0x7760b779, 0x7ef32296,
+    0xc25d8581, 0xa71a32cb, 0xfa31586c, 0xed49b341,
+    0x5249dd8c, 0xdae158dc, 0x936a5cd7, 0x2fb58c91,
+    0x1f617238, 0xf4c40bbe, 0xfc9ef774, 0xbb62bd84,
+    0xba88107e, 0xef1a0c45, 0x52124603, 0x6557f87a,
+    0x9c26779b, 0x05863028, 0x35875518, 0xf9b8d106,
+    0x51c66c09, 0x7941f544, 0xbcf6f070, 0x39b53706,
+    0x3166a931, 0xc97f93f7, 0x23f7bd3a, 0x5edb8506,
+    0xabe50eda, 0xfc98167d, 0xa4ca5244, 0xf93f6a95,
+    0x447cd5a9, 0x15ef7110, 0xa57c2d5e, 0x2e5d61f4,
+    0x613d3217, 0x4ff52cce, 0xafe3f5e1, 0x696f8e30,
+    0x1ef051f7, 0x006e298c, 0xb97f1d14, 0xa920a3e8,
+    0x80aee787,
+};
+#endif
 #elif MCUBOOT_SIGN_RSA_LEN == 3072
 #define HAVE_KEYS
 const unsigned char root_pub_der[] = {
@@ -105,6 +151,68 @@ const unsigned char root_pub_der[] = {
     0x3b, 0x02, 0x03, 0x01, 0x00, 0x01,
 };
 const unsigned int root_pub_der_len = 398;
+#if defined(MCUBOOT_KEY_HASH_TABLE)
+const unsigned char root_pub_der_hash[] = {
+    0x44, 0x97, 0x93, 0xfb, 0x65, 0xcd, 0x76, 0x98,
+    0x75, 0x3d, 0x5b, 0x3f, 0x35, 0xfa, 0xb1, 0x5f,
+    0x1e, 0x3a, 0x45, 0x11, 0x1f, 0xf2, 0x4e, 0x1d,
+    0x46, 0x74, 0x1d, 0xe5, 0xae, 0x12, 0xd5, 0x9e,
+};
+const unsigned int root_pub_der_hash_len = 32;
+#endif
+#if defined(MCUBOOT_RSA_PRECOMP_TABLES)
+const unsigned int root_pub_der_table[] = {
+    0xe673de3b, 0x6374ac5a, 0x2daf9366, 0xb57bd3b0,
+    0x6e886591, 0x8a18cf23, 0xd99f0717, 0xb565dd01,
+    0x2b0ef881, 0xf55fafe7, 0x0162fff7, 0x060a81f3,
+    0x6d8c4374, 0xad01cab7, 0x4a05751f, 0xe69df40c,
+    0x23305736, 0x52e89637, 0xf7fa65dd, 0xa0a094c8,
+    0x1f0dd01e, 0xcf150880, 0xac2a22f4, 0x5985ee85,
+    0x5872a4b0, 0x99bfac68, 0x019ce70c, 0xb0f3f683,
+    0xb1517c12, 0x1d1bff1a, 0xd1ea1a40, 0x06eedcbe,
+    0xa77eda87, 0x6a7751eb, 0xa4094fa5, 0x768c6b94,
+    0x1122fb7f, 0xe819fd2f, 0x5b82e77a, 0x9a6fcbbb,
+    0xe7cac4f8, 0xb37cc3fb, 0x6f7babb7, 0xb2aa5a6c,
+    0x30089c4d, 0x4485cc73, 0xd473338d, 0x936cd7bf,
+    0xcea4a8ca, 0x25f88dbe, 0x8e87ee60, 0x51665e99,
+    0xada7f63a, 0x9be41ce8, 0x96edcfb3, 0x131b172e,
+    0xa8ba7a80, 0xb69acde5, 0x226c5e61, 0x671fc86e,
+    0x78e5be47, 0xd3b4cc2f, 0x2502aa00, 0x4e68b2e0,
+    0x7e9c9bba, 0xd24e570c, 0xadc2e1a5, 0x6fd1154f,
+    0xa72b1325, 0x04da8c34, 0x76dd5f54, 0x36804938,
+    0xf949db78, 0x6ecc85ed, 0xf91000d8, 0x72463f8b,
+    0x5cfd7305, 0xad870083, 0xb8a71d44, 0x7e72d37a,
+    0x574bde0f, 0x8c229e71, 0xf4ef2a8f, 0x15688c1a,
+    0x8173bf6e, 0x228b2d4e, 0xaaa68a63, 0xea7bb115,
+    0x25e5d296, 0x45c87126, 0x1a34205d, 0x3433f896,
+    0xdd082a28, 0x58997c01, 0x5810a4a7, 0xb42c0e98,
+    0xa04638d4, 0x3a879048, 0x7ca61b2d, 0xe0dd6259,
+    0x55123fc5, 0x2ef5deec, 0x9ac7688c, 0x8a5bb339,
+    0x04083dcf, 0xfba082e4, 0xf5bd5f21, 0x3bc0bb80,
+    0x0508b168, 0xd326e831, 0x1a3e396d, 0x00bf7fe1,
+    0xc536bc01, 0x42b332aa, 0xfe4cab9d, 0x7d5a6a66,
+    0x032bca90, 0xa5a3c4a7, 0xb729a6a8, 0x2d602549,
+    0xd5bc2223, 0x3187a304, 0x4af6e591, 0x9bdbafc1,
+    0xf13c6f69, 0xb9734cc0, 0x6655e882, 0x9d2fb3b0,
+    0xd3102df5, 0x33cd4027, 0x94e72bb3, 0x7c55230a,
+    0x9ab167b2, 0x1d4fedc3, 0xd8a83c6f, 0x54ec8329,
+    0xd5eeb4d1, 0xed2a7bec, 0x91db40c5, 0x16d3274a,
+    0xdc805893, 0xbbb2332b, 0x1868df5b, 0xcd0b6e0a,
+    0x798003c8, 0x84f4f932, 0xb098e8d7, 0x498fc166,
+    0xaeefc41f, 0xf000fe77, 0x93c44eee, 0x95bcfe91,
+    0x60f5867d, 0x07a09792, 0x238701a7, 0x0e499545,
+    0x3e9d92e1, 0xbb075158, 0x54715f22, 0xf7726675,
+    0x47489602, 0x4e2c2bea, 0xd14cbd50, 0xbd60e1fb,
+    0x82da2bec, 0x997052d1, 0x7e2762df, 0x85aa9f1c,
+    0xaf38710c, 0x14a5c5c5, 0xd61e9416, 0xf991dbbc,
+    0xc3d2506c, 0x9dc4db1b, 0xc77bb7fe, 0x4a34329a,
+    0x2b966e7b, 0xd30b11c5, 0xeb1328d3, 0xb239db53,
+    0x8a8295d9, 0x29598798, 0x504c872d, 0x65fa9b83,
+    0x184b19fc, 0xb1db1fcf, 0x43751595, 0x3d4338f5,
+    0x62862673, 0x0717ef99, 0xa6d2f092, 0x0b940021,
+    0x8a1ab50d,
+};
+#endif
 #endif
 #elif defined(MCUBOOT_SIGN_EC256) || \
       defined(MCUBOOT_SIGN_EC384)
@@ -124,6 +232,79 @@ const unsigned char root_pub_der[] = {
     0x8b, 0x68, 0x34, 0xcc, 0x3a, 0x6a, 0xfc, 0x53,
     0x8e, 0xfa, 0xc1, };
 const unsigned int root_pub_der_len = 91;
+#if defined(MCUBOOT_KEY_HASH_TABLE)
+const unsigned char root_pub_der_hash[] = {
+    0xe3, 0x04, 0x66, 0xf6, 0xb8, 0x47, 0x0c, 0x1f,
+    0x29, 0x07, 0x0b, 0x17, 0xf1, 0xe2, 0xd3, 0xe9,
+    0x4d, 0x44, 0x5e, 0x3f, 0x60, 0x80, 0x87, 0xfd,
+    0xc7, 0x11, 0xe4, 0x38, 0x2b, 0xb5, 0x38, 0xb6,
+};
+const unsigned int root_pub_der_hash_len = 32;
+#endif
+#if defined(MCUBOOT_ECDSA_COMB_TABLES)
+const unsigned int root_pub_der_table[] = {
+    0x953988d9, 0x245737e5, 0xcd14fb2f, 0xdbbe1937,
+    0xa91daee8, 0xa44995a1, 0xe8feed5b, 0x2acb403c,
+    0x538efac1, 0xcc3a6afc, 0x7d8b6834, 0x810ee5f0,
+    0x48b24a6a, 0x308ad6fe, 0xebd7cdd5, 0x94b9d65a,
+    0xe0de8d08, 0x37fea77a, 0x9076f87e, 0xb938819c,
+    0xa4bfdff6, 0xdd08fdc4, 0xf1c49e0c, 0x401412b1,
+    0x448d02f8, 0x75e15e4d, 0x254c59c4, 0x24873c84,
+    0xfcb34a59, 0x7b5acd96, 0x410fd69b, 0x18ffada2,
+    0x095d6404, 0xba51091c, 0x9f5254fe, 0xb685c3a2,
+    0x8b1a64a2, 0x6f8f80b3, 0xe94b8a0f, 0xff9dbd73,
+    0x87570ff8, 0x3d94ab64, 0x56e63864, 0x5e09893c,
+    0x6cf48f1f, 0xae04a2e4, 0x29b33c7c, 0x99ddb9bd,
+    0x738420b4, 0xae87634a, 0x19c0ac3d, 0x66496f5d,
+    0x809e6750, 0x05175d0d, 0x3c83bbb4, 0x47e47a7f,
+    0x3e35f56a, 0xcc4500c5, 0xb1faa36b, 0xe0631d97,
+    0xbe69873b, 0x27e5368e, 0xfd6d8809, 0x82980e0b,
+    0x924f9052, 0xa4ddec1d, 0xda3736ca, 0x1770297b,
+    0x7d33c259, 0xd98d2055, 0x8d6ce20e, 0x0e7b50af,
+    0x86bcb5ab, 0xe4057c36, 0xb8930865, 0xea27dfbb,
+    0x24602491, 0x9585c0dd, 0xfa8ea176, 0xbbae20ef,
+    0xc1f348ab, 0x641330fe, 0xe7f6cc50, 0x12776b49,
+    0x75752b58, 0x85f09c08, 0x8c2566df, 0x3e46097f,
+    0xe74cc68a, 0x9cbf86bf, 0x34716214, 0xb72114a7,
+    0xc6713faa, 0x83dc4fe4, 0x141fea38, 0x059cedb5,
+    0xbb3bf62d, 0x7ac59335, 0xdc947607, 0x32d5ddc4,
+    0xef2c11d0, 0x5118a6b3, 0x3b4f0626, 0x094ff567,
+    0x7630e5cd, 0x6fc4a673, 0x175563a8, 0xfc27a17c,
+    0x59d8bb88, 0xdbfa7418, 0x0a1aacf0, 0xd020f7d5,
+    0x0b3de029, 0xb57c5e3c, 0xcef1a94a, 0x83f53555,
+    0x10571617, 0xe199f083, 0xa2789066, 0x8a8a1e17,
+    0x9ce8d2d9, 0xa4b9b5ec, 0xa3909bdd, 0x82d50ae8,
+    0xf48e4f8c, 0x3107ec54, 0x2fde3200, 0x73fae410,
+    0x7d664d50, 0xa62b1d7f, 0x995fc672, 0xade15d2c,
+    0xd2dbcd89, 0x6217a24a, 0x2f22c327, 0xa2e40f39,
+    0xecaed1fc, 0xd19afcc0, 0x64afbea5, 0x26bc6fc0,
+    0x8843c77d, 0x88f2b5e1, 0x0303c565, 0x62f56c26,
+    0x63c4a052, 0x795af59e, 0x2afcb70b, 0xe15c86f9,
+    0xdc0601ba, 0x00b8b87b, 0x6756162c, 0x82918329,
+    0x6328eb26, 0x76e72125, 0x43094aea, 0xcb86d44c,
+    0x6b8fae89, 0xab1a49bd, 0x2024d052, 0x718e39a0,
+    0x824f1c58, 0x9d24b0b3, 0x90ec37cd, 0x3c4f9b79,
+    0x5d08a319, 0x8519e9aa, 0x7d7df977, 0x4e471200,
+    0x2c351c95, 0x9b28d1af, 0x4484edc8, 0x39e67b7b,
+    0xfad8e719, 0x59b9aed5, 0xf7a3fb4d, 0x6dbb6172,
+    0xaeca252a, 0xe072ced5, 0x00ea1d92, 0xc38d9f8e,
+    0x3faba453, 0x801d39cf, 0x27dc1291, 0x241a0481,
+    0x7e3d40e4, 0x19c52ec0, 0x46b82097, 0xd3c27146,
+    0xe3b2fcf3, 0xbead00d9, 0x8b01d225, 0x68ea1b7a,
+    0x0ccf4b2e, 0x928f760d, 0x62d5ba6c, 0x0049891c,
+    0xf486fc0e, 0xd0399977, 0x9b0a3cc0, 0xe9c70a59,
+    0x03290a89, 0xda5dae89, 0xabeaf1c4, 0xcc2047e3,
+    0xe3a86eb1, 0xd42bd16f, 0x880311c7, 0xb1834d05,
+    0x3bee9ba7, 0x0d35ebf4, 0x9d35c750, 0xbba12914,
+    0xf847e9fc, 0xc7c86617, 0x8de7f33a, 0xa5682b32,
+    0xb6c968c4, 0x63ce98fb, 0x55a1669c, 0x77101db6,
+    0xa0a0d77f, 0xe7495372, 0x9bf41445, 0x25152a50,
+    0xf01ead1e, 0xa36a7492, 0x0c8be52c, 0xa79f136c,
+    0xb781695f, 0x7b9b4df3, 0xf0326462, 0x0a92ea41,
+    0x650c8e03, 0x43822450, 0xa0bb342f, 0x13cae4e0,
+    0xa5464dbd, 0x48686a75, 0xf9443cdd, 0xf17e2cae,
+};
+#endif
 #else /* MCUBOOT_SIGN_EC384 */
 const unsigned char root_pub_der[] = {
     0x30, 0x76, 0x30, 0x10, 0x06, 0x07, 0x2a, 0x86,
@@ -143,6 +324,17 @@ const unsigned char root_pub_der[] = {
     0xa8, 0xf2, 0x48, 0xfe, 0x3a, 0x60, 0x69, 0xa5,
 };
 const unsigned int root_pub_der_len = 120;
+#if defined(MCUBOOT_KEY_HASH_TABLE)
+const unsigned char root_pub_der_hash[] = {
+    0x85, 0xb7, 0xbd, 0x5f, 0x5d, 0xff, 0x9a, 0x03,
+    0xa9, 0x99, 0x27, 0xad, 0xaf, 0x6c, 0xa6, 0xfe,
+    0xbd, 0xe8, 0x22, 0xc1, 0xa4, 0x80, 0x92, 0x83,
+    0x24, 0xa8, 0xe6, 0x03, 0x23, 0x71, 0x5c, 0x57,
+    0x79, 0x46, 0x1c, 0x49, 0x6a, 0x95, 0xae, 0xe8,
+    0xc4, 0xf9, 0x0b, 0x99, 0x77, 0x9f, 0x84, 0x8a,
+};
+const unsigned int root_pub_der_hash_len = 48;
+#endif
 #endif /* MCUBOOT_SIGN_EC384 */
 #elif defined(MCUBOOT_SIGN_ED25519)
 #define HAVE_KEYS
@@ -155,6 +347,259 @@ const unsigned char root_pub_der[] = {
     0x20, 0xff, 0xb4, 0xe0,
 };
 const unsigned int root_pub_der_len = 44;
+#if defined(MCUBOOT_KEY_HASH_TABLE)
+const unsigned char root_pub_der_hash[] = {
+    0xc1, 0x90, 0x7f, 0xa4, 0xea, 0xc7, 0xfa, 0xe3,
+    0x84, 0x0a, 0x78, 0x90, 0x2b, 0x6f, 0x07, 0x10,
+    0xb0, 0x37, 0xe9, 0x96, 0x8e, 0x5c, 0x62, 0x74,
+    0xa1, 0x2a, 0x28, 0x79, 0x0c, 0x7d, 0x4e, 0x3c,
+};
+const unsigned int root_pub_der_hash_len = 32;
+#endif
+#if defined(MCUBOOT_ED25519_PRECOMP_TABLES)
+const unsigned int root_pub_der_table[] = {
+    0x00af004a, 0x01295b40, 0x03dc78b8, 0x016825c5,
+    0x0396dafe, 0x01ed1efb, 0x01bc7ae7, 0x010b768d,
+    0x00043acc, 0x018e9922, 0x0388675e, 0x0173f211,
+    0x0384173e, 0x00947b3f, 0x00c6ce8d, 0x0112b11e,
+    0x0208514f, 0x0184901a, 0x03fe30ba, 0x01770ed6,
+    0x03638e2f, 0x013bcbfd, 0x01e49c09, 0x0189fb11,
+    0x03229d10, 0x00a531ca, 0x0291da16, 0x010140fb,
+    0x00516d87, 0x0150cffc, 0x02826740, 0x016bf180,
+    0x026e1869, 0x0110f099, 0x01652cb1, 0x0099f888,
+    0x01c1a2a0, 0x01c2bd6e, 0x005f6b20, 0x003c94de,
+    0x02152b48, 0x013314dc, 0x03d466e9, 0x00109863,
+    0x016eb021, 0x00993c42, 0x00425599, 0x00806f33,
+    0x0024d440, 0x013ffee7, 0x02d569d0, 0x01e1c8b1,
+    0x021941e4, 0x00695adf, 0x03df9797, 0x00fcd375,
+    0x0178404f, 0x004c061a, 0x029171f8, 0x00fb7701,
+    0x00c1b264, 0x00e27980, 0x0340bebb, 0x01d551c5,
+    0x00859dda, 0x01dd5c3c, 0x03565045, 0x012d668f,
+    0x03ea0eec, 0x01fed583, 0x01104b25, 0x01077cec,
+    0x01428c12, 0x009dd158, 0x02276653, 0x01266753,
+    0x02c094ae, 0x0179d341, 0x00a70df7, 0x00197012,
+    0x01757f50, 0x00853ed3, 0x02415f04, 0x0130da3d,
+    0x034498bc, 0x0099738b, 0x00c0cec6, 0x016ce522,
+    0x006becb7, 0x015778a8, 0x01d326d2, 0x015c2029,
+    0x00fa611d, 0x00077719, 0x021c345d, 0x006f615e,
+    0x01eaf065, 0x006cb578, 0x03a35b58, 0x01ea3e0e,
+    0x02f89548, 0x003bcb88, 0x00512481, 0x01ca9ee4,
+    0x02d5dcdb, 0x015e036d, 0x026dab83, 0x014c5db3,
+    0x012c9ee6, 0x0074a793, 0x025bf83a, 0x01745116,
+    0x02c7f159, 0x0178d5d4, 0x00846fc7, 0x00296ce2,
+    0x01fe4a6e, 0x007acb26, 0x01a3427f, 0x01ef88f2,
+    0x006a24be, 0x019d01cc, 0x01f47639, 0x01b98cce,
+    0x03458425, 0x01ce54d9, 0x00bd6ed1, 0x01de0835,
+    0x01ec70b0, 0x019abb35, 0x01ebc219, 0x0024b922,
+    0x000bb45c, 0x01e84a6a, 0x02564831, 0x0063e3e0,
+    0x003c4d55, 0x0094c8af, 0x000f5391, 0x00dfa3da,
+    0x0368ba41, 0x004c3976, 0x034f005f, 0x00e29e2f,
+    0x01f47f8f, 0x0181d013, 0x02d15b3d, 0x010e10e9,
+    0x001297cc, 0x001f94ab, 0x0295a1ee, 0x00968d5f,
+    0x0267ffb3, 0x010f97b6, 0x02dbba5f, 0x00f3ad0a,
+    0x01e95e53, 0x01eb4bed, 0x01607f2c, 0x016d2ca4,
+    0x03d04372, 0x01d55a8c, 0x01507c51, 0x0024193f,
+    0x03f19431, 0x0157a429, 0x0264d030, 0x0033f00c,
+    0x02ac20d4, 0x007fe64f, 0x00f1eeed, 0x00d0f855,
+    0x0030da4e, 0x0103ffb5, 0x030dc4b1, 0x01c3a470,
+    0x00679bd6, 0x01642880, 0x02283cf4, 0x01ec883c,
+    0x00f45e22, 0x00100cc4, 0x0166bc70, 0x01a2bb3e,
+    0x0243eee3, 0x00c1f9c0, 0x003be923, 0x01d49d6f,
+    0x01aa84a7, 0x0176feb6, 0x02baa175, 0x01ee43ab,
+    0x004ae477, 0x01fac8eb, 0x0059852a, 0x0087ed6a,
+    0x035dad9b, 0x01426bd4, 0x00401c2a, 0x00324276,
+    0x0051b084, 0x00138ae2, 0x0313e541, 0x00be1588,
+    0x007eddec, 0x00569e6a, 0x035644e9, 0x0012bfa4,
+    0x01caf5a6, 0x00af5db9, 0x007e79dd, 0x009f4b5b,
+    0x0044de5c, 0x01580cec, 0x0206c0ed, 0x0018a9da,
+    0x00877df9, 0x009a72ad, 0x01401669, 0x017b26f8,
+    0x017719bf, 0x00f84053, 0x00875db0, 0x002865aa,
+    0x02ce9757, 0x017d53d6, 0x01247e24, 0x008fcd13,
+    0x03e95a0e, 0x00ebe6cd, 0x00b3265e, 0x013e1305,
+    0x01efe5ba, 0x0005ce77, 0x00c746bb, 0x00ff5e12,
+    0x02a15c62, 0x011714e9, 0x013260d5, 0x010d4986,
+    0x01df97a4, 0x01a1726d, 0x02add556, 0x012962b5,
+    0x003089ba, 0x01abf4c4, 0x02b23193, 0x0154f79d,
+    0x03514953, 0x0019ea52, 0x002613f0, 0x0065f2c5,
+    0x0245cb1a, 0x01ccb2fc, 0x0052b271, 0x00ff06be,
+    0x033194c9, 0x0135508e, 0x0125e9f3, 0x0016e08b,
+    0x011f4799, 0x01747a5e, 0x016a9866, 0x00fb1b9f,
+    0x0211c5a6, 0x00e32d8e, 0x031c4c41, 0x00c3bc79,
+    0x02f2308a, 0x01ca6165, 0x03ecbcd5, 0x0042f6e2,
+    0x005bb77f, 0x0062e1e2, 0x033fbb55, 0x006f18e2,
+    0x004df3a8, 0x002e1ca7, 0x0376fa7b, 0x006966dc,
+    0x023ed1c8, 0x002f0b46, 0x0392c7fa, 0x0183fe00,
+    0x0069ec03, 0x00236560, 0x01719c36, 0x017837e7,
+    0x02c41fd8, 0x00432384, 0x00fc8b4f, 0x0178e50b,
+    0x0105a340, 0x01cf39dc, 0x00c94742, 0x002bd031,
+    0x01af91a1, 0x01db513a, 0x03ab6b42, 0x00ad168d,
+    0x011cac93, 0x00a3e3e9, 0x035232a0, 0x00b9608e,
+    0x01ff4a4f, 0x01b0e410, 0x032d173e, 0x012252df,
+    0x013c1aa2, 0x0033be24, 0x02bbd64d, 0x00636724,
+    0x016400b9, 0x014db57d, 0x03ad2829, 0x01adbe96,
+    0x009201ab, 0x005faaa7, 0x03ba2e21, 0x00e7f6be,
+    0x01c107ed, 0x0144191f, 0x02dd6f06, 0x00c7c68d,
+    0x0215ef12, 0x00010d62, 0x00f39828, 0x018d1b82,
+    0x00589471, 0x00f10a5f, 0x036416d2, 0x0139bb53,
+    0x01d52e6f, 0x01ec72f2, 0x02b3b18c, 0x008b0d20,
+    0x032dabc6, 0x01b65e0a, 0x00aa635d, 0x000f812b,
+    0x03a3e6b1, 0x014de45d, 0x00655d33, 0x0086f0cf,
+    0x03ecf28a, 0x0064bbc8, 0x01604e34, 0x001e8481,
+    0x011b1b25, 0x0133c9e4, 0x03eb7d58, 0x015b6457,
+    0x03c1b6fd, 0x01c02c38, 0x01a3044f, 0x000daf3f,
+    0x021ff510, 0x015cfdfd, 0x021b8b9b, 0x00d1e085,
+    0x011ac56e, 0x00015c7a, 0x00eb0440, 0x0028883c,
+    0x016a18e0, 0x0039d992, 0x002bbc90, 0x0059dade,
+    0x01a6cf0b, 0x014afc0a, 0x037574d1, 0x002a948d,
+    0x018e9393, 0x002b43fd, 0x01747bdc, 0x011d72cc,
+    0x03b09b76, 0x00e1a690, 0x020ba202, 0x010e5d36,
+    0x0099183d, 0x0121dd3d, 0x028edb9c, 0x01d83cd3,
+    0x0242c106, 0x009a0ec5, 0x00739d3d, 0x01ef8463,
+    0x02025db2, 0x019acae4, 0x02a119b5, 0x00f88840,
+    0x00fd8e32, 0x014715a6, 0x03fb8c3b, 0x01365f6d,
+    0x010f3e54, 0x017c832b, 0x0022ab56, 0x01b5a461,
+    0x00250cec, 0x01549f9c, 0x0242dd79, 0x006b6bd5,
+    0x011b0586, 0x00e5ef01, 0x00d7780d, 0x01991adc,
+    0x021657e8, 0x00a8339b, 0x019baf36, 0x0139e332,
+    0x032c6a7e, 0x00d7bdf6, 0x02b69d9e, 0x008e19ba,
+    0x023f8839, 0x01b9ba1f, 0x01a539b9, 0x0154fcef,
+    0x02c03c57, 0x01477753, 0x038befe7, 0x00de1bfb,
+    0x02dce10a, 0x01fe3dd7, 0x01a4a579, 0x01532cbd,
+    0x0249b021, 0x009673e7, 0x00dba0d2, 0x00d40932,
+    0x028f2ebd, 0x00f9a3fb, 0x0304173e, 0x002b8974,
+    0x0294bdd4, 0x01165302, 0x0037a748, 0x0003d0bc,
+    0x0374025e, 0x00209dd3, 0x00bc32b2, 0x00c27dca,
+    0x01927220, 0x0075acba, 0x038a638b, 0x0022c8a8,
+    0x01a36d96, 0x00bacc59, 0x021a2ce4, 0x011b9835,
+    0x010796a9, 0x015c8c8d, 0x000738cf, 0x000f561d,
+    0x002ce308, 0x009a7b7b, 0x03e0b3d9, 0x00edf2ce,
+    0x0306b153, 0x01a0ff86, 0x0392ba06, 0x0005b5be,
+    0x03b1d019, 0x00c9a10b, 0x028ef029, 0x017689bf,
+    0x02989b0a, 0x01ecc3db, 0x00c4e3e5, 0x001c79be,
+    0x0013d4b3, 0x001b7a8b, 0x03b06e2d, 0x01d79a07,
+    0x0018262c, 0x01a93c88, 0x00da499f, 0x01b839f4,
+    0x039e3cdd, 0x00167b59, 0x03f9ce04, 0x01075d61,
+    0x004e7ebe, 0x0109dfbf, 0x03b6860e, 0x013d3d1d,
+    0x0050bb7d, 0x013a34ad, 0x03db7ebe, 0x01026636,
+    0x02df28a1, 0x01e42b2f, 0x02820595, 0x00a1b065,
+    0x0231162f, 0x00d53adb, 0x01c90b35, 0x010443c5,
+    0x03e6ccc6, 0x0022fafa, 0x031b40ff, 0x01c521e4,
+    0x00d66220, 0x015dfa13, 0x012bbe63, 0x00ba8af8,
+    0x03634b3a, 0x000aa9a4, 0x025a582a, 0x01eea5e8,
+    0x02fd5a3e, 0x012f062d, 0x016d478a, 0x00cb3d01,
+    0x0045a81b, 0x00281f26, 0x030622da, 0x010a13b9,
+    0x02523bf9, 0x01a07a55, 0x012b95ab, 0x0045fc24,
+    0x03bac1d4, 0x013bf9b7, 0x03ecd19f, 0x0188f977,
+    0x0284385f, 0x0169970a, 0x02374ed3, 0x0081b2c5,
+    0x0068c523, 0x005c116e, 0x02e2880d, 0x0057a852,
+    0x015f9678, 0x019c1ec9, 0x03cf4410, 0x010e40bd,
+    0x00181cac, 0x0175443c, 0x02b8ac19, 0x000655e5,
+    0x03b57a84, 0x00c06bf8, 0x0395ff79, 0x007ad065,
+    0x03e78955, 0x0101c4bb, 0x01cc8da0, 0x010d4216,
+    0x03052fff, 0x01f07e8a, 0x03800a31, 0x002854ef,
+    0x00addffd, 0x0167d4f4, 0x003144b2, 0x00ae16f1,
+    0x0256195b, 0x008bb8c6, 0x00e78468, 0x003c81e5,
+    0x001a1b95, 0x00e25e8e, 0x01c16681, 0x019cadcc,
+    0x0072d730, 0x01974145, 0x0055090f, 0x0116a875,
+    0x0138ed8c, 0x01e39270, 0x021fc7b0, 0x000860de,
+    0x039a83fc, 0x00e5740b, 0x035326f9, 0x0122c036,
+    0x03dbaa4e, 0x000f3407, 0x03d0defe, 0x00e378d4,
+    0x03612547, 0x00c8cd79, 0x035a961f, 0x0159084f,
+    0x03a546ae, 0x01d14d5e, 0x00c6d319, 0x01756d0a,
+    0x03b37717, 0x01edee55, 0x0026a7c1, 0x0004bbf1,
+    0x00458f43, 0x01faef21, 0x01e9276f, 0x00bc2b06,
+    0x01b22569, 0x00108f28, 0x03d4c582, 0x003c0861,
+    0x023a0536, 0x0199ce5e, 0x003aeb22, 0x0071ebbd,
+    0x0391d392, 0x00c8f06a, 0x02639caa, 0x0033d3f8,
+    0x0226bedd, 0x003a7191, 0x02edf8e0, 0x0101c969,
+    0x03d49a7c, 0x00d7e732, 0x00d5f3fe, 0x00ff1471,
+    0x0273cb6e, 0x0102e7d9, 0x02f11b69, 0x002045ce,
+    0x0282ee7f, 0x01ef68be, 0x018d0560, 0x01feb938,
+    0x024a5315, 0x01cdf8f4, 0x029648f9, 0x01c4df93,
+    0x021b5b85, 0x01e35668, 0x01c38f76, 0x00cd4a3f,
+    0x0096c197, 0x001992c2, 0x013485bf, 0x00bfe5e8,
+    0x023efb27, 0x01a05a9b, 0x03c06832, 0x0015f613,
+    0x010dacb7, 0x019e4237, 0x038d151e, 0x009f61b3,
+    0x036df2b4, 0x019bb6eb, 0x02b039ca, 0x0186411f,
+    0x036a8b54, 0x00a105b2, 0x00197481, 0x01947b74,
+    0x03aff3f9, 0x006bb28a, 0x00312cd6, 0x00244490,
+    0x02d7d830, 0x00d02042, 0x02b38f8b, 0x01bba832,
+    0x00362db1, 0x00750ae0, 0x0031e37f, 0x01e2ddf2,
+    0x00156530, 0x017b5c03, 0x0351af56, 0x01120944,
+    0x03030e64, 0x01d51819, 0x012e32d5, 0x00744a92,
+    0x002764fb, 0x001d5e0b, 0x012ae66a, 0x01c325c9,
+    0x03b43fd0, 0x00479710, 0x012f3858, 0x00b3c7f4,
+    0x01e08e6f, 0x01d40d63, 0x03c31ba2, 0x006f90cf,
+    0x017ab907, 0x005d36ff, 0x03ff07ae, 0x01833748,
+    0x0368318c, 0x00789cee, 0x0140c271, 0x014077c5,
+    0x03bd02df, 0x012ed263, 0x0368ba97, 0x0011f610,
+    0x00fcc77d, 0x01cbba44, 0x00db39c1, 0x00ffd19b,
+    0x03356d60, 0x01facf87, 0x02cd4c52, 0x018acc27,
+    0x00a6c4f8, 0x01c9b078, 0x015eb53d, 0x008e5f82,
+    0x01af4c6e, 0x00bdde50, 0x0189bed2, 0x005401a5,
+    0x0187e7c9, 0x0128caf7, 0x02bac12f, 0x00a35660,
+    0x01daffe2, 0x01bec02f, 0x02881e9a, 0x019987de,
+    0x03327ee5, 0x00647b5b, 0x01066c53, 0x00708fce,
+    0x02cd4c04, 0x00ee674a, 0x015ec9a4, 0x017ff9cf,
+    0x03aabbb1, 0x004e089c, 0x02b92d2f, 0x016873e8,
+    0x020f4fa3, 0x00b231a0, 0x024b4821, 0x0004ae00,
+    0x03972de5, 0x0112c307, 0x00c877df, 0x01571cb2,
+    0x037e4a77, 0x019c2218, 0x03367ebe, 0x0125a2b4,
+    0x021ea4bf, 0x0129aeb2, 0x03f555ea, 0x008e2945,
+    0x024ce73d, 0x0013c1c5, 0x00e0770a, 0x019ba967,
+    0x03107238, 0x014b36b1, 0x02467533, 0x00a8bbd9,
+    0x001ac254, 0x00bd5496, 0x0093f9ae, 0x013877d7,
+    0x00faa578, 0x0154ea42, 0x011f1193, 0x0103606e,
+    0x03188660, 0x00d6f547, 0x01c8e0e0, 0x003505c6,
+    0x001c9659, 0x002369b2, 0x0353a142, 0x0141a533,
+    0x0362cfb6, 0x01e54838, 0x03f9ff30, 0x00821f20,
+    0x0202542e, 0x00d227e3, 0x019498b6, 0x00540a5f,
+    0x01e5b0b2, 0x01cca8d0, 0x01fedb5b, 0x001e4e84,
+    0x023fd106, 0x01a9d7a5, 0x023c04db, 0x0084fa7f,
+    0x037eaef3, 0x014fdf49, 0x01f7b35f, 0x01047869,
+    0x018afae4, 0x019f78b4, 0x0352318d, 0x0108a8f9,
+    0x03132db8, 0x011537a0, 0x0270756f, 0x01f6f906,
+    0x02aa4fd5, 0x012c62e7, 0x011f3907, 0x013492a5,
+    0x035b4b75, 0x00810575, 0x02fd67c6, 0x017a05a9,
+    0x019d063f, 0x017434e3, 0x0202e533, 0x016df60f,
+    0x01988bf3, 0x00d592cc, 0x0131e966, 0x015f2a11,
+    0x00d6db27, 0x01febaab, 0x033362b0, 0x01bd3cd6,
+    0x009a7c67, 0x00f739b9, 0x02a74b7e, 0x0157243b,
+    0x03ba00c1, 0x008b4033, 0x021f7022, 0x01c44c6f,
+    0x038d9825, 0x0007160a, 0x01f9f039, 0x0099b70a,
+    0x03bf1e63, 0x00382ebe, 0x01a3a0bc, 0x0087c2cb,
+    0x000cd0d4, 0x0123ef05, 0x008b37e4, 0x0011acca,
+    0x0320640c, 0x005f1b7d, 0x00b715d9, 0x01a9d83f,
+    0x02d7a82a, 0x00c9893e, 0x03be7c3c, 0x0120bebf,
+    0x00d29b3f, 0x00b66ebc, 0x0228d4df, 0x0164e1f4,
+    0x02915db1, 0x004627bd, 0x03a76c6e, 0x00eca06e,
+    0x03a093a0, 0x019aa369, 0x012f2466, 0x00651609,
+    0x01551666, 0x00fbc3f7, 0x033e2783, 0x00362a48,
+    0x00a53211, 0x00388e29, 0x025d4d9b, 0x01d3f306,
+    0x032b5b7b, 0x00ad109d, 0x026133b2, 0x0192592f,
+    0x022d9581, 0x00298897, 0x020e26cd, 0x001442bb,
+    0x02aafe9b, 0x005a8453, 0x008e1920, 0x0122d50a,
+    0x030eaa89, 0x01e77a92, 0x01ea9585, 0x0080132c,
+    0x02aebd62, 0x014cabfc, 0x01283d40, 0x0177e324,
+    0x01c1e5ad, 0x0011b527, 0x0222772f, 0x00650f27,
+    0x00389ec8, 0x00115812, 0x00358cbb, 0x01f0f6c1,
+    0x00fb530e, 0x0148c539, 0x02ec4f88, 0x0022f0f5,
+    0x01f531ce, 0x00ef5cf2, 0x02eaa017, 0x01c140ff,
+    0x0100f436, 0x01664630, 0x026f0507, 0x01c9b443,
+    0x032d7c5c, 0x0048d4a3, 0x013e0164, 0x01898301,
+    0x01dc48c1, 0x00db82a6, 0x03f3c9d4, 0x017ccfda,
+    0x011998b1, 0x00287181, 0x03f4106c, 0x006b37e2,
+    0x01ff8e5d, 0x01ac31e0, 0x000f6be7, 0x004f7e16,
+    0x01f6571b, 0x01a47842, 0x025a8690, 0x019db9f4,
+    0x0008c4b1, 0x01a8b825, 0x0028920d, 0x003d039a,
+    0x00e9deae, 0x0168b3f5, 0x02dbd7d5, 0x00c38cc6,
+    0x014fd487, 0x005c71be, 0x0002c16b, 0x0139aae5,
+    0x003ef945, 0x00895907, 0x004ae336, 0x01346903,
+    0x03179c35, 0x0048e567, 0x010cb098, 0x0119271a,
+    0x00fe9c96, 0x00874655, 0x0024de0c, 0x00fd8f73,
+    0x02493d49, 0x003ad995, 0x013d39ab, 0x01c60c06,
+};
+#endif
 #endif
 
 #if defined(HAVE_KEYS)
@@ -162,6 +607,19 @@ const struct bootutil_key bootutil_keys[] = {
     {
         .key = root_pub_der,
         .len = &root_pub_der_len,
+#if defined(MCUBOOT_KEY_HASH_TABLE)
+        .hash = root_pub_der_hash,
+        .hash_len = &root_pub_der_hash_len,
+#endif
+#if defined(MCUBOOT_ECDSA_COMB_TABLES)
+        .ecdsa_table = root_pub_der_table,
+#endif
+#if defined(MCUBOOT_ED25519_PRECOMP_TABLES)
+        .ed25519_table = root_pub_der_table,
+#endif
+#if defined(MCUBOOT_RSA_PRECOMP_TABLES)
+        .rsa_table = root_pub_der_table,
+#endif
     },
 };
 const int bootutil_key_cnt = 1;
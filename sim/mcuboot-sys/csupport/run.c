@@ -26,6 +26,7 @@
 #define BOOT_LOG_LEVEL BOOT_LOG_LEVEL_ERROR
 #include <bootutil/bootutil_log.h>
 #include "bootutil/crypto/common.h"
+#include "bootutil/crypto/sha.h"
 
 #define ARRAY_SIZE(x) (sizeof(x) / sizeof((x)[0]))
 
@@ -52,9 +53,20 @@ struct sim_context {
     int jumped;
     uint8_t c_asserts;
     uint8_t c_catch_asserts;
+    uint32_t erase_count;
+    uint64_t erase_time_us;
     jmp_buf boot_jmpbuf;
 };
 
+/*
+ * Erase timing model, loosely based on serial NOR flash datasheets: every
+ * erase command has a fixed cost plus a cost proportional to its size, so a
+ * 64 KiB block erases several times faster than its sixteen 4 KiB sectors
+ * one by one.
+ */
+#define SIM_ERASE_CMD_US        40000
+#define SIM_ERASE_US_PER_KIB    2000
+
 #ifdef MCUBOOT_ENCRYPT_RSA
 static int
 parse_pubkey(mbedtls_rsa_context *ctx, uint8_t **p, uint8_t *end)
@@ -349,6 +361,169 @@ int invoke_boot_load_image_from_flash_to_sram(struct sim_context *ctx, struct ar
 #endif /* MCUBOOT_RAM_LOAD */
 }
 
+/*
+ * Hash the image in the primary slot of the first image `iterations` times,
+ * the same way it is hashed when validated. On success, `hashed` is set to
+ * the number of bytes hashed by a single iteration.
+ */
+int invoke_img_hash(struct sim_context *ctx, struct area_desc *adesc,
+                    uint32_t iterations, uint32_t *hashed)
+{
+#if !defined(MCUBOOT_SIGN_PURE) && !defined(MCUBOOT_RAM_LOAD)
+    static uint8_t tmpbuf[BOOT_TMPBUF_SZ];
+    uint8_t hash[IMAGE_HASH_SIZE];
+    const struct flash_area *fa_p;
+    struct image_header hdr;
+    uint32_t i;
+    int res;
+
+    sim_set_flash_areas(adesc);
+    sim_set_context(ctx);
+
+    res = flash_area_open(FLASH_AREA_IMAGE_PRIMARY(0), &fa_p);
+    if (res == 0) {
+        res = boot_image_load_header(fa_p, &hdr);
+        for (i = 0; res == 0 && i < iterations; i++) {
+            res = bootutil_img_hash(NULL, &hdr, fa_p, tmpbuf, sizeof(tmpbuf),
+                                    hash, NULL, 0);
+        }
+        flash_area_close(fa_p);
+    }
+
+    if (res == 0) {
+        *hashed = hdr.ih_hdr_size + hdr.ih_img_size + hdr.ih_protect_tlv_size;
+    }
+
+    sim_reset_flash_areas();
+    sim_reset_context();
+    return res;
+#else
+    (void)ctx;
+    (void)adesc;
+    (void)iterations;
+    (void)hashed;
+    return -1;
+#endif
+}
+
+/*
+ * Erase the primary slot of the first image with boot_erase_region(); the
+ * number of erase commands and their modeled time are counted in `ctx`.
+ */
+int invoke_erase_region(struct sim_context *ctx, struct area_desc *adesc)
+{
+    const struct flash_area *fa_p;
+    int res;
+
+    sim_set_flash_areas(adesc);
+    sim_set_context(ctx);
+
+    res = flash_area_open(FLASH_AREA_IMAGE_PRIMARY(0), &fa_p);
+    if (res == 0) {
+        res = boot_erase_region(fa_p, 0, flash_area_get_size(fa_p), false);
+        flash_area_close(fa_p);
+    }
+
+    sim_reset_flash_areas();
+    sim_reset_context();
+    return res;
+}
+
+/*
+ * Verify the RSA signature of the image in the primary slot of the first
+ * image `iterations` times, with the first built in key. Then check that
+ * the signature is rejected for another hash and that another signature is
+ * rejected. Returns 0 if all of these checks pass.
+ */
+int invoke_rsa_verify(struct sim_context *ctx, struct area_desc *adesc,
+                      uint32_t iterations)
+{
+#if defined(MCUBOOT_SIGN_RSA) && !defined(MCUBOOT_HW_KEY) && \
+    !defined(MCUBOOT_BUILTIN_KEY) && !defined(MCUBOOT_SIGN_PURE) && \
+    !defined(MCUBOOT_RAM_LOAD)
+    static uint8_t tmpbuf[BOOT_TMPBUF_SZ];
+    uint8_t sig[MCUBOOT_SIGN_RSA_LEN / 8];
+    uint8_t hash[IMAGE_HASH_SIZE];
+    const struct flash_area *fa_p;
+    struct image_header hdr;
+    struct image_tlv_iter it;
+    uint32_t off;
+    uint16_t len;
+    uint32_t i;
+    int res;
+    FIH_DECLARE(fih_rc, FIH_FAILURE);
+
+    sim_set_flash_areas(adesc);
+    sim_set_context(ctx);
+
+    res = flash_area_open(FLASH_AREA_IMAGE_PRIMARY(0), &fa_p);
+    if (res == 0) {
+        res = boot_image_load_header(fa_p, &hdr);
+        if (res == 0) {
+            res = bootutil_img_hash(NULL, &hdr, fa_p, tmpbuf, sizeof(tmpbuf),
+                                    hash, NULL, 0);
+        }
+        if (res == 0) {
+            res = bootutil_tlv_iter_begin(&it, &hdr, fa_p,
+#if MCUBOOT_SIGN_RSA_LEN == 2048
+                                          IMAGE_TLV_RSA2048_PSS,
+#else
+                                          IMAGE_TLV_RSA3072_PSS,
+#endif
+                                          false);
+        }
+        if (res == 0) {
+            res = bootutil_tlv_iter_next(&it, &off, &len, NULL);
+        }
+        if (res == 0 && len != sizeof(sig)) {
+            res = -1;
+        }
+        if (res == 0) {
+            res = flash_area_read(fa_p, off, sig, sizeof(sig));
+        }
+        flash_area_close(fa_p);
+    }
+
+    for (i = 0; res == 0 && i < iterations; i++) {
+        FIH_CALL(bootutil_verify_sig, fih_rc, hash, sizeof(hash), sig,
+                 sizeof(sig), 0);
+        if (FIH_NOT_EQ(fih_rc, FIH_SUCCESS)) {
+            res = -1;
+        }
+    }
+
+    if (res == 0) {
+        hash[0] ^= 1;
+        FIH_CALL(bootutil_verify_sig, fih_rc, hash, sizeof(hash), sig,
+                 sizeof(sig), 0);
+        hash[0] ^= 1;
+        if (FIH_EQ(fih_rc, FIH_SUCCESS)) {
+            printf("Signature accepted for another hash\n");
+            res = -1;
+        }
+    }
+
+    if (res == 0) {
+        sig[sizeof(sig) / 2] ^= 1;
+        FIH_CALL(bootutil_verify_sig, fih_rc, hash, sizeof(hash), sig,
+                 sizeof(sig), 0);
+        if (FIH_EQ(fih_rc, FIH_SUCCESS)) {
+            printf("Modified signature accepted\n");
+            res = -1;
+        }
+    }
+
+    sim_reset_flash_areas();
+    sim_reset_context();
+    return res;
+#else
+    (void)ctx;
+    (void)adesc;
+    (void)iterations;
+    return -1;
+#endif
+}
+
 void *os_malloc(size_t size)
 {
     // printf("os_malloc 0x%x bytes\n", size);
@@ -403,6 +578,27 @@ int flash_area_read(const struct flash_area *area, uint32_t off, void *dst,
     return sim_flash_read(area->fa_device_id, area->fa_off + off, dst, len);
 }
 
+#ifdef MCUBOOT_FLASH_ASYNC_READ
+/*
+ * The simulated flash has no asynchronous interface: the read is done when it
+ * is started and its result is handed back when it is waited for.
+ */
+static int sim_async_read_rc;
+
+int flash_area_read_async(const struct flash_area *area, uint32_t off,
+                          void *dst, uint32_t len)
+{
+    sim_async_read_rc = flash_area_read(area, off, dst, len);
+    return 0;
+}
+
+int flash_area_read_wait(const struct flash_area *area)
+{
+    (void)area;
+    return sim_async_read_rc;
+}
+#endif
+
 int flash_area_write(const struct flash_area *area, uint32_t off, const void *src,
                      uint32_t len)
 {
@@ -425,9 +621,32 @@ int flash_area_erase(const struct flash_area *area, uint32_t off, uint32_t len)
         ctx->jumped++;
         longjmp(ctx->boot_jmpbuf, 1);
     }
+    ctx->erase_count++;
+    ctx->erase_time_us += SIM_ERASE_CMD_US + (uint64_t)len / 1024 * SIM_ERASE_US_PER_KIB;
     return sim_flash_erase(area->fa_device_id, area->fa_off + off, len);
 }
 
+#ifdef MCUBOOT_FLASH_MULTI_SECTOR_ERASE
+/*
+ * The simulated devices have 32 and 64 KiB erase blocks, aligned on their size
+ * in the device, on top of their sectors.
+ */
+uint32_t flash_area_erase_size(const struct flash_area *area, uint32_t off)
+{
+    static const uint32_t block_sizes[] = { 0x10000, 0x8000 };
+    uint32_t dev_off = area->fa_off + off;
+    size_t i;
+
+    for (i = 0; i < ARRAY_SIZE(block_sizes); i++) {
+        if (dev_off % block_sizes[i] == 0) {
+            return block_sizes[i];
+        }
+    }
+
+    return 0;
+}
+#endif
+
 int flash_area_to_sectors(int idx, int *cnt, struct flash_area *ret)
 {
     int rc = 0;
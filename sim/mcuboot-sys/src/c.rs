@@ -25,6 +25,7 @@ pub enum BootGoResult {
     Normal {
         result: i32,
         asserts: u8,
+        erases: u32,
 
         resp: api::BootRsp,
     },
@@ -58,6 +59,15 @@ impl BootGoResult {
         }
     }
 
+    /// Get the number of flash erases done by the run.  An interrupted run will be considered to
+    /// have done none.
+    pub fn erase_count(&self) -> u32 {
+        match self {
+            BootGoResult::Normal { erases, .. } => *erases,
+            _ => 0,
+        }
+    }
+
     /// Retrieve the 'resp' field that is filled in.
     pub fn resp(&self) -> Option<&api::BootRsp> {
         match self {
@@ -111,7 +121,7 @@ pub fn boot_go(multiflash: &mut SimMultiFlash, areadesc: &AreaDesc,
     if result == -0x13579 {
         BootGoResult::Stopped
     } else {
-        BootGoResult::Normal { result, asserts, resp: rsp }
+        BootGoResult::Normal { result, asserts, erases: sim_ctx.erase_count, resp: rsp }
     }
 }
 
@@ -137,6 +147,80 @@ pub fn boot_load_image_from_flash_to_sram(multiflash: &mut SimMultiFlash, areade
     result == 0
 }
 
+/// Hash the image in the primary slot `iterations` times, returning the number of bytes hashed
+/// by each iteration, or None if hashing failed or is not supported by this configuration.
+pub fn img_hash(multiflash: &mut SimMultiFlash, areadesc: &AreaDesc, iterations: u32) -> Option<u32> {
+    init_crypto();
+
+    for (&dev_id, flash) in multiflash.iter_mut() {
+        api::set_flash(dev_id, flash);
+    }
+    let mut sim_ctx = api::CSimContext {
+        flash_counter: 0,
+        c_catch_asserts: 0,
+        .. Default::default()
+    };
+    let mut hashed: u32 = 0;
+    let result: i32 = unsafe {
+        let adesc = areadesc.get_c();
+        raw::invoke_img_hash(&mut sim_ctx as *mut _,
+                             adesc.borrow() as *const _,
+                             iterations, &mut hashed as *mut _) as i32
+    };
+    for &dev_id in multiflash.keys() {
+        api::clear_flash(dev_id);
+    }
+    if result == 0 { Some(hashed) } else { None }
+}
+
+/// Verify the RSA signature of the image in the primary slot `iterations` times, and check that
+/// a modified hash or signature is rejected. Returns false if any check failed or RSA signatures
+/// are not supported by this configuration.
+pub fn rsa_verify(multiflash: &mut SimMultiFlash, areadesc: &AreaDesc, iterations: u32) -> bool {
+    init_crypto();
+
+    for (&dev_id, flash) in multiflash.iter_mut() {
+        api::set_flash(dev_id, flash);
+    }
+    let mut sim_ctx = api::CSimContext {
+        flash_counter: 0,
+        c_catch_asserts: 0,
+        .. Default::default()
+    };
+    let result: i32 = unsafe {
+        let adesc = areadesc.get_c();
+        raw::invoke_rsa_verify(&mut sim_ctx as *mut _,
+                               adesc.borrow() as *const _,
+                               iterations) as i32
+    };
+    for &dev_id in multiflash.keys() {
+        api::clear_flash(dev_id);
+    }
+    result == 0
+}
+
+/// Erase the primary slot, returning the number of erase commands issued and their modeled
+/// duration in microseconds, or None if the erase failed.
+pub fn erase_region(multiflash: &mut SimMultiFlash, areadesc: &AreaDesc) -> Option<(u32, u64)> {
+    for (&dev_id, flash) in multiflash.iter_mut() {
+        api::set_flash(dev_id, flash);
+    }
+    let mut sim_ctx = api::CSimContext {
+        flash_counter: 0,
+        c_catch_asserts: 0,
+        .. Default::default()
+    };
+    let result: i32 = unsafe {
+        let adesc = areadesc.get_c();
+        raw::invoke_erase_region(&mut sim_ctx as *mut _,
+                                 adesc.borrow() as *const _) as i32
+    };
+    for &dev_id in multiflash.keys() {
+        api::clear_flash(dev_id);
+    }
+    if result == 0 { Some((sim_ctx.erase_count, sim_ctx.erase_time_us)) } else { None }
+}
+
 pub fn boot_trailer_sz(align: u32) -> u32 {
     unsafe { raw::boot_trailer_sz(align) }
 }
@@ -206,6 +290,14 @@ mod raw {
         pub fn invoke_boot_load_image_from_flash_to_sram(sim_ctx: *mut CSimContext,
             areadesc: *const CAreaDesc) -> libc::c_int;
 
+        pub fn invoke_img_hash(sim_ctx: *mut CSimContext, areadesc: *const CAreaDesc,
+            iterations: u32, hashed: *mut u32) -> libc::c_int;
+
+        pub fn invoke_erase_region(sim_ctx: *mut CSimContext, areadesc: *const CAreaDesc) -> libc::c_int;
+
+        pub fn invoke_rsa_verify(sim_ctx: *mut CSimContext, areadesc: *const CAreaDesc,
+            iterations: u32) -> libc::c_int;
+
         pub fn boot_trailer_sz(min_write_sz: u32) -> u32;
         pub fn boot_status_sz(min_write_sz: u32) -> u32;
 
@@ -60,6 +60,7 @@ pub trait Flash {
     fn reset_bad_regions(&mut self);
 
     fn set_verify_writes(&mut self, enable: bool);
+    fn set_rewrite_erased(&mut self, enable: bool);
 
     fn sector_iter(&self) -> SectorIter<'_>;
     fn device_size(&self) -> usize;
@@ -93,6 +94,8 @@ pub struct SimFlash {
     // Alignment required for writes.
     align: usize,
     verify_writes: bool,
+    // Allow writes to locations that still hold the erased value.
+    rewrite_erased: bool,
     erased_val: u8,
 }
 
@@ -111,6 +114,7 @@ impl SimFlash {
             bad_region: Vec::new(),
             align,
             verify_writes: true,
+            rewrite_erased: false,
             erased_val,
         }
     }
@@ -178,7 +182,9 @@ impl Flash for SimFlash {
     ///
     /// This emulates a flash device which starts out erased, with the
     /// added restriction that repeated writes to the same location
-    /// are disallowed, even if they would be safe to do.
+    /// are disallowed, even if they would be safe to do. With
+    /// `set_rewrite_erased`, writing again to a location that still holds
+    /// the erased value is allowed, as most NOR flash without ECC does.
     fn write(&mut self, offset: usize, payload: &[u8]) -> Result<()> {
         for &(off, len, rate) in &self.bad_region {
             if offset >= off && (offset + payload.len()) <= (off + len) {
@@ -204,8 +210,10 @@ impl Flash for SimFlash {
             panic!("Write length not multiple of alignment");
         }
 
+        let old = &self.data[offset .. offset + payload.len()];
         for (i, x) in &mut self.write_safe[offset .. offset + payload.len()].iter_mut().enumerate() {
-            if self.verify_writes && !(*x) {
+            if self.verify_writes && !(*x) &&
+                !(self.rewrite_erased && old[i] == self.erased_val) {
                 panic!("Write to unerased location at 0x{:x}", offset + i);
             }
             *x = false;
@@ -248,6 +256,10 @@ impl Flash for SimFlash {
         self.verify_writes = enable;
     }
 
+    fn set_rewrite_erased(&mut self, enable: bool) {
+        self.rewrite_erased = enable;
+    }
+
     /// An iterator over each sector in the device.
     fn sector_iter(&self) -> SectorIter<'_> {
         SectorIter {
@@ -31,6 +31,9 @@ pub enum Caps {
     HwRollbackProtection = (1 << 18),
     EcdsaP384            = (1 << 19),
     SwapUsingOffset      = (1 << 20),
+    DecompressImages     = (1 << 21),
+    ValidationCache      = (1 << 22),
+    DeltaImages          = (1 << 23),
 }
 
 impl Caps {
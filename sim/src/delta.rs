@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: Apache-2.0
+
+//! A patch encoder for delta images.
+//!
+//! This produces the patches imgtool stores as the payload of a delta image:
+//! a sequence of COPY, LITERAL and SEEK commands, each a command byte followed
+//! by a LEB128 encoded argument, that rebuild the new image from the base
+//! image in the primary slot.  The bootloader applies them in place, once the
+//! base image has been moved up by `shift` bytes, so data is never copied from
+//! an offset of the moved base image below that of the output.  Like imgtool,
+//! a greedy match finder over an index of the base image is good enough.
+
+use std::collections::HashMap;
+
+const COPY: u8 = 0x00;
+const LITERAL: u8 = 0x01;
+const SEEK: u8 = 0x02;
+
+/// Shortest matches worth a COPY, continuing from the base position or not.
+const MIN_CONTINUATION: usize = 8;
+const MIN_MATCH: usize = 16;
+const KEY_SIZE: usize = 8;
+const MAX_CANDIDATES: usize = 8;
+
+fn push_varint(out: &mut Vec<u8>, mut value: u64) {
+    loop {
+        let byte = (value & 0x7f) as u8;
+        value >>= 7;
+        if value == 0 {
+            out.push(byte);
+            return;
+        }
+        out.push(byte | 0x80);
+    }
+}
+
+fn push_command(out: &mut Vec<u8>, cmd: u8, arg: u64) {
+    out.push(cmd);
+    push_varint(out, arg);
+}
+
+fn match_len(a: &[u8], b: &[u8]) -> usize {
+    a.iter().zip(b).take_while(|(x, y)| x == y).count()
+}
+
+/// Computes the patch turning `base` into `new`, `new` going at `out_off` of
+/// the primary slot.
+pub fn make_patch(base: &[u8], new: &[u8], out_off: usize, shift: usize) -> Vec<u8> {
+    let mut index: HashMap<&[u8], Vec<usize>> = HashMap::new();
+    for pos in 0 .. base.len().saturating_sub(KEY_SIZE - 1) {
+        let positions = index.entry(&base[pos .. pos + KEY_SIZE]).or_default();
+        if positions.len() < MAX_CANDIDATES {
+            positions.push(pos);
+        }
+    }
+
+    let mut patch = vec![];
+    let mut literal = vec![];
+    let mut base_pos = 0;
+    let mut i = 0;
+
+    let flush_literal = |patch: &mut Vec<u8>, literal: &mut Vec<u8>| {
+        if !literal.is_empty() {
+            push_command(patch, LITERAL, literal.len() as u64);
+            patch.append(literal);
+        }
+    };
+
+    while i < new.len() {
+        // Base data must be read from at or after the output offset.
+        let first = (out_off + i).saturating_sub(shift);
+        let mut best_len = 0;
+        let mut best_pos = 0;
+        if base_pos >= first && base_pos < base.len() {
+            best_len = match_len(&base[base_pos..], &new[i..]);
+            best_pos = base_pos;
+            if best_len < MIN_CONTINUATION {
+                best_len = 0;
+            }
+        }
+        if i + KEY_SIZE <= new.len() {
+            for &pos in index.get(&new[i .. i + KEY_SIZE]).into_iter().flatten() {
+                if pos < first || pos == base_pos {
+                    continue;
+                }
+                let n = match_len(&base[pos..], &new[i..]);
+                if n >= MIN_MATCH && n > best_len {
+                    best_len = n;
+                    best_pos = pos;
+                }
+            }
+        }
+
+        if best_len == 0 {
+            literal.push(new[i]);
+            i += 1;
+            continue;
+        }
+
+        flush_literal(&mut patch, &mut literal);
+        if best_pos != base_pos {
+            let d = best_pos as i64 - base_pos as i64;
+            let zigzag = if d >= 0 { (d as u64) << 1 } else { (((-d - 1) as u64) << 1) | 1 };
+            push_command(&mut patch, SEEK, zigzag);
+        }
+        push_command(&mut patch, COPY, best_len as u64);
+        base_pos = best_pos + best_len;
+        i += best_len;
+    }
+
+    flush_literal(&mut patch, &mut literal);
+    patch
+}
+
+#[cfg(test)]
+mod test {
+    use super::*;
+
+    #[test]
+    fn moved_code() {
+        let mut x = 1u32;
+        let base: Vec<u8> = (0 .. 4096).map(|_| {
+            x = x.wrapping_mul(1103515245).wrapping_add(12345);
+            (x >> 16) as u8
+        }).collect();
+        let mut new = vec![0xa5; 100];
+        new.extend_from_slice(&base[32 .. 2048]);
+
+        // Moved up by a sector, the base can be copied from.
+        let patch = make_patch(&base, &new, 32, 4096);
+        assert_eq!(&patch[..2], &[LITERAL, 100]);
+        assert!(patch.len() < 120);
+
+        // Without the shift, it is overwritten before it is needed.
+        let patch = make_patch(&base, &new, 32, 0);
+        assert_eq!(patch.len(), 3 + new.len());
+    }
+}
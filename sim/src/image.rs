@@ -19,7 +19,8 @@ use rand::{
     rngs::SmallRng,
 };
 use std::{
-    collections::{BTreeMap, HashSet}, io::{Cursor, Write}, mem, rc::Rc, slice
+    collections::{BTreeMap, HashSet}, io::{Cursor, Write}, mem, ops::Range, rc::Rc, slice,
+    time::Instant,
 };
 use aes::{
     Aes128,
@@ -50,7 +51,9 @@ use crate::depends::{
     PairDep,
     UpgradeInfo,
 };
-use crate::tlv::{ManifestGen, TlvGen, TlvFlags};
+use crate::delta;
+use crate::lzma;
+use crate::tlv::{ManifestGen, TlvGen, TlvFlags, TlvKinds};
 use crate::utils::align_up;
 use typenum::{U32, U16};
 
@@ -90,11 +93,13 @@ struct OneImage {
 
 /// The Rust-side representation of an image.  For unencrypted images, this
 /// is just the unencrypted payload.  For encrypted images, we store both
-/// the encrypted and the plaintext.
+/// the encrypted and the plaintext.  For compressed and delta images, the
+/// plaintext is the image the bootloader decompresses or patches them to.
 struct ImageData {
     size: usize,
     plain: Vec<u8>,
     cipher: Option<Vec<u8>>,
+    compressed: Option<Vec<u8>>,
 }
 
 /// For the RamLoad test cases, we need a contiguous area of RAM to load these images into.  For
@@ -138,7 +143,7 @@ impl ImagesBuilder {
     /// Some(builder) if is possible to test this configuration, or None if
     /// not possible (for example, if there aren't enough image slots).
     pub fn new(device: DeviceName, align: usize, erased_val: u8) -> Result<Self, String> {
-        let (flash, areadesc, unsupported_caps) = Self::make_device(device, align, erased_val);
+        let (mut flash, areadesc, unsupported_caps) = Self::make_device(device, align, erased_val);
 
         for cap in unsupported_caps {
             if cap.present() {
@@ -146,6 +151,14 @@ impl ImagesBuilder {
             }
         }
 
+        // Sectors that read as blank are not erased before being written again, which only
+        // flash that allows writing over the erased value supports.
+        if cfg!(feature = "erase-skip-blank") {
+            for dev in flash.values_mut() {
+                dev.set_rewrite_erased(true);
+            }
+        }
+
         let num_images = Caps::get_num_images();
 
         let mut slots = Vec::with_capacity(num_images);
@@ -913,6 +926,69 @@ impl Images {
         fails > 0
     }
 
+    /// Upgrade to an image that only differs from the one in the primary slot in one sector, and
+    /// check that swap-skip-unchanged saves the erase of every other sector, while still leaving the
+    /// upgrade in the primary slot.
+    pub fn run_swap_skip_unchanged(&self) -> bool {
+        if !cfg!(feature = "swap-skip-unchanged") || self.images.iter().any(|image| {
+            image.upgrades.cipher.is_some() || image.upgrades.compressed.is_some()
+        }) {
+            return false;
+        }
+
+        let mut fails = 0;
+
+        // The images of a plain upgrade differ in every sector.
+        let mut flash = self.flash.clone();
+        let result = c::boot_go(&mut flash, &self.areadesc, None, None, false);
+        if !result.success() || !self.verify_images(&flash, 0, 1) {
+            warn!("Failed the upgrade to a different image");
+            fails += 1;
+        }
+        let full_erases = result.erase_count();
+
+        // Put the upgrade in the primary slot, but for one byte in the middle of the image.
+        let mut flash = self.flash.clone();
+        let mut shared = 0;
+        for image in &self.images {
+            let slot = &image.slots[0];
+            let dev = flash.get_mut(&slot.dev_id).unwrap();
+            let mut buf = image.upgrades.plain.clone();
+            let image_end = slot.base_off + buf.len();
+            let sectors: Vec<_> = dev.sector_iter()
+                .filter(|s| s.base >= slot.base_off && s.base < image_end)
+                .collect();
+            let erase_len = sectors.iter().map(|s| s.size).sum();
+
+            let mid = buf.len() / 2;
+            buf[mid] = !buf[mid];
+            dev.erase(slot.base_off, erase_len).unwrap();
+            dev.write(slot.base_off, &buf).unwrap();
+            shared += sectors.len() - 1;
+        }
+
+        let result = c::boot_go(&mut flash, &self.areadesc, None, None, false);
+        if !result.success() {
+            warn!("Failed the upgrade to an image sharing {} sectors", shared);
+            fails += 1;
+        }
+        if !self.verify_images(&flash, 0, 1) {
+            warn!("Primary slot image verification FAIL");
+            fails += 1;
+        }
+
+        let erases = result.erase_count();
+        info!("Upgrade erases: {} for a different image, {} for one sharing {} sectors",
+              full_erases, erases, shared);
+        if erases + shared as u32 > full_erases {
+            warn!("Shared sectors were erased: {} erases instead of at most {}",
+                  erases, full_erases.saturating_sub(shared as u32));
+            fails += 1;
+        }
+
+        fails > 0
+    }
+
     // Test expecting failed upgrade and primary slot left untouched
     pub fn run_fail_upgrade_primary_intact(&self) -> bool {
         let mut flash = self.flash.clone();
@@ -960,6 +1036,67 @@ impl Images {
         fails > 0
     }
 
+    /// Test that a delta image is refused, and the primary slot left alone, when the primary slot
+    /// no longer holds the image the delta image was made against.
+    pub fn run_delta_wrong_base(&self) -> bool {
+        if !Caps::DeltaImages.present() {
+            return false;
+        }
+
+        let mut flash = self.flash.clone();
+        let mut fails = 0;
+        let mut deltas = 0;
+
+        // Damage the payload of each base image.
+        for image in &self.images {
+            let dev = flash.get_mut(&image.slots[1].dev_id).unwrap();
+            let mut flags = [0u8; 4];
+            dev.read(image.slots[1].base_off + 16, &mut flags).unwrap();
+            if u32::from_le_bytes(flags) & TlvFlags::DELTA as u32 != 0 {
+                deltas += 1;
+            }
+
+            let slot = &image.slots[0];
+            let dev = flash.get_mut(&slot.dev_id).unwrap();
+            let mut buf = vec![0u8; dev.align()];
+            let off = slot.base_off + 1024;
+            dev.read(off, &mut buf).unwrap();
+            buf[0] ^= 0xff;
+            dev.set_verify_writes(false);
+            dev.write(off, &buf).unwrap();
+            dev.set_verify_writes(true);
+        }
+
+        if deltas == 0 {
+            info!("Skipping delta base test, the upgrades are not delta images");
+            return false;
+        }
+
+        let primaries: Vec<Vec<u8>> = self.images.iter().map(|image| {
+            let slot = &image.slots[0];
+            let mut buf = vec![0u8; image.primaries.plain.len()];
+            flash.get(&slot.dev_id).unwrap().read(slot.base_off, &mut buf).unwrap();
+            buf
+        }).collect();
+
+        self.mark_upgrades(&mut flash, 1);
+
+        // The primary slot image fails its own validation when that is enabled.
+        c::boot_go(&mut flash, &self.areadesc, None, None, false);
+
+        for (image, expected) in self.images.iter().zip(&primaries) {
+            let slot = &image.slots[0];
+            let mut buf = vec![0u8; expected.len()];
+            flash.get(&slot.dev_id).unwrap().read(slot.base_off, &mut buf).unwrap();
+            if buf != *expected {
+                warn!("Primary slot written although it does not hold the delta base image");
+                fails += 1;
+            }
+        }
+
+        fails > 0
+    }
+
     // Test that an upgrade is rejected.  Assumes that the image was build
     // such that the upgrade is instead a downgrade.
     pub fn run_nodowngrade(&self) -> bool {
@@ -1461,6 +1598,236 @@ impl Images {
         false
     }
 
+    /// Measure how fast the image in the primary slot is hashed, as it is during validation, and
+    /// report the effective throughput.
+    pub fn run_hash_bench(&self) -> bool {
+        if Caps::RamLoad.present() {
+            return false;
+        }
+
+        const ITERATIONS: u32 = 32;
+
+        let mut flash = self.flash.clone();
+
+        let start = Instant::now();
+        let hashed = c::img_hash(&mut flash, &self.areadesc, ITERATIONS);
+        let elapsed = start.elapsed();
+
+        let hashed = if let Some(hashed) = hashed {
+            hashed
+        } else {
+            error!("Hashing the primary image failed");
+            return true;
+        };
+
+        let total = hashed as f64 * ITERATIONS as f64;
+        info!("Hashed {} bytes {} times in {:?}: {:.2} MB/s",
+              hashed, ITERATIONS, elapsed,
+              total / elapsed.as_secs_f64() / (1024.0 * 1024.0));
+
+        false
+    }
+
+    /// Verify the RSA signature of the primary slot image with the built in key and report how
+    /// long a verification takes. A modified hash or signature must be rejected.
+    pub fn run_rsa_verify_bench(&self) -> bool {
+        if !(Caps::RSA2048.present() || Caps::RSA3072.present()) || Caps::RamLoad.present() {
+            return false;
+        }
+
+        const ITERATIONS: u32 = 16;
+
+        let mut flash = self.flash.clone();
+
+        let start = Instant::now();
+        let ok = c::rsa_verify(&mut flash, &self.areadesc, ITERATIONS);
+        let elapsed = start.elapsed();
+
+        if !ok {
+            error!("RSA signature verification checks failed");
+            return true;
+        }
+
+        info!("Verified the RSA signature {} times in {:?}: {:.0} us each",
+              ITERATIONS, elapsed,
+              elapsed.as_secs_f64() * 1e6 / ITERATIONS as f64);
+
+        false
+    }
+
+    /// Erase the primary slot and report how many erase commands it took and how long they would
+    /// take on a typical serial NOR flash. Check that the slot is blank afterwards, that the
+    /// erases were coalesced where the flash allows it, and that blank regions are not erased
+    /// again with erase-skip-blank.
+    pub fn run_erase_bench(&self) -> bool {
+        let mut flash = self.flash.clone();
+
+        let (count, time_us) = if let Some(result) = c::erase_region(&mut flash, &self.areadesc) {
+            result
+        } else {
+            error!("Erasing the primary slot failed");
+            return true;
+        };
+
+        info!("Erased the primary slot with {} erase commands, modeled time {:.1} ms",
+              count, time_us as f64 / 1000.0);
+
+        let mut fails = 0;
+        let slot = &self.images[0].slots[0];
+        let dev = flash.get(&slot.dev_id).unwrap();
+        let sectors = self.areadesc.get_area_sectors(FlashId::Image0).unwrap();
+
+        // The simulated flash also erases 64 and 32 KiB blocks aligned on their size: an erase
+        // starting on such a boundary takes in the following sectors that fit in the block.
+        let mut expected = 0;
+        let mut i = 0;
+        while i < sectors.len() {
+            let block = if cfg!(feature = "flash-multi-sector-erase") {
+                [0x10000, 0x8000].iter().copied().find(|b| sectors[i].off % b == 0).unwrap_or(0)
+            } else {
+                0
+            };
+            let mut size = sectors[i].size;
+            i += 1;
+            while i < sectors.len() && size + sectors[i].size <= block {
+                size += sectors[i].size;
+                i += 1;
+            }
+            expected += 1;
+        }
+        if count != expected {
+            warn!("Expected {} erase commands for {} sectors, got {}",
+                  expected, sectors.len(), count);
+            fails += 1;
+        }
+
+        let mut buf = vec![0u8; slot.len];
+        dev.read(slot.base_off, &mut buf).unwrap();
+        if let Some(pos) = buf.iter().position(|&b| b != dev.erased_val()) {
+            warn!("Primary slot not blank after the erase at offset {:#x}", pos);
+            fails += 1;
+        }
+
+        if cfg!(feature = "erase-skip-blank") {
+            // Nothing is left to erase in the blank slot.
+            match c::erase_region(&mut flash, &self.areadesc) {
+                Some((0, _)) => (),
+                Some((count, _)) => {
+                    warn!("Erasing the blank slot took {} erase commands", count);
+                    fails += 1;
+                }
+                None => {
+                    warn!("Erasing the blank slot failed");
+                    fails += 1;
+                }
+            }
+
+            // A single word written in the middle of the slot is found and erased alone.
+            let dev = flash.get_mut(&slot.dev_id).unwrap();
+            let off = slot.base_off + slot.len / 2 + dev.align();
+            let word = vec![!dev.erased_val(); dev.align()];
+            dev.write(off, &word).unwrap();
+            match c::erase_region(&mut flash, &self.areadesc) {
+                Some((1, _)) => (),
+                Some((count, _)) => {
+                    warn!("Erasing one written word took {} erase commands", count);
+                    fails += 1;
+                }
+                None => {
+                    warn!("Erasing one written word failed");
+                    fails += 1;
+                }
+            }
+
+            let dev = flash.get(&slot.dev_id).unwrap();
+            dev.read(slot.base_off, &mut buf).unwrap();
+            if buf.iter().any(|&b| b != dev.erased_val()) {
+                warn!("Primary slot not blank after erasing one written word");
+                fails += 1;
+            }
+        }
+
+        fails > 0
+    }
+
+    /// Boot with a validation record of the primary slot, and check that the record stands in for
+    /// hashing the image only while neither the trailer nor the image have been written since.
+    pub fn run_validation_cache(&self) -> bool {
+        if !Caps::ValidationCache.present() {
+            return false;
+        }
+
+        let mut flash = self.flash.clone();
+        let mut fails = 0;
+
+        // The first boot validates the image in full and records it.
+        if !c::boot_go(&mut flash, &self.areadesc, None, None, false).success() {
+            warn!("Failed first boot");
+            fails += 1;
+        }
+
+        // Damage the image payload behind MCUboot's back, leaving its header, its TLVs and the
+        // trailer alone. Only a boot that went by the record accepts the image now.
+        for image in &self.images {
+            let slot = &image.slots[0];
+            let dev = flash.get_mut(&slot.dev_id).unwrap();
+            let mut buf = vec![0u8; dev.align()];
+            let off = slot.base_off + 1024;
+            dev.read(off, &mut buf).unwrap();
+            buf[0] ^= 0xff;
+            dev.set_verify_writes(false);
+            dev.write(off, &buf).unwrap();
+            dev.set_verify_writes(true);
+        }
+
+        if !c::boot_go(&mut flash, &self.areadesc, None, None, false).success() {
+            warn!("The validation record was not used");
+            fails += 1;
+        }
+
+        // Writing the trailer starts a new write generation.
+        let mut confirmed = flash.clone();
+        for image in &self.images {
+            let slot = &image.slots[0];
+            let dev = confirmed.get_mut(&slot.dev_id).unwrap();
+            let mut ok = vec![0u8; dev.align()];
+            let off = slot.trailer_off + c::boot_max_align() * 3;
+            dev.read(off, &mut ok).unwrap();
+            if ok[0] != dev.erased_val() {
+                warn!("image_ok already written");
+                fails += 1;
+                continue;
+            }
+            ok[0] = 1u8;
+            dev.write(off, &ok).unwrap();
+        }
+
+        if c::boot_go(&mut confirmed, &self.areadesc, None, None, false).success() {
+            warn!("Damaged image accepted after the trailer was written");
+            fails += 1;
+        }
+
+        // Erasing and writing the slot again takes the record away.
+        let mut rewritten = flash.clone();
+        for image in &self.images {
+            let slot = &image.slots[0];
+            let dev = rewritten.get_mut(&slot.dev_id).unwrap();
+            let len = align_up(image.primaries.find(slot.index).len() as u32,
+                               dev.align() as u32) as usize;
+            let mut buf = vec![0u8; len];
+            dev.read(slot.base_off, &mut buf).unwrap();
+            dev.erase(slot.base_off, slot.len).unwrap();
+            dev.write(slot.base_off, &buf).unwrap();
+        }
+
+        if c::boot_go(&mut rewritten, &self.areadesc, None, None, false).success() {
+            warn!("Damaged image accepted after the slot was written again");
+            fails += 1;
+        }
+
+        fails > 0
+    }
+
     /// Adds a new flash area that fails statistically
     fn mark_bad_status_with_rate(&self, flash: &mut SimMultiFlash, slot: usize,
                                  rate: f32) {
@@ -1857,7 +2224,16 @@ fn estimate_swap_scratch_trailer_size(dev: &dyn Flash, areadesc: &AreaDesc, slot
 fn image_largest_trailer(dev: &dyn Flash, areadesc: &AreaDesc, slot: &SlotInfo) -> usize {
             // Using the header size we know, the trailer size, and the slot size, we can compute
             // the largest image possible.
-            let trailer = if Caps::OverwriteUpgrade.present() {
+            let trailer = if Caps::DeltaImages.present() {
+                // A sector is left below the trailer sectors for the base image of a delta image
+                // to be moved up into before it is patched.
+                let sector_size = dev.sector_iter().next().unwrap().size as u32;
+                (align_up(c::boot_trailer_sz(dev.align() as u32), sector_size) + sector_size) as usize
+            } else if Caps::OverwriteUpgrade.present() && Caps::ValidationCache.present() {
+                // The validation records sit below the swap state fields.
+                let align = dev.align() as u32;
+                (c::boot_trailer_sz(align) - c::boot_status_sz(align)) as usize
+            } else if Caps::OverwriteUpgrade.present() {
                 // magic + image-ok + copy-done + swap-info
                 c::boot_magic_sz() + 3 * c::boot_max_align()
             } else if Caps::SwapUsingOffset.present() || Caps::SwapUsingMove.present() {
@@ -1913,6 +2289,16 @@ fn install_image(flash: &mut SimMultiFlash, areadesc: &AreaDesc, slots: &[SlotIn
     let slot = &slots[slot_ind];
     let mut offset = slot.base_off;
     let dev_id = slot.dev_id;
+
+    // Upgrades are given compressed when the bootloader can decompress them, as a patch against
+    // the image in the primary slot when it can apply one to it.
+    let compress = slot.index == 1 && Caps::DecompressImages.present();
+    let delta_base = if compress && Caps::DeltaImages.present() {
+        read_delta_base(flash, areadesc, slots)
+    } else {
+        None
+    };
+
     let dev = flash.get_mut(&dev_id).unwrap();
 
     let mut tlv: Box<dyn ManifestGen> = Box::new(make_tlv());
@@ -1992,7 +2378,13 @@ fn install_image(flash: &mut SimMultiFlash, areadesc: &AreaDesc, slots: &[SlotIn
 
     // The core of the image itself is just pseudorandom data.
     let mut b_img = vec![0; len];
-    splat(&mut b_img, offset);
+    if let Some(base) = &delta_base {
+        splat_delta(&mut b_img, base, offset);
+    } else if compress {
+        splat_compressible(&mut b_img, offset);
+    } else {
+        splat(&mut b_img, offset);
+    }
 
     // Add some information at the start of the payload to make it easier
     // to see what it is.  This will fail if the image itself is too small.
@@ -2030,19 +2422,42 @@ fn install_image(flash: &mut SimMultiFlash, areadesc: &AreaDesc, slots: &[SlotIn
         }
     }
 
-    // Build the TLV itself.
-    if img_manipulation == ImageManipulation::BadSignature  {
+    // Build the TLV itself.  The signature of a compressed image is that of
+    // the outer manifest.
+    if img_manipulation == ImageManipulation::BadSignature && !compress {
         tlv.corrupt_sig();
     }
     let mut b_tlv = tlv.make_tlv();
 
+    let align = dev.align();
+
+    let compressed = if compress {
+        let mut ctlv: Box<dyn ManifestGen> = Box::new(make_tlv());
+        ctlv.set_security_counter(security_counter);
+        for dep in deps.my_deps(offset, slot.index) {
+            ctlv.add_dependency(deps.other_id(), &dep);
+        }
+        if img_manipulation == ImageManipulation::BadSignature {
+            ctlv.corrupt_sig();
+        }
+        let mut cbuf = match &delta_base {
+            Some(base) => make_delta_image(ctlv, &header, &b_img, &b_tlv, base),
+            None => make_compressed_image(ctlv, &header, &b_img, &b_tlv),
+        };
+        while cbuf.len() % align != 0 {
+            cbuf.push(dev.erased_val());
+        }
+        Some(cbuf)
+    } else {
+        None
+    };
+
     let mut buf = vec![];
     buf.append(&mut b_header.to_vec());
     buf.append(&mut b_img);
     buf.append(&mut b_tlv.clone());
 
     // Pad the buffer to a multiple of the flash alignment.
-    let align = dev.align();
     let image_sz = buf.len();
     while buf.len() % align != 0 {
         buf.push(dev.erased_val());
@@ -2092,13 +2507,30 @@ fn install_image(flash: &mut SimMultiFlash, areadesc: &AreaDesc, slots: &[SlotIn
             size: image_sz,
             plain: copy,
             cipher: enc_copy,
+            compressed: None,
         }
     } else {
 
-        dev.write(offset, &buf).unwrap();
+        // The plain image of a compressed one is only ever written by the
+        // bootloader.
+        let (copy, compressed) = match compressed {
+            Some(cbuf) => {
+                dev.write(offset, &cbuf).unwrap();
 
-        let mut copy = vec![0u8; buf.len()];
-        dev.read(offset, &mut copy).unwrap();
+                let mut ccopy = vec![0u8; cbuf.len()];
+                dev.read(offset, &mut ccopy).unwrap();
+
+                (buf, Some(ccopy))
+            }
+            None => {
+                dev.write(offset, &buf).unwrap();
+
+                let mut copy = vec![0u8; buf.len()];
+                dev.read(offset, &mut copy).unwrap();
+
+                (copy, None)
+            }
+        };
 
         let enc_copy: Option<Vec<u8>>;
 
@@ -2119,16 +2551,185 @@ fn install_image(flash: &mut SimMultiFlash, areadesc: &AreaDesc, slots: &[SlotIn
             size: image_sz,
             plain: copy,
             cipher: enc_copy,
+            compressed,
         }
     }
 }
 
+/// Build the compressed image of an image, as imgtool does: the payload is
+/// LZMA2 compressed, and the size, hash and signature of the image are added
+/// to the protected TLVs of the new manifest `tlv`.  Half of the images,
+/// picked by their contents, also go through the ARM-Thumb filter.
+fn make_compressed_image(mut tlv: Box<dyn ManifestGen>, header: &ImageHeader, payload: &[u8],
+                         plain_tlv: &[u8]) -> Vec<u8> {
+    let arm_thumb = payload[payload.len() / 2] & 1 != 0;
+    let mut filtered = payload.to_vec();
+    let mut flags = TlvFlags::COMPRESSED_LZMA2 as u32;
+    if arm_thumb {
+        lzma::arm_thumb_filter(&mut filtered);
+        flags |= TlvFlags::COMPRESSED_ARM_THUMB as u32;
+    }
+    let body = lzma::compress(&filtered);
+    info!("Compressed image: {:#x} -> {:#x} bytes{}", payload.len(), body.len(),
+          if arm_thumb { ", ARM-Thumb filtered" } else { "" });
+
+    tlv.add_flags(flags);
+    add_decoded_tlvs(tlv.as_mut(), header, plain_tlv);
+    make_encoded_image(tlv, header, body)
+}
+
+/// Build the delta image of an image, as imgtool does: the payload is a patch
+/// against the base image, and the delta base TLV follows the size, hash and
+/// signature of the image in the protected TLVs of the new manifest `tlv`.
+fn make_delta_image(mut tlv: Box<dyn ManifestGen>, header: &ImageHeader, payload: &[u8],
+                    plain_tlv: &[u8], base: &DeltaBase) -> Vec<u8> {
+    let body = delta::make_patch(&base.data, payload, header.hdr_size as usize, base.shift);
+    info!("Delta image: {:#x} -> {:#x} bytes, base moved up by {:#x}", payload.len(), body.len(),
+          base.shift);
+
+    let mut base_tlv = vec![];
+    base_tlv.extend_from_slice(&(base.data.len() as u32).to_le_bytes());
+    base_tlv.extend_from_slice(&(base.shift as u32).to_le_bytes());
+    base_tlv.extend_from_slice(&base.hash);
+
+    tlv.add_flags(TlvFlags::DELTA as u32);
+    add_decoded_tlvs(tlv.as_mut(), header, plain_tlv);
+    tlv.add_protected_tlv(TlvKinds::DELTABASE, &base_tlv);
+    make_encoded_image(tlv, header, body)
+}
+
+/// Add the size, hash and signature of the image the bootloader decodes a
+/// compressed or delta image to to the protected TLVs of its manifest.
+fn add_decoded_tlvs(tlv: &mut dyn ManifestGen, header: &ImageHeader, plain_tlv: &[u8]) {
+    tlv.add_protected_tlv(TlvKinds::DECOMPSIZE, &header.img_size.to_le_bytes());
+    for (kind, data) in tlv_entries(plain_tlv) {
+        if kind == TlvKinds::SHA256 as u16 || kind == TlvKinds::SHA384 as u16 {
+            tlv.add_protected_tlv(TlvKinds::DECOMPSHA, &data);
+        } else if kind == TlvKinds::RSA2048 as u16 || kind == TlvKinds::ECDSASIG as u16 ||
+            kind == TlvKinds::RSA3072 as u16 || kind == TlvKinds::ED25519 as u16 {
+            tlv.add_protected_tlv(TlvKinds::DECOMPSIGNATURE, &data);
+        }
+    }
+}
+
+/// Build the compressed or delta image with the payload `body` and the
+/// manifest `tlv`.
+fn make_encoded_image(mut tlv: Box<dyn ManifestGen>, header: &ImageHeader,
+                      mut body: Vec<u8>) -> Vec<u8> {
+    let cheader = ImageHeader {
+        magic: header.magic,
+        load_addr: header.load_addr,
+        hdr_size: header.hdr_size,
+        protect_tlv_size: tlv.protect_size(),
+        img_size: body.len() as u32,
+        flags: tlv.get_flags(),
+        ver: header.ver.clone(),
+        _pad2: 0,
+    };
+
+    let mut buf = cheader.as_raw().to_vec();
+    buf.resize(header.hdr_size as usize, 0);
+    tlv.add_bytes(&buf);
+    tlv.add_bytes(&body);
+
+    buf.append(&mut body);
+    buf.append(&mut tlv.make_tlv());
+    buf
+}
+
+/// Default MCUBOOT_DECOMPRESS_BUFFER_SIZE, by which the bootloader patches.
+const DECOMPRESS_BUFFER_SIZE: usize = 4096;
+
+/// The image in the primary slot, which delta images are made against.
+struct DeltaBase {
+    /// The image, up to the end of its TLVs.
+    data: Vec<u8>,
+    /// Where its payload is in `data`.
+    payload: Range<usize>,
+    hash: Vec<u8>,
+    /// How far the bootloader moves the image up before patching it.
+    shift: usize,
+}
+
+/// Read the image in the primary slot to make a delta image against, if the
+/// bootloader can apply one: it patches the primary slot a sector at a time,
+/// staging each in a sector of the secondary slot, so the sectors of both
+/// slots must all be the same size.  The base image is moved up by a sector
+/// when there is room for it below the trailer.
+fn read_delta_base(flash: &SimMultiFlash, areadesc: &AreaDesc,
+                   slots: &[SlotInfo]) -> Option<DeltaBase> {
+    let sectors = |slot: &SlotInfo| {
+        let area = areadesc.iter_areas()
+            .find(|a| a.device_id == slot.dev_id && a.off as usize == slot.base_off)
+            .unwrap();
+        areadesc.get_area_sectors(area.flash_id).unwrap().iter()
+            .map(|s| s.size as usize)
+            .collect::<Vec<_>>()
+    };
+    let primary = sectors(&slots[0]);
+    let sector_size = primary[0];
+    if sector_size % DECOMPRESS_BUFFER_SIZE != 0 ||
+        primary.iter().chain(sectors(&slots[1]).iter()).any(|&size| size != sector_size) {
+        return None;
+    }
+
+    let dev = flash.get(&slots[0].dev_id).unwrap();
+    let mut header = [0u8; 16];
+    dev.read(slots[0].base_off, &mut header).unwrap();
+    let word = |pos: usize| u16::from_le_bytes([header[pos], header[pos + 1]]) as usize;
+    if u32::from_le_bytes(header[0..4].try_into().unwrap()) != 0x96f3b83d {
+        return None;
+    }
+    let payload = word(8) .. word(8) + u32::from_le_bytes(header[12..16].try_into().unwrap()) as usize;
+
+    let mut info = [0u8; 4];
+    dev.read(slots[0].base_off + payload.end + word(10), &mut info).unwrap();
+    let size = payload.end + word(10) + u16::from_le_bytes([info[2], info[3]]) as usize;
+    let mut data = vec![0u8; size];
+    dev.read(slots[0].base_off, &mut data).unwrap();
+
+    let hash = tlv_entries(&data[payload.end..]).into_iter()
+        .find(|(kind, _)| *kind == TlvKinds::SHA256 as u16 || *kind == TlvKinds::SHA384 as u16)?
+        .1;
+
+    let trailer = align_up(c::boot_trailer_sz(dev.align() as u32), sector_size as u32) as usize;
+    let limit = slots[0].len - trailer;
+    if size > limit {
+        return None;
+    }
+    let shift = if size + sector_size <= limit { sector_size } else { 0 };
+
+    Some(DeltaBase { data, payload, hash, shift })
+}
+
+/// Return the kind and the contents of the unprotected TLVs of an image.
+fn tlv_entries(tlv: &[u8]) -> Vec<(u16, Vec<u8>)> {
+    let word = |pos: usize| u16::from_le_bytes([tlv[pos], tlv[pos + 1]]) as usize;
+    let mut entries = vec![];
+    let mut pos = 0;
+
+    // Skip the protected area.
+    if word(0) == 0x6908 {
+        pos = word(2);
+    }
+    assert_eq!(word(pos), 0x6907);
+    let end = pos + word(pos + 2);
+    pos += 4;
+    while pos < end {
+        let len = word(pos + 2);
+        entries.push((word(pos) as u16, tlv[pos + 4 .. pos + 4 + len].to_vec()));
+        pos += 4 + len;
+    }
+    entries
+}
+
 /// Install no image.  This is used when no upgrade happens.
 fn install_no_image() -> ImageData {
     ImageData {
         size: 0,
         plain: vec![],
         cipher: None,
+        compressed: None,
     }
 }
 
@@ -2185,6 +2786,9 @@ impl ImageData {
     /// Find the image contents for the given slot.  This assumes that slot 0
     /// is unencrypted, and slot 1 is encrypted.
     fn find(&self, slot: usize) -> &Vec<u8> {
+        if let (1, Some(compressed)) = (slot, &self.compressed) {
+            return compressed;
+        }
         let encrypted = Caps::EncRsa.present() || Caps::EncKw.present() ||
             Caps::EncEc256.present() || Caps::EncX25519.present();
         match (encrypted, slot) {
@@ -2473,6 +3077,59 @@ fn splat(data: &mut [u8], seed: usize) {
     rng.fill_bytes(data);
 }
 
+/// Fill the buffer with the payload of a new build of a base image: most of
+/// the base payload, moved up a little, with some blocks of pseudorandom data
+/// in between.
+fn splat_delta(data: &mut [u8], base: &DeltaBase, seed: usize) {
+    const BLOCK: usize = 1024;
+    const MOVED: usize = 512;
+
+    splat(data, seed);
+
+    let payload = &base.data[base.payload.clone()];
+    for (n, block) in data.chunks_mut(BLOCK).enumerate() {
+        if n == 0 || n % 4 == 3 || n * BLOCK - MOVED >= payload.len() {
+            continue;
+        }
+        let src = &payload[n * BLOCK - MOVED ..];
+        let len = block.len().min(src.len());
+        block[..len].copy_from_slice(&src[..len]);
+    }
+}
+
+/// Fill the buffer with pseudorandom data that compresses: runs of random
+/// bytes alternate with runs of a single byte and with copies of earlier
+/// data, so that the matches found by an LZ encoder vary in length and
+/// distance.
+fn splat_compressible(data: &mut [u8], seed: usize) {
+    splat(data, seed);
+
+    let mut seed_block = [0u8; 32];
+    let mut buf = Cursor::new(&mut seed_block[..]);
+    buf.write_u32::<LittleEndian>(0x7a1f3c05).unwrap();
+    buf.write_u32::<LittleEndian>(seed as u32).unwrap();
+    let mut rng: SmallRng = SeedableRng::from_seed(seed_block);
+
+    let mut pos = 1;
+    while pos < data.len() {
+        let len = rng.gen_range(1..300usize).min(data.len() - pos);
+        match rng.gen_range(0..4u32) {
+            0 => (),
+            1 => {
+                let byte = data[pos - 1];
+                data[pos..pos + len].fill(byte);
+            }
+            _ => {
+                let dist = rng.gen_range(1..=pos.min(0x8000));
+                for i in pos..pos + len {
+                    data[i] = data[i - dist];
+                }
+            }
+        }
+        pos += len;
+    }
+}
+
 /// Return a read-only view into the raw bytes of this object
 trait AsRaw : Sized {
     fn as_raw(&self) -> &[u8] {
@@ -13,8 +13,10 @@ use std::{
 use serde_derive::Deserialize;
 
 mod caps;
+mod delta;
 mod depends;
 mod image;
+mod lzma;
 mod tlv;
 mod utils;
 pub mod testlog;
@@ -0,0 +1,587 @@
+// SPDX-License-Identifier: Apache-2.0
+
+//! A small LZMA2 encoder.
+//!
+//! This produces the raw LZMA2 streams, preceded by the two byte header
+//! (dictionary size code, then LZMA properties), that imgtool stores as the
+//! payload of a compressed image.  It only needs to be correct, not good: a
+//! greedy hash chain match finder feeds a plain LZMA coder that uses all
+//! the kinds of packets (literals, matches, repeated matches and short
+//! repeats) so that the decoder in the bootloader gets exercised.
+
+/// lc = 3, lp = 0, pb = 2, as xz uses by default.
+const LC: u32 = 3;
+const LP: u32 = 0;
+const PB: u32 = 2;
+
+/// Dictionary size code of a 64 KiB dictionary.
+pub const DICT_CODE: u8 = 8;
+pub const DICT_SIZE: usize = 64 * 1024;
+
+const PROB_BITS: u32 = 11;
+const PROB_INIT: u16 = 1 << (PROB_BITS - 1);
+const MOVE_BITS: u32 = 5;
+const TOP_VALUE: u32 = 1 << 24;
+
+const STATES: usize = 12;
+const LIT_STATES: usize = 7;
+const POS_STATES_MAX: usize = 1 << 4;
+const LEN_LOW_SYMBOLS: usize = 8;
+const LEN_MID_SYMBOLS: usize = 8;
+const MATCH_LEN_MIN: usize = 2;
+const MATCH_LEN_MAX: usize = MATCH_LEN_MIN + LEN_LOW_SYMBOLS + LEN_MID_SYMBOLS + 256 - 1;
+const DIST_STATES: usize = 4;
+const DIST_MODEL_START: u32 = 4;
+const DIST_MODEL_END: u32 = 14;
+const FULL_DISTANCES: usize = 1 << (DIST_MODEL_END >> 1);
+const ALIGN_BITS: u32 = 4;
+const LITERAL_CODER_SIZE: usize = 0x300;
+
+/// Largest amount of data put in a single chunk.  Random data can grow a
+/// little when compressed, this keeps the packed size well within the 64 KiB
+/// limit of LZMA2 chunks.
+const CHUNK_SIZE: usize = 32 * 1024;
+
+/// How many earlier positions with the same hash are tried for a match.
+const CHAIN_DEPTH: usize = 32;
+const HASH_BITS: u32 = 16;
+
+/// LZMA2 control bytes.
+const CTRL_END: u8 = 0x00;
+const CTRL_COPY: u8 = 0x02;
+const CTRL_COPY_RESET_DICT: u8 = 0x01;
+const CTRL_LZMA: u8 = 0x80;
+const CTRL_RESET_STATE: u8 = 0xA0;
+const CTRL_NEW_PROPS: u8 = 0xC0;
+const CTRL_RESET_DICT: u8 = 0xE0;
+
+#[derive(Clone)]
+struct LenCoder {
+    choice: u16,
+    choice2: u16,
+    low: [[u16; LEN_LOW_SYMBOLS]; POS_STATES_MAX],
+    mid: [[u16; LEN_MID_SYMBOLS]; POS_STATES_MAX],
+    high: [u16; 256],
+}
+
+impl LenCoder {
+    fn new() -> LenCoder {
+        LenCoder {
+            choice: PROB_INIT,
+            choice2: PROB_INIT,
+            low: [[PROB_INIT; LEN_LOW_SYMBOLS]; POS_STATES_MAX],
+            mid: [[PROB_INIT; LEN_MID_SYMBOLS]; POS_STATES_MAX],
+            high: [PROB_INIT; 256],
+        }
+    }
+
+    fn encode(&mut self, rc: &mut RangeEncoder, len: usize, pos_state: usize) {
+        let len = len - MATCH_LEN_MIN;
+        if len < LEN_LOW_SYMBOLS {
+            rc.bit(&mut self.choice, 0);
+            rc.bittree(&mut self.low[pos_state], 3, len as u32);
+        } else if len < LEN_LOW_SYMBOLS + LEN_MID_SYMBOLS {
+            rc.bit(&mut self.choice, 1);
+            rc.bit(&mut self.choice2, 0);
+            rc.bittree(&mut self.mid[pos_state], 3, (len - LEN_LOW_SYMBOLS) as u32);
+        } else {
+            rc.bit(&mut self.choice, 1);
+            rc.bit(&mut self.choice2, 1);
+            rc.bittree(&mut self.high, 8, (len - LEN_LOW_SYMBOLS - LEN_MID_SYMBOLS) as u32);
+        }
+    }
+}
+
+/// The probability model, reset at the start of the stream and after
+/// uncompressed chunks.
+#[derive(Clone)]
+struct Model {
+    is_match: [[u16; POS_STATES_MAX]; STATES],
+    is_rep: [u16; STATES],
+    is_rep0: [u16; STATES],
+    is_rep1: [u16; STATES],
+    is_rep2: [u16; STATES],
+    is_rep0_long: [[u16; POS_STATES_MAX]; STATES],
+    dist_slot: [[u16; 64]; DIST_STATES],
+    dist_special: [u16; 1 + FULL_DISTANCES - DIST_MODEL_END as usize],
+    dist_align: [u16; 1 << ALIGN_BITS],
+    match_len: LenCoder,
+    rep_len: LenCoder,
+    literal: Vec<u16>,
+    state: usize,
+    reps: [u32; 4],
+}
+
+impl Model {
+    fn new() -> Model {
+        Model {
+            is_match: [[PROB_INIT; POS_STATES_MAX]; STATES],
+            is_rep: [PROB_INIT; STATES],
+            is_rep0: [PROB_INIT; STATES],
+            is_rep1: [PROB_INIT; STATES],
+            is_rep2: [PROB_INIT; STATES],
+            is_rep0_long: [[PROB_INIT; POS_STATES_MAX]; STATES],
+            dist_slot: [[PROB_INIT; 64]; DIST_STATES],
+            dist_special: [PROB_INIT; 1 + FULL_DISTANCES - DIST_MODEL_END as usize],
+            dist_align: [PROB_INIT; 1 << ALIGN_BITS],
+            match_len: LenCoder::new(),
+            rep_len: LenCoder::new(),
+            literal: vec![PROB_INIT; LITERAL_CODER_SIZE << (LC + LP)],
+            state: 0,
+            reps: [0; 4],
+        }
+    }
+}
+
+struct RangeEncoder {
+    low: u64,
+    range: u32,
+    cache: u8,
+    cache_size: u64,
+    out: Vec<u8>,
+}
+
+impl RangeEncoder {
+    fn new() -> RangeEncoder {
+        RangeEncoder {
+            low: 0,
+            range: u32::MAX,
+            cache: 0,
+            cache_size: 1,
+            out: vec![],
+        }
+    }
+
+    fn shift_low(&mut self) {
+        if (self.low as u32) < 0xFF00_0000 || (self.low >> 32) != 0 {
+            let carry = (self.low >> 32) as u8;
+            let mut temp = self.cache;
+            loop {
+                self.out.push(temp.wrapping_add(carry));
+                temp = 0xFF;
+                self.cache_size -= 1;
+                if self.cache_size == 0 {
+                    break;
+                }
+            }
+            self.cache = (self.low >> 24) as u8;
+        }
+        self.cache_size += 1;
+        self.low = (self.low & 0x00FF_FFFF) << 8;
+    }
+
+    fn normalize(&mut self) {
+        if self.range < TOP_VALUE {
+            self.range <<= 8;
+            self.shift_low();
+        }
+    }
+
+    fn bit(&mut self, prob: &mut u16, bit: u32) {
+        let bound = (self.range >> PROB_BITS) * (*prob as u32);
+        if bit == 0 {
+            self.range = bound;
+            *prob += ((1 << PROB_BITS) - *prob) >> MOVE_BITS;
+        } else {
+            self.low += bound as u64;
+            self.range -= bound;
+            *prob -= *prob >> MOVE_BITS;
+        }
+        self.normalize();
+    }
+
+    fn bittree(&mut self, probs: &mut [u16], bits: u32, value: u32) {
+        let mut m = 1;
+        for i in (0..bits).rev() {
+            let bit = (value >> i) & 1;
+            self.bit(&mut probs[m], bit);
+            m = (m << 1) | bit as usize;
+        }
+    }
+
+    fn bittree_reverse(&mut self, probs: &mut [u16], bits: u32, value: u32) {
+        let mut m = 1;
+        for i in 0..bits {
+            let bit = (value >> i) & 1;
+            self.bit(&mut probs[m], bit);
+            m = (m << 1) | bit as usize;
+        }
+    }
+
+    fn direct(&mut self, bits: u32, value: u32) {
+        for i in (0..bits).rev() {
+            self.range >>= 1;
+            if (value >> i) & 1 != 0 {
+                self.low += self.range as u64;
+            }
+            self.normalize();
+        }
+    }
+
+    fn finish(mut self) -> Vec<u8> {
+        for _ in 0..5 {
+            self.shift_low();
+        }
+        self.out
+    }
+}
+
+/// What to emit at a given position.
+#[derive(Clone, Copy)]
+enum Packet {
+    Literal,
+    Match { dist: u32, len: usize },
+    Rep { index: usize, len: usize },
+    ShortRep,
+}
+
+/// Finds matches in the data, remembering every position it was told about.
+struct MatchFinder {
+    head: Vec<i64>,
+    prev: Vec<i64>,
+}
+
+impl MatchFinder {
+    fn new(len: usize) -> MatchFinder {
+        MatchFinder {
+            head: vec![-1; 1 << HASH_BITS],
+            prev: vec![-1; len],
+        }
+    }
+
+    fn hash(data: &[u8], pos: usize) -> usize {
+        let v = (data[pos] as u32) | (data[pos + 1] as u32) << 8 | (data[pos + 2] as u32) << 16;
+        (v.wrapping_mul(2654435761) >> (32 - HASH_BITS)) as usize
+    }
+
+    fn insert(&mut self, data: &[u8], pos: usize) {
+        if pos + 3 <= data.len() {
+            let h = Self::hash(data, pos);
+            self.prev[pos] = self.head[h];
+            self.head[h] = pos as i64;
+        }
+    }
+
+    /// Longest earlier match at pos within the dictionary, as (distance, length).
+    fn find(&self, data: &[u8], pos: usize) -> (usize, usize) {
+        let mut best = (0, 0);
+        if pos + 3 > data.len() {
+            return best;
+        }
+        let max = (data.len() - pos).min(MATCH_LEN_MAX);
+        let mut cand = self.head[Self::hash(data, pos)];
+        let mut depth = 0;
+        while cand >= 0 && depth < CHAIN_DEPTH {
+            let c = cand as usize;
+            if pos - c > DICT_SIZE {
+                break;
+            }
+            let len = common_len(data, c, pos, max);
+            if len > best.1 {
+                best = (pos - c, len);
+                if len == max {
+                    break;
+                }
+            }
+            cand = self.prev[c];
+            depth += 1;
+        }
+        best
+    }
+}
+
+fn common_len(data: &[u8], a: usize, b: usize, max: usize) -> usize {
+    let mut n = 0;
+    while n < max && data[a + n] == data[b + n] {
+        n += 1;
+    }
+    n
+}
+
+struct Encoder<'a> {
+    data: &'a [u8],
+    model: Model,
+    mf: MatchFinder,
+}
+
+impl<'a> Encoder<'a> {
+    fn pos_state(pos: usize) -> usize {
+        pos & ((1 << PB) - 1)
+    }
+
+    /// Picks the packet to emit at pos, preferring repeated distances
+    /// when they do about as well as a new match.
+    fn choose(&self, pos: usize) -> Packet {
+        let data = self.data;
+        let max = (data.len() - pos).min(MATCH_LEN_MAX);
+
+        let mut rep = (0, 0);
+        for (index, &r) in self.model.reps.iter().enumerate() {
+            let dist = r as usize + 1;
+            if dist > pos || dist > DICT_SIZE {
+                continue;
+            }
+            let len = common_len(data, pos - dist, pos, max);
+            if len > rep.1 {
+                rep = (index, len);
+            }
+        }
+
+        let (dist, len) = self.mf.find(data, pos);
+
+        if rep.1 >= MATCH_LEN_MIN && rep.1 + 1 >= len {
+            return Packet::Rep { index: rep.0, len: rep.1 };
+        }
+        if len >= 3 || (len == MATCH_LEN_MIN && dist < 128) {
+            return Packet::Match { dist: (dist - 1) as u32, len };
+        }
+        let rep0 = self.model.reps[0] as usize + 1;
+        if rep0 <= pos && data[pos - rep0] == data[pos] {
+            return Packet::ShortRep;
+        }
+        Packet::Literal
+    }
+
+    fn encode_literal(&mut self, rc: &mut RangeEncoder, pos: usize) {
+        let data = self.data;
+        let m = &mut self.model;
+        let prev = if pos > 0 { data[pos - 1] as usize } else { 0 };
+        let base = LITERAL_CODER_SIZE *
+            (((pos & ((1 << LP) - 1)) << LC) + (prev >> (8 - LC)));
+        let probs = &mut m.literal[base..base + LITERAL_CODER_SIZE];
+        let byte = data[pos] as u32;
+        let mut sym = 1usize;
+        let mut i = 8;
+
+        if m.state >= LIT_STATES {
+            let mut matched = data[pos - m.reps[0] as usize - 1] as u32;
+            while i > 0 {
+                i -= 1;
+                let match_bit = (matched >> 7) & 1;
+                matched <<= 1;
+                let bit = (byte >> i) & 1;
+                rc.bit(&mut probs[((1 + match_bit as usize) << 8) + sym], bit);
+                sym = (sym << 1) | bit as usize;
+                if match_bit != bit {
+                    break;
+                }
+            }
+        }
+        while i > 0 {
+            i -= 1;
+            let bit = (byte >> i) & 1;
+            rc.bit(&mut probs[sym], bit);
+            sym = (sym << 1) | bit as usize;
+        }
+
+        m.state = if m.state < 4 { 0 } else if m.state < 10 { m.state - 3 } else { m.state - 6 };
+    }
+
+    fn encode_dist(&mut self, rc: &mut RangeEncoder, dist: u32, len: usize) {
+        let m = &mut self.model;
+        let len_state = (len - MATCH_LEN_MIN).min(DIST_STATES - 1);
+        let slot = if dist < DIST_MODEL_START {
+            dist
+        } else {
+            let top = 31 - dist.leading_zeros();
+            (top << 1) | ((dist >> (top - 1)) & 1)
+        };
+        rc.bittree(&mut m.dist_slot[len_state], 6, slot);
+        if slot < DIST_MODEL_START {
+            return;
+        }
+
+        let bits = (slot >> 1) - 1;
+        let base = (2 | (slot & 1)) << bits;
+        let reduced = dist - base;
+        if slot < DIST_MODEL_END {
+            let off = (base - slot) as usize;
+            rc.bittree_reverse(&mut m.dist_special[off..], bits, reduced);
+        } else {
+            rc.direct(bits - ALIGN_BITS, reduced >> ALIGN_BITS);
+            rc.bittree_reverse(&mut m.dist_align, ALIGN_BITS, reduced & ((1 << ALIGN_BITS) - 1));
+        }
+    }
+
+    /// Encodes a packet and returns the number of bytes it covers.
+    fn encode(&mut self, rc: &mut RangeEncoder, pos: usize, packet: Packet) -> usize {
+        let pos_state = Self::pos_state(pos);
+        let state = self.model.state;
+
+        match packet {
+            Packet::Literal => {
+                rc.bit(&mut self.model.is_match[state][pos_state], 0);
+                self.encode_literal(rc, pos);
+                1
+            }
+            Packet::Match { dist, len } => {
+                let m = &mut self.model;
+                rc.bit(&mut m.is_match[state][pos_state], 1);
+                rc.bit(&mut m.is_rep[state], 0);
+                m.match_len.encode(rc, len, pos_state);
+                m.state = if state < LIT_STATES { 7 } else { 10 };
+                self.encode_dist(rc, dist, len);
+                let m = &mut self.model;
+                m.reps = [dist, m.reps[0], m.reps[1], m.reps[2]];
+                len
+            }
+            Packet::ShortRep => {
+                let m = &mut self.model;
+                rc.bit(&mut m.is_match[state][pos_state], 1);
+                rc.bit(&mut m.is_rep[state], 1);
+                rc.bit(&mut m.is_rep0[state], 0);
+                rc.bit(&mut m.is_rep0_long[state][pos_state], 0);
+                m.state = if state < LIT_STATES { 9 } else { 11 };
+                1
+            }
+            Packet::Rep { index, len } => {
+                let m = &mut self.model;
+                rc.bit(&mut m.is_match[state][pos_state], 1);
+                rc.bit(&mut m.is_rep[state], 1);
+                if index == 0 {
+                    rc.bit(&mut m.is_rep0[state], 0);
+                    rc.bit(&mut m.is_rep0_long[state][pos_state], 1);
+                } else {
+                    rc.bit(&mut m.is_rep0[state], 1);
+                    if index == 1 {
+                        rc.bit(&mut m.is_rep1[state], 0);
+                    } else {
+                        rc.bit(&mut m.is_rep1[state], 1);
+                        rc.bit(&mut m.is_rep2[state], (index == 3) as u32);
+                    }
+                    let dist = m.reps[index];
+                    for i in (1..=index).rev() {
+                        m.reps[i] = m.reps[i - 1];
+                    }
+                    m.reps[0] = dist;
+                }
+                m.rep_len.encode(rc, len, pos_state);
+                m.state = if state < LIT_STATES { 8 } else { 11 };
+                len
+            }
+        }
+    }
+
+    /// Encodes data[start..end] as the body of one LZMA chunk, returning how
+    /// far it got (a match can run past the end) and the packed bytes.
+    fn encode_chunk(&mut self, start: usize, end: usize) -> (usize, Vec<u8>) {
+        let mut rc = RangeEncoder::new();
+        let mut pos = start;
+        while pos < end {
+            let mut packet = self.choose(pos);
+            // Matches have to end within the chunk.
+            match &mut packet {
+                Packet::Match { len, .. } | Packet::Rep { len, .. } => {
+                    *len = (*len).min(end - pos);
+                    if *len < MATCH_LEN_MIN {
+                        packet = Packet::Literal;
+                    }
+                }
+                _ => (),
+            }
+            let n = self.encode(&mut rc, pos, packet);
+            for p in pos..pos + n {
+                self.mf.insert(self.data, p);
+            }
+            pos += n;
+        }
+        (pos, rc.finish())
+    }
+}
+
+/// Compresses data into an imgtool style LZMA2 payload: the two header bytes
+/// followed by the LZMA2 chunks and the end marker.
+pub fn compress(data: &[u8]) -> Vec<u8> {
+    let props = ((PB * 5 + LP) * 9 + LC) as u8;
+    let mut out = vec![DICT_CODE, props];
+    let mut enc = Encoder {
+        data,
+        model: Model::new(),
+        mf: MatchFinder::new(data.len()),
+    };
+    let mut pos = 0;
+    let mut first = true;
+    let mut need_props = true;
+    let mut need_state_reset = false;
+
+    while pos < data.len() {
+        let end = (pos + CHUNK_SIZE).min(data.len());
+        let saved = enc.model.clone();
+        let (done, packed) = enc.encode_chunk(pos, end);
+        let unpacked = done - pos;
+
+        if packed.len() >= unpacked {
+            // Not worth compressing: store it and start over with a fresh
+            // model, as xz does.
+            enc.model = saved;
+            out.push(if first { CTRL_COPY_RESET_DICT } else { CTRL_COPY });
+            out.extend_from_slice(&((unpacked - 1) as u16).to_be_bytes());
+            out.extend_from_slice(&data[pos..done]);
+            enc.model = Model::new();
+            need_state_reset = true;
+        } else {
+            let ctrl = if first {
+                CTRL_RESET_DICT
+            } else if need_props {
+                CTRL_NEW_PROPS
+            } else if need_state_reset {
+                CTRL_RESET_STATE
+            } else {
+                CTRL_LZMA
+            };
+            let u = (unpacked - 1) as u32;
+            out.push(ctrl | (u >> 16) as u8);
+            out.extend_from_slice(&(u as u16).to_be_bytes());
+            out.extend_from_slice(&((packed.len() - 1) as u16).to_be_bytes());
+            if ctrl >= CTRL_NEW_PROPS {
+                out.push(props);
+            }
+            out.extend_from_slice(&packed);
+            need_props = false;
+            need_state_reset = false;
+        }
+        first = false;
+        pos = done;
+    }
+
+    out.push(CTRL_END);
+    out
+}
+
+/// Applies the ARM-Thumb BCJ filter, which the bootloader reverts while
+/// decompressing, turning the targets of BL instructions into absolute
+/// addresses.
+pub fn arm_thumb_filter(buf: &mut [u8]) {
+    let mut i = 0;
+    while i + 4 <= buf.len() {
+        if (buf[i + 1] & 0xF8) == 0xF0 && (buf[i + 3] & 0xF8) == 0xF8 {
+            let src = ((buf[i + 1] as u32 & 7) << 19) |
+                ((buf[i] as u32) << 11) |
+                ((buf[i + 3] as u32 & 7) << 8) |
+                (buf[i + 2] as u32);
+            let dest = ((src << 1).wrapping_add(i as u32 + 4)) >> 1;
+            buf[i + 1] = 0xF0 | ((dest >> 19) & 7) as u8;
+            buf[i] = (dest >> 11) as u8;
+            buf[i + 3] = 0xF8 | ((dest >> 8) & 7) as u8;
+            buf[i + 2] = dest as u8;
+            i += 2;
+        }
+        i += 2;
+    }
+}
+
+#[cfg(test)]
+mod test {
+    use super::*;
+
+    #[test]
+    fn header() {
+        let out = compress(&[0u8; 100]);
+        assert_eq!(out[0], DICT_CODE);
+        assert_eq!(out[1], 93);
+        assert_eq!(out[2], CTRL_RESET_DICT);
+        assert_eq!(*out.last().unwrap(), CTRL_END);
+        let packed: usize = u16::from_be_bytes(out[5..7].try_into().unwrap()) as usize + 1;
+        assert_eq!(out.len(), 2 + 1 + 4 + 1 + packed + 1);
+    }
+}
@@ -62,6 +62,10 @@ pub enum TlvKinds {
     ENCX25519 = 0x33,
     DEPENDENCY = 0x40,
     SECCNT = 0x50,
+    DECOMPSIZE = 0x70,
+    DECOMPSHA = 0x71,
+    DECOMPSIGNATURE = 0x72,
+    DELTABASE = 0x77,
 }
 
 #[allow(dead_code, non_camel_case_types)]
@@ -71,6 +75,9 @@ pub enum TlvFlags {
     ENCRYPTED_AES128 = 0x04,
     ENCRYPTED_AES256 = 0x08,
     RAM_LOAD = 0x20,
+    COMPRESSED_LZMA2 = 0x400,
+    COMPRESSED_ARM_THUMB = 0x800,
+    DELTA = 0x1000,
 }
 
 /// A generator for manifests.  The format of the manifest can be either a
@@ -90,6 +97,13 @@ pub trait ManifestGen {
     /// Add a dependency on another image.
     fn add_dependency(&mut self, id: u8, version: &ImageVersion);
 
+    /// Add a TLV to the protected area, after the dependencies and the
+    /// security counter.
+    fn add_protected_tlv(&mut self, kind: TlvKinds, data: &[u8]);
+
+    /// Set additional header flags.
+    fn add_flags(&mut self, flags: u32);
+
     /// Add a sequence of bytes to the payload that the manifest is
     /// protecting.
     fn add_bytes(&mut self, bytes: &[u8]);
@@ -126,6 +140,8 @@ pub struct TlvGen {
     kinds: Vec<TlvKinds>,
     payload: Vec<u8>,
     dependencies: Vec<Dependency>,
+    /// Other protected TLVs.
+    protected: Vec<(TlvKinds, Vec<u8>)>,
     enc_key: Vec<u8>,
     /// Should this signature be corrupted.
     gen_corrupted: bool,
@@ -345,7 +361,8 @@ impl ManifestGen for TlvGen {
 
     fn protect_size(&self) -> u16 {
         let mut size = 0;
-        if !self.dependencies.is_empty() || (Caps::HwRollbackProtection.present() && self.security_cnt.is_some()) {
+        if !self.dependencies.is_empty() || !self.protected.is_empty() ||
+            (Caps::HwRollbackProtection.present() && self.security_cnt.is_some()) {
             // include the TLV area header.
             size += 4;
             // add space for each dependency.
@@ -353,6 +370,9 @@ impl ManifestGen for TlvGen {
             if Caps::HwRollbackProtection.present() && self.security_cnt.is_some() {
                 size += 4 + 4;
             }
+            for (_, data) in &self.protected {
+                size += 4 + data.len() as u16;
+            }
         }
         size
     }
@@ -364,6 +384,14 @@ impl ManifestGen for TlvGen {
         });
     }
 
+    fn add_protected_tlv(&mut self, kind: TlvKinds, data: &[u8]) {
+        self.protected.push((kind, data.to_vec()));
+    }
+
+    fn add_flags(&mut self, flags: u32) {
+        self.flags |= flags;
+    }
+
     fn corrupt_sig(&mut self) {
         self.gen_corrupted = true;
     }
@@ -462,6 +490,12 @@ impl ManifestGen for TlvGen {
                 protected_tlv.write_u32::<LittleEndian>(self.security_cnt.unwrap() as u32).unwrap();
             }
 
+            for (kind, data) in &self.protected {
+                protected_tlv.write_u16::<LittleEndian>(*kind as u16).unwrap();
+                protected_tlv.write_u16::<LittleEndian>(data.len() as u16).unwrap();
+                protected_tlv.extend_from_slice(data);
+            }
+
             assert_eq!(size, protected_tlv.len() as u16, "protected TLV length incorrect");
         }
 
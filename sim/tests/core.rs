@@ -59,7 +59,9 @@ sim_test!(revert_with_fails, make_image(&NO_DEPS, false), run_revert_with_fails(
 sim_test!(perm_with_fails, make_image(&NO_DEPS, true), run_perm_with_fails());
 sim_test!(perm_with_random_fails, make_image(&NO_DEPS, true), run_perm_with_random_fails(5));
 sim_test!(norevert, make_image(&NO_DEPS, true), run_norevert());
+sim_test!(swap_skip_unchanged, make_image(&NO_DEPS, true), run_swap_skip_unchanged());
 sim_test!(oversized_secondary_slot, make_oversized_secondary_slot_image(), run_fail_upgrade_primary_intact());
+sim_test!(delta_wrong_base, make_no_upgrade_image(&NO_DEPS, ImageManipulation::None), run_delta_wrong_base());
 #[cfg(feature = "check-load-addr")]
 sim_test!(wrong_load_addr, make_bad_secondary_slot_image(ImageManipulation::WrongOffset), run_fail_upgrade_primary_intact());
 
@@ -83,6 +85,11 @@ sim_test!(ram_load_failed_validation, make_no_upgrade_image(&NO_DEPS, ImageManip
 #[cfg(not(feature = "check-load-addr"))]
 sim_test!(ram_load_corrupt_higher_version_image, make_no_upgrade_image(&NO_DEPS, ImageManipulation::CorruptHigherVersionImage), run_ram_load_boot_with_result(true));
 
+sim_test!(img_hash_throughput, make_no_upgrade_image(&NO_DEPS, ImageManipulation::None), run_hash_bench());
+sim_test!(rsa_verify_timing, make_no_upgrade_image(&NO_DEPS, ImageManipulation::None), run_rsa_verify_bench());
+sim_test!(erase_timing, make_no_upgrade_image(&NO_DEPS, ImageManipulation::None), run_erase_bench());
+sim_test!(validation_cache, make_no_upgrade_image(&NO_DEPS, ImageManipulation::None), run_validation_cache());
+
 sim_test!(hw_prot_missing_security_cnt, make_image_with_security_counter(None), run_hw_rollback_prot());
 sim_test!(hw_prot_failed_security_cnt_check, make_image_with_security_counter(Some(0)), run_hw_rollback_prot());
 